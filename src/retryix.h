@@ -2,6 +2,7 @@
 #define RETRYIX_H
 
 #include <stddef.h>
+#include <stdbool.h>
 #include <CL/cl.h>
 
 #ifdef _WIN32
@@ -55,16 +56,733 @@ int retryixCheckDeviceCapability(cl_device_id device_id, const char* capability)
 #define RETRYIX_ERROR_OPENCL    -4
 #define RETRYIX_ERROR_BUFFER_TOO_SMALL -5
 #define RETRYIX_ERROR_FILE_IO   -6
+#define RETRYIX_ERROR_NOT_FOUND -7
+#define RETRYIX_ERROR_INVALID_ARG -8
 
 // === 輔助宏 ===
 #define RETRYIX_MAX_PLATFORMS   16
 #define RETRYIX_MAX_DEVICES     64
 #define RETRYIX_MAX_NAME_LEN    256
+#define RETRYIX_MAX_HAZARD_WAITS 16     // 每個記憶體物件最多追蹤的未完成讀取數
 
 // === Kernel 測試與管理 API ===
+// 內核優化等級
+typedef enum {
+    RETRYIX_KERNEL_OPT_NONE = 0,
+    RETRYIX_KERNEL_OPT_BASIC = 1,
+    RETRYIX_KERNEL_OPT_AGGRESSIVE = 2,
+    RETRYIX_KERNEL_OPT_VENDOR_SPECIFIC = 3  // 啟用廠商/擴展變體層（子群組、fp16；64 位元原子依設備能力於各層提供）
+} retryix_kernel_opt_level_t;
+
 RETRYIX_API void retryix_kernel_atomic_add_demo(void);
 int retryix_kernel_register_template(const char* template_name, const char* kernel_name, const char* source_code);
 int retryix_kernel_execute(const char* template_name, size_t global_work_size, size_t local_work_size, ...);
+cl_kernel retryix_kernel_compile_best(const char* template_name);
+
+// 多內核程序與執行緒安全的內核實例
+// 模板註冊需在並行啟動前完成；之後 execute 系列可由多個執行緒同時呼叫，
+// 每個執行緒使用各自的內核實例（OpenCL 2.1+ 以 clCloneKernel 建立，否則 clCreateKernel）
+int retryix_kernel_register_program(const char* template_name, const char* source_code);
+int retryix_kernel_execute_kernel(const char* template_name, const char* kernel_name,
+                                  size_t global_work_size, size_t local_work_size, ...);
+// 逐次啟動：借出池中的獨立實例，用畢歸還
+cl_kernel retryix_kernel_acquire(const char* template_name, const char* kernel_name);
+int retryix_kernel_release(const char* template_name, cl_kernel kernel);
+
+// 執行期常數特化：defines 為以 NULL 結尾的 "NAME=VALUE" 陣列，注入為 -D 選項
+// 特化版本於背景編譯，完成前回傳通用變體；結果依 KernelEngine\CacheSize 以 LRU 快取
+// 回傳的 cl_kernel 由管理器持有，LRU 淘汰時會釋放；多執行緒並行時請改用 execute_specialized（啟動期間不會被淘汰）
+cl_kernel retryix_kernel_compile_specialized(const char* template_name, const char* const* defines);
+cl_kernel retryix_kernel_compile_specialized_wait(const char* template_name, const char* const* defines);
+int retryix_kernel_execute_specialized(const char* template_name, const char* const* defines,
+                                       size_t global_work_size, size_t local_work_size, ...);
+
+// 工作組大小自動調校：參數格式同 retryix_kernel_execute（value, size, ..., NULL）
+// 調校會重複執行內核，僅適用於可重複執行的內核或預備資料；一般啟動只套用已調校（或持久化）的結果，不會自行調校
+int retryix_kernel_autotune(const char* template_name, size_t global_work_size, ...);
+int retryix_kernel_set_bounds_checked(const char* template_name, int bounds_checked);
+// 預設值取自 KernelEngine\OptimizationLevel
+int retryix_kernel_set_opt_level(retryix_kernel_opt_level_t level);
+
+// 變體量測模式：編譯所有可行策略，以使用者提供的代表性啟動量測並選出最快且正確的變體
+// launch 需於 queue 上排入一次完整工作（含必要的輸入重置），成功回傳 0，可輸出內核事件供設備計時
+typedef int (*retryix_kernel_launch_fn)(cl_kernel kernel, cl_command_queue queue, cl_event* out_event, void* user_data);
+// 驗證 launch 後的輸出，正確回傳 0；傳入 NULL 表示不驗證
+typedef int (*retryix_kernel_verify_fn)(void* user_data);
+int retryix_kernel_benchmark_variants(const char* template_name, retryix_kernel_launch_fn launch,
+                                      retryix_kernel_verify_fn verify, void* user_data);
+
+// === 記憶體管理 API ===
+// 記憶體類型定義
+typedef enum {
+    RETRYIX_MEM_READ_ONLY = 0x1,
+    RETRYIX_MEM_WRITE_ONLY = 0x2,
+    RETRYIX_MEM_READ_WRITE = 0x4,
+    RETRYIX_MEM_HOST_PTR = 0x8,
+    RETRYIX_MEM_ALLOC_HOST_PTR = 0x10,
+    RETRYIX_MEM_COPY_HOST_PTR = 0x20,
+    RETRYIX_MEM_PERSISTENT = 0x40,
+    RETRYIX_MEM_ZERO_COPY = 0x80
+} retryix_memory_flags_t;
+
+typedef struct retryix_memory_context retryix_memory_context_t;
+
+retryix_memory_context_t* retryix_memory_init(cl_context context, cl_device_id device);
+// 獨立管理器（例如每個子設備一個）：以 retryix_memory_bind 綁定至呼叫執行緒後，retryix_memory_alloc 自該管理器配置，
+// 以指標操作的 API 先在綁定的管理器、再在全局管理器中查找。限制：
+//   - 綁定只作用於呼叫執行緒，交給執行緒池的任務不會繼承，需在任務內自行綁定
+//   - 持有 context 的模組（primitives、sort、hash、spmv、blas、half、placement）以 retryix_memory_alloc_from
+//     自全局管理器配置內部緩衝區，與呼叫端綁定無關；傳入這些模組的緩衝區需屬於其 context
+retryix_memory_context_t* retryix_memory_create(cl_context context, cl_device_id device);
+retryix_memory_context_t* retryix_memory_bind(retryix_memory_context_t* ctx);
+void retryix_memory_destroy(retryix_memory_context_t* ctx);
+void* retryix_memory_alloc(size_t size, retryix_memory_flags_t flags, const char* debug_name);
+// 自指定的管理器配置（NULL 為全局管理器），不受呼叫執行緒的綁定影響
+void* retryix_memory_alloc_from(retryix_memory_context_t* ctx, size_t size, retryix_memory_flags_t flags,
+                                const char* debug_name);
+int retryix_memory_free(void* ptr);
+void* retryix_memory_map(void* ptr, cl_command_queue queue, retryix_memory_flags_t map_flags);
+int retryix_memory_unmap(void* ptr, cl_command_queue queue);
+int retryix_memory_copy_to_device(void* host_ptr, cl_command_queue queue, bool blocking);
+int retryix_memory_copy_from_device(void* host_ptr, cl_command_queue queue, bool blocking);
+void retryix_memory_print_stats(void);
+void retryix_memory_cleanup(void);
+
+// === SVM API ===
+// SVM 能力等級定義 - 修正枚舉衝突
+typedef enum {
+    RETRYIX_SVM_LEVEL_NONE = 0,           // 不支援 SVM
+    RETRYIX_SVM_LEVEL_COARSE_GRAIN,       // 粗粒度 SVM (手動同步)
+    RETRYIX_SVM_LEVEL_FINE_GRAIN,         // 細粒度 SVM (自動同步)
+    RETRYIX_SVM_LEVEL_FINE_GRAIN_SYSTEM,  // 系統級細粒度 SVM
+    RETRYIX_SVM_LEVEL_EMULATED            // 軟體模擬 SVM
+} retryix_svm_level_t;
+
+// SVM 記憶體標誌 - 與等級分開定義
+typedef enum {
+    RETRYIX_SVM_FLAG_READ_WRITE = 0x1,
+    RETRYIX_SVM_FLAG_READ_ONLY = 0x2,
+    RETRYIX_SVM_FLAG_WRITE_ONLY = 0x4,
+    RETRYIX_SVM_FLAG_ATOMIC = 0x8,
+    RETRYIX_SVM_FLAG_FINE_GRAIN = 0x10,
+    RETRYIX_SVM_FLAG_COARSE_GRAIN = 0x20
+} retryix_svm_flags_t;
+
+typedef struct retryix_svm_context retryix_svm_context_t;
+
+retryix_svm_context_t* retryix_svm_create_context(cl_context context, cl_device_id device);
+void retryix_svm_destroy_context(retryix_svm_context_t* svm_ctx);
+retryix_svm_level_t retryix_svm_probe_capabilities(cl_device_id device, cl_bitfield* capabilities);
+void* retryix_svm_alloc(retryix_svm_context_t* ctx, size_t size, retryix_svm_flags_t flags);
+int retryix_svm_free(retryix_svm_context_t* ctx, void* ptr);
+int retryix_svm_map(retryix_svm_context_t* ctx, void* ptr, cl_command_queue queue);
+int retryix_svm_unmap(retryix_svm_context_t* ctx, void* ptr, cl_command_queue queue);
+
+// === 相依追蹤 API ===
+// 記憶體描述符記錄最後寫入事件與未完成的讀取事件；傳輸與追蹤式啟動只等待實際需要的事件
+// （RAW / WAR / WAW），不再以 clFinish 保守同步。主機端讀寫資料前需呼叫 *_sync
+typedef enum {
+    RETRYIX_ACCESS_AUTO = 0,        // 依內核參數資訊推斷（const / __constant 視為唯讀，否則讀寫）
+    RETRYIX_ACCESS_READ = 0x1,
+    RETRYIX_ACCESS_WRITE = 0x2,
+    RETRYIX_ACCESS_READ_WRITE = 0x3
+} retryix_access_t;
+
+cl_mem retryix_memory_get_device_mem(void* host_ptr);
+// 將存取 host_ptr 緩衝區前需等待的事件附加至 waits（已存在者不重複）
+int retryix_memory_hazard_waits(void* host_ptr, retryix_access_t access,
+                                cl_event* waits, cl_uint max_waits, cl_uint* num_waits);
+// 登記已排入的存取事件（內部保留參考）
+int retryix_memory_hazard_record(void* host_ptr, retryix_access_t access, cl_event event);
+int retryix_memory_sync(void* host_ptr);
+// 以上函數各自鎖定管理器，可多執行緒呼叫。對同一批緩衝區「收集等待 -> 排入命令 -> 登記事件」需在
+// lock/unlock 區間內完成（可重入），否則並行的排入可能遺失相依，或等待已被其他執行緒釋放的事件
+void retryix_memory_lock(void);
+void retryix_memory_unlock(void);
+int retryix_svm_hazard_waits(retryix_svm_context_t* ctx, void* ptr, retryix_access_t access,
+                             cl_event* waits, cl_uint max_waits, cl_uint* num_waits);
+int retryix_svm_hazard_record(retryix_svm_context_t* ctx, void* ptr, retryix_access_t access, cl_event event);
+int retryix_svm_sync(retryix_svm_context_t* ctx, void* ptr);
+// SVM 管理器同樣以可重入鎖保護描述符與存取紀錄；begin_launch 至 end_launch 之間需持有
+void retryix_svm_lock(retryix_svm_context_t* ctx);
+void retryix_svm_unlock(retryix_svm_context_t* ctx);
+
+// SVM 內核參數：原生等級以 clSetKernelArgSVMPointer 綁定，模擬等級綁定回退緩衝區
+// 標記為間接存取的配置（被其他 SVM 結構內的指標引用）於每次啟動自動以 CL_KERNEL_EXEC_INFO_SVM_PTRS 登記；
+// 主機已映射的粗粒度配置在啟動前自動解映射，啟動後非阻塞重新映射（主機存取前呼叫 retryix_svm_sync）
+// begin_launch 失敗時已自動解映射的配置會重新映射，不需呼叫 end_launch
+int retryix_svm_set_indirect(retryix_svm_context_t* ctx, void* ptr, int indirect);
+int retryix_svm_set_kernel_arg(retryix_svm_context_t* ctx, cl_kernel kernel, cl_uint arg_index, void* ptr);
+int retryix_svm_begin_launch(retryix_svm_context_t* ctx, cl_kernel kernel, cl_command_queue queue,
+                             void* const* ptrs, const retryix_access_t* access, cl_uint count,
+                             cl_event* waits, cl_uint max_waits, cl_uint* num_waits);
+int retryix_svm_end_launch(retryix_svm_context_t* ctx, cl_command_queue queue,
+                           void* const* ptrs, const retryix_access_t* access, cl_uint count,
+                           cl_event event);
+// begin_launch 成功但內核排入失敗時以此取代 end_launch：重新映射自動解映射的配置
+int retryix_svm_abort_launch(retryix_svm_context_t* ctx, cl_command_queue queue);
+
+// 追蹤式內核參數
+typedef enum {
+    RETRYIX_ARG_VALUE = 0,          // 以值傳遞：value 指向資料，size 為大小
+    RETRYIX_ARG_BUFFER,             // retryix_memory_alloc 配置的主機指標（value），存取模式參與相依追蹤
+    RETRYIX_ARG_LOCAL,              // __local 記憶體：size 為位元組數
+    RETRYIX_ARG_SVM                 // SVM 指標（value，可指向配置內部）；需先 retryix_kernel_set_svm_context
+} retryix_kernel_arg_kind_t;
+
+typedef struct {
+    retryix_kernel_arg_kind_t kind;
+    retryix_access_t access;        // 僅 BUFFER / SVM 使用
+    const void* value;
+    size_t size;
+} retryix_kernel_arg_t;
+
+// 連結 SVM 管理器後，所有 execute 系列啟動都會登記間接存取的 SVM 配置（SVM 管理器不具執行緒安全）
+int retryix_kernel_set_svm_context(retryix_svm_context_t* svm_context);
+// 非阻塞啟動：依各緩衝區參數的存取模式插入等待事件並登記本次啟動；
+// out_event 非 NULL 時回傳啟動事件（呼叫端負責釋放）
+int retryix_kernel_execute_tracked(const char* template_name, const char* kernel_name,
+                                   size_t global_work_size, size_t local_work_size,
+                                   const retryix_kernel_arg_t* args, cl_uint num_args, cl_event* out_event);
+
+// 原子聚合量測：單一計數器上比較 naive（同 retryix_kernel_atomic_add_demo）、
+// 階層式聚合（子群組 -> local memory -> 每組一次全域原子）與兩階段歸約的吞吐量
+int retryix_kernel_atomic_benchmark(size_t num_items, int iterations);
+
+// === 任務圖 API ===
+// 節點為傳輸、內核啟動或主機回呼；邊由宣告的緩衝區存取（RAW/WAR/WAW）與明確相依推導，
+// 以 cl_event 等待清單在亂序佇列（或多個循序佇列）上執行，可重複提交
+typedef struct retryix_graph retryix_graph_t;
+typedef void (*retryix_graph_host_fn)(void* user_data);
+
+retryix_graph_t* retryix_graph_create(cl_context context, cl_device_id device);
+void retryix_graph_destroy(retryix_graph_t* graph);
+// 以下新增節點的函數回傳節點編號，失敗回傳 -1
+int retryix_graph_add_write(retryix_graph_t* graph, cl_mem buffer, size_t offset, size_t size, const void* host_ptr);
+int retryix_graph_add_read(retryix_graph_t* graph, cl_mem buffer, size_t offset, size_t size, void* host_ptr);
+int retryix_graph_add_copy(retryix_graph_t* graph, cl_mem src, size_t src_offset,
+                           cl_mem dst, size_t dst_offset, size_t size);
+int retryix_graph_add_kernel(retryix_graph_t* graph, cl_kernel kernel, cl_uint work_dim,
+                             const size_t* global_work_size, const size_t* local_work_size);
+int retryix_graph_add_host(retryix_graph_t* graph, retryix_graph_host_fn fn, void* user_data);
+int retryix_graph_set_arg(retryix_graph_t* graph, int node_index, cl_uint arg_index, size_t size, const void* value);
+int retryix_graph_reads(retryix_graph_t* graph, int node_index, cl_mem buffer);
+int retryix_graph_writes(retryix_graph_t* graph, int node_index, cl_mem buffer);
+int retryix_graph_add_dependency(retryix_graph_t* graph, int from, int to);
+int retryix_graph_submit(retryix_graph_t* graph);
+int retryix_graph_wait(retryix_graph_t* graph);
+double retryix_graph_critical_path_ms(retryix_graph_t* graph);
+void retryix_graph_print_timing(retryix_graph_t* graph);
+
+// === 自動配置 API ===
+// 依用途提示、設備能力（SVM 等級、CL_DEVICE_HOST_UNIFIED_MEMORY）與短時間頻寬探測，
+// 為每筆配置選擇 SVM、零拷貝或設備常駐；可以 Placement\Force 強制（1 DEVICE / 2 ZERO_COPY / 3 SVM）
+typedef enum {
+    RETRYIX_USAGE_HOST_WRITE_ONCE = 0x1,    // 主機寫入一次
+    RETRYIX_USAGE_DEVICE_READ_MANY = 0x2,   // 設備多次讀取
+    RETRYIX_USAGE_HOST_READ_BACK = 0x4,     // 主機讀回結果
+    RETRYIX_USAGE_SHARED_ATOMIC = 0x8       // 主機與設備共用原子操作
+} retryix_usage_hint_t;
+
+typedef enum {
+    RETRYIX_PLACEMENT_DEVICE = 0,           // 設備常駐（retryix_memory_alloc + 顯式傳輸）
+    RETRYIX_PLACEMENT_ZERO_COPY,            // 主機記憶體零拷貝（RETRYIX_MEM_ZERO_COPY）
+    RETRYIX_PLACEMENT_SVM,                  // retryix_svm_alloc
+    RETRYIX_PLACEMENT_COUNT
+} retryix_placement_t;
+
+int retryix_placement_init(cl_context context, cl_device_id device, cl_command_queue queue,
+                           retryix_svm_context_t* svm);
+void retryix_placement_cleanup(void);
+const char* retryix_placement_name(retryix_placement_t placement);
+// hints 為 retryix_usage_hint_t 的組合
+void* retryix_alloc_auto(size_t size, unsigned int hints, const char* debug_name, retryix_placement_t* out_placement);
+int retryix_free_auto(void* ptr);
+int retryix_alloc_auto_placement(void* ptr, retryix_placement_t* out_placement);
+int retryix_alloc_auto_arg(void* ptr, retryix_access_t access, retryix_kernel_arg_t* out_arg);
+// 主機寫入後 publish，主機讀取前 acquire
+int retryix_alloc_auto_publish(void* ptr, cl_command_queue queue);
+int retryix_alloc_auto_acquire(void* ptr, cl_command_queue queue);
+void retryix_placement_print_report(void);
+
+// === 命令序列錄製與重播 API ===
+// 錄製一串傳輸與內核啟動，緩衝區與純量以槽位符號綁定；結束錄製時一次驗證並設定全部參數，
+// 重播只重設變動的槽位後依序排入。錄製的主機指標於重播時直接使用
+typedef struct retryix_recording retryix_recording_t;
+
+retryix_recording_t* retryix_record_create(cl_command_queue queue);
+void retryix_record_destroy(retryix_recording_t* rec);
+// 槽位函數回傳槽編號，命令函數回傳命令編號，失敗回傳 -1
+int retryix_record_buffer_slot(retryix_recording_t* rec, cl_mem buffer);
+int retryix_record_scalar_slot(retryix_recording_t* rec, size_t size, const void* initial);
+int retryix_record_write(retryix_recording_t* rec, int slot, size_t offset, size_t size, const void* host_ptr);
+int retryix_record_read(retryix_recording_t* rec, int slot, size_t offset, size_t size, void* host_ptr);
+int retryix_record_kernel(retryix_recording_t* rec, const char* template_name, const char* kernel_name,
+                          size_t global_work_size, size_t local_work_size);
+int retryix_record_arg_value(retryix_recording_t* rec, int cmd_index, cl_uint arg_index, size_t size, const void* value);
+int retryix_record_arg_local(retryix_recording_t* rec, int cmd_index, cl_uint arg_index, size_t size);
+int retryix_record_arg_buffer(retryix_recording_t* rec, int cmd_index, cl_uint arg_index, int slot);
+int retryix_record_arg_scalar(retryix_recording_t* rec, int cmd_index, cl_uint arg_index, int slot);
+int retryix_record_end(retryix_recording_t* rec);
+// 重播前可更新的綁定
+int retryix_record_bind_buffer(retryix_recording_t* rec, int slot, cl_mem buffer);
+int retryix_record_set_scalar(retryix_recording_t* rec, int slot, const void* value);
+int retryix_record_set_host_ptr(retryix_recording_t* rec, int cmd_index, void* host_ptr);
+// out_event 為 NULL 時等待完成，否則回傳最後一個命令的事件
+int retryix_record_replay(retryix_recording_t* rec, cl_event* out_event);
+// 量測重播與等效逐次呼叫的主機端開銷（微秒/迭代）
+int retryix_record_benchmark(retryix_recording_t* rec, int iterations, double* out_replay_us, double* out_individual_us);
+void retryix_record_print_stats(retryix_recording_t* rec);
+
+// === 平行原語 API ===
+// reduce / scan / compact 以內核模板（retryix_prim_<type>）實作，多階段派送可處理任意長度（上限 2^31 - 1）。
+// 輸入輸出可為 retryix_memory_alloc 的主機指標或 SVM 指標（需先 retryix_kernel_set_svm_context），
+// 啟動經由相依追蹤排入；結果留在設備端，主機讀取前以 copy_from_device / retryix_svm_sync 取得。
+// 暫存緩衝區由模組重用，不具執行緒安全
+typedef enum {
+    RETRYIX_PRIM_INT = 0,
+    RETRYIX_PRIM_FLOAT,
+    RETRYIX_PRIM_DOUBLE,                    // 需 cl_khr_fp64
+    RETRYIX_PRIM_TYPE_COUNT
+} retryix_prim_type_t;
+
+typedef enum {
+    RETRYIX_PRIM_OP_SUM = 0,
+    RETRYIX_PRIM_OP_MIN,
+    RETRYIX_PRIM_OP_MAX,
+    RETRYIX_PRIM_OP_COUNT
+} retryix_prim_op_t;
+
+int retryix_primitives_init(cl_context context, cl_device_id device, cl_command_queue queue);
+void retryix_primitives_cleanup(void);
+// out_value 為主機端單一元素（阻塞至結果可用）
+int retryix_prim_reduce(retryix_prim_type_t type, retryix_prim_op_t op, const void* input, size_t count, void* out_value);
+// input 與 output 可相同（原地掃描）
+int retryix_prim_scan(retryix_prim_type_t type, const void* input, void* output, size_t count, int inclusive);
+// 保留 flags（cl_int，非零保留）對應的元素；flags 為 NULL 時保留非零元素。out_count 非 NULL 時阻塞讀回保留數
+int retryix_prim_compact(retryix_prim_type_t type, const void* input, const void* flags, void* output,
+                         size_t count, size_t* out_count);
+// 多執行緒 CPU 基準（主機指標；於共用執行緒池執行，分段數取自 Primitives\CpuThreads，0 為池大小 + 1）
+int retryix_prim_cpu_reduce(retryix_prim_type_t type, retryix_prim_op_t op, const void* input, size_t count, void* out_value);
+int retryix_prim_cpu_scan(retryix_prim_type_t type, const void* input, void* output, size_t count, int inclusive);
+int retryix_prim_cpu_compact(retryix_prim_type_t type, const void* input, const void* flags, void* output,
+                             size_t count, size_t* out_count);
+int retryix_primitives_benchmark(retryix_prim_type_t type, size_t count, int iterations);
+
+// === 排序 API ===
+// LSD 基數排序：tile 內以 local memory 掃描逐位元 split，tile 直方圖經 retryix_prim_scan 取得全域偏移後分散寫回；
+// 位數寬度依 local memory 大小選擇（可以 Sort\RadixBits 指定）。鍵為無號 32/64 位元，payload 為選用的 cl_uint，
+// 排序穩定且原地完成。緩衝區可為 retryix_memory_alloc 的主機指標或 SVM 指標，主機讀取前需同步
+typedef enum {
+    RETRYIX_SORT_KEY_U32 = 0,
+    RETRYIX_SORT_KEY_U64,
+    RETRYIX_SORT_KEY_TYPE_COUNT
+} retryix_sort_key_t;
+
+int retryix_sort_init(cl_context context, cl_device_id device, cl_command_queue queue);
+void retryix_sort_cleanup(void);
+// key_bits 為參與排序的低位元數（0 為完整寬度），鍵範圍已知時可減少遍數
+int retryix_sort_radix(retryix_sort_key_t key_type, void* keys, void* values, size_t count, cl_uint key_bits);
+// 各分段獨立排序；segment_offsets 為 num_segments + 1 個 cl_uint（首項 0、末項 count、遞增）
+int retryix_sort_segmented(retryix_sort_key_t key_type, void* keys, void* values, size_t count,
+                           const void* segment_offsets, size_t num_segments);
+int retryix_sort_benchmark(retryix_sort_key_t key_type, size_t count, int with_values, int iterations);
+
+// === 稠密線性代數 API ===
+// 列主序、不轉置的 GEMM（C = alpha * A * B + beta * C）與 GEMV（y = alpha * A * x + beta * y）。
+// GEMM 以 local memory 分塊並以向量型別累加，分塊大小 / 每 work-item 工作量 / 向量寬度於首次使用時依設備掃描選出，
+// 存入調校快取（blas.sgemm 等）；雙精度僅在設備支援 cl_khr_fp64 時可用。緩衝區可為 retryix_memory_alloc 或 SVM 指標
+typedef enum {
+    RETRYIX_BLAS_FLOAT = 0,
+    RETRYIX_BLAS_DOUBLE,
+    RETRYIX_BLAS_TYPE_COUNT
+} retryix_blas_type_t;
+
+int retryix_blas_init(cl_context context, cl_device_id device, cl_command_queue queue);
+void retryix_blas_cleanup(void);
+// 忽略快取重新調校（調校矩陣大小取自 Blas\TuneSize）
+int retryix_blas_tune(retryix_blas_type_t type);
+int retryix_blas_sgemm(size_t M, size_t N, size_t K, float alpha, const void* A, size_t lda,
+                       const void* B, size_t ldb, float beta, void* C, size_t ldc);
+int retryix_blas_dgemm(size_t M, size_t N, size_t K, double alpha, const void* A, size_t lda,
+                       const void* B, size_t ldb, double beta, void* C, size_t ldc);
+int retryix_blas_sgemv(size_t M, size_t N, float alpha, const void* A, size_t lda,
+                       const void* x, float beta, void* y);
+int retryix_blas_dgemv(size_t M, size_t N, double alpha, const void* A, size_t lda,
+                       const void* x, double beta, void* y);
+// n x n 方陣的 GFLOP/s 與正確性（對照未最佳化的 CPU 三重迴圈）
+int retryix_blas_benchmark(size_t n, int iterations);
+
+// === 稀疏矩陣向量乘法 API ===
+// y = A * x，A 由 CSR 建立後轉為 CSR scalar（每列一個 work-item）、CSR vector（每列一組 work-item）或
+// SELL-C-σ（C 列一組交錯儲存，σ 列內依列長排序；參數取自 Spmv\SellChunk / Spmv\SellSigma）。
+// AUTO 依列長統計與 SELL 補零比例選擇格式；值型別沿用 retryix_blas_type_t
+typedef enum {
+    RETRYIX_SPMV_AUTO = 0,
+    RETRYIX_SPMV_CSR_SCALAR,
+    RETRYIX_SPMV_CSR_VECTOR,
+    RETRYIX_SPMV_SELL,
+    RETRYIX_SPMV_FORMAT_COUNT
+} retryix_spmv_format_t;
+
+typedef struct retryix_spmv_matrix retryix_spmv_matrix_t;
+
+int retryix_spmv_init(cl_context context, cl_device_id device, cl_command_queue queue);
+void retryix_spmv_cleanup(void);
+// row_ptr（rows + 1）、col_idx、values 為 retryix_memory_alloc 緩衝區且主機端內容有效；CSR 格式直接沿用，
+// 需存活至 retryix_spmv_destroy
+retryix_spmv_matrix_t* retryix_spmv_create(retryix_blas_type_t type, size_t rows, size_t cols,
+                                           const cl_uint* row_ptr, const cl_uint* col_idx, const void* values,
+                                           retryix_spmv_format_t format);
+void retryix_spmv_destroy(retryix_spmv_matrix_t* matrix);
+retryix_spmv_format_t retryix_spmv_get_format(const retryix_spmv_matrix_t* matrix);
+const char* retryix_spmv_format_name(retryix_spmv_format_t format);
+// x、y 可為 retryix_memory 或 SVM 指標，主機讀取 y 前需同步
+int retryix_spmv_multiply(const retryix_spmv_matrix_t* matrix, const void* x, void* y);
+// 各格式的 GB/s（相對 STREAM copy 頻寬，結果快取於 spmv.stream）與 CPU CSR 比對
+int retryix_spmv_benchmark(retryix_blas_type_t type, size_t rows, int iterations);
+
+// === 設備端雜湊表 API ===
+// 開放定址線性探測表，鍵 / 值皆為 cl_uint（0xFFFFFFFF 保留為空槽），以 RETRYIX_ATOMIC_CAS_VALUE 並行插入；
+// 需全域原子操作。表可置於設備記憶體或 SVM（細粒度 SVM 時 retryix_hash_sync 後主機可直接讀取鍵值陣列）。
+// 輸入 / 輸出陣列可為 retryix_memory_alloc 或 SVM 指標；負載上限取自 Hash\MaxLoadFactorPct
+// 鍵 0xFFFFFFFF 為空槽標記，無法存放：插入時略過並列印略過數（不計入 out_inserted，不視為錯誤），查詢時一律找不到。
+// 各 API 可由多執行緒呼叫（共用統計緩衝區以互斥鎖串行化），但同一張表的並行修改由呼叫端負責
+#define RETRYIX_HASH_NOT_FOUND 0xFFFFFFFFu
+
+typedef struct retryix_hash_table retryix_hash_table_t;
+
+int retryix_hash_init(cl_context context, cl_device_id device, cl_command_queue queue, retryix_svm_context_t* svm);
+void retryix_hash_cleanup(void);
+// max_load_factor <= 0 時使用設定值
+size_t retryix_hash_capacity_for(size_t expected_items, double max_load_factor);
+retryix_hash_table_t* retryix_hash_create(size_t expected_items, double max_load_factor, int use_svm);
+void retryix_hash_destroy(retryix_hash_table_t* table);
+int retryix_hash_clear(retryix_hash_table_t* table);
+// values 為 NULL 時只插入鍵；out_inserted 回報新插入的相異鍵數
+int retryix_hash_insert(retryix_hash_table_t* table, const void* keys, const void* values, size_t count,
+                        size_t* out_inserted);
+// 找不到的鍵輸出 RETRYIX_HASH_NOT_FOUND；out_found 非 NULL 時阻塞讀回命中數
+int retryix_hash_lookup(const retryix_hash_table_t* table, const void* keys, void* out_values, size_t count,
+                        size_t* out_found);
+int retryix_hash_count(const retryix_hash_table_t* table, size_t* out_count);
+int retryix_hash_count_distinct(const void* keys, size_t count, size_t* out_distinct);
+size_t retryix_hash_size(const retryix_hash_table_t* table);
+size_t retryix_hash_capacity(const retryix_hash_table_t* table);
+double retryix_hash_load_factor(const retryix_hash_table_t* table);
+int retryix_hash_sync(retryix_hash_table_t* table);
+const cl_uint* retryix_hash_keys(const retryix_hash_table_t* table);
+const cl_uint* retryix_hash_values(const retryix_hash_table_t* table);
+int retryix_hash_benchmark(size_t count, int iterations);
+
+// === 半精度儲存 API ===
+// 設備端緩衝區以 IEEE half 儲存（內核以 RETRYIX_HALF_LOAD / STORE 存取），主機端以 float32 上傳/下載，
+// 轉換於 pinned 暫存區進行（F16C 可用時向量化），傳輸量與設備記憶體減半；需 Applications\AI\FP16Support
+int retryix_half_init(cl_context context, cl_device_id device, cl_command_queue queue);
+void retryix_half_cleanup(void);
+void* retryix_half_alloc(size_t count, retryix_memory_flags_t flags, const char* debug_name);
+int retryix_half_free(void* buffer);
+int retryix_half_upload(void* buffer, const float* src, size_t count, int blocking);
+int retryix_half_download(void* buffer, float* dst, size_t count);
+int retryix_half_scale(void* buffer, size_t count, float alpha);
+// 主機端轉換（最近偶數捨入；未初始化亦可使用）
+void retryix_half_from_float(cl_half* dst, const float* src, size_t count);
+void retryix_half_to_float(float* dst, const cl_half* src, size_t count);
+int retryix_half_host_simd(void);
+int retryix_half_benchmark(size_t count, int iterations);
+
+// === 傳輸時轉換 API ===
+// 上傳時將 AoS 記錄拆分為各欄位的 SoA 設備緩衝區，型別轉換與打包在同一次走訪中寫入 pinned 暫存區；下載為反向
+#define RETRYIX_TRANSFORM_MAX_FIELDS      32
+#define RETRYIX_TRANSFORM_MAX_COMPONENTS  16
+
+typedef enum {
+    RETRYIX_FIELD_U8 = 0,
+    RETRYIX_FIELD_I8,
+    RETRYIX_FIELD_U16,
+    RETRYIX_FIELD_I16,
+    RETRYIX_FIELD_U32,
+    RETRYIX_FIELD_I32,
+    RETRYIX_FIELD_F16,
+    RETRYIX_FIELD_F32,
+    RETRYIX_FIELD_F64,
+    RETRYIX_FIELD_TYPE_COUNT
+} retryix_field_type_t;
+
+typedef struct {
+    size_t offset;                      // 欄位在主機記錄內的位元組偏移
+    retryix_field_type_t host_type;
+    retryix_field_type_t device_type;   // 整數目標飽和、浮點轉整數採最近偶數捨入
+    cl_uint components;                 // 每筆記錄的元素數（例如 float3 為 3），於設備端連續存放
+} retryix_field_desc_t;
+
+typedef struct {
+    size_t stride;                      // 主機記錄大小（通常為 sizeof(struct)）
+    const retryix_field_desc_t* fields;
+    cl_uint num_fields;
+} retryix_layout_t;
+
+int retryix_transform_init(cl_context context, cl_device_id device, cl_command_queue queue);
+void retryix_transform_cleanup(void);
+// 欄位 field 於設備端 count 筆記錄所需的位元組數（buffers[field] 至少需此大小）
+size_t retryix_transform_field_bytes(const retryix_layout_t* layout, cl_uint field, size_t count);
+const char* retryix_transform_type_name(retryix_field_type_t type);
+// buffers[f] 為 retryix_memory_alloc 配置的指標，直接寫入設備端（主機影子不更新）
+int retryix_transform_upload(const retryix_layout_t* layout, const void* records, size_t count,
+                             void* const* buffers, int blocking);
+int retryix_transform_download(const retryix_layout_t* layout, void* records, size_t count, void* const* buffers);
+int retryix_transform_benchmark(size_t count, int iterations);
+
+// === CPU 偽設備 API ===
+// 無 OpenCL 設備（或 DeviceManager\PreferredDevice = "cpu"）時以主機執行內建運算：
+// AVX / AVX2 向量化（執行期偵測，否則純量）並於共用執行緒池分派；指標皆為一般主機記憶體
+typedef enum {
+    RETRYIX_CPU_OP_INCREMENT = 0,           // out = a + 1（內建 "test" 內核）
+    RETRYIX_CPU_OP_ADD,                     // out = a + b
+    RETRYIX_CPU_OP_SUB,                     // out = a - b
+    RETRYIX_CPU_OP_MUL,                     // out = a * b
+    RETRYIX_CPU_OP_SCALE,                   // out = alpha * a
+    RETRYIX_CPU_OP_AXPY,                    // out = alpha * a + b
+    RETRYIX_CPU_OP_COUNT
+} retryix_cpu_op_t;
+
+int retryix_cpu_device_init(void);
+void retryix_cpu_device_cleanup(void);
+int retryix_cpu_device_active(void);
+// 依 DeviceManager\FallbackToCPU 決定是否改用 CPU 偽設備；reason 為記錄訊息
+int retryix_cpu_device_fallback(const char* reason);
+const char* retryix_cpu_op_name(retryix_cpu_op_t op);
+// out 可與 a 或 b 相同
+int retryix_cpu_elementwise(retryix_cpu_op_t op, float* out, const float* a, const float* b, float alpha, size_t count);
+int retryix_cpu_reduce(retryix_prim_type_t type, retryix_prim_op_t op, const void* input, size_t count, void* out_value);
+int retryix_cpu_scan(retryix_prim_type_t type, const void* input, void* output, size_t count, int inclusive);
+int retryix_cpu_device_benchmark(size_t count, int iterations);
+
+// === 執行緒池 API ===
+// 共用工作竊取執行緒池：每個 worker 一個 Chase-Lev 雙端佇列，閒置時自其他 worker 竊取；
+// 池外執行緒提交的任務進入注入佇列。大小取自 Performance\ThreadPoolSize（0 為處理器數），
+// Performance\ThreadAffinity 非零時將 worker 綁定至對應核心。未初始化時於首次使用時建立
+typedef void (*retryix_pool_fn)(void* arg);
+typedef void (*retryix_pool_range_fn)(void* arg, size_t begin, size_t end);
+
+// fork/join 群組：spawn 前以 retryix_pool_group_init 歸零，wait 期間呼叫端協助執行任務
+typedef struct {
+    volatile int64_t pending;
+} retryix_pool_group_t;
+
+typedef struct {
+    uint64_t executed;
+    uint64_t steals;
+    uint64_t failed_steals;                 // 竊取時 CAS 競爭失敗
+    uint64_t idle_waits;                    // 進入睡眠次數
+    double idle_ms;
+    size_t queue_depth;
+    size_t max_queue_depth;
+} retryix_pool_worker_stats_t;
+
+int retryix_pool_init(int threads);         // threads <= 0 時使用設定值
+void retryix_pool_cleanup(void);            // 尚未執行的任務由呼叫端完成
+int retryix_pool_size(void);
+int retryix_pool_current_worker(void);      // 池外執行緒回傳 -1
+void retryix_pool_group_init(retryix_pool_group_t* group);
+// 無可用 worker 時同步執行
+int retryix_pool_spawn(retryix_pool_group_t* group, retryix_pool_fn fn, void* arg);
+int retryix_pool_submit(retryix_pool_fn fn, void* arg);
+void retryix_pool_wait(retryix_pool_group_t* group);
+// 將 [0, count) 遞迴對半切分至 grain 以下（grain 為 0 時自動），返回時全部完成
+void retryix_pool_parallel_for(size_t count, size_t grain, retryix_pool_range_fn fn, void* arg);
+int retryix_pool_get_stats(int worker, retryix_pool_worker_stats_t* out);
+void retryix_pool_reset_stats(void);
+void retryix_pool_print_stats(void);
+int retryix_pool_benchmark(size_t count, int iterations);
+
+// === 多設備 NDRange API ===
+// 每個設備（GPU、OpenCL CPU、子設備）各自的 queue，同平台設備預設共用 context（MultiDevice\SharedContext）；
+// 1-D 切第 0 維、2-D 切第 1 維（列），區塊依各設備觀測吞吐量以 guided self-scheduling 動態領取，
+// 設備驅動於共用執行緒池執行。
+// 失敗設備手上的區塊改由其他設備完成。模板源碼須自足（不含內核管理器前導）
+#define RETRYIX_MULTI_MAX_ARGS 32
+
+typedef enum {
+    RETRYIX_MULTI_ARG_SCALAR = 0,           // 純量：ptr 指向值
+    RETRYIX_MULTI_ARG_INPUT,                // 唯讀主機陣列，完整複製到每個設備
+    RETRYIX_MULTI_ARG_OUTPUT,               // 主機輸出陣列：各區塊只讀回所屬範圍（合併即寫回原位）
+    RETRYIX_MULTI_ARG_LOCAL                 // __local 空間，size 為位元組數
+} retryix_multi_arg_kind_t;
+
+typedef struct {
+    retryix_multi_arg_kind_t kind;
+    void* ptr;
+    size_t size;                            // 位元組數
+    size_t row_bytes;                       // OUTPUT：切分維度每個索引對應的輸出位元組數
+} retryix_multi_arg_t;
+
+typedef struct {
+    char name[128];
+    cl_device_type type;
+    uint64_t chunks;
+    uint64_t items;                         // 完成的 work-item 數
+    uint64_t failures;
+    double busy_ms;
+    double throughput;                      // work-item / ms
+} retryix_multi_device_stats_t;
+
+// type 為 0 時使用全部設備；依 DeviceManager\MaxDevices 上限並略過 DeviceManager\DeviceBlacklist
+int retryix_multi_init(cl_device_type type);
+// 追加設備（例如子設備）並以其獨立 context 與佇列開啟，回傳索引；管理器持有設備參考直到 retryix_multi_cleanup
+int retryix_multi_add_device(cl_device_id device);
+void retryix_multi_cleanup(void);
+int retryix_multi_device_count(void);
+int retryix_multi_get_device(int device_index, cl_device_id* device, cl_context* context, cl_command_queue* queue);
+// 該設備上的模板內核（首次呼叫時編譯），由管理器持有；不可與同模板的 retryix_multi_execute 並行設定參數
+cl_kernel retryix_multi_get_kernel(const char* template_name, int device_index);
+// 同上，但回傳呼叫端擁有的新內核物件（以 clReleaseKernel 釋放），可於任意執行緒並行設定參數
+cl_kernel retryix_multi_create_kernel(const char* template_name, int device_index);
+int retryix_multi_has_template(const char* template_name);
+// 模板在該設備的程序（首次呼叫時編譯），由管理器持有；可以 clCreateKernel 建立同一原始碼中的其他內核
+cl_program retryix_multi_get_program(const char* template_name, int device_index);
+int retryix_multi_register_template(const char* template_name, const char* kernel_name, const char* source_code);
+// local 可為 NULL；最小區塊取自 MultiDevice\MinChunkItems（work-item 數）
+int retryix_multi_execute(const char* template_name, cl_uint work_dim, const size_t* global, const size_t* local,
+                          const retryix_multi_arg_t* args, cl_uint num_args);
+int retryix_multi_execute_on(int device_index, const char* template_name, cl_uint work_dim, const size_t* global,
+                             const size_t* local, const retryix_multi_arg_t* args, cl_uint num_args);
+int retryix_multi_get_stats(int device_index, retryix_multi_device_stats_t* out);
+void retryix_multi_reset_stats(void);
+void retryix_multi_print_stats(void);
+// 各設備單獨與全部設備一起執行，報告加速比與擴展效率；最後一次為全部設備執行
+int retryix_multi_scaling_report(const char* template_name, cl_uint work_dim, const size_t* global, const size_t* local,
+                                 const retryix_multi_arg_t* args, cl_uint num_args, int iterations);
+int retryix_multi_benchmark(size_t width, size_t height, int iterations);
+
+// === Memory RAID API ===
+// 單一邏輯緩衝區以條帶輪流分散至多設備管理器中的設備（條帶 k 位於成員 k % width），
+// 傳輸與內核啟動每個成員一個佇列並行。條帶大小預設取自 MemoryRAID\StripeKB，
+// 並對齊 MemoryRAID\MemoryAlignment、設備基底位址對齊與元素大小
+#define RETRYIX_RAID_MAX_MEMBERS 16
+
+typedef struct retryix_raid_buffer retryix_raid_buffer_t;
+
+typedef struct {
+    size_t size;
+    size_t element_size;
+    size_t stripe_bytes;
+    size_t stripe_count;
+    int width;
+    int devices[RETRYIX_RAID_MAX_MEMBERS];
+} retryix_raid_info_t;
+
+typedef enum {
+    RETRYIX_RAID_ARG_BUFFER = 0,            // RAID 緩衝區：每個條帶以子緩衝區傳入
+    RETRYIX_RAID_ARG_SCALAR,                // value / size
+    RETRYIX_RAID_ARG_LOCAL,                 // __local 空間，size 為位元組數
+    RETRYIX_RAID_ARG_STRIPE_BASE            // cl_ulong：本條帶第一個元素的邏輯索引
+} retryix_raid_arg_kind_t;
+
+typedef struct {
+    retryix_raid_arg_kind_t kind;
+    retryix_raid_buffer_t* buffer;
+    const void* value;
+    size_t size;
+} retryix_raid_arg_t;
+
+// devices 為多設備索引（NULL 時取前 width 個，width <= 0 為全部）；stripe_bytes 為 0 時使用設定值
+retryix_raid_buffer_t* retryix_raid_alloc(size_t size, size_t element_size, const int* devices, int width,
+                                          size_t stripe_bytes);
+void retryix_raid_free(retryix_raid_buffer_t* buffer);
+int retryix_raid_write(retryix_raid_buffer_t* buffer, size_t offset, const void* src, size_t size);
+int retryix_raid_read(retryix_raid_buffer_t* buffer, size_t offset, void* dst, size_t size);
+int retryix_raid_get_info(const retryix_raid_buffer_t* buffer, retryix_raid_info_t* out);
+// 以 retryix_multi_register_template 註冊的模板逐條帶啟動：global size 為條帶元素數、get_global_id 為條帶內索引；
+// 所有 RAID 緩衝區參數需有相同成員與條帶元素數
+int retryix_raid_launch(const char* template_name, const retryix_raid_arg_t* args, cl_uint num_args);
+// 依條帶寬度 1..N 報告聚合讀寫頻寬並驗證逐條帶分派
+int retryix_raid_benchmark(size_t bytes, int iterations);
+
+// === 集合通訊 API ===
+// 多設備管理器中各設備各持一個 cl_mem，於設備間做 all-reduce / broadcast / all-gather。
+// 同 context 的成員以 clEnqueueCopyBuffer 直接傳輸，否則經雙槽 pinned 主機暫存；
+// 傳輸以 Collective\ChunkKB 分塊，每塊到達即在目的設備歸約，與後續傳輸重疊（tree 與 ring reduce-scatter）；
+// ring 的成員在同一步驟既送出又接收同一緩衝區的不同區段：歸約的接收先進接收區、依到達事件逐塊歸約；
+// all-gather 的接收先進接收區，待該步驟傳輸完成後才寫入
+#define RETRYIX_COLL_MAX_MEMBERS 16
+
+typedef struct retryix_coll_group retryix_coll_group_t;
+
+typedef enum {
+    RETRYIX_COLL_RING = 0,                  // reduce-scatter + all-gather，大資料頻寬最佳
+    RETRYIX_COLL_TREE,                      // 二項樹歸約 + 廣播，小資料延遲最低
+    RETRYIX_COLL_NAIVE,                     // 主機收集、歸約後寫回（對照組）
+    RETRYIX_COLL_ALGO_COUNT
+} retryix_coll_algo_t;
+
+// devices 為多設備索引（NULL 時取前 count 個，count <= 0 為全部）
+retryix_coll_group_t* retryix_coll_create(const int* devices, int count);
+void retryix_coll_destroy(retryix_coll_group_t* group);
+int retryix_coll_size(const retryix_coll_group_t* group);
+const char* retryix_coll_algo_name(retryix_coll_algo_t algo);
+// buffers[r] 屬於成員 r 的 context，各含 count 個元素；完成後每個成員都持有歸約結果
+int retryix_coll_allreduce(retryix_coll_group_t* group, cl_mem* buffers, size_t count, retryix_prim_type_t type,
+                           retryix_prim_op_t op, retryix_coll_algo_t algo);
+int retryix_coll_broadcast(retryix_coll_group_t* group, cl_mem* buffers, size_t bytes, int root);
+// send[r] 為 bytes 位元組，recv[r] 為 bytes * 成員數，依成員順序排列
+int retryix_coll_allgather(retryix_coll_group_t* group, cl_mem* send, cl_mem* recv, size_t bytes);
+void retryix_coll_print_stats(const retryix_coll_group_t* group);
+// float 總和：naive / ring / tree all-reduce 與 broadcast、all-gather 的演算法頻寬並驗證結果
+int retryix_coll_benchmark(size_t count, int iterations);
+
+// === 設備分割 API ===
+// 以 clCreateSubDevices 切分 CPU 設備（等分、指定數量或 NUMA/快取親和網域），每個子設備有自己的 context、queue
+// 與記憶體管理器，讓工作負載固定在單一 socket 上。子設備不加入多設備管理器：它們與父設備共用計算單元，
+// 同時加入會讓 multi / raid / coll 的排程重複計算核心
+#define RETRYIX_PARTITION_MAX_UNITS 16
+
+typedef struct retryix_partition retryix_partition_t;
+
+typedef enum {
+    RETRYIX_PARTITION_EQUALLY = 0,          // 每個子設備 units 個計算單元
+    RETRYIX_PARTITION_BY_COUNTS,            // counts[0..num_counts) 個計算單元
+    RETRYIX_PARTITION_BY_AFFINITY           // 依 domain（CL_DEVICE_AFFINITY_DOMAIN_*）
+} retryix_partition_mode_t;
+
+typedef struct {
+    retryix_partition_mode_t mode;
+    cl_uint units;
+    cl_uint counts[RETRYIX_PARTITION_MAX_UNITS];
+    int num_counts;
+    cl_device_affinity_domain domain;
+} retryix_partition_spec_t;
+
+typedef struct {
+    cl_device_id device;
+    cl_context context;                     // 子設備專用，由分割持有
+    cl_command_queue queue;
+    cl_uint compute_units;
+    retryix_memory_context_t* memory;
+} retryix_partition_info_t;
+
+// "numa"、"l4"、"l3"、"l2"、"l1"、"next"、"equally:N"、"counts:A,B,..."
+int retryix_partition_parse(const char* text, retryix_partition_spec_t* out);
+// parent 為 NULL 時取第一個 CPU 設備；spec 為 NULL 時取自 DevicePartition\Scheme（預設 "numa"）
+retryix_partition_t* retryix_partition_create(cl_device_id parent, const retryix_partition_spec_t* spec);
+void retryix_partition_destroy(retryix_partition_t* partition);
+int retryix_partition_count(const retryix_partition_t* partition);
+int retryix_partition_get_info(const retryix_partition_t* partition, int index, retryix_partition_info_t* out);
+// 呼叫執行緒的記憶體 API 改用該子設備的管理器（限制見 retryix_memory_bind）
+int retryix_partition_bind(const retryix_partition_t* partition, int index);
+void retryix_partition_unbind(void);
+// 同時執行的獨立工作負載：整個設備共用對比各自固定於子設備，並驗證結果
+int retryix_partition_benchmark(size_t count, int iterations);
+
+// === 設定與調校快取 API ===
+// Windows 讀取 HKLM\SOFTWARE\RetryIX\<subkey>，其他平台讀取 RETRYIX_<SUBKEY>_<NAME> 環境變數
+unsigned long retryix_config_get_dword(const char* subkey, const char* value_name, unsigned long default_value);
+int retryix_config_get_string(const char* subkey, const char* value_name, char* out, size_t max_len);
+// 以設備（名稱 + 驅動版本）為單位持久化調校結果，可多執行緒呼叫；查無項目時回傳 RETRYIX_ERROR_NOT_FOUND；
+// 鍵或值含 tab / 換行時 put 回傳 RETRYIX_ERROR_INVALID_ARG
+int retryix_tuning_get(cl_device_id device, const char* key, char* value, size_t max_len);
+int retryix_tuning_put(cl_device_id device, const char* key, const char* value);
+void retryix_tuning_reset(void);
 
 #ifdef __cplusplus
 }
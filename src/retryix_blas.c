@@ -0,0 +1,681 @@
+// retryix_blas.c - RetryIX 分塊稠密線性代數（GEMM / GEMV），分塊參數依設備調校並快取
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define RETRYIX_BLAS_TUNE_RUNS    3
+#define RETRYIX_BLAS_MAX_DIM      0x7FFFFFFFu
+
+static const char* BLAS_TYPE_LABELS[RETRYIX_BLAS_TYPE_COUNT] = { "float", "double" };
+static const char* BLAS_PREFIXES[RETRYIX_BLAS_TYPE_COUNT] = { "s", "d" };
+static const size_t BLAS_ELEMENT_SIZES[RETRYIX_BLAS_TYPE_COUNT] = { sizeof(cl_float), sizeof(cl_double) };
+
+// GEMM 分塊候選：TS 為方形 tile 邊長，WPT 為每個 work-item 計算的列數，VW 為每個 work-item 計算的行數
+// （4 時以 RIX_T4 向量累加）；work-group 大小為 (TS / WPT) * (TS / VW)
+typedef struct {
+    cl_uint ts;
+    cl_uint wpt;
+    cl_uint vw;
+} retryix_gemm_config_t;
+
+static const retryix_gemm_config_t GEMM_CANDIDATES[] = {
+    {  8, 1, 1 }, { 16, 1, 1 }, { 16, 2, 1 }, { 16, 4, 1 }, { 16, 4, 4 }, { 16, 8, 4 },
+    { 32, 2, 4 }, { 32, 4, 1 }, { 32, 4, 4 }, { 32, 8, 1 }, { 32, 8, 4 }
+};
+#define RETRYIX_GEMM_CANDIDATE_COUNT (sizeof(GEMM_CANDIDATES) / sizeof(GEMM_CANDIDATES[0]))
+#define RETRYIX_GEMM_DEFAULT_CANDIDATE 4    // 16 x 4 x 4
+
+static const size_t GEMV_CANDIDATES[] = { 32, 64, 128, 256 };
+#define RETRYIX_GEMV_CANDIDATE_COUNT (sizeof(GEMV_CANDIDATES) / sizeof(GEMV_CANDIDATES[0]))
+#define RETRYIX_GEMV_DEFAULT_LOCAL 128
+
+// === 內核源碼 ===
+
+// 元素型別標頭：雙精度使用 UNIVERSAL_VECTOR_TEMPLATE 的 RETRYIX_REAL / RETRYIX_REAL4，僅在 RETRYIX_NATIVE_DOUBLE 下編譯；
+// 單精度固定為 float / float4（RETRYIX_REAL 在 fp64 設備上會升為 double）
+static const char* BLAS_TYPE_HEADERS[RETRYIX_BLAS_TYPE_COUNT] = {
+    "#define RIX_T float\n"
+    "#define RIX_T4 float4\n",
+
+    "#ifndef RETRYIX_NATIVE_DOUBLE\n"
+    "#error \"DGEMM / DGEMV require RETRYIX_NATIVE_DOUBLE\"\n"
+    "#endif\n"
+    "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+    "#define RIX_T RETRYIX_REAL\n"
+    "#define RIX_T4 RETRYIX_REAL4\n"
+};
+
+// 列主序 C = alpha * A * B + beta * C（A: M x K, B: K x N），一維 NDRange，每個 work-group 負責一個 TS x TS 輸出 tile；
+// A、B 的 tile 協同載入 local memory 後，每個 work-item 以暫存器累加 WPT x VW 個輸出
+static const char* GEMM_KERNEL_BODY =
+"#define RTS (TS / WPT)\n"
+"#define CTS (TS / VW)\n"
+"#define LOCAL_ITEMS (RTS * CTS)\n"
+"#if VW == 4\n"
+"  #define RIX_VEC RIX_T4\n"
+"  #define RIX_VLOAD(p) vload4(0, p)\n"
+"  #define RIX_VSTORE(v, p) vstore4(v, 0, p)\n"
+"#else\n"
+"  #define RIX_VEC RIX_T\n"
+"  #define RIX_VLOAD(p) (*(p))\n"
+"  #define RIX_VSTORE(v, p) (*(p) = (v))\n"
+"#endif\n"
+"\n"
+"__kernel void retryix_gemm(uint M, uint N, uint K, RIX_T alpha,\n"
+"                           __global const RIX_T* A, uint lda, __global const RIX_T* B, uint ldb,\n"
+"                           RIX_T beta, __global RIX_T* C, uint ldc) {\n"
+"    __local RIX_T Asub[TS][TS];\n"
+"    __local RIX_T Bsub[TS][TS];\n"
+"    uint lid = get_local_id(0);\n"
+"    uint tc = lid % CTS;\n"
+"    uint tr = lid / CTS;\n"
+"    uint tiles_n = (N + TS - 1) / TS;\n"
+"    uint row0 = (uint)(get_group_id(0) / tiles_n) * TS;\n"
+"    uint col0 = (uint)(get_group_id(0) % tiles_n) * TS;\n"
+"\n"
+"    RIX_VEC acc[WPT];\n"
+"    for (uint w = 0; w < WPT; w++) acc[w] = (RIX_VEC)(0);\n"
+"\n"
+"    for (uint t = 0; t < K; t += TS) {\n"
+"        for (uint i = lid; i < TS * TS; i += LOCAL_ITEMS) {\n"
+"            uint r = i / TS;\n"
+"            uint c = i % TS;\n"
+"            Asub[r][c] = (row0 + r < M && t + c < K) ? A[(size_t)(row0 + r) * lda + t + c] : (RIX_T)0;\n"
+"            Bsub[r][c] = (t + r < K && col0 + c < N) ? B[(size_t)(t + r) * ldb + col0 + c] : (RIX_T)0;\n"
+"        }\n"
+"        barrier(CLK_LOCAL_MEM_FENCE);\n"
+"        for (uint k = 0; k < TS; k++) {\n"
+"            RIX_VEC b = RIX_VLOAD(&Bsub[k][tc * VW]);\n"
+"            for (uint w = 0; w < WPT; w++) acc[w] += Asub[tr + w * RTS][k] * b;\n"
+"        }\n"
+"        barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    }\n"
+"\n"
+"    for (uint w = 0; w < WPT; w++) {\n"
+"        uint row = row0 + tr + w * RTS;\n"
+"        if (row >= M) continue;\n"
+"        RIX_T out[VW];\n"
+"        RIX_VSTORE(acc[w], out);\n"
+"        for (uint j = 0; j < VW; j++) {\n"
+"            uint col = col0 + tc * VW + j;\n"
+"            if (col >= N) continue;\n"
+"            __global RIX_T* c = C + (size_t)row * ldc + col;\n"
+"            *c = alpha * out[j] + (beta != (RIX_T)0 ? beta * *c : (RIX_T)0);\n"
+"        }\n"
+"    }\n"
+"}\n";
+
+// 列主序 y = alpha * A * x + beta * y（A: M x N），每個 work-group 計算一列：
+// 以 RIX_T4 向量載入做部分內積，再於 local memory 樹狀歸約；local size 需為 2 的冪次
+static const char* GEMV_KERNEL_BODY =
+"__kernel void retryix_gemv(uint M, uint N, RIX_T alpha, __global const RIX_T* A, uint lda,\n"
+"                           __global const RIX_T* x, RIX_T beta, __global RIX_T* y, __local RIX_T* scratch) {\n"
+"    uint row = get_group_id(0);\n"
+"    uint lid = get_local_id(0);\n"
+"    uint lsize = get_local_size(0);\n"
+"    __global const RIX_T* a = A + (size_t)row * lda;\n"
+"    uint n4 = N & ~3u;\n"
+"    RIX_T sum = (RIX_T)0;\n"
+"    for (uint j = lid * 4; j < n4; j += lsize * 4) {\n"
+"        sum += dot(vload4(0, a + j), vload4(0, x + j));\n"
+"    }\n"
+"    for (uint j = n4 + lid; j < N; j += lsize) sum += a[j] * x[j];\n"
+"    scratch[lid] = sum;\n"
+"    barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    for (uint s = lsize >> 1; s > 0; s >>= 1) {\n"
+"        if (lid < s) scratch[lid] += scratch[lid + s];\n"
+"        barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    }\n"
+"    if (lid == 0 && row < M) {\n"
+"        y[row] = alpha * scratch[0] + (beta != (RIX_T)0 ? beta * y[row] : (RIX_T)0);\n"
+"    }\n"
+"}\n";
+
+// === 上下文 ===
+
+typedef union {
+    cl_float f;
+    cl_double d;
+} retryix_blas_scalar_t;
+
+typedef struct {
+    bool available;
+    bool gemm_tuned;
+    bool gemv_tuned;
+    int gemm_config;                        // GEMM_CANDIDATES 索引
+    size_t gemv_local;
+    bool gemm_usable[RETRYIX_GEMM_CANDIDATE_COUNT];
+} retryix_blas_type_state_t;
+
+typedef struct {
+    cl_context context;
+    cl_device_id device;
+    cl_command_queue queue;
+    size_t max_work_group_size;
+    cl_ulong local_mem_size;
+    retryix_blas_type_state_t types[RETRYIX_BLAS_TYPE_COUNT];
+    unsigned long tune_size;                // Blas\TuneSize：調校用方陣邊長
+    uint64_t gemm_calls;
+    uint64_t gemv_calls;
+} retryix_blas_context_t;
+
+static retryix_blas_context_t* g_blas_context = NULL;
+
+static void gemm_template_name(retryix_blas_type_t type, int config, char* out, size_t max_len) {
+    const retryix_gemm_config_t* c = &GEMM_CANDIDATES[config];
+    snprintf(out, max_len, "retryix_%sgemm_t%u_w%u_v%u", BLAS_PREFIXES[type], c->ts, c->wpt, c->vw);
+}
+
+static void gemv_template_name(retryix_blas_type_t type, char* out, size_t max_len) {
+    snprintf(out, max_len, "retryix_%sgemv", BLAS_PREFIXES[type]);
+}
+
+static size_t gemm_local_size(int config) {
+    const retryix_gemm_config_t* c = &GEMM_CANDIDATES[config];
+    return (size_t)(c->ts / c->wpt) * (c->ts / c->vw);
+}
+
+// retryix_memory 配置以緩衝區參數綁定，其餘視為 SVM 指標
+static retryix_kernel_arg_t buffer_arg(const void* ptr, retryix_access_t access) {
+    retryix_kernel_arg_t arg;
+    arg.kind = retryix_memory_get_device_mem((void*)ptr) ? RETRYIX_ARG_BUFFER : RETRYIX_ARG_SVM;
+    arg.access = access;
+    arg.value = ptr;
+    arg.size = 0;
+    return arg;
+}
+
+static retryix_kernel_arg_t value_arg(const void* value, size_t size) {
+    retryix_kernel_arg_t arg = { RETRYIX_ARG_VALUE, RETRYIX_ACCESS_AUTO, value, size };
+    return arg;
+}
+
+static retryix_kernel_arg_t local_arg(size_t size) {
+    retryix_kernel_arg_t arg = { RETRYIX_ARG_LOCAL, RETRYIX_ACCESS_AUTO, NULL, size };
+    return arg;
+}
+
+static int register_source(const char* name, const char* defines, const char* header, const char* body) {
+    size_t len = strlen(defines) + strlen(header) + strlen(body) + 2;
+    char* source = (char*)malloc(len);
+    if (!source) return -1;
+    snprintf(source, len, "%s%s\n%s", defines, header, body);
+    int rc = retryix_kernel_register_program(name, source);
+    free(source);
+    return rc;
+}
+
+// 註冊精度的所有候選模板（僅註冊，編譯延後至調校或首次使用）
+static int register_type(retryix_blas_context_t* ctx, retryix_blas_type_t type) {
+    retryix_blas_type_state_t* state = &ctx->types[type];
+    char name[96];
+    char defines[96];
+    size_t elem = BLAS_ELEMENT_SIZES[type];
+
+    for (int i = 0; i < (int)RETRYIX_GEMM_CANDIDATE_COUNT; i++) {
+        const retryix_gemm_config_t* c = &GEMM_CANDIDATES[i];
+        // 設備限制不符的候選不註冊
+        state->gemm_usable[i] = gemm_local_size(i) <= ctx->max_work_group_size &&
+                                2 * (cl_ulong)c->ts * c->ts * elem <= ctx->local_mem_size;
+        if (!state->gemm_usable[i]) continue;
+        gemm_template_name(type, i, name, sizeof(name));
+        snprintf(defines, sizeof(defines), "#define TS %u\n#define WPT %u\n#define VW %u\n", c->ts, c->wpt, c->vw);
+        if (register_source(name, defines, BLAS_TYPE_HEADERS[type], GEMM_KERNEL_BODY) != 0) return -1;
+    }
+    gemv_template_name(type, name, sizeof(name));
+    if (register_source(name, "", BLAS_TYPE_HEADERS[type], GEMV_KERNEL_BODY) != 0) return -1;
+
+    state->available = true;
+    state->gemm_config = state->gemm_usable[RETRYIX_GEMM_DEFAULT_CANDIDATE] ? RETRYIX_GEMM_DEFAULT_CANDIDATE : 0;
+    state->gemv_local = RETRYIX_GEMV_DEFAULT_LOCAL;
+    return 0;
+}
+
+// 候選可用：已編譯且內核工作組上限容納其 local size
+static bool kernel_accepts_local(retryix_blas_context_t* ctx, const char* template_name,
+                                 const char* kernel_name, size_t local) {
+    cl_kernel kernel = retryix_kernel_acquire(template_name, kernel_name);
+    if (!kernel) return false;
+    size_t wg = 0;
+    bool ok = clGetKernelWorkGroupInfo(kernel, ctx->device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(wg), &wg, NULL) == CL_SUCCESS &&
+              local <= wg;
+    retryix_kernel_release(template_name, kernel);
+    return ok;
+}
+
+static int launch_gemm(retryix_blas_type_t type, int config,
+                       cl_uint M, cl_uint N, cl_uint K, const retryix_blas_scalar_t* alpha,
+                       const void* A, cl_uint lda, const void* B, cl_uint ldb,
+                       const retryix_blas_scalar_t* beta, void* C, cl_uint ldc) {
+    char name[96];
+    gemm_template_name(type, config, name, sizeof(name));
+    cl_uint ts = GEMM_CANDIDATES[config].ts;
+    size_t tiles = (size_t)((M + ts - 1) / ts) * ((N + ts - 1) / ts);
+    size_t local = gemm_local_size(config);
+    size_t elem = BLAS_ELEMENT_SIZES[type];
+
+    retryix_kernel_arg_t args[11] = {
+        value_arg(&M, sizeof(M)), value_arg(&N, sizeof(N)), value_arg(&K, sizeof(K)), value_arg(alpha, elem),
+        buffer_arg(A, RETRYIX_ACCESS_READ), value_arg(&lda, sizeof(lda)),
+        buffer_arg(B, RETRYIX_ACCESS_READ), value_arg(&ldb, sizeof(ldb)),
+        value_arg(beta, elem), buffer_arg(C, RETRYIX_ACCESS_READ_WRITE), value_arg(&ldc, sizeof(ldc))
+    };
+    return retryix_kernel_execute_tracked(name, "retryix_gemm", tiles * local, local, args, 11, NULL);
+}
+
+static int launch_gemv(retryix_blas_type_t type, size_t local,
+                       cl_uint M, cl_uint N, const retryix_blas_scalar_t* alpha, const void* A, cl_uint lda,
+                       const void* x, const retryix_blas_scalar_t* beta, void* y) {
+    char name[96];
+    gemv_template_name(type, name, sizeof(name));
+    size_t elem = BLAS_ELEMENT_SIZES[type];
+
+    retryix_kernel_arg_t args[9] = {
+        value_arg(&M, sizeof(M)), value_arg(&N, sizeof(N)), value_arg(alpha, elem),
+        buffer_arg(A, RETRYIX_ACCESS_READ), value_arg(&lda, sizeof(lda)), buffer_arg(x, RETRYIX_ACCESS_READ),
+        value_arg(beta, elem), buffer_arg(y, RETRYIX_ACCESS_READ_WRITE),
+        local_arg(local * elem)
+    };
+    return retryix_kernel_execute_tracked(name, "retryix_gemv", (size_t)M * local, local, args, 9, NULL);
+}
+
+static void fill_matrix(retryix_blas_type_t type, void* data, size_t count, uint32_t seed) {
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        double v = (double)(seed >> 8) / (double)(1u << 24) - 0.5;
+        if (type == RETRYIX_BLAS_FLOAT) ((cl_float*)data)[i] = (cl_float)v;
+        else ((cl_double*)data)[i] = v;
+    }
+}
+
+static retryix_blas_scalar_t make_scalar(retryix_blas_type_t type, double value) {
+    retryix_blas_scalar_t s;
+    if (type == RETRYIX_BLAS_FLOAT) s.f = (cl_float)value;
+    else s.d = value;
+    return s;
+}
+
+// === 調校 ===
+
+// 量測一個啟動（含完成等待的牆鐘時間，取最佳值），失敗回傳負值
+static double time_launch(retryix_blas_type_t type, int config, size_t gemv_local,
+                          cl_uint size, void* A, void* B, void* C) {
+    retryix_blas_scalar_t one = make_scalar(type, 1.0);
+    retryix_blas_scalar_t zero = make_scalar(type, 0.0);
+    double best = -1.0;
+    for (int run = 0; run <= RETRYIX_BLAS_TUNE_RUNS; run++) {
+        double t0 = rixNowMs();
+        int rc = (config >= 0)
+            ? launch_gemm(type, config, size, size, size, &one, A, size, B, size, &zero, C, size)
+            : launch_gemv(type, gemv_local, size, size, &one, A, size, B, &zero, C);
+        if (rc != 0 || retryix_memory_sync(C) != 0) return -1.0;
+        double ms = rixNowMs() - t0;
+        if (run == 0) continue; // 第一次為預熱（含編譯）
+        if (best < 0.0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+// 掃描所有可行的 GEMM 分塊與 GEMV local size，結果以設備為單位存入調校快取
+static int tune_type(retryix_blas_context_t* ctx, retryix_blas_type_t type, bool tune_gemm, bool tune_gemv) {
+    retryix_blas_type_state_t* state = &ctx->types[type];
+    size_t elem = BLAS_ELEMENT_SIZES[type];
+    cl_uint size = (cl_uint)ctx->tune_size;
+    // GEMV 以較大的方陣量測，避免啟動開銷主導（size >= 64，B / C 足以容納 x / y）
+    cl_uint gemv_size = size * 4;
+    size_t bytes = (size_t)gemv_size * gemv_size * elem;
+
+    void* A = retryix_memory_alloc_from(NULL, bytes, RETRYIX_MEM_READ_WRITE, "blas_tune_a");
+    void* B = retryix_memory_alloc_from(NULL, (size_t)size * size * elem, RETRYIX_MEM_READ_WRITE, "blas_tune_b");
+    void* C = retryix_memory_alloc_from(NULL, (size_t)size * size * elem, RETRYIX_MEM_READ_WRITE, "blas_tune_c");
+    if (!A || !B || !C) {
+        if (C) retryix_memory_free(C);
+        if (B) retryix_memory_free(B);
+        if (A) retryix_memory_free(A);
+        return -1;
+    }
+    fill_matrix(type, A, bytes / elem, 1u);
+    fill_matrix(type, B, (size_t)size * size, 2u);
+    retryix_memory_copy_to_device(A, ctx->queue, true);
+    retryix_memory_copy_to_device(B, ctx->queue, true);
+
+    char name[96];
+    char key[64];
+    char value[64];
+    printf("Tuning %sGEMM/%sGEMV (%u x %u)...\n", BLAS_PREFIXES[type], BLAS_PREFIXES[type], size, size);
+
+    if (tune_gemm) {
+        double best_ms = -1.0;
+        for (int i = 0; i < (int)RETRYIX_GEMM_CANDIDATE_COUNT; i++) {
+            if (!state->gemm_usable[i]) continue;
+            gemm_template_name(type, i, name, sizeof(name));
+            if (!kernel_accepts_local(ctx, name, "retryix_gemm", gemm_local_size(i))) {
+                state->gemm_usable[i] = false;
+                continue;
+            }
+            double ms = time_launch(type, i, 0, size, A, B, C);
+            if (ms <= 0.0) continue;
+            printf("  TS %2u WPT %u VW %u: %8.3f ms (%.2f GFLOP/s)\n", GEMM_CANDIDATES[i].ts, GEMM_CANDIDATES[i].wpt,
+                   GEMM_CANDIDATES[i].vw, ms, 2.0 * size * size * size / (ms * 1e6));
+            if (best_ms < 0.0 || ms < best_ms) {
+                best_ms = ms;
+                state->gemm_config = i;
+            }
+        }
+        if (best_ms > 0.0) {
+            const retryix_gemm_config_t* c = &GEMM_CANDIDATES[state->gemm_config];
+            snprintf(key, sizeof(key), "blas.%sgemm", BLAS_PREFIXES[type]);
+            snprintf(value, sizeof(value), "%u %u %u", c->ts, c->wpt, c->vw);
+            retryix_tuning_put(ctx->device, key, value);
+        }
+        state->gemm_tuned = true;
+    }
+
+    if (tune_gemv) {
+        // GEMV 使用 A 作為矩陣、B 的開頭作為 x、C 的開頭作為 y
+        double best_ms = -1.0;
+        gemv_template_name(type, name, sizeof(name));
+        for (size_t i = 0; i < RETRYIX_GEMV_CANDIDATE_COUNT; i++) {
+            size_t local = GEMV_CANDIDATES[i];
+            if (local > ctx->max_work_group_size || !kernel_accepts_local(ctx, name, "retryix_gemv", local)) continue;
+            double ms = time_launch(type, -1, local, gemv_size, A, B, C);
+            if (ms <= 0.0) continue;
+            printf("  GEMV local %3zu: %8.3f ms (%.2f GB/s)\n", local, ms, (double)bytes / (ms * 1e6));
+            if (best_ms < 0.0 || ms < best_ms) {
+                best_ms = ms;
+                state->gemv_local = local;
+            }
+        }
+        if (best_ms > 0.0) {
+            snprintf(key, sizeof(key), "blas.%sgemv", BLAS_PREFIXES[type]);
+            snprintf(value, sizeof(value), "%zu", state->gemv_local);
+            retryix_tuning_put(ctx->device, key, value);
+        }
+        state->gemv_tuned = true;
+    }
+
+    retryix_memory_free(C);
+    retryix_memory_free(B);
+    retryix_memory_free(A);
+    return 0;
+}
+
+// 讀取快取的調校結果，缺少時執行掃描
+static int ensure_tuned(retryix_blas_context_t* ctx, retryix_blas_type_t type, bool need_gemm, bool need_gemv) {
+    if (type < 0 || type >= RETRYIX_BLAS_TYPE_COUNT || !ctx->types[type].available) {
+        printf("BLAS: requested precision not available on this device\n");
+        return -1;
+    }
+    retryix_blas_type_state_t* state = &ctx->types[type];
+    char key[64];
+    char value[64];
+
+    if (need_gemm && !state->gemm_tuned) {
+        unsigned int ts, wpt, vw;
+        snprintf(key, sizeof(key), "blas.%sgemm", BLAS_PREFIXES[type]);
+        if (retryix_tuning_get(ctx->device, key, value, sizeof(value)) == RETRYIX_SUCCESS &&
+            sscanf(value, "%u %u %u", &ts, &wpt, &vw) == 3) {
+            for (int i = 0; i < (int)RETRYIX_GEMM_CANDIDATE_COUNT; i++) {
+                const retryix_gemm_config_t* c = &GEMM_CANDIDATES[i];
+                if (c->ts == ts && c->wpt == wpt && c->vw == vw && state->gemm_usable[i]) {
+                    state->gemm_config = i;
+                    state->gemm_tuned = true;
+                }
+            }
+        }
+    }
+    if (need_gemv && !state->gemv_tuned) {
+        size_t local = 0;
+        snprintf(key, sizeof(key), "blas.%sgemv", BLAS_PREFIXES[type]);
+        if (retryix_tuning_get(ctx->device, key, value, sizeof(value)) == RETRYIX_SUCCESS &&
+            sscanf(value, "%zu", &local) == 1 && local > 0 && (local & (local - 1)) == 0 &&
+            local <= ctx->max_work_group_size) {
+            state->gemv_local = local;
+            state->gemv_tuned = true;
+        }
+    }
+
+    bool tune_gemm = need_gemm && !state->gemm_tuned;
+    bool tune_gemv = need_gemv && !state->gemv_tuned;
+    if (tune_gemm || tune_gemv) {
+        if (tune_type(ctx, type, tune_gemm, tune_gemv) != 0) {
+            // 調校失敗時沿用預設值
+            state->gemm_tuned = state->gemm_tuned || tune_gemm;
+            state->gemv_tuned = state->gemv_tuned || tune_gemv;
+        }
+    }
+    return 0;
+}
+
+// === 公開 API ===
+
+int retryix_blas_init(cl_context context, cl_device_id device, cl_command_queue queue) {
+    if (g_blas_context) return 0;
+    if (!context || !device || !queue) return -1;
+
+    if (!retryix_memory_init(context, device)) return -1;
+
+    retryix_blas_context_t* ctx = (retryix_blas_context_t*)calloc(1, sizeof(retryix_blas_context_t));
+    if (!ctx) return -1;
+
+    ctx->context = context;
+    ctx->device = device;
+    ctx->queue = queue;
+    clGetDeviceInfo(device, CL_DEVICE_MAX_WORK_GROUP_SIZE, sizeof(ctx->max_work_group_size), &ctx->max_work_group_size, NULL);
+    clGetDeviceInfo(device, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(ctx->local_mem_size), &ctx->local_mem_size, NULL);
+    if (ctx->max_work_group_size == 0) ctx->max_work_group_size = 64;
+    if (ctx->local_mem_size == 0) ctx->local_mem_size = 16 * 1024;
+    ctx->tune_size = retryix_config_get_dword("Blas", "TuneSize", 512);
+    if (ctx->tune_size < 64) ctx->tune_size = 64;
+
+    char extensions[4096] = {0};
+    clGetDeviceInfo(device, CL_DEVICE_EXTENSIONS, sizeof(extensions) - 1, extensions, NULL);
+    bool fp64 = (strstr(extensions, "cl_khr_fp64") != NULL);
+
+    if (register_type(ctx, RETRYIX_BLAS_FLOAT) != 0 || (fp64 && register_type(ctx, RETRYIX_BLAS_DOUBLE) != 0)) {
+        free(ctx);
+        return -1;
+    }
+
+    g_blas_context = ctx;
+
+    printf("RetryIX BLAS Initialized\n");
+    printf("  SGEMM/SGEMV: YES, DGEMM/DGEMV: %s\n", fp64 ? "YES" : "NO (no cl_khr_fp64)");
+    return 0;
+}
+
+void retryix_blas_cleanup(void) {
+    if (!g_blas_context) return;
+    free(g_blas_context);
+    g_blas_context = NULL;
+}
+
+// 重新執行調校掃描（忽略快取）
+int retryix_blas_tune(retryix_blas_type_t type) {
+    retryix_blas_context_t* ctx = g_blas_context;
+    if (!ctx || type < 0 || type >= RETRYIX_BLAS_TYPE_COUNT || !ctx->types[type].available) return -1;
+    return tune_type(ctx, type, true, true);
+}
+
+static int gemm_common(retryix_blas_type_t type, size_t M, size_t N, size_t K, retryix_blas_scalar_t alpha,
+                       const void* A, size_t lda, const void* B, size_t ldb,
+                       retryix_blas_scalar_t beta, void* C, size_t ldc) {
+    retryix_blas_context_t* ctx = g_blas_context;
+    if (!ctx || !A || !B || !C || M == 0 || N == 0 || K == 0) return -1;
+    if (M > RETRYIX_BLAS_MAX_DIM || N > RETRYIX_BLAS_MAX_DIM || K > RETRYIX_BLAS_MAX_DIM) return -1;
+    if (lda < K || ldb < N || ldc < N || lda > RETRYIX_BLAS_MAX_DIM || ldb > RETRYIX_BLAS_MAX_DIM || ldc > RETRYIX_BLAS_MAX_DIM) return -1;
+    if (ensure_tuned(ctx, type, true, false) != 0) return -1;
+
+    ctx->gemm_calls++;
+    return launch_gemm(type, ctx->types[type].gemm_config, (cl_uint)M, (cl_uint)N, (cl_uint)K, &alpha,
+                       A, (cl_uint)lda, B, (cl_uint)ldb, &beta, C, (cl_uint)ldc);
+}
+
+static int gemv_common(retryix_blas_type_t type, size_t M, size_t N, retryix_blas_scalar_t alpha,
+                       const void* A, size_t lda, const void* x, retryix_blas_scalar_t beta, void* y) {
+    retryix_blas_context_t* ctx = g_blas_context;
+    if (!ctx || !A || !x || !y || M == 0 || N == 0) return -1;
+    if (M > RETRYIX_BLAS_MAX_DIM || N > RETRYIX_BLAS_MAX_DIM || lda < N || lda > RETRYIX_BLAS_MAX_DIM) return -1;
+    if (ensure_tuned(ctx, type, false, true) != 0) return -1;
+
+    ctx->gemv_calls++;
+    return launch_gemv(type, ctx->types[type].gemv_local, (cl_uint)M, (cl_uint)N, &alpha,
+                       A, (cl_uint)lda, x, &beta, y);
+}
+
+int retryix_blas_sgemm(size_t M, size_t N, size_t K, float alpha, const void* A, size_t lda,
+                       const void* B, size_t ldb, float beta, void* C, size_t ldc) {
+    return gemm_common(RETRYIX_BLAS_FLOAT, M, N, K, make_scalar(RETRYIX_BLAS_FLOAT, alpha), A, lda, B, ldb,
+                       make_scalar(RETRYIX_BLAS_FLOAT, beta), C, ldc);
+}
+
+int retryix_blas_dgemm(size_t M, size_t N, size_t K, double alpha, const void* A, size_t lda,
+                       const void* B, size_t ldb, double beta, void* C, size_t ldc) {
+    return gemm_common(RETRYIX_BLAS_DOUBLE, M, N, K, make_scalar(RETRYIX_BLAS_DOUBLE, alpha), A, lda, B, ldb,
+                       make_scalar(RETRYIX_BLAS_DOUBLE, beta), C, ldc);
+}
+
+int retryix_blas_sgemv(size_t M, size_t N, float alpha, const void* A, size_t lda,
+                       const void* x, float beta, void* y) {
+    return gemv_common(RETRYIX_BLAS_FLOAT, M, N, make_scalar(RETRYIX_BLAS_FLOAT, alpha), A, lda, x,
+                       make_scalar(RETRYIX_BLAS_FLOAT, beta), y);
+}
+
+int retryix_blas_dgemv(size_t M, size_t N, double alpha, const void* A, size_t lda,
+                       const void* x, double beta, void* y) {
+    return gemv_common(RETRYIX_BLAS_DOUBLE, M, N, make_scalar(RETRYIX_BLAS_DOUBLE, alpha), A, lda, x,
+                       make_scalar(RETRYIX_BLAS_DOUBLE, beta), y);
+}
+
+// === 量測 ===
+
+static double load_value(retryix_blas_type_t type, const void* data, size_t i) {
+    return type == RETRYIX_BLAS_FLOAT ? (double)((const cl_float*)data)[i] : ((const cl_double*)data)[i];
+}
+
+// 未最佳化的 CPU 參考（i-j-k 三重迴圈，以 double 累加）
+static void reference_gemm(retryix_blas_type_t type, size_t n, const void* A, const void* B, double* C) {
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            double sum = 0.0;
+            for (size_t k = 0; k < n; k++) sum += load_value(type, A, i * n + k) * load_value(type, B, k * n + j);
+            C[i * n + j] = sum;
+        }
+    }
+}
+
+static void reference_gemv(retryix_blas_type_t type, size_t n, const void* A, const void* x, double* y) {
+    for (size_t i = 0; i < n; i++) {
+        double sum = 0.0;
+        for (size_t j = 0; j < n; j++) sum += load_value(type, A, i * n + j) * load_value(type, x, j);
+        y[i] = sum;
+    }
+}
+
+// 最大相對誤差（以參考值的最大絕對值正規化）
+static double max_relative_error(retryix_blas_type_t type, const void* result, const double* expected, size_t count) {
+    double max_abs = 1e-30, max_err = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        double e = fabs(expected[i]);
+        if (e > max_abs) max_abs = e;
+        double err = fabs(load_value(type, result, i) - expected[i]);
+        if (err > max_err) max_err = err;
+    }
+    return max_err / max_abs;
+}
+
+static int bench_type(retryix_blas_context_t* ctx, retryix_blas_type_t type, size_t n, int iterations) {
+    size_t elem = BLAS_ELEMENT_SIZES[type];
+    size_t count = n * n;
+    void* A = retryix_memory_alloc(count * elem, RETRYIX_MEM_READ_WRITE, "blas_bench_a");
+    void* B = retryix_memory_alloc(count * elem, RETRYIX_MEM_READ_WRITE, "blas_bench_b");
+    void* C = retryix_memory_alloc(count * elem, RETRYIX_MEM_READ_WRITE, "blas_bench_c");
+    double* expected = (double*)malloc(count * sizeof(double));
+    int failures = 0;
+    if (!A || !B || !C || !expected) {
+        failures = 1;
+    } else {
+        fill_matrix(type, A, count, 11u);
+        fill_matrix(type, B, count, 23u);
+        retryix_memory_copy_to_device(A, ctx->queue, true);
+        retryix_memory_copy_to_device(B, ctx->queue, true);
+        retryix_blas_scalar_t one = make_scalar(type, 1.0);
+        retryix_blas_scalar_t zero = make_scalar(type, 0.0);
+        // 單精度容差隨內積長度放寬
+        double tolerance = (type == RETRYIX_BLAS_FLOAT) ? 1e-5 * sqrt((double)n) + 1e-5 : 1e-12 * n;
+
+        for (int op = 0; op < 2; op++) {
+            double gpu_best = -1.0;
+            int rc = 0;
+            for (int it = 0; it <= iterations && rc == 0; it++) {
+                double t0 = rixNowMs();
+                rc = (op == 0) ? gemm_common(type, n, n, n, one, A, n, B, n, zero, C, n)
+                               : gemv_common(type, n, n, one, A, n, B, zero, C);
+                if (rc == 0) rc = retryix_memory_sync(C);
+                double ms = rixNowMs() - t0;
+                if (it == 0) continue;
+                if (gpu_best < 0.0 || ms < gpu_best) gpu_best = ms;
+            }
+
+            double t0 = rixNowMs();
+            if (op == 0) reference_gemm(type, n, A, B, expected);
+            else reference_gemv(type, n, A, B, expected);
+            double cpu_ms = rixNowMs() - t0;
+
+            double err = 1.0;
+            if (rc == 0) {
+                retryix_memory_copy_from_device(C, ctx->queue, true);
+                err = max_relative_error(type, C, expected, op == 0 ? count : n);
+            }
+            bool correct = (rc == 0 && err <= tolerance);
+            if (!correct) failures++;
+
+            double flops = (op == 0) ? 2.0 * n * n * n : 2.0 * n * n;
+            printf("  %s%s GPU %9.3f ms (%8.2f GFLOP/s)  naive CPU %9.3f ms (%7.2f GFLOP/s)  err %.2e  %s\n",
+                   BLAS_PREFIXES[type], op == 0 ? "GEMM" : "GEMV", gpu_best,
+                   gpu_best > 0.0 ? flops / (gpu_best * 1e6) : 0.0, cpu_ms,
+                   cpu_ms > 0.0 ? flops / (cpu_ms * 1e6) : 0.0, err, correct ? "PASS" : "FAIL");
+        }
+    }
+
+    free(expected);
+    if (C) retryix_memory_free(C);
+    if (B) retryix_memory_free(B);
+    if (A) retryix_memory_free(A);
+    return failures;
+}
+
+// 以 n x n 方陣量測 GEMM / GEMV 的 GFLOP/s 並與未最佳化的 CPU 參考比對
+int retryix_blas_benchmark(size_t n, int iterations) {
+    retryix_blas_context_t* ctx = g_blas_context;
+    if (!ctx || n == 0 || n > 8192) return -1;
+    if (iterations <= 0) iterations = 3;
+
+    printf("\n=== RetryIX BLAS Benchmark (%zu x %zu) ===\n", n, n);
+    int failures = 0;
+    for (int t = 0; t < RETRYIX_BLAS_TYPE_COUNT; t++) {
+        retryix_blas_type_t type = (retryix_blas_type_t)t;
+        if (!ctx->types[t].available) {
+            printf("  %s: not available\n", BLAS_TYPE_LABELS[t]);
+            continue;
+        }
+        if (ensure_tuned(ctx, type, true, true) != 0) {
+            failures++;
+            continue;
+        }
+        const retryix_gemm_config_t* c = &GEMM_CANDIDATES[ctx->types[t].gemm_config];
+        printf(" %s: tile %u, %u rows x %u cols per work-item, GEMV local %zu\n", BLAS_TYPE_LABELS[t],
+               c->ts, c->wpt, c->vw, ctx->types[t].gemv_local);
+        failures += bench_type(ctx, type, n, iterations);
+    }
+    printf("==========================================\n\n");
+    return failures ? -1 : 0;
+}
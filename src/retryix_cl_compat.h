@@ -19,6 +19,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <time.h>
+#endif
+
 // ── Error name helper ────────────────────────────────────────────────────────
 static inline const char* rixCLErrorName(cl_int err) {
     switch (err) {
@@ -108,6 +114,64 @@ static inline cl_command_queue rixCreateQueue(cl_context ctx, cl_device_id dev,
     return q;
 }
 
+// 以指定屬性建立佇列（profiling / out-of-order）
+static inline cl_command_queue rixCreateQueueWithFlags(cl_context ctx, cl_device_id dev,
+                                                       cl_command_queue_properties flags, cl_int* out_err) {
+    cl_int err = CL_SUCCESS;
+    cl_command_queue q = NULL;
+#if CL_TARGET_OPENCL_VERSION >= 200
+    const cl_queue_properties props[] = { CL_QUEUE_PROPERTIES, (cl_queue_properties)flags, 0 };
+    q = clCreateCommandQueueWithProperties(ctx, dev, props, &err);
+#else
+    q = clCreateCommandQueue(ctx, dev, flags, &err);
+#endif
+    if (out_err) *out_err = err;
+    return q;
+}
+
+// 建立啟用 profiling 的佇列（自動調校量測設備時間用）
+static inline cl_command_queue rixCreateProfilingQueue(cl_context ctx, cl_device_id dev, cl_int* out_err) {
+    return rixCreateQueueWithFlags(ctx, dev, CL_QUEUE_PROFILING_ENABLE, out_err);
+}
+
+// 等待事件清單後放置標記（1.1 以 clEnqueueWaitForEvents + clEnqueueMarker 模擬）
+static inline cl_int rixEnqueueMarkerWaitList(cl_command_queue q, cl_uint num_events,
+                                              const cl_event* events, cl_event* out_event) {
+#ifdef CL_VERSION_1_2
+    return clEnqueueMarkerWithWaitList(q, num_events, events, out_event);
+#else
+    if (num_events > 0) {
+        cl_int err = clEnqueueWaitForEvents(q, num_events, events);
+        if (err != CL_SUCCESS) return err;
+    }
+    return clEnqueueMarker(q, out_event);
+#endif
+}
+
+// 讀取事件的設備執行時間（毫秒），佇列需啟用 profiling
+static inline double rixEventElapsedMs(cl_event ev) {
+    cl_ulong t_start = 0, t_end = 0;
+    if (clGetEventProfilingInfo(ev, CL_PROFILING_COMMAND_START, sizeof(t_start), &t_start, NULL) != CL_SUCCESS ||
+        clGetEventProfilingInfo(ev, CL_PROFILING_COMMAND_END, sizeof(t_end), &t_end, NULL) != CL_SUCCESS) {
+        return -1.0;
+    }
+    return (double)(t_end - t_start) * 1e-6;
+}
+
+// 主機端單調時鐘（毫秒），用於無 profiling 事件時的量測
+static inline double rixNowMs(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec * 1e-6;
+#endif
+}
+
 // ── Program build helper (prints build log on failure) ──────────────────────
 static inline cl_program rixBuildProgram(cl_context ctx, cl_device_id dev,
                                          const char* src, const char* options) {
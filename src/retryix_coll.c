@@ -0,0 +1,719 @@
+// retryix_coll.c - RetryIX 跨設備集合運算：ring / tree all-reduce、broadcast、all-gather（分塊管線化傳輸與歸約）
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RETRYIX_COLL_SLOTS  2                // 跨 context 暫存槽數：讀取下一塊時上一塊仍在寫入/歸約
+
+static const size_t COLL_ELEMENT_SIZES[RETRYIX_PRIM_TYPE_COUNT] = { sizeof(cl_int), sizeof(cl_float), sizeof(cl_double) };
+static const char* COLL_TEMPLATE = "retryix_coll";
+static const char* COLL_KERNELS[RETRYIX_PRIM_TYPE_COUNT] = {
+    "retryix_coll_reduce_int", "retryix_coll_reduce_float", "retryix_coll_reduce_double"
+};
+static const char* COLL_ALGO_NAMES[RETRYIX_COLL_ALGO_COUNT] = { "ring", "tree", "naive" };
+
+// dst[dst_off + i] = op(dst[dst_off + i], src[src_off + i])
+static const char* COLL_SOURCE =
+"#define RIX_COLL_COMBINE(a, b, op) ((op) == 0 ? (a) + (b) : ((op) == 1 ? min(a, b) : max(a, b)))\n"
+"#define RIX_COLL_REDUCE(T) \\\n"
+"__kernel void retryix_coll_reduce_##T(__global T* dst, __global const T* src, uint op, ulong dst_off, ulong src_off, ulong n) { \\\n"
+"    size_t i = get_global_id(0); \\\n"
+"    if (i < n) dst[dst_off + i] = RIX_COLL_COMBINE(dst[dst_off + i], src[src_off + i], op); \\\n"
+"}\n"
+"RIX_COLL_REDUCE(int)\n"
+"RIX_COLL_REDUCE(float)\n"
+"#ifdef cl_khr_fp64\n"
+"#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+"RIX_COLL_REDUCE(double)\n"
+"#endif\n";
+
+typedef struct {
+    int device;                             // 多設備管理器索引
+    cl_context context;
+    cl_command_queue compute;               // 多設備管理器的佇列：歸約內核
+    cl_command_queue copy;                  // 本群組專用的傳輸佇列，與歸約重疊
+    cl_mem scratch;                         // 接收區
+    size_t scratch_bytes;
+    cl_mem staging_mem;                     // 跨 context 時的 pinned 主機暫存
+    char* staging_ptr;
+    cl_kernel reduce[RETRYIX_PRIM_TYPE_COUNT];  // 本群組專用的歸約內核（設備不支援 fp64 時 double 為 NULL）
+} retryix_coll_member_t;
+
+struct retryix_coll_group {
+    int count;
+    retryix_coll_member_t members[RETRYIX_COLL_MAX_MEMBERS];
+    size_t chunk_bytes;
+    uint64_t bytes_direct;                  // 設備間直接複製
+    uint64_t bytes_staged;                  // 經主機暫存
+};
+
+// 歸約目標：傳入的區塊與 target[target_off..] 合併
+typedef struct {
+    cl_mem target;
+    size_t target_off;                      // 位元組
+    retryix_prim_type_t type;
+    retryix_prim_op_t op;
+} retryix_coll_reduce_t;
+
+// 一次點對點傳輸（一個池任務）
+typedef struct {
+    retryix_coll_group_t* group;
+    int from;
+    cl_mem src;
+    size_t src_off;
+    int to;
+    cl_mem dst;
+    size_t dst_off;
+    size_t bytes;
+    bool reduce;
+    bool deferred;                          // dst 為接收區：同一步驟的傳輸全部完成後才寫入 spec.target
+    retryix_coll_reduce_t spec;
+    cl_int err;
+} retryix_coll_move_t;
+
+static size_t min_size(size_t a, size_t b) {
+    return a < b ? a : b;
+}
+
+static cl_int enqueue_reduce(retryix_coll_group_t* group, int member, const retryix_coll_reduce_t* spec, cl_mem src,
+                             size_t src_off, size_t bytes, cl_event wait) {
+    retryix_coll_member_t* m = &group->members[member];
+    cl_kernel kernel = m->reduce[spec->type];
+    if (!kernel) return CL_INVALID_KERNEL;
+    size_t elem = COLL_ELEMENT_SIZES[spec->type];
+    cl_uint op = (cl_uint)spec->op;
+    cl_ulong dst_off = (cl_ulong)(spec->target_off / elem);
+    cl_ulong src_elems = (cl_ulong)(src_off / elem);
+    cl_ulong n = (cl_ulong)(bytes / elem);
+    size_t global = (size_t)n;
+
+    cl_int err = clSetKernelArg(kernel, 0, sizeof(cl_mem), &spec->target);
+    if (err == CL_SUCCESS) err = clSetKernelArg(kernel, 1, sizeof(cl_mem), &src);
+    if (err == CL_SUCCESS) err = clSetKernelArg(kernel, 2, sizeof(cl_uint), &op);
+    if (err == CL_SUCCESS) err = clSetKernelArg(kernel, 3, sizeof(cl_ulong), &dst_off);
+    if (err == CL_SUCCESS) err = clSetKernelArg(kernel, 4, sizeof(cl_ulong), &src_elems);
+    if (err == CL_SUCCESS) err = clSetKernelArg(kernel, 5, sizeof(cl_ulong), &n);
+    if (err == CL_SUCCESS) err = clEnqueueNDRangeKernel(m->compute, kernel, 1, NULL, &global, NULL,
+                                                        wait ? 1 : 0, wait ? &wait : NULL, NULL);
+    return err;
+}
+
+// 分塊傳輸：同 context 以 clEnqueueCopyBuffer 直接複製，否則經 pinned 暫存（讀取第 c+1 塊時第 c 塊寫入與歸約仍在進行）；
+// 每塊到達即在目的設備的計算佇列歸約，與後續傳輸重疊
+static void move_task(void* arg) {
+    retryix_coll_move_t* mv = (retryix_coll_move_t*)arg;
+    retryix_coll_group_t* group = mv->group;
+    retryix_coll_member_t* from = &group->members[mv->from];
+    retryix_coll_member_t* to = &group->members[mv->to];
+    size_t chunk = group->chunk_bytes;
+    cl_event slot_events[RETRYIX_COLL_SLOTS] = { NULL };
+    bool direct = (from->context == to->context);
+    cl_int err = CL_SUCCESS;
+
+    for (size_t done = 0, index = 0; done < mv->bytes && err == CL_SUCCESS; done += chunk, index++) {
+        size_t len = min_size(chunk, mv->bytes - done);
+        cl_event arrived = NULL;
+        if (direct) {
+            err = clEnqueueCopyBuffer(to->copy, mv->src, mv->dst, mv->src_off + done, mv->dst_off + done, len, 0, NULL,
+                                      &arrived);
+        } else {
+            int slot = (int)(index % RETRYIX_COLL_SLOTS);
+            if (slot_events[slot]) {
+                err = clWaitForEvents(1, &slot_events[slot]);
+                clReleaseEvent(slot_events[slot]);
+                slot_events[slot] = NULL;
+            }
+            char* staging = to->staging_ptr + (size_t)slot * chunk;
+            if (err == CL_SUCCESS) {
+                err = clEnqueueReadBuffer(from->copy, mv->src, CL_TRUE, mv->src_off + done, len, staging, 0, NULL, NULL);
+            }
+            if (err == CL_SUCCESS) {
+                err = clEnqueueWriteBuffer(to->copy, mv->dst, CL_FALSE, mv->dst_off + done, len, staging, 0, NULL,
+                                           &arrived);
+            }
+        }
+        if (err == CL_SUCCESS && mv->reduce && !mv->deferred) {
+            retryix_coll_reduce_t spec = mv->spec;
+            spec.target_off += done;
+            err = enqueue_reduce(group, mv->to, &spec, mv->dst, mv->dst_off + done, len, arrived);
+        }
+        if (arrived) {
+            if (direct) {
+                clReleaseEvent(arrived);
+            } else {
+                slot_events[index % RETRYIX_COLL_SLOTS] = arrived; // 暫存槽重用前需等待寫入完成
+            }
+        }
+    }
+    for (int s = 0; s < RETRYIX_COLL_SLOTS; s++) {
+        if (slot_events[s]) {
+            clWaitForEvents(1, &slot_events[s]);
+            clReleaseEvent(slot_events[s]);
+        }
+    }
+    cl_int finish = clFinish(to->copy);
+    if (err == CL_SUCCESS) err = finish;
+    finish = clFinish(to->compute);
+    if (err == CL_SUCCESS) err = finish;
+    mv->err = err;
+}
+
+// 延後的寫入：來源緩衝區已不再被本步驟的傳輸讀取，於目的設備的計算佇列歸約或複製進 spec.target
+static int commit_deferred(retryix_coll_group_t* group, retryix_coll_move_t* moves, int count) {
+    cl_int err = CL_SUCCESS;
+    for (int i = 0; i < count && err == CL_SUCCESS; i++) {
+        retryix_coll_move_t* mv = &moves[i];
+        if (!mv->deferred) continue;
+        if (mv->reduce) {
+            err = enqueue_reduce(group, mv->to, &mv->spec, mv->dst, mv->dst_off, mv->bytes, NULL);
+        } else {
+            err = clEnqueueCopyBuffer(group->members[mv->to].compute, mv->dst, mv->spec.target, mv->dst_off,
+                                      mv->spec.target_off, mv->bytes, 0, NULL, NULL);
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        if (!moves[i].deferred) continue;
+        cl_int finish = clFinish(group->members[moves[i].to].compute);
+        if (err == CL_SUCCESS) err = finish;
+    }
+    if (err != CL_SUCCESS) {
+        printf("RetryIX Collective: deferred write failed (%s)\n", rixCLErrorName(err));
+        return -1;
+    }
+    return 0;
+}
+
+// 一個步驟內的所有傳輸並行，全部完成後才進入下一步
+static int run_moves(retryix_coll_group_t* group, retryix_coll_move_t* moves, int count) {
+    retryix_pool_group_t pool;
+    retryix_pool_group_init(&pool);
+    for (int i = 0; i < count; i++) {
+        moves[i].group = group;
+        retryix_pool_spawn(&pool, move_task, &moves[i]);
+    }
+    retryix_pool_wait(&pool);
+
+    int rc = 0;
+    for (int i = 0; i < count; i++) {
+        if (moves[i].err != CL_SUCCESS) {
+            printf("RetryIX Collective: transfer %d -> %d failed (%s)\n", moves[i].from, moves[i].to,
+                   rixCLErrorName(moves[i].err));
+            rc = -1;
+            continue;
+        }
+        bool direct = group->members[moves[i].from].context == group->members[moves[i].to].context;
+        if (direct) group->bytes_direct += moves[i].bytes;
+        else group->bytes_staged += moves[i].bytes;
+    }
+    return rc == 0 ? commit_deferred(group, moves, count) : rc;
+}
+
+static int ensure_scratch(retryix_coll_group_t* group, size_t bytes) {
+    for (int r = 0; r < group->count; r++) {
+        retryix_coll_member_t* m = &group->members[r];
+        if (m->scratch_bytes >= bytes) continue;
+        if (m->scratch) clReleaseMemObject(m->scratch);
+        cl_int err = CL_SUCCESS;
+        m->scratch = clCreateBuffer(m->context, CL_MEM_READ_WRITE, bytes, NULL, &err);
+        m->scratch_bytes = (err == CL_SUCCESS) ? bytes : 0;
+        if (err != CL_SUCCESS) {
+            m->scratch = NULL;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void set_move(retryix_coll_move_t* mv, int from, cl_mem src, size_t src_off, int to, cl_mem dst, size_t dst_off,
+                     size_t bytes) {
+    memset(mv, 0, sizeof(*mv));
+    mv->from = from;
+    mv->src = src;
+    mv->src_off = src_off;
+    mv->to = to;
+    mv->dst = dst;
+    mv->dst_off = dst_off;
+    mv->bytes = bytes;
+}
+
+// 經接收區傳輸：本步驟中目的緩衝區同時是其他傳輸的來源（不同佇列同時讀寫同一 cl_mem 沒有先後），
+// 先收進 to 的接收區，所有傳輸完成後才寫入 target
+static void set_deferred_move(retryix_coll_group_t* group, retryix_coll_move_t* mv, int from, cl_mem src,
+                              size_t src_off, int to, cl_mem target, size_t target_off, size_t bytes) {
+    set_move(mv, from, src, src_off, to, group->members[to].scratch, 0, bytes);
+    mv->deferred = true;
+    mv->spec.target = target;
+    mv->spec.target_off = target_off;
+}
+
+static size_t segment_begin(size_t count, int index, int members) {
+    return (size_t)((uint64_t)count * (uint64_t)index / (uint64_t)members);
+}
+
+// reduce-scatter 後 all-gather：每步每個成員只傳 1/N，頻寬與成員數無關；
+// 成員在同一步驟既送出一個區段又接收另一個區段。reduce-scatter 收進接收區，每塊到達即以到達事件排序、
+// 歸約進另一個（未被送出的）區段，與下一塊傳輸重疊；all-gather 的接收經接收區延後寫入
+static int allreduce_ring(retryix_coll_group_t* group, cl_mem* buffers, size_t count, retryix_prim_type_t type,
+                          retryix_prim_op_t op) {
+    int n = group->count;
+    size_t elem = COLL_ELEMENT_SIZES[type];
+    size_t max_segment = (count + (size_t)n - 1) / (size_t)n * elem;
+    if (ensure_scratch(group, max_segment) != 0) return -1;
+
+    retryix_coll_move_t moves[RETRYIX_COLL_MAX_MEMBERS];
+    for (int step = 0; step < n - 1; step++) {
+        int active = 0;
+        for (int r = 0; r < n; r++) {
+            int to = (r + 1) % n;
+            int seg = (r - step + n) % n;
+            size_t begin = segment_begin(count, seg, n) * elem;
+            size_t bytes = segment_begin(count, seg + 1, n) * elem - begin;
+            if (bytes == 0) continue;
+            retryix_coll_move_t* mv = &moves[active++];
+            set_move(mv, r, buffers[r], begin, to, group->members[to].scratch, 0, bytes);
+            mv->reduce = true;
+            mv->spec.target = buffers[to];
+            mv->spec.target_off = begin;
+            mv->spec.type = type;
+            mv->spec.op = op;
+        }
+        if (run_moves(group, moves, active) != 0) return -1;
+    }
+    // 成員 r 此時持有完整歸約的區段 (r + 1) % n
+    for (int step = 0; step < n - 1; step++) {
+        int active = 0;
+        for (int r = 0; r < n; r++) {
+            int to = (r + 1) % n;
+            int seg = (r + 1 - step + n) % n;
+            size_t begin = segment_begin(count, seg, n) * elem;
+            size_t bytes = segment_begin(count, seg + 1, n) * elem - begin;
+            if (bytes == 0) continue;
+            set_deferred_move(group, &moves[active++], r, buffers[r], begin, to, buffers[to], begin, bytes);
+        }
+        if (run_moves(group, moves, active) != 0) return -1;
+    }
+    return 0;
+}
+
+// 二項樹：log2(N) 輪歸約至 rank 0，再 log2(N) 輪廣播；延遲低但每輪傳完整緩衝區
+static int tree_broadcast(retryix_coll_group_t* group, cl_mem* buffers, size_t bytes, int root) {
+    int n = group->count;
+    int top = 1;
+    while (top < n) top <<= 1;
+    retryix_coll_move_t moves[RETRYIX_COLL_MAX_MEMBERS];
+    for (int mask = top >> 1; mask >= 1; mask >>= 1) {
+        int active = 0;
+        for (int rel = 0; rel < n; rel += 2 * mask) {
+            if (rel + mask >= n) continue;
+            int from = (rel + root) % n;
+            int to = (rel + mask + root) % n;
+            set_move(&moves[active++], from, buffers[from], 0, to, buffers[to], 0, bytes);
+        }
+        if (run_moves(group, moves, active) != 0) return -1;
+    }
+    return 0;
+}
+
+static int allreduce_tree(retryix_coll_group_t* group, cl_mem* buffers, size_t count, retryix_prim_type_t type,
+                          retryix_prim_op_t op) {
+    int n = group->count;
+    size_t bytes = count * COLL_ELEMENT_SIZES[type];
+    if (ensure_scratch(group, bytes) != 0) return -1;
+
+    retryix_coll_move_t moves[RETRYIX_COLL_MAX_MEMBERS];
+    for (int mask = 1; mask < n; mask <<= 1) {
+        int active = 0;
+        for (int r = mask; r < n; r += 2 * mask) {
+            int to = r - mask;
+            retryix_coll_move_t* mv = &moves[active++];
+            set_move(mv, r, buffers[r], 0, to, group->members[to].scratch, 0, bytes);
+            mv->reduce = true;
+            mv->spec.target = buffers[to];
+            mv->spec.type = type;
+            mv->spec.op = op;
+        }
+        if (run_moves(group, moves, active) != 0) return -1;
+    }
+    return tree_broadcast(group, buffers, bytes, 0);
+}
+
+// 對照組：全部讀回主機、主機端歸約後寫回每個設備
+typedef struct {
+    retryix_coll_group_t* group;
+    int member;
+    cl_mem buffer;
+    void* host;
+    size_t bytes;
+    bool write;
+    cl_int err;
+} retryix_coll_host_io_t;
+
+static void host_io_task(void* arg) {
+    retryix_coll_host_io_t* io = (retryix_coll_host_io_t*)arg;
+    cl_command_queue queue = io->group->members[io->member].copy;
+    io->err = io->write ? clEnqueueWriteBuffer(queue, io->buffer, CL_TRUE, 0, io->bytes, io->host, 0, NULL, NULL)
+                        : clEnqueueReadBuffer(queue, io->buffer, CL_TRUE, 0, io->bytes, io->host, 0, NULL, NULL);
+}
+
+#define COLL_HOST_COMBINE(T, dst, src, n, op)                                        \
+    do {                                                                              \
+        T* d_ = (T*)(dst);                                                            \
+        const T* s_ = (const T*)(src);                                                \
+        for (size_t i_ = 0; i_ < (n); i_++) {                                         \
+            if ((op) == RETRYIX_PRIM_OP_SUM) d_[i_] += s_[i_];                        \
+            else if ((op) == RETRYIX_PRIM_OP_MIN) d_[i_] = s_[i_] < d_[i_] ? s_[i_] : d_[i_]; \
+            else d_[i_] = s_[i_] > d_[i_] ? s_[i_] : d_[i_];                          \
+        }                                                                             \
+    } while (0)
+
+static int allreduce_naive(retryix_coll_group_t* group, cl_mem* buffers, size_t count, retryix_prim_type_t type,
+                           retryix_prim_op_t op) {
+    int n = group->count;
+    size_t bytes = count * COLL_ELEMENT_SIZES[type];
+    char* host = (char*)malloc(bytes * (size_t)n);
+    if (!host) return -1;
+
+    retryix_coll_host_io_t ios[RETRYIX_COLL_MAX_MEMBERS];
+    retryix_pool_group_t pool;
+    int rc = 0;
+    for (int pass = 0; pass < 2 && rc == 0; pass++) {
+        bool write = (pass == 1);
+        retryix_pool_group_init(&pool);
+        for (int r = 0; r < n; r++) {
+            ios[r].group = group;
+            ios[r].member = r;
+            ios[r].buffer = buffers[r];
+            ios[r].host = write ? host : host + (size_t)r * bytes;
+            ios[r].bytes = bytes;
+            ios[r].write = write;
+            retryix_pool_spawn(&pool, host_io_task, &ios[r]);
+        }
+        retryix_pool_wait(&pool);
+        for (int r = 0; r < n; r++) {
+            if (ios[r].err != CL_SUCCESS) rc = -1;
+        }
+        if (!write && rc == 0) {
+            for (int r = 1; r < n; r++) {
+                const char* src = host + (size_t)r * bytes;
+                switch (type) {
+                case RETRYIX_PRIM_INT:   COLL_HOST_COMBINE(cl_int, host, src, count, op); break;
+                case RETRYIX_PRIM_FLOAT: COLL_HOST_COMBINE(cl_float, host, src, count, op); break;
+                default:                 COLL_HOST_COMBINE(cl_double, host, src, count, op); break;
+                }
+            }
+        }
+    }
+    free(host);
+    return rc;
+}
+
+static void release_member(retryix_coll_member_t* m) {
+    if (m->staging_ptr) {
+        clEnqueueUnmapMemObject(m->copy, m->staging_mem, m->staging_ptr, 0, NULL, NULL);
+        clFinish(m->copy);
+    }
+    if (m->staging_mem) clReleaseMemObject(m->staging_mem);
+    if (m->scratch) clReleaseMemObject(m->scratch);
+    if (m->copy) clReleaseCommandQueue(m->copy);
+    for (int t = 0; t < RETRYIX_PRIM_TYPE_COUNT; t++) {
+        if (m->reduce[t]) clReleaseKernel(m->reduce[t]);
+    }
+}
+
+// 三種型別共用一份原始碼：註冊一個模板，每個設備只編譯一次；已註冊時不重新註冊
+static int register_kernels(void) {
+    if (retryix_multi_has_template(COLL_TEMPLATE)) return 0;
+    return retryix_multi_register_template(COLL_TEMPLATE, COLL_KERNELS[RETRYIX_PRIM_INT], COLL_SOURCE);
+}
+
+// 由該設備的模板程序建立本群組專用的歸約內核；double 僅在設備支援 fp64 時存在
+static int create_reduce_kernels(retryix_coll_member_t* m) {
+    cl_program program = retryix_multi_get_program(COLL_TEMPLATE, m->device);
+    if (!program) return -1;
+    for (int t = 0; t < RETRYIX_PRIM_TYPE_COUNT; t++) {
+        cl_int err = CL_SUCCESS;
+        m->reduce[t] = clCreateKernel(program, COLL_KERNELS[t], &err);
+        if (err != CL_SUCCESS) m->reduce[t] = NULL;
+    }
+    return m->reduce[RETRYIX_PRIM_INT] && m->reduce[RETRYIX_PRIM_FLOAT] ? 0 : -1;
+}
+
+// 呼叫前對 buffers 的寫入需已完成；各成員的計算佇列先行 clFinish
+static int begin_collective(retryix_coll_group_t* group, cl_mem* buffers) {
+    if (!group || !buffers) return -1;
+    for (int r = 0; r < group->count; r++) {
+        if (!buffers[r]) return -1;
+        clFinish(group->members[r].compute);
+    }
+    return 0;
+}
+
+// === 公開 API ===
+
+retryix_coll_group_t* retryix_coll_create(const int* devices, int count) {
+    int available = retryix_multi_device_count();
+    if (available == 0) return NULL;
+    if (count <= 0) count = devices ? 0 : available;
+    if (count <= 0 || count > RETRYIX_COLL_MAX_MEMBERS || (!devices && count > available)) return NULL;
+
+    retryix_coll_group_t* group = (retryix_coll_group_t*)calloc(1, sizeof(retryix_coll_group_t));
+    if (!group) return NULL;
+    size_t chunk_kb = retryix_config_get_dword("Collective", "ChunkKB", 1024);
+    if (chunk_kb < 4) chunk_kb = 4;
+    group->chunk_bytes = chunk_kb * 1024;
+
+    if (register_kernels() != 0) {
+        free(group);
+        return NULL;
+    }
+
+    int rc = 0;
+    for (int r = 0; r < count && rc == 0; r++) {
+        retryix_coll_member_t* m = &group->members[r];
+        cl_device_id device = NULL;
+        m->device = devices ? devices[r] : r;
+        for (int p = 0; p < r; p++) {
+            if (group->members[p].device == m->device) rc = -1; // 同一設備不可重複
+        }
+        if (rc != 0 || retryix_multi_get_device(m->device, &device, &m->context, &m->compute) != 0) {
+            rc = -1;
+            break;
+        }
+        group->count = r + 1;
+
+        if (create_reduce_kernels(m) != 0) {
+            printf("RetryIX Collective: reduce kernels unavailable on device %d\n", m->device);
+            rc = -1;
+            break;
+        }
+        cl_int err = CL_SUCCESS;
+        m->copy = rixCreateQueue(m->context, device, &err);
+        if (err == CL_SUCCESS) {
+            m->staging_mem = clCreateBuffer(m->context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
+                                            RETRYIX_COLL_SLOTS * group->chunk_bytes, NULL, &err);
+        }
+        if (err == CL_SUCCESS) {
+            m->staging_ptr = (char*)clEnqueueMapBuffer(m->copy, m->staging_mem, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0,
+                                                       RETRYIX_COLL_SLOTS * group->chunk_bytes, 0, NULL, NULL, &err);
+        }
+        if (err != CL_SUCCESS) {
+            printf("RetryIX Collective: member %d setup failed (%s)\n", r, rixCLErrorName(err));
+            rc = -1;
+        }
+    }
+    if (rc != 0) {
+        retryix_coll_destroy(group);
+        return NULL;
+    }
+    return group;
+}
+
+void retryix_coll_destroy(retryix_coll_group_t* group) {
+    if (!group) return;
+    for (int r = 0; r < group->count; r++) release_member(&group->members[r]);
+    free(group);
+}
+
+int retryix_coll_size(const retryix_coll_group_t* group) {
+    return group ? group->count : 0;
+}
+
+const char* retryix_coll_algo_name(retryix_coll_algo_t algo) {
+    return (algo >= 0 && algo < RETRYIX_COLL_ALGO_COUNT) ? COLL_ALGO_NAMES[algo] : "unknown";
+}
+
+int retryix_coll_allreduce(retryix_coll_group_t* group, cl_mem* buffers, size_t count, retryix_prim_type_t type,
+                           retryix_prim_op_t op, retryix_coll_algo_t algo) {
+    if (begin_collective(group, buffers) != 0 || count == 0) return -1;
+    if (type < 0 || type >= RETRYIX_PRIM_TYPE_COUNT || op < 0 || op >= RETRYIX_PRIM_OP_COUNT) return -1;
+    if (group->count == 1) return 0;
+    switch (algo) {
+    case RETRYIX_COLL_RING:  return allreduce_ring(group, buffers, count, type, op);
+    case RETRYIX_COLL_TREE:  return allreduce_tree(group, buffers, count, type, op);
+    case RETRYIX_COLL_NAIVE: return allreduce_naive(group, buffers, count, type, op);
+    default:                 return -1;
+    }
+}
+
+int retryix_coll_broadcast(retryix_coll_group_t* group, cl_mem* buffers, size_t bytes, int root) {
+    if (begin_collective(group, buffers) != 0 || bytes == 0 || root < 0 || root >= group->count) return -1;
+    return tree_broadcast(group, buffers, bytes, root);
+}
+
+// ring：每步每個成員把上一步收到的區塊轉給下一個成員（同一步驟既送又收，接收經接收區延後寫入）
+int retryix_coll_allgather(retryix_coll_group_t* group, cl_mem* send, cl_mem* recv, size_t bytes) {
+    if (begin_collective(group, send) != 0 || begin_collective(group, recv) != 0 || bytes == 0) return -1;
+    if (ensure_scratch(group, bytes) != 0) return -1;
+    int n = group->count;
+    retryix_coll_move_t moves[RETRYIX_COLL_MAX_MEMBERS];
+    for (int r = 0; r < n; r++) set_move(&moves[r], r, send[r], 0, r, recv[r], (size_t)r * bytes, bytes);
+    if (run_moves(group, moves, n) != 0) return -1;
+
+    for (int step = 0; step < n - 1; step++) {
+        for (int r = 0; r < n; r++) {
+            int to = (r + 1) % n;
+            size_t offset = (size_t)((r - step + n) % n) * bytes;
+            set_deferred_move(group, &moves[r], r, recv[r], offset, to, recv[to], offset, bytes);
+        }
+        if (run_moves(group, moves, n) != 0) return -1;
+    }
+    return 0;
+}
+
+void retryix_coll_print_stats(const retryix_coll_group_t* group) {
+    if (!group) return;
+    printf("  Collective group: %d members, chunk %zu KB, %.1f MB device-to-device, %.1f MB via pinned staging\n",
+           group->count, group->chunk_bytes / 1024, (double)group->bytes_direct / (1024.0 * 1024.0),
+           (double)group->bytes_staged / (1024.0 * 1024.0));
+    for (int r = 0; r < group->count; r++) {
+        const retryix_coll_member_t* m = &group->members[r];
+        int shared = 0;
+        for (int p = 0; p < group->count; p++) {
+            if (p != r && group->members[p].context == m->context) shared++;
+        }
+        printf("    rank %d: device %d, shares context with %d member(s)\n", r, m->device, shared);
+    }
+}
+
+// === 量測 ===
+
+static int upload_inputs(retryix_coll_group_t* group, cl_mem* buffers, float* host, size_t count) {
+    for (int r = 0; r < group->count; r++) {
+        for (size_t i = 0; i < count; i++) host[i] = (float)((i % 13) + (size_t)r);
+        if (clEnqueueWriteBuffer(group->members[r].copy, buffers[r], CL_TRUE, 0, count * sizeof(float), host, 0, NULL,
+                                 NULL) != CL_SUCCESS) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 所有成員的結果都與 expect(i) 相同
+static bool verify_all(retryix_coll_group_t* group, cl_mem* buffers, float* host, size_t count, int mode) {
+    int n = group->count;
+    for (int r = 0; r < n; r++) {
+        if (clEnqueueReadBuffer(group->members[r].copy, buffers[r], CL_TRUE, 0, count * sizeof(float), host, 0, NULL,
+                                NULL) != CL_SUCCESS) {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            float expect;
+            if (mode == 0) expect = (float)((size_t)n * (i % 13)) + (float)(n * (n - 1) / 2);   // all-reduce 總和
+            else if (mode == 1) expect = (float)(i % 13);                                           // 自 rank 0 廣播
+            else expect = (float)((i % (count / (size_t)n)) % 13 + i / (count / (size_t)n));        // all-gather
+            if (host[i] != expect) return false;
+        }
+    }
+    return true;
+}
+
+int retryix_coll_benchmark(size_t count, int iterations) {
+    if (retryix_multi_device_count() == 0 && retryix_multi_init(0) != 0) return -1;
+    retryix_coll_group_t* group = retryix_coll_create(NULL, 0);
+    if (!group) return -1;
+    int n = group->count;
+    if (count == 0) count = (size_t)16 << 20;
+    if (iterations <= 0) iterations = 3;
+    count = count / (size_t)n * (size_t)n; // all-gather 每個成員等量
+    size_t bytes = count * sizeof(float);
+
+    cl_mem buffers[RETRYIX_COLL_MAX_MEMBERS] = { NULL };
+    cl_mem blocks[RETRYIX_COLL_MAX_MEMBERS] = { NULL };
+    float* host = (float*)malloc(bytes);
+    int failures = 0;
+    for (int r = 0; r < n && host; r++) {
+        cl_int err = CL_SUCCESS;
+        buffers[r] = clCreateBuffer(group->members[r].context, CL_MEM_READ_WRITE, bytes, NULL, &err);
+        if (err == CL_SUCCESS) {
+            blocks[r] = clCreateBuffer(group->members[r].context, CL_MEM_READ_WRITE, bytes / (size_t)n, NULL, &err);
+        }
+        if (err != CL_SUCCESS) failures++;
+    }
+    if (!host || failures) {
+        for (int r = 0; r < n; r++) {
+            if (buffers[r]) clReleaseMemObject(buffers[r]);
+            if (blocks[r]) clReleaseMemObject(blocks[r]);
+        }
+        free(host);
+        retryix_coll_destroy(group);
+        return -1;
+    }
+
+    printf("\n=== RetryIX Collective Benchmark (%d devices, %.1f MB float, best of %d) ===\n", n,
+           (double)bytes / (1024.0 * 1024.0), iterations);
+    printf("  operation              ms    algbw GB/s   vs naive\n");
+
+    double naive_ms = 0.0;
+    const retryix_coll_algo_t order[3] = { RETRYIX_COLL_NAIVE, RETRYIX_COLL_RING, RETRYIX_COLL_TREE };
+    for (int a = 0; a < 3; a++) {
+        double best = -1.0;
+        bool ok = true;
+        for (int it = 0; it < iterations && ok; it++) {
+            if (upload_inputs(group, buffers, host, count) != 0) {
+                ok = false;
+                break;
+            }
+            double t0 = rixNowMs();
+            ok = retryix_coll_allreduce(group, buffers, count, RETRYIX_PRIM_FLOAT, RETRYIX_PRIM_OP_SUM, order[a]) == 0;
+            double ms = rixNowMs() - t0;
+            if (best < 0.0 || ms < best) best = ms;
+        }
+        ok = ok && verify_all(group, buffers, host, count, 0);
+        if (order[a] == RETRYIX_COLL_NAIVE) naive_ms = best;
+        printf("  all-reduce %-7s %9.3f  %12.2f  %8.2fx  %s\n", retryix_coll_algo_name(order[a]), best,
+               ok ? (double)bytes / (best * 1e6) : 0.0, ok && best > 0.0 ? naive_ms / best : 0.0, ok ? "PASS" : "FAIL");
+        if (!ok) failures++;
+    }
+
+    // 廣播與 all-gather 只報告頻寬
+    double best = -1.0;
+    bool ok = true;
+    for (int it = 0; it < iterations && ok; it++) {
+        ok = upload_inputs(group, buffers, host, count) == 0;
+        double t0 = rixNowMs();
+        ok = ok && retryix_coll_broadcast(group, buffers, bytes, 0) == 0;
+        double ms = rixNowMs() - t0;
+        if (best < 0.0 || ms < best) best = ms;
+    }
+    ok = ok && verify_all(group, buffers, host, count, 1);
+    printf("  broadcast (tree)   %9.3f  %12.2f  %9s  %s\n", best, ok ? (double)bytes / (best * 1e6) : 0.0, "-",
+           ok ? "PASS" : "FAIL");
+    if (!ok) failures++;
+
+    best = -1.0;
+    ok = true;
+    size_t block_count = count / (size_t)n;
+    for (int it = 0; it < iterations && ok; it++) {
+        for (int r = 0; r < n && ok; r++) {
+            for (size_t i = 0; i < block_count; i++) host[i] = (float)(i % 13 + (size_t)r);
+            ok = clEnqueueWriteBuffer(group->members[r].copy, blocks[r], CL_TRUE, 0, block_count * sizeof(float), host, 0,
+                                      NULL, NULL) == CL_SUCCESS;
+        }
+        double t0 = rixNowMs();
+        ok = ok && retryix_coll_allgather(group, blocks, buffers, block_count * sizeof(float)) == 0;
+        double ms = rixNowMs() - t0;
+        if (best < 0.0 || ms < best) best = ms;
+    }
+    ok = ok && verify_all(group, buffers, host, count, 2);
+    printf("  all-gather (ring)  %9.3f  %12.2f  %9s  %s\n", best, ok ? (double)bytes / (best * 1e6) : 0.0, "-",
+           ok ? "PASS" : "FAIL");
+    if (!ok) failures++;
+
+    retryix_coll_print_stats(group);
+    printf("=====================================================\n\n");
+
+    for (int r = 0; r < n; r++) {
+        clReleaseMemObject(buffers[r]);
+        clReleaseMemObject(blocks[r]);
+    }
+    free(host);
+    retryix_coll_destroy(group);
+    return failures ? -1 : 0;
+}
@@ -0,0 +1,252 @@
+// retryix_config.c - RetryIX 設定讀取與調校結果持久化
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+
+#include "retryix.h"
+#include "retryix_thread.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#endif
+
+#define RETRYIX_REGISTRY_ROOT   "SOFTWARE\\RetryIX\\"
+#define RETRYIX_TUNING_FILE     "retryix_tuning.cache"
+
+// 調校快取項目
+typedef struct {
+    char device_key[192];           // 設備識別（名稱 + 驅動版本）
+    char key[128];                  // 項目鍵
+    char value[128];                // 項目值
+} retryix_tuning_entry_t;
+
+// 調校快取
+static retryix_tuning_entry_t* g_tuning_entries = NULL;
+static size_t g_tuning_count = 0;
+static size_t g_tuning_capacity = 0;
+static int g_tuning_loaded = 0;
+static char g_tuning_path[512] = {0};
+static rix_mutex_t g_tuning_lock;           // 保護快取表（各模組會自執行緒池任務讀寫）
+static rix_once_t g_tuning_once = RIX_ONCE_INIT;
+
+static void init_tuning_lock(void) {
+    rix_mutex_init(&g_tuning_lock);
+}
+
+// === 設定讀取 ===
+
+#ifndef _WIN32
+// 將 "KernelEngine" + "CacheSize" 轉為環境變數名 RETRYIX_KERNELENGINE_CACHESIZE
+static void build_env_name(const char* subkey, const char* value_name, char* out, size_t max_len) {
+    size_t n = (size_t)snprintf(out, max_len, "RETRYIX_%s_%s", subkey, value_name);
+    if (n >= max_len) n = max_len - 1;
+    for (size_t i = 0; i < n; i++) {
+        if (out[i] == '\\' || out[i] == '/') out[i] = '_';
+        else out[i] = (char)toupper((unsigned char)out[i]);
+    }
+}
+#endif
+
+// 讀取 DWORD 設定（Windows 讀登錄檔，其他平台讀環境變數）
+unsigned long retryix_config_get_dword(const char* subkey, const char* value_name, unsigned long default_value) {
+    if (!subkey || !value_name) return default_value;
+
+#ifdef _WIN32
+    char path[256];
+    snprintf(path, sizeof(path), RETRYIX_REGISTRY_ROOT "%s", subkey);
+    DWORD data = 0;
+    DWORD size = sizeof(data);
+    if (RegGetValueA(HKEY_LOCAL_MACHINE, path, value_name, RRF_RT_REG_DWORD, NULL, &data, &size) == ERROR_SUCCESS) {
+        return (unsigned long)data;
+    }
+    return default_value;
+#else
+    char env_name[256];
+    build_env_name(subkey, value_name, env_name, sizeof(env_name));
+    const char* env = getenv(env_name);
+    if (!env || !*env) return default_value;
+    return strtoul(env, NULL, 0);
+#endif
+}
+
+// 讀取字串設定，成功回傳 0
+int retryix_config_get_string(const char* subkey, const char* value_name, char* out, size_t max_len) {
+    if (!subkey || !value_name || !out || max_len == 0) return RETRYIX_ERROR_NULL_PTR;
+
+#ifdef _WIN32
+    char path[256];
+    snprintf(path, sizeof(path), RETRYIX_REGISTRY_ROOT "%s", subkey);
+    DWORD size = (DWORD)max_len;
+    if (RegGetValueA(HKEY_LOCAL_MACHINE, path, value_name, RRF_RT_REG_SZ, NULL, out, &size) == ERROR_SUCCESS) {
+        return RETRYIX_SUCCESS;
+    }
+    return RETRYIX_ERROR_FILE_IO;
+#else
+    char env_name[256];
+    build_env_name(subkey, value_name, env_name, sizeof(env_name));
+    const char* env = getenv(env_name);
+    if (!env || !*env) return RETRYIX_ERROR_FILE_IO;
+    snprintf(out, max_len, "%s", env);
+    return RETRYIX_SUCCESS;
+#endif
+}
+
+// === 調校快取 ===
+
+// 設備識別：名稱 + 驅動版本，避免驅動更新後沿用舊結果
+static void build_device_key(cl_device_id device, char* out, size_t max_len) {
+    char name[128] = {0};
+    char driver[64] = {0};
+    clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(name), name, NULL);
+    clGetDeviceInfo(device, CL_DRIVER_VERSION, sizeof(driver), driver, NULL);
+    snprintf(out, max_len, "%s|%s", name, driver);
+
+    // 去除會破壞檔案格式的字元
+    for (char* p = out; *p; p++) {
+        if (*p == '\t' || *p == '\n' || *p == '\r') *p = '_';
+    }
+}
+
+static void resolve_tuning_path(void) {
+    if (g_tuning_path[0]) return;
+
+    char dir[384] = {0};
+    if (retryix_config_get_string("Core", "CachePath", dir, sizeof(dir)) == RETRYIX_SUCCESS && dir[0]) {
+        size_t n = strlen(dir);
+        const char* sep = (dir[n - 1] == '\\' || dir[n - 1] == '/') ? "" : "/";
+        snprintf(g_tuning_path, sizeof(g_tuning_path), "%s%s%s", dir, sep, RETRYIX_TUNING_FILE);
+    } else {
+        snprintf(g_tuning_path, sizeof(g_tuning_path), "%s", RETRYIX_TUNING_FILE);
+    }
+}
+
+static retryix_tuning_entry_t* find_tuning_entry(const char* device_key, const char* key) {
+    for (size_t i = 0; i < g_tuning_count; i++) {
+        if (strcmp(g_tuning_entries[i].device_key, device_key) == 0 &&
+            strcmp(g_tuning_entries[i].key, key) == 0) {
+            return &g_tuning_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static retryix_tuning_entry_t* append_tuning_entry(void) {
+    if (g_tuning_count >= g_tuning_capacity) {
+        size_t new_capacity = g_tuning_capacity ? g_tuning_capacity * 2 : 64;
+        retryix_tuning_entry_t* grown = (retryix_tuning_entry_t*)realloc(g_tuning_entries,
+                                                                        new_capacity * sizeof(retryix_tuning_entry_t));
+        if (!grown) return NULL;
+        g_tuning_entries = grown;
+        g_tuning_capacity = new_capacity;
+    }
+    retryix_tuning_entry_t* entry = &g_tuning_entries[g_tuning_count++];
+    memset(entry, 0, sizeof(*entry));
+    return entry;
+}
+
+// 載入快取檔（格式：device_key \t key \t value）
+static void load_tuning_cache(void) {
+    if (g_tuning_loaded) return;
+    g_tuning_loaded = 1;
+    resolve_tuning_path();
+
+    FILE* fp = fopen(g_tuning_path, "r");
+    if (!fp) return;
+
+    char line[512];
+    while (fgets(line, sizeof(line), fp)) {
+        size_t n = strlen(line);
+        while (n && (line[n - 1] == '\n' || line[n - 1] == '\r')) line[--n] = '\0';
+
+        char* tab1 = strchr(line, '\t');
+        if (!tab1) continue;
+        char* tab2 = strchr(tab1 + 1, '\t');
+        if (!tab2) continue;
+        *tab1 = '\0';
+        *tab2 = '\0';
+
+        retryix_tuning_entry_t* entry = find_tuning_entry(line, tab1 + 1);
+        if (!entry) entry = append_tuning_entry();
+        if (!entry) break;
+        snprintf(entry->device_key, sizeof(entry->device_key), "%s", line);
+        snprintf(entry->key, sizeof(entry->key), "%s", tab1 + 1);
+        snprintf(entry->value, sizeof(entry->value), "%s", tab2 + 1);
+    }
+    fclose(fp);
+}
+
+static int save_tuning_cache(void) {
+    FILE* fp = fopen(g_tuning_path, "w");
+    if (!fp) return RETRYIX_ERROR_FILE_IO;
+
+    for (size_t i = 0; i < g_tuning_count; i++) {
+        fprintf(fp, "%s\t%s\t%s\n", g_tuning_entries[i].device_key,
+                g_tuning_entries[i].key, g_tuning_entries[i].value);
+    }
+    fclose(fp);
+    return RETRYIX_SUCCESS;
+}
+
+// 查詢設備調校結果，找到回傳 0
+int retryix_tuning_get(cl_device_id device, const char* key, char* value, size_t max_len) {
+    if (!device || !key || !value || max_len == 0) return RETRYIX_ERROR_NULL_PTR;
+
+    char device_key[192];
+    build_device_key(device, device_key, sizeof(device_key));
+
+    rix_call_once(&g_tuning_once, init_tuning_lock);
+    rix_mutex_lock(&g_tuning_lock);
+    load_tuning_cache();
+    retryix_tuning_entry_t* entry = find_tuning_entry(device_key, key);
+    if (entry) snprintf(value, max_len, "%s", entry->value);
+    rix_mutex_unlock(&g_tuning_lock);
+
+    return entry ? RETRYIX_SUCCESS : RETRYIX_ERROR_NOT_FOUND;
+}
+
+// 寫入設備調校結果並立即落盤
+int retryix_tuning_put(cl_device_id device, const char* key, const char* value) {
+    if (!device || !key || !value) return RETRYIX_ERROR_NULL_PTR;
+    if (strchr(key, '\t') || strchr(key, '\n') || strchr(value, '\t') || strchr(value, '\n')) {
+        return RETRYIX_ERROR_INVALID_ARG;     // 快取檔以 tab / 換行分隔欄位
+    }
+
+    char device_key[192];
+    build_device_key(device, device_key, sizeof(device_key));
+
+    rix_call_once(&g_tuning_once, init_tuning_lock);
+    rix_mutex_lock(&g_tuning_lock);
+    load_tuning_cache();
+    retryix_tuning_entry_t* entry = find_tuning_entry(device_key, key);
+    if (!entry) {
+        entry = append_tuning_entry();
+        if (entry) {
+            snprintf(entry->device_key, sizeof(entry->device_key), "%s", device_key);
+            snprintf(entry->key, sizeof(entry->key), "%s", key);
+        }
+    }
+    int rc = RETRYIX_ERROR_NULL_PTR;
+    if (entry) {
+        snprintf(entry->value, sizeof(entry->value), "%s", value);
+        rc = save_tuning_cache();
+    }
+    rix_mutex_unlock(&g_tuning_lock);
+    return rc;
+}
+
+// 釋放調校快取（下次查詢會重新載入）
+void retryix_tuning_reset(void) {
+    rix_call_once(&g_tuning_once, init_tuning_lock);
+    rix_mutex_lock(&g_tuning_lock);
+    free(g_tuning_entries);
+    g_tuning_entries = NULL;
+    g_tuning_count = 0;
+    g_tuning_capacity = 0;
+    g_tuning_loaded = 0;
+    g_tuning_path[0] = '\0';
+    rix_mutex_unlock(&g_tuning_lock);
+}
@@ -0,0 +1,613 @@
+// retryix_cpu.c - RetryIX CPU 偽設備：無 OpenCL 設備時以 SIMD 與工作竊取執行緒池執行內建運算
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+
+// AVX / AVX2 路徑：以 target 屬性單獨編譯，執行期以 CPUID 選擇
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #include <cpuid.h>
+  #include <immintrin.h>
+  #define RETRYIX_CPU_X86 1
+  #define RETRYIX_AVX_TARGET  __attribute__((target("avx")))
+  #define RETRYIX_AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  #include <intrin.h>
+  #include <immintrin.h>
+  #define RETRYIX_CPU_X86 1
+  #define RETRYIX_AVX_TARGET
+  #define RETRYIX_AVX2_TARGET
+#endif
+
+#define RETRYIX_CPU_BLOCK         65536   // reduce / scan 的固定區塊：結果與執行緒數無關
+#define RETRYIX_CPU_GRAIN         32768   // 逐元素運算每次取出的元素數
+#define RETRYIX_CPU_MAX_COUNT     0x7FFFFFFFu
+
+static const size_t CPU_ELEMENT_SIZES[RETRYIX_PRIM_TYPE_COUNT] = { sizeof(cl_int), sizeof(cl_float), sizeof(cl_double) };
+static const char* CPU_OP_LABELS[RETRYIX_CPU_OP_COUNT] = { "increment", "add", "sub", "mul", "scale", "axpy" };
+
+typedef struct {
+    bool avx;
+    bool avx2;
+} retryix_cpu_context_t;
+
+static retryix_cpu_context_t* g_cpu_context = NULL;
+
+typedef union {
+    cl_int i;
+    cl_float f;
+    cl_double d;
+} retryix_cpu_value_t;
+
+// === SIMD 偵測 ===
+
+#ifdef RETRYIX_CPU_X86
+// AVX 需 CPUID.1:ECX 的 AVX 與 OSXSAVE 並由作業系統保存 YMM；AVX2 另看 CPUID.7:EBX bit 5
+static void detect_simd(bool* avx, bool* avx2) {
+    unsigned int ecx1 = 0;
+    unsigned int ebx7 = 0;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    ecx1 = (unsigned int)info[2];
+    __cpuidex(info, 7, 0);
+    ebx7 = (unsigned int)info[1];
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx1, &edx)) return;
+    if (__get_cpuid_max(0, NULL) >= 7) {
+        __cpuid_count(7, 0, eax, ebx7, ecx, edx);
+    }
+#endif
+    const unsigned int required = (1u << 28) | (1u << 27);
+    if ((ecx1 & required) != required) return;
+#if defined(_MSC_VER)
+    unsigned long long xcr0 = _xgetbv(0);
+#else
+    unsigned int xcr0_lo, xcr0_hi;
+    __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    unsigned long long xcr0 = ((unsigned long long)xcr0_hi << 32) | xcr0_lo;
+#endif
+    if ((xcr0 & 0x6u) != 0x6u) return;
+    *avx = true;
+    *avx2 = (ebx7 & (1u << 5)) != 0;
+}
+#else
+static void detect_simd(bool* avx, bool* avx2) {
+    (void)avx;
+    (void)avx2;
+}
+#endif
+
+// === 逐元素運算 ===
+
+typedef struct {
+    retryix_cpu_op_t op;
+    float* out;
+    const float* a;
+    const float* b;
+    float alpha;
+    bool avx;
+} retryix_cpu_elementwise_job_t;
+
+static void elementwise_scalar(const retryix_cpu_elementwise_job_t* job, size_t begin, size_t end) {
+    float* out = job->out;
+    const float* a = job->a;
+    const float* b = job->b;
+    const float alpha = job->alpha;
+    size_t i;
+    switch (job->op) {
+        case RETRYIX_CPU_OP_INCREMENT: for (i = begin; i < end; i++) out[i] = a[i] + 1.0f; break;
+        case RETRYIX_CPU_OP_ADD:       for (i = begin; i < end; i++) out[i] = a[i] + b[i]; break;
+        case RETRYIX_CPU_OP_SUB:       for (i = begin; i < end; i++) out[i] = a[i] - b[i]; break;
+        case RETRYIX_CPU_OP_MUL:       for (i = begin; i < end; i++) out[i] = a[i] * b[i]; break;
+        case RETRYIX_CPU_OP_SCALE:     for (i = begin; i < end; i++) out[i] = alpha * a[i]; break;
+        case RETRYIX_CPU_OP_AXPY:      for (i = begin; i < end; i++) out[i] = alpha * a[i] + b[i]; break;
+        default: break;
+    }
+}
+
+#ifdef RETRYIX_CPU_X86
+// 8 寬度主迴圈，餘數交給純量版本；乘加分開計算，結果與純量版本逐位元一致
+RETRYIX_AVX_TARGET
+static void elementwise_avx(const retryix_cpu_elementwise_job_t* job, size_t begin, size_t end) {
+    float* out = job->out;
+    const float* a = job->a;
+    const float* b = job->b;
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 alpha = _mm256_set1_ps(job->alpha);
+    size_t i = begin;
+    switch (job->op) {
+        case RETRYIX_CPU_OP_INCREMENT:
+            for (; i + 8 <= end; i += 8) _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(a + i), one));
+            break;
+        case RETRYIX_CPU_OP_ADD:
+            for (; i + 8 <= end; i += 8) _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+            break;
+        case RETRYIX_CPU_OP_SUB:
+            for (; i + 8 <= end; i += 8) _mm256_storeu_ps(out + i, _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+            break;
+        case RETRYIX_CPU_OP_MUL:
+            for (; i + 8 <= end; i += 8) _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+            break;
+        case RETRYIX_CPU_OP_SCALE:
+            for (; i + 8 <= end; i += 8) _mm256_storeu_ps(out + i, _mm256_mul_ps(alpha, _mm256_loadu_ps(a + i)));
+            break;
+        case RETRYIX_CPU_OP_AXPY:
+            for (; i + 8 <= end; i += 8) {
+                __m256 ax = _mm256_mul_ps(alpha, _mm256_loadu_ps(a + i));
+                _mm256_storeu_ps(out + i, _mm256_add_ps(ax, _mm256_loadu_ps(b + i)));
+            }
+            break;
+        default: break;
+    }
+    elementwise_scalar(job, i, end);
+}
+#endif
+
+static void elementwise_range(void* arg, size_t begin, size_t end) {
+    const retryix_cpu_elementwise_job_t* job = (const retryix_cpu_elementwise_job_t*)arg;
+#ifdef RETRYIX_CPU_X86
+    if (job->avx) {
+        elementwise_avx(job, begin, end);
+        return;
+    }
+#endif
+    elementwise_scalar(job, begin, end);
+}
+
+// === 歸約 ===
+
+typedef struct {
+    retryix_prim_type_t type;
+    retryix_prim_op_t op;
+    const void* input;
+    void* output;
+    size_t count;
+    bool inclusive;
+    retryix_cpu_value_t* partials;   // 每個區塊一個
+    bool avx;
+    bool avx2;
+} retryix_cpu_reduce_job_t;
+
+static retryix_cpu_value_t value_identity(retryix_prim_type_t type, retryix_prim_op_t op) {
+    retryix_cpu_value_t v;
+    memset(&v, 0, sizeof(v));
+    if (op == RETRYIX_PRIM_OP_SUM) return v;
+    bool is_min = (op == RETRYIX_PRIM_OP_MIN);
+    switch (type) {
+        case RETRYIX_PRIM_INT: v.i = is_min ? INT_MAX : INT_MIN; break;
+        case RETRYIX_PRIM_FLOAT: v.f = is_min ? INFINITY : -INFINITY; break;
+        default: v.d = is_min ? (double)INFINITY : -(double)INFINITY; break;
+    }
+    return v;
+}
+
+static retryix_cpu_value_t value_combine(retryix_prim_type_t type, retryix_prim_op_t op,
+                                         retryix_cpu_value_t a, retryix_cpu_value_t b) {
+    retryix_cpu_value_t r;
+    switch (type) {
+        case RETRYIX_PRIM_INT:
+            if (op == RETRYIX_PRIM_OP_SUM) r.i = (cl_int)((uint32_t)a.i + (uint32_t)b.i);
+            else if (op == RETRYIX_PRIM_OP_MIN) r.i = b.i < a.i ? b.i : a.i;
+            else r.i = b.i > a.i ? b.i : a.i;
+            break;
+        case RETRYIX_PRIM_FLOAT:
+            if (op == RETRYIX_PRIM_OP_SUM) r.f = a.f + b.f;
+            else if (op == RETRYIX_PRIM_OP_MIN) r.f = b.f < a.f ? b.f : a.f;
+            else r.f = b.f > a.f ? b.f : a.f;
+            break;
+        default:
+            if (op == RETRYIX_PRIM_OP_SUM) r.d = a.d + b.d;
+            else if (op == RETRYIX_PRIM_OP_MIN) r.d = b.d < a.d ? b.d : a.d;
+            else r.d = b.d > a.d ? b.d : a.d;
+            break;
+    }
+    return r;
+}
+
+static retryix_cpu_value_t reduce_scalar(retryix_prim_type_t type, retryix_prim_op_t op, const void* input,
+                                         size_t begin, size_t end, retryix_cpu_value_t acc) {
+    retryix_cpu_value_t v;
+    for (size_t i = begin; i < end; i++) {
+        switch (type) {
+            case RETRYIX_PRIM_INT: v.i = ((const cl_int*)input)[i]; break;
+            case RETRYIX_PRIM_FLOAT: v.f = ((const cl_float*)input)[i]; break;
+            default: v.d = ((const cl_double*)input)[i]; break;
+        }
+        acc = value_combine(type, op, acc, v);
+    }
+    return acc;
+}
+
+#ifdef RETRYIX_CPU_X86
+// 兩組累加器隱藏加法延遲；水平合併後與餘數以純量合併
+#define RIX_REDUCE_LOOP(VEC, LOAD, OP, PTR, WIDTH) \
+    for (; i + 2 * (WIDTH) <= end; i += 2 * (WIDTH)) { \
+        acc0 = OP(acc0, LOAD((const VEC*)((PTR) + i))); \
+        acc1 = OP(acc1, LOAD((const VEC*)((PTR) + i + (WIDTH)))); \
+    }
+
+RETRYIX_AVX_TARGET
+static retryix_cpu_value_t reduce_f32_avx(retryix_prim_op_t op, const float* in, size_t begin, size_t end) {
+    retryix_cpu_value_t acc = value_identity(RETRYIX_PRIM_FLOAT, op);
+    size_t i = begin;
+    __m256 acc0 = _mm256_set1_ps(acc.f);
+    __m256 acc1 = acc0;
+    if (op == RETRYIX_PRIM_OP_SUM) {
+        RIX_REDUCE_LOOP(float, _mm256_loadu_ps, _mm256_add_ps, in, 8)
+        acc0 = _mm256_add_ps(acc0, acc1);
+    } else if (op == RETRYIX_PRIM_OP_MIN) {
+        RIX_REDUCE_LOOP(float, _mm256_loadu_ps, _mm256_min_ps, in, 8)
+        acc0 = _mm256_min_ps(acc0, acc1);
+    } else {
+        RIX_REDUCE_LOOP(float, _mm256_loadu_ps, _mm256_max_ps, in, 8)
+        acc0 = _mm256_max_ps(acc0, acc1);
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, acc0);
+    for (int k = 0; k < 8; k++) {
+        retryix_cpu_value_t v;
+        v.f = lanes[k];
+        acc = value_combine(RETRYIX_PRIM_FLOAT, op, acc, v);
+    }
+    return reduce_scalar(RETRYIX_PRIM_FLOAT, op, in, i, end, acc);
+}
+
+RETRYIX_AVX_TARGET
+static retryix_cpu_value_t reduce_f64_avx(retryix_prim_op_t op, const double* in, size_t begin, size_t end) {
+    retryix_cpu_value_t acc = value_identity(RETRYIX_PRIM_DOUBLE, op);
+    size_t i = begin;
+    __m256d acc0 = _mm256_set1_pd(acc.d);
+    __m256d acc1 = acc0;
+    if (op == RETRYIX_PRIM_OP_SUM) {
+        RIX_REDUCE_LOOP(double, _mm256_loadu_pd, _mm256_add_pd, in, 4)
+        acc0 = _mm256_add_pd(acc0, acc1);
+    } else if (op == RETRYIX_PRIM_OP_MIN) {
+        RIX_REDUCE_LOOP(double, _mm256_loadu_pd, _mm256_min_pd, in, 4)
+        acc0 = _mm256_min_pd(acc0, acc1);
+    } else {
+        RIX_REDUCE_LOOP(double, _mm256_loadu_pd, _mm256_max_pd, in, 4)
+        acc0 = _mm256_max_pd(acc0, acc1);
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc0);
+    for (int k = 0; k < 4; k++) {
+        retryix_cpu_value_t v;
+        v.d = lanes[k];
+        acc = value_combine(RETRYIX_PRIM_DOUBLE, op, acc, v);
+    }
+    return reduce_scalar(RETRYIX_PRIM_DOUBLE, op, in, i, end, acc);
+}
+
+RETRYIX_AVX2_TARGET
+static retryix_cpu_value_t reduce_i32_avx2(retryix_prim_op_t op, const cl_int* in, size_t begin, size_t end) {
+    retryix_cpu_value_t acc = value_identity(RETRYIX_PRIM_INT, op);
+    size_t i = begin;
+    __m256i acc0 = _mm256_set1_epi32(acc.i);
+    __m256i acc1 = acc0;
+    if (op == RETRYIX_PRIM_OP_SUM) {
+        RIX_REDUCE_LOOP(__m256i, _mm256_loadu_si256, _mm256_add_epi32, in, 8)
+        acc0 = _mm256_add_epi32(acc0, acc1);
+    } else if (op == RETRYIX_PRIM_OP_MIN) {
+        RIX_REDUCE_LOOP(__m256i, _mm256_loadu_si256, _mm256_min_epi32, in, 8)
+        acc0 = _mm256_min_epi32(acc0, acc1);
+    } else {
+        RIX_REDUCE_LOOP(__m256i, _mm256_loadu_si256, _mm256_max_epi32, in, 8)
+        acc0 = _mm256_max_epi32(acc0, acc1);
+    }
+    cl_int lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, acc0);
+    for (int k = 0; k < 8; k++) {
+        retryix_cpu_value_t v;
+        v.i = lanes[k];
+        acc = value_combine(RETRYIX_PRIM_INT, op, acc, v);
+    }
+    return reduce_scalar(RETRYIX_PRIM_INT, op, in, i, end, acc);
+}
+#endif
+
+static retryix_cpu_value_t reduce_block(const retryix_cpu_reduce_job_t* job, retryix_prim_op_t op, size_t begin, size_t end) {
+#ifdef RETRYIX_CPU_X86
+    if (job->type == RETRYIX_PRIM_FLOAT && job->avx) return reduce_f32_avx(op, (const float*)job->input, begin, end);
+    if (job->type == RETRYIX_PRIM_DOUBLE && job->avx) return reduce_f64_avx(op, (const double*)job->input, begin, end);
+    if (job->type == RETRYIX_PRIM_INT && job->avx2) return reduce_i32_avx2(op, (const cl_int*)job->input, begin, end);
+#endif
+    return reduce_scalar(job->type, op, job->input, begin, end, value_identity(job->type, op));
+}
+
+// 區塊索引範圍：每個區塊的歸約結果寫入 partials
+static void reduce_range(void* arg, size_t begin, size_t end) {
+    retryix_cpu_reduce_job_t* job = (retryix_cpu_reduce_job_t*)arg;
+    for (size_t b = begin; b < end; b++) {
+        size_t first = b * RETRYIX_CPU_BLOCK;
+        size_t last = first + RETRYIX_CPU_BLOCK < job->count ? first + RETRYIX_CPU_BLOCK : job->count;
+        job->partials[b] = reduce_block(job, job->op, first, last);
+    }
+}
+
+// 區塊掃描（partials 已轉為各區塊的起始偏移）
+static void scan_range(void* arg, size_t begin, size_t end) {
+    retryix_cpu_reduce_job_t* job = (retryix_cpu_reduce_job_t*)arg;
+    for (size_t b = begin; b < end; b++) {
+        size_t first = b * RETRYIX_CPU_BLOCK;
+        size_t last = first + RETRYIX_CPU_BLOCK < job->count ? first + RETRYIX_CPU_BLOCK : job->count;
+        switch (job->type) {
+            case RETRYIX_PRIM_INT: {
+                const cl_int* in = (const cl_int*)job->input;
+                cl_int* out = (cl_int*)job->output;
+                uint32_t running = (uint32_t)job->partials[b].i;
+                for (size_t i = first; i < last; i++) {
+                    uint32_t v = (uint32_t)in[i];
+                    if (job->inclusive) running += v;
+                    out[i] = (cl_int)running;
+                    if (!job->inclusive) running += v;
+                }
+                break;
+            }
+            case RETRYIX_PRIM_FLOAT: {
+                const cl_float* in = (const cl_float*)job->input;
+                cl_float* out = (cl_float*)job->output;
+                cl_float running = job->partials[b].f;
+                for (size_t i = first; i < last; i++) {
+                    cl_float v = in[i];
+                    if (job->inclusive) running += v;
+                    out[i] = running;
+                    if (!job->inclusive) running += v;
+                }
+                break;
+            }
+            default: {
+                const cl_double* in = (const cl_double*)job->input;
+                cl_double* out = (cl_double*)job->output;
+                cl_double running = job->partials[b].d;
+                for (size_t i = first; i < last; i++) {
+                    cl_double v = in[i];
+                    if (job->inclusive) running += v;
+                    out[i] = running;
+                    if (!job->inclusive) running += v;
+                }
+                break;
+            }
+        }
+    }
+}
+
+// === 公開 API ===
+
+int retryix_cpu_device_init(void) {
+    if (g_cpu_context) return 0;
+
+    retryix_cpu_context_t* ctx = (retryix_cpu_context_t*)calloc(1, sizeof(retryix_cpu_context_t));
+    if (!ctx) return -1;
+
+    detect_simd(&ctx->avx, &ctx->avx2);
+    retryix_pool_init(0);
+
+    g_cpu_context = ctx;
+
+    printf("RetryIX CPU Pseudo-Device Initialized\n");
+    printf("  Workers: %d (shared pool) + caller, SIMD: %s\n", retryix_pool_size(),
+           ctx->avx2 ? "AVX2" : (ctx->avx ? "AVX" : "scalar"));
+    return 0;
+}
+
+void retryix_cpu_device_cleanup(void) {
+    retryix_cpu_context_t* ctx = g_cpu_context;
+    if (!ctx) return;
+    free(ctx);
+    g_cpu_context = NULL;
+}
+
+int retryix_cpu_device_active(void) {
+    return g_cpu_context ? 1 : 0;
+}
+
+// 無設備時是否改用 CPU 偽設備（DeviceManager\FallbackToCPU），成功初始化回傳 0
+int retryix_cpu_device_fallback(const char* reason) {
+    if (retryix_config_get_dword("DeviceManager", "FallbackToCPU", 1) == 0) return -1;
+    if (retryix_cpu_device_init() != 0) return -1;
+    printf("%s: using CPU pseudo-device for built-in operations\n", reason ? reason : "No OpenCL device");
+    return 0;
+}
+
+const char* retryix_cpu_op_name(retryix_cpu_op_t op) {
+    if (op < 0 || op >= RETRYIX_CPU_OP_COUNT) return "unknown";
+    return CPU_OP_LABELS[op];
+}
+
+int retryix_cpu_elementwise(retryix_cpu_op_t op, float* out, const float* a, const float* b, float alpha, size_t count) {
+    retryix_cpu_context_t* ctx = g_cpu_context;
+    if (!ctx || !out || !a || count == 0 || op < 0 || op >= RETRYIX_CPU_OP_COUNT) return -1;
+    bool binary = (op == RETRYIX_CPU_OP_ADD || op == RETRYIX_CPU_OP_SUB || op == RETRYIX_CPU_OP_MUL ||
+                   op == RETRYIX_CPU_OP_AXPY);
+    if (binary && !b) return -1;
+
+    retryix_cpu_elementwise_job_t job = { op, out, a, b, alpha, ctx->avx };
+    retryix_pool_parallel_for(count, RETRYIX_CPU_GRAIN, elementwise_range, &job);
+    return 0;
+}
+
+int retryix_cpu_reduce(retryix_prim_type_t type, retryix_prim_op_t op, const void* input, size_t count, void* out_value) {
+    retryix_cpu_context_t* ctx = g_cpu_context;
+    if (!ctx || !input || !out_value || count == 0 || count > RETRYIX_CPU_MAX_COUNT) return -1;
+    if (type < 0 || type >= RETRYIX_PRIM_TYPE_COUNT || op < 0 || op >= RETRYIX_PRIM_OP_COUNT) return -1;
+
+    size_t blocks = (count + RETRYIX_CPU_BLOCK - 1) / RETRYIX_CPU_BLOCK;
+    retryix_cpu_value_t* partials = (retryix_cpu_value_t*)malloc(blocks * sizeof(retryix_cpu_value_t));
+    if (!partials) return -1;
+
+    retryix_cpu_reduce_job_t job = { type, op, input, NULL, count, false, partials, ctx->avx, ctx->avx2 };
+    retryix_pool_parallel_for(blocks, 1, reduce_range, &job);
+
+    retryix_cpu_value_t acc = value_identity(type, op);
+    for (size_t b = 0; b < blocks; b++) acc = value_combine(type, op, acc, partials[b]);
+    memcpy(out_value, &acc, CPU_ELEMENT_SIZES[type]);
+    free(partials);
+    return 0;
+}
+
+// 兩階段：各區塊以 SIMD 求和，序列化掃描區塊總和後各區塊平行展開（input 與 output 可相同）
+int retryix_cpu_scan(retryix_prim_type_t type, const void* input, void* output, size_t count, int inclusive) {
+    retryix_cpu_context_t* ctx = g_cpu_context;
+    if (!ctx || !input || !output || count == 0 || count > RETRYIX_CPU_MAX_COUNT) return -1;
+    if (type < 0 || type >= RETRYIX_PRIM_TYPE_COUNT) return -1;
+
+    size_t blocks = (count + RETRYIX_CPU_BLOCK - 1) / RETRYIX_CPU_BLOCK;
+    retryix_cpu_value_t* partials = (retryix_cpu_value_t*)malloc(blocks * sizeof(retryix_cpu_value_t));
+    if (!partials) return -1;
+
+    retryix_cpu_reduce_job_t job = { type, RETRYIX_PRIM_OP_SUM, input, output, count, inclusive != 0,
+                                     partials, ctx->avx, ctx->avx2 };
+    if (blocks > 1) {
+        retryix_pool_parallel_for(blocks, 1, reduce_range, &job);
+        retryix_cpu_value_t running = value_identity(type, RETRYIX_PRIM_OP_SUM);
+        for (size_t b = 0; b < blocks; b++) {
+            retryix_cpu_value_t sum = partials[b];
+            partials[b] = running;
+            running = value_combine(type, RETRYIX_PRIM_OP_SUM, running, sum);
+        }
+    } else {
+        partials[0] = value_identity(type, RETRYIX_PRIM_OP_SUM);
+    }
+    retryix_pool_parallel_for(blocks, 1, scan_range, &job);
+    free(partials);
+    return 0;
+}
+
+// === 量測 ===
+
+static double best_of(int iterations, const double* samples) {
+    double best = -1.0;
+    for (int i = 0; i < iterations; i++) {
+        if (samples[i] > 0.0 && (best < 0.0 || samples[i] < best)) best = samples[i];
+    }
+    return best;
+}
+
+static int run_cpu_benchmark(retryix_cpu_context_t* ctx, size_t count, int iterations, float* a, float* b,
+                             float* out, cl_int* ints, cl_int* int_out, double* samples) {
+    int failures = 0;
+    uint32_t seed = 3u;
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        a[i] = (float)(seed >> 8) / (float)(1u << 24);
+        b[i] = (float)(i % 1024) * 0.5f;
+        ints[i] = (cl_int)((seed >> 8) % 2001) - 1000;
+    }
+
+    printf("\n=== RetryIX CPU Pseudo-Device Benchmark (%zu elements, %d workers, %s) ===\n", count,
+           retryix_pool_size(), ctx->avx2 ? "AVX2" : (ctx->avx ? "AVX" : "scalar"));
+
+    // 參考頻寬：單執行緒 memcpy（讀 + 寫）
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        memcpy(out, a, count * sizeof(float));
+        samples[it] = rixNowMs() - t0;
+    }
+    double copy_ms = best_of(iterations, samples);
+    double copy_gb = copy_ms > 0.0 ? 2.0 * count * sizeof(float) / (copy_ms * 1e6) : 0.0;
+    printf("  %-12s %8.3f ms  %7.2f GB/s (memcpy reference)\n", "copy", copy_ms, copy_gb);
+
+    static const retryix_cpu_op_t ops[] = { RETRYIX_CPU_OP_INCREMENT, RETRYIX_CPU_OP_ADD, RETRYIX_CPU_OP_AXPY };
+    for (size_t k = 0; k < sizeof(ops) / sizeof(ops[0]); k++) {
+        retryix_cpu_op_t op = ops[k];
+        for (int it = 0; it < iterations; it++) {
+            double t0 = rixNowMs();
+            samples[it] = (retryix_cpu_elementwise(op, out, a, b, 2.0f, count) == 0) ? rixNowMs() - t0 : -1.0;
+        }
+        double ms = best_of(iterations, samples);
+        size_t streams = (op == RETRYIX_CPU_OP_INCREMENT) ? 2 : 3;
+        size_t mismatches = 0;
+        for (size_t i = 0; i < count; i++) {
+            float expected = (op == RETRYIX_CPU_OP_INCREMENT) ? a[i] + 1.0f
+                           : (op == RETRYIX_CPU_OP_ADD) ? a[i] + b[i] : 2.0f * a[i] + b[i];
+            if (out[i] != expected) mismatches++;
+        }
+        if (ms < 0.0 || mismatches) failures++;
+        double gb = ms > 0.0 ? (double)streams * count * sizeof(float) / (ms * 1e6) : 0.0;
+        printf("  %-12s %8.3f ms  %7.2f GB/s (%3.0f%% of copy)  %s\n", retryix_cpu_op_name(op), ms, gb,
+               copy_gb > 0.0 ? 100.0 * gb / copy_gb : 0.0, mismatches ? "FAIL" : "PASS");
+    }
+
+    // 歸約與掃描：與多執行緒純量基準（retryix_prim_cpu_*）比較
+    cl_int int_sum = 0, int_ref = 0;
+    float float_max = 0.0f, float_ref = 0.0f;
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        samples[it] = (retryix_cpu_reduce(RETRYIX_PRIM_INT, RETRYIX_PRIM_OP_SUM, ints, count, &int_sum) == 0) ? rixNowMs() - t0 : -1.0;
+    }
+    double reduce_ms = best_of(iterations, samples);
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        samples[it] = (retryix_prim_cpu_reduce(RETRYIX_PRIM_INT, RETRYIX_PRIM_OP_SUM, ints, count, &int_ref) == 0) ? rixNowMs() - t0 : -1.0;
+    }
+    double reduce_ref_ms = best_of(iterations, samples);
+    bool reduce_ok = (int_sum == int_ref);
+    reduce_ok = reduce_ok && retryix_cpu_reduce(RETRYIX_PRIM_FLOAT, RETRYIX_PRIM_OP_MAX, a, count, &float_max) == 0 &&
+                retryix_prim_cpu_reduce(RETRYIX_PRIM_FLOAT, RETRYIX_PRIM_OP_MAX, a, count, &float_ref) == 0 &&
+                float_max == float_ref;
+    if (!reduce_ok) failures++;
+    printf("  %-12s %8.3f ms  %7.2f GB/s  baseline %8.3f ms  %s\n", "reduce(int)", reduce_ms,
+           reduce_ms > 0.0 ? count * sizeof(cl_int) / (reduce_ms * 1e6) : 0.0, reduce_ref_ms, reduce_ok ? "PASS" : "FAIL");
+
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        samples[it] = (retryix_cpu_scan(RETRYIX_PRIM_INT, ints, int_out, count, 0) == 0) ? rixNowMs() - t0 : -1.0;
+    }
+    double scan_ms = best_of(iterations, samples);
+    size_t scan_mismatches = 0;
+    uint32_t running = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (int_out[i] != (cl_int)running) scan_mismatches++;
+        running += (uint32_t)ints[i];
+    }
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        samples[it] = (retryix_prim_cpu_scan(RETRYIX_PRIM_INT, ints, int_out, count, 0) == 0) ? rixNowMs() - t0 : -1.0;
+    }
+    double scan_ref_ms = best_of(iterations, samples);
+    if (scan_mismatches) failures++;
+    printf("  %-12s %8.3f ms  %7.2f GB/s  baseline %8.3f ms  %s\n", "scan(int)", scan_ms,
+           scan_ms > 0.0 ? 2.0 * count * sizeof(cl_int) / (scan_ms * 1e6) : 0.0, scan_ref_ms,
+           scan_mismatches ? "FAIL" : "PASS");
+
+    retryix_pool_print_stats();
+    printf("=====================================================\n\n");
+    return failures;
+}
+
+int retryix_cpu_device_benchmark(size_t count, int iterations) {
+    retryix_cpu_context_t* ctx = g_cpu_context;
+    if (!ctx || count == 0 || count > RETRYIX_CPU_MAX_COUNT) return -1;
+    if (iterations <= 0) iterations = 5;
+    retryix_pool_reset_stats();
+
+    float* a = (float*)malloc(count * sizeof(float));
+    float* b = (float*)malloc(count * sizeof(float));
+    float* out = (float*)malloc(count * sizeof(float));
+    cl_int* ints = (cl_int*)malloc(count * sizeof(cl_int));
+    cl_int* int_out = (cl_int*)malloc(count * sizeof(cl_int));
+    double* samples = (double*)malloc((size_t)iterations * sizeof(double));
+
+    int failures = 1;
+    if (a && b && out && ints && int_out && samples) {
+        failures = run_cpu_benchmark(ctx, count, iterations, a, b, out, ints, int_out, samples);
+    }
+
+    free(samples);
+    free(int_out);
+    free(ints);
+    free(out);
+    free(b);
+    free(a);
+    return failures ? -1 : 0;
+}
@@ -0,0 +1,663 @@
+// retryix_graph.c - RetryIX 任務圖（DAG）執行引擎
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RETRYIX_GRAPH_MAX_QUEUES 4          // 不支援亂序佇列時使用的循序佇列數
+
+// 節點類型
+typedef enum {
+    RETRYIX_GRAPH_NODE_WRITE = 0,           // 主機 -> 設備
+    RETRYIX_GRAPH_NODE_READ,                // 設備 -> 主機
+    RETRYIX_GRAPH_NODE_COPY,                // 設備 -> 設備
+    RETRYIX_GRAPH_NODE_KERNEL,              // 內核啟動
+    RETRYIX_GRAPH_NODE_HOST                 // 主機回呼
+} retryix_graph_node_type_t;
+
+static const char* NODE_TYPE_LABELS[] = { "write", "read", "copy", "kernel", "host" };
+
+// 節點的緩衝區存取宣告
+typedef struct {
+    cl_mem buffer;
+    bool is_write;
+} retryix_graph_access_t;
+
+// 內核參數副本（提交時重新設定，同一 cl_kernel 可用於多個節點）
+typedef struct {
+    size_t size;
+    void* value;                            // NULL 表示 __local 記憶體
+} retryix_graph_arg_t;
+
+typedef struct {
+    retryix_graph_node_type_t type;
+    char label[64];
+
+    // 傳輸
+    cl_mem buffer;
+    cl_mem src_buffer;
+    size_t offset;
+    size_t src_offset;
+    size_t size;
+    void* host_ptr;
+
+    // 內核
+    cl_kernel kernel;
+    cl_uint work_dim;
+    size_t global[3];
+    size_t local[3];
+    bool has_local;
+    retryix_graph_arg_t* args;
+    cl_uint arg_count;
+
+    // 主機回呼
+    retryix_graph_host_fn host_fn;
+    void* user_data;
+
+    // 相依關係
+    retryix_graph_access_t* accesses;
+    size_t access_count;
+    size_t access_capacity;
+    int* explicit_deps;
+    size_t explicit_count;
+    size_t explicit_capacity;
+    int* deps;                              // 推導後的相依節點（含明確相依）
+    size_t dep_count;
+    size_t dep_capacity;
+
+    // 執行狀態
+    cl_uint queue_index;
+    bool queue_continued;                   // 已有後繼節點沿用此佇列
+    cl_event event;
+    cl_event marker;
+    double host_start_ms;
+    double host_end_ms;
+    double duration_ms;
+    double path_ms;                         // 以此節點結尾的最長路徑
+    int critical_prev;
+} retryix_graph_node_t;
+
+struct retryix_graph {
+    cl_context context;
+    cl_device_id device;
+    cl_command_queue queues[RETRYIX_GRAPH_MAX_QUEUES];
+    cl_uint queue_count;
+    bool out_of_order;
+
+    retryix_graph_node_t* nodes;
+    size_t node_count;
+    size_t node_capacity;
+
+    bool edges_dirty;
+    bool in_flight;
+    cl_event* wait_scratch;
+
+    // 統計
+    uint64_t submit_count;
+    double submit_start_ms;
+    double wall_ms;
+    double critical_ms;
+    double serial_ms;
+    int critical_tail;
+};
+
+// === 內部函數 ===
+
+static int grow_array(void** array, size_t* capacity, size_t needed, size_t elem_size) {
+    if (needed <= *capacity) return 0;
+    size_t new_capacity = *capacity ? *capacity * 2 : 8;
+    while (new_capacity < needed) new_capacity *= 2;
+    void* grown = realloc(*array, new_capacity * elem_size);
+    if (!grown) return -1;
+    *array = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+static retryix_graph_node_t* new_node(retryix_graph_t* graph, retryix_graph_node_type_t type, int* out_index) {
+    if (graph->in_flight) {
+        printf("Graph is executing; wait before adding nodes\n");
+        return NULL;
+    }
+    if (grow_array((void**)&graph->nodes, &graph->node_capacity, graph->node_count + 1,
+                   sizeof(retryix_graph_node_t)) != 0) {
+        return NULL;
+    }
+
+    int index = (int)graph->node_count++;
+    retryix_graph_node_t* node = &graph->nodes[index];
+    memset(node, 0, sizeof(*node));
+    node->type = type;
+    node->critical_prev = -1;
+    snprintf(node->label, sizeof(node->label), "%s#%d", NODE_TYPE_LABELS[type], index);
+
+    graph->edges_dirty = true;
+    *out_index = index;
+    return node;
+}
+
+static retryix_graph_node_t* get_node(retryix_graph_t* graph, int index) {
+    if (!graph || index < 0 || (size_t)index >= graph->node_count) return NULL;
+    return &graph->nodes[index];
+}
+
+static int add_access(retryix_graph_t* graph, int index, cl_mem buffer, bool is_write) {
+    retryix_graph_node_t* node = get_node(graph, index);
+    if (!node || !buffer || graph->in_flight) return -1;
+    if (grow_array((void**)&node->accesses, &node->access_capacity, node->access_count + 1,
+                   sizeof(retryix_graph_access_t)) != 0) {
+        return -1;
+    }
+    node->accesses[node->access_count].buffer = buffer;
+    node->accesses[node->access_count].is_write = is_write;
+    node->access_count++;
+    graph->edges_dirty = true;
+    return 0;
+}
+
+static int add_dep(retryix_graph_node_t* node, int dep) {
+    for (size_t i = 0; i < node->dep_count; i++) {
+        if (node->deps[i] == dep) return 0;
+    }
+    if (grow_array((void**)&node->deps, &node->dep_capacity, node->dep_count + 1, sizeof(int)) != 0) return -1;
+    node->deps[node->dep_count++] = dep;
+    return 0;
+}
+
+// 每個緩衝區的存取狀態（推導 RAW/WAR/WAW 邊）
+typedef struct {
+    cl_mem buffer;
+    int last_writer;
+    int* readers;
+    size_t reader_count;
+    size_t reader_capacity;
+} retryix_graph_buffer_state_t;
+
+// 依節點插入順序與緩衝區存取推導相依邊，並分配佇列
+static int derive_edges(retryix_graph_t* graph) {
+    retryix_graph_buffer_state_t* states = NULL;
+    size_t state_count = 0, state_capacity = 0;
+    int rc = 0;
+
+    for (size_t i = 0; i < graph->node_count && rc == 0; i++) {
+        retryix_graph_node_t* node = &graph->nodes[i];
+        node->dep_count = 0;
+
+        for (size_t e = 0; e < node->explicit_count && rc == 0; e++) {
+            rc = add_dep(node, node->explicit_deps[e]);
+        }
+
+        // 先處理讀取，再處理寫入（同一節點可同時讀寫同一緩衝區）
+        for (int pass = 0; pass < 2 && rc == 0; pass++) {
+            for (size_t a = 0; a < node->access_count && rc == 0; a++) {
+                retryix_graph_access_t* access = &node->accesses[a];
+                if (access->is_write != (pass == 1)) continue;
+
+                retryix_graph_buffer_state_t* state = NULL;
+                for (size_t s = 0; s < state_count; s++) {
+                    if (states[s].buffer == access->buffer) {
+                        state = &states[s];
+                        break;
+                    }
+                }
+                if (!state) {
+                    if (grow_array((void**)&states, &state_capacity, state_count + 1,
+                                   sizeof(retryix_graph_buffer_state_t)) != 0) {
+                        rc = -1;
+                        break;
+                    }
+                    state = &states[state_count++];
+                    memset(state, 0, sizeof(*state));
+                    state->buffer = access->buffer;
+                    state->last_writer = -1;
+                }
+
+                // RAW / WAW：等待上一個寫入者
+                if (state->last_writer >= 0 && state->last_writer != (int)i) {
+                    rc = add_dep(node, state->last_writer);
+                }
+
+                if (!access->is_write) {
+                    // 讀取者清單無法擴充時不可略過，否則之後的寫入者會漏掉 WAR 相依
+                    if (rc == 0 && grow_array((void**)&state->readers, &state->reader_capacity,
+                                              state->reader_count + 1, sizeof(int)) != 0) {
+                        rc = -1;
+                    }
+                    if (rc == 0) state->readers[state->reader_count++] = (int)i;
+                } else {
+                    // WAR：等待上次寫入後的所有讀取者
+                    for (size_t r = 0; r < state->reader_count && rc == 0; r++) {
+                        if (state->readers[r] != (int)i) rc = add_dep(node, state->readers[r]);
+                    }
+                    state->last_writer = (int)i;
+                    state->reader_count = 0;
+                }
+            }
+        }
+
+        // 佇列分配：亂序佇列全部使用同一佇列；否則沿用第一個尚未被接續的前驅佇列，
+        // 讓同一分支留在同一循序佇列，獨立分支分散到其他佇列
+        node->queue_continued = false;
+        node->queue_index = 0;
+        if (!graph->out_of_order) {
+            bool assigned = false;
+            for (size_t d = 0; d < node->dep_count; d++) {
+                retryix_graph_node_t* dep = &graph->nodes[node->deps[d]];
+                if (!dep->queue_continued) {
+                    dep->queue_continued = true;
+                    node->queue_index = dep->queue_index;
+                    assigned = true;
+                    break;
+                }
+            }
+            if (!assigned) node->queue_index = (cl_uint)(i % graph->queue_count);
+        }
+    }
+
+    size_t max_deps = 0;
+    for (size_t i = 0; i < graph->node_count; i++) {
+        if (graph->nodes[i].dep_count > max_deps) max_deps = graph->nodes[i].dep_count;
+    }
+    free(graph->wait_scratch);
+    graph->wait_scratch = (cl_event*)malloc((max_deps ? max_deps : 1) * sizeof(cl_event));
+    if (!graph->wait_scratch) rc = -1;
+
+    for (size_t s = 0; s < state_count; s++) free(states[s].readers);
+    free(states);
+
+    if (rc == 0) graph->edges_dirty = false;
+    return rc;
+}
+
+static void release_node_events(retryix_graph_node_t* node) {
+    if (node->event) clReleaseEvent(node->event);
+    if (node->marker) clReleaseEvent(node->marker);
+    node->event = NULL;
+    node->marker = NULL;
+}
+
+static void host_node_run(void* arg) {
+    retryix_graph_node_t* node = (retryix_graph_node_t*)arg;
+    node->host_start_ms = rixNowMs();
+    node->host_fn(node->user_data);
+    node->host_end_ms = rixNowMs();
+    clSetUserEventStatus(node->event, CL_COMPLETE);
+}
+
+// 前驅完成後將主機回呼交給共用執行緒池，不佔用驅動的回呼執行緒；完成後設定節點的使用者事件
+static void CL_CALLBACK host_node_callback(cl_event event, cl_int status, void* user_data) {
+    retryix_graph_node_t* node = (retryix_graph_node_t*)user_data;
+    (void)event;
+
+    if (status != CL_COMPLETE) {
+        clSetUserEventStatus(node->event, status < 0 ? status : CL_INVALID_EVENT);
+        return;
+    }
+    if (retryix_pool_submit(host_node_run, node) != 0) {
+        host_node_run(node); // 無法交給執行緒池時於回呼執行緒直接執行，避免使用者事件永不完成
+    }
+}
+
+static cl_int enqueue_node(retryix_graph_t* graph, retryix_graph_node_t* node) {
+    cl_command_queue queue = graph->queues[node->queue_index];
+    cl_uint wait_count = (cl_uint)node->dep_count;
+    cl_event* waits = graph->wait_scratch;
+    for (size_t d = 0; d < node->dep_count; d++) {
+        waits[d] = graph->nodes[node->deps[d]].event;
+    }
+    const cl_event* wait_list = wait_count ? waits : NULL;
+
+    switch (node->type) {
+    case RETRYIX_GRAPH_NODE_WRITE:
+        return clEnqueueWriteBuffer(queue, node->buffer, CL_FALSE, node->offset, node->size, node->host_ptr,
+                                    wait_count, wait_list, &node->event);
+    case RETRYIX_GRAPH_NODE_READ:
+        return clEnqueueReadBuffer(queue, node->buffer, CL_FALSE, node->offset, node->size, node->host_ptr,
+                                   wait_count, wait_list, &node->event);
+    case RETRYIX_GRAPH_NODE_COPY:
+        return clEnqueueCopyBuffer(queue, node->src_buffer, node->buffer, node->src_offset, node->offset,
+                                   node->size, wait_count, wait_list, &node->event);
+    case RETRYIX_GRAPH_NODE_KERNEL:
+        for (cl_uint a = 0; a < node->arg_count; a++) {
+            cl_int err = clSetKernelArg(node->kernel, a, node->args[a].size, node->args[a].value);
+            if (err != CL_SUCCESS) return err;
+        }
+        return clEnqueueNDRangeKernel(queue, node->kernel, node->work_dim, NULL, node->global,
+                                      node->has_local ? node->local : NULL, wait_count, wait_list, &node->event);
+    case RETRYIX_GRAPH_NODE_HOST: {
+        cl_int err;
+        node->event = clCreateUserEvent(graph->context, &err);
+        if (err != CL_SUCCESS) return err;
+
+        // 無前驅時直接執行
+        if (wait_count == 0) {
+            node->host_start_ms = rixNowMs();
+            node->host_fn(node->user_data);
+            node->host_end_ms = rixNowMs();
+            return clSetUserEventStatus(node->event, CL_COMPLETE);
+        }
+
+        err = rixEnqueueMarkerWaitList(queue, wait_count, wait_list, &node->marker);
+        if (err != CL_SUCCESS) {
+            clSetUserEventStatus(node->event, err);
+            return err;
+        }
+        return clSetEventCallback(node->marker, CL_COMPLETE, host_node_callback, node);
+    }
+    }
+    return CL_INVALID_VALUE;
+}
+
+// 收集節點耗時並計算關鍵路徑
+static void compute_timings(retryix_graph_t* graph) {
+    graph->critical_ms = 0.0;
+    graph->serial_ms = 0.0;
+    graph->critical_tail = -1;
+
+    for (size_t i = 0; i < graph->node_count; i++) {
+        retryix_graph_node_t* node = &graph->nodes[i];
+        if (node->type == RETRYIX_GRAPH_NODE_HOST) {
+            node->duration_ms = node->host_end_ms - node->host_start_ms;
+        } else {
+            double ms = rixEventElapsedMs(node->event);
+            node->duration_ms = ms > 0.0 ? ms : 0.0;
+        }
+        graph->serial_ms += node->duration_ms;
+
+        // 節點依插入順序排列，前驅必在前面
+        node->path_ms = node->duration_ms;
+        node->critical_prev = -1;
+        for (size_t d = 0; d < node->dep_count; d++) {
+            retryix_graph_node_t* dep = &graph->nodes[node->deps[d]];
+            if (dep->path_ms + node->duration_ms > node->path_ms) {
+                node->path_ms = dep->path_ms + node->duration_ms;
+                node->critical_prev = node->deps[d];
+            }
+        }
+        if (node->path_ms > graph->critical_ms || graph->critical_tail < 0) {
+            graph->critical_ms = node->path_ms;
+            graph->critical_tail = (int)i;
+        }
+    }
+}
+
+// === 公開 API ===
+
+// 建立任務圖（支援時使用亂序佇列，否則使用多個循序佇列）
+retryix_graph_t* retryix_graph_create(cl_context context, cl_device_id device) {
+    if (!context || !device) return NULL;
+
+    retryix_graph_t* graph = (retryix_graph_t*)calloc(1, sizeof(retryix_graph_t));
+    if (!graph) return NULL;
+
+    graph->context = context;
+    graph->device = device;
+    graph->critical_tail = -1;
+
+    cl_command_queue_properties supported = 0;
+    clGetDeviceInfo(device, CL_DEVICE_QUEUE_PROPERTIES, sizeof(supported), &supported, NULL);
+
+    cl_int err = CL_INVALID_VALUE;
+    if (supported & CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE) {
+        graph->queues[0] = rixCreateQueueWithFlags(context, device,
+                                                   CL_QUEUE_PROFILING_ENABLE | CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE, &err);
+    }
+    if (err == CL_SUCCESS) {
+        graph->queue_count = 1;
+        graph->out_of_order = true;
+    } else {
+        for (cl_uint q = 0; q < RETRYIX_GRAPH_MAX_QUEUES; q++) {
+            graph->queues[q] = rixCreateProfilingQueue(context, device, &err);
+            if (err != CL_SUCCESS) break;
+            graph->queue_count++;
+        }
+        if (graph->queue_count == 0) {
+            printf("Failed to create graph queues: %s\n", rixCLErrorName(err));
+            free(graph);
+            return NULL;
+        }
+    }
+
+    printf("RetryIX Task Graph created (%s, %u queue%s)\n", graph->out_of_order ? "out-of-order" : "in-order",
+           graph->queue_count, graph->queue_count > 1 ? "s" : "");
+    return graph;
+}
+
+// 主機 -> 設備傳輸（host_ptr 須在提交完成前保持有效）
+int retryix_graph_add_write(retryix_graph_t* graph, cl_mem buffer, size_t offset, size_t size, const void* host_ptr) {
+    if (!graph || !buffer || !host_ptr || size == 0) return -1;
+    int index;
+    retryix_graph_node_t* node = new_node(graph, RETRYIX_GRAPH_NODE_WRITE, &index);
+    if (!node) return -1;
+    node->buffer = buffer;
+    node->offset = offset;
+    node->size = size;
+    node->host_ptr = (void*)host_ptr;
+    return add_access(graph, index, buffer, true) == 0 ? index : -1;
+}
+
+// 設備 -> 主機傳輸
+int retryix_graph_add_read(retryix_graph_t* graph, cl_mem buffer, size_t offset, size_t size, void* host_ptr) {
+    if (!graph || !buffer || !host_ptr || size == 0) return -1;
+    int index;
+    retryix_graph_node_t* node = new_node(graph, RETRYIX_GRAPH_NODE_READ, &index);
+    if (!node) return -1;
+    node->buffer = buffer;
+    node->offset = offset;
+    node->size = size;
+    node->host_ptr = host_ptr;
+    return add_access(graph, index, buffer, false) == 0 ? index : -1;
+}
+
+// 設備 -> 設備拷貝
+int retryix_graph_add_copy(retryix_graph_t* graph, cl_mem src, size_t src_offset,
+                           cl_mem dst, size_t dst_offset, size_t size) {
+    if (!graph || !src || !dst || size == 0) return -1;
+    int index;
+    retryix_graph_node_t* node = new_node(graph, RETRYIX_GRAPH_NODE_COPY, &index);
+    if (!node) return -1;
+    node->src_buffer = src;
+    node->src_offset = src_offset;
+    node->buffer = dst;
+    node->offset = dst_offset;
+    node->size = size;
+    if (add_access(graph, index, src, false) != 0 || add_access(graph, index, dst, true) != 0) return -1;
+    return index;
+}
+
+// 內核啟動；參數以 retryix_graph_set_arg 設定，緩衝區存取以 retryix_graph_reads/writes 宣告
+int retryix_graph_add_kernel(retryix_graph_t* graph, cl_kernel kernel, cl_uint work_dim,
+                             const size_t* global_work_size, const size_t* local_work_size) {
+    if (!graph || !kernel || !global_work_size || work_dim == 0 || work_dim > 3) return -1;
+
+    cl_uint num_args = 0;
+    if (clGetKernelInfo(kernel, CL_KERNEL_NUM_ARGS, sizeof(num_args), &num_args, NULL) != CL_SUCCESS) return -1;
+
+    int index;
+    retryix_graph_node_t* node = new_node(graph, RETRYIX_GRAPH_NODE_KERNEL, &index);
+    if (!node) return -1;
+
+    node->kernel = kernel;
+    node->work_dim = work_dim;
+    for (cl_uint d = 0; d < work_dim; d++) {
+        node->global[d] = global_work_size[d];
+        node->local[d] = local_work_size ? local_work_size[d] : 0;
+    }
+    node->has_local = (local_work_size != NULL);
+
+    if (num_args > 0) {
+        node->args = (retryix_graph_arg_t*)calloc(num_args, sizeof(retryix_graph_arg_t));
+        if (!node->args) return -1;
+        node->arg_count = num_args;
+    }
+
+    char name[48] = {0};
+    if (clGetKernelInfo(kernel, CL_KERNEL_FUNCTION_NAME, sizeof(name) - 1, name, NULL) == CL_SUCCESS && name[0]) {
+        snprintf(node->label, sizeof(node->label), "%s#%d", name, index);
+    }
+    return index;
+}
+
+// 設定內核節點參數（值會被複製；value 為 NULL 表示 __local 記憶體）
+int retryix_graph_set_arg(retryix_graph_t* graph, int node_index, cl_uint arg_index, size_t size, const void* value) {
+    retryix_graph_node_t* node = get_node(graph, node_index);
+    if (!node || node->type != RETRYIX_GRAPH_NODE_KERNEL || arg_index >= node->arg_count) return -1;
+
+    retryix_graph_arg_t* arg = &node->args[arg_index];
+    void* copy = NULL;
+    if (value) {
+        copy = malloc(size);
+        if (!copy) return -1;
+        memcpy(copy, value, size);
+    }
+    free(arg->value);
+    arg->value = copy;
+    arg->size = size;
+    return 0;
+}
+
+// 宣告節點讀取/寫入的緩衝區
+int retryix_graph_reads(retryix_graph_t* graph, int node_index, cl_mem buffer) {
+    return add_access(graph, node_index, buffer, false);
+}
+
+int retryix_graph_writes(retryix_graph_t* graph, int node_index, cl_mem buffer) {
+    return add_access(graph, node_index, buffer, true);
+}
+
+// 主機回呼：於所有前驅完成後交由共用執行緒池執行
+int retryix_graph_add_host(retryix_graph_t* graph, retryix_graph_host_fn fn, void* user_data) {
+    if (!graph || !fn) return -1;
+    int index;
+    retryix_graph_node_t* node = new_node(graph, RETRYIX_GRAPH_NODE_HOST, &index);
+    if (!node) return -1;
+    node->host_fn = fn;
+    node->user_data = user_data;
+    return index;
+}
+
+// 明確相依（from 必須先於 to 加入，確保圖無環）
+int retryix_graph_add_dependency(retryix_graph_t* graph, int from, int to) {
+    retryix_graph_node_t* node = get_node(graph, to);
+    if (!node || !get_node(graph, from) || from >= to || graph->in_flight) return -1;
+    if (grow_array((void**)&node->explicit_deps, &node->explicit_capacity, node->explicit_count + 1,
+                   sizeof(int)) != 0) {
+        return -1;
+    }
+    node->explicit_deps[node->explicit_count++] = from;
+    graph->edges_dirty = true;
+    return 0;
+}
+
+// 提交整張圖（非阻塞）；可重複提交，上一次提交未完成時會先等待
+int retryix_graph_submit(retryix_graph_t* graph) {
+    if (!graph || graph->node_count == 0) return -1;
+    if (graph->in_flight) retryix_graph_wait(graph);
+    if (graph->edges_dirty && derive_edges(graph) != 0) return -1;
+
+    for (size_t i = 0; i < graph->node_count; i++) {
+        release_node_events(&graph->nodes[i]);
+    }
+
+    graph->submit_start_ms = rixNowMs();
+    for (size_t i = 0; i < graph->node_count; i++) {
+        retryix_graph_node_t* node = &graph->nodes[i];
+        cl_int err = enqueue_node(graph, node);
+        if (err != CL_SUCCESS) {
+            printf("Graph node %s failed to enqueue: %s\n", node->label, rixCLErrorName(err));
+            // 等待已排入的工作（含主機回呼）結束後回報失敗
+            graph->in_flight = true;
+            retryix_graph_wait(graph);
+            return -1;
+        }
+    }
+
+    for (cl_uint q = 0; q < graph->queue_count; q++) clFlush(graph->queues[q]);
+    graph->in_flight = true;
+    graph->submit_count++;
+    return 0;
+}
+
+// 等待最近一次提交完成並更新時間統計
+int retryix_graph_wait(retryix_graph_t* graph) {
+    if (!graph) return -1;
+    if (!graph->in_flight) return 0;
+
+    int rc = 0;
+    for (size_t i = 0; i < graph->node_count; i++) {
+        retryix_graph_node_t* node = &graph->nodes[i];
+        if (node->event && clWaitForEvents(1, &node->event) != CL_SUCCESS) {
+            printf("Graph node %s failed\n", node->label);
+            rc = -1;
+        }
+    }
+    graph->wall_ms = rixNowMs() - graph->submit_start_ms;
+    graph->in_flight = false;
+
+    compute_timings(graph);
+    return rc;
+}
+
+// 關鍵路徑耗時（毫秒），需先完成一次 submit + wait
+double retryix_graph_critical_path_ms(retryix_graph_t* graph) {
+    return graph ? graph->critical_ms : 0.0;
+}
+
+// 時間報告：關鍵路徑、序列總和與實際牆鐘時間
+void retryix_graph_print_timing(retryix_graph_t* graph) {
+    if (!graph) return;
+
+    printf("\n=== RetryIX Task Graph Timing ===\n");
+    printf("Nodes: %zu, Submissions: %llu, Queues: %u (%s)\n", graph->node_count,
+           (unsigned long long)graph->submit_count, graph->queue_count,
+           graph->out_of_order ? "out-of-order" : "in-order");
+    printf("Wall Time: %.3f ms\n", graph->wall_ms);
+    printf("Serial Sum: %.3f ms\n", graph->serial_ms);
+    printf("Critical Path: %.3f ms\n", graph->critical_ms);
+    if (graph->wall_ms > 0.0) {
+        printf("Overlap: %.2fx (serial sum / wall time)\n", graph->serial_ms / graph->wall_ms);
+    }
+
+    // 由尾端回溯關鍵路徑
+    int path[64];
+    int length = 0;
+    for (int n = graph->critical_tail; n >= 0 && length < 64; n = graph->nodes[n].critical_prev) {
+        path[length++] = n;
+    }
+    printf("Critical Path Nodes:\n");
+    for (int i = length - 1; i >= 0; i--) {
+        retryix_graph_node_t* node = &graph->nodes[path[i]];
+        printf("  %-24s %.4f ms (queue %u)\n", node->label, node->duration_ms, node->queue_index);
+    }
+    printf("=================================\n\n");
+}
+
+// 釋放任務圖
+void retryix_graph_destroy(retryix_graph_t* graph) {
+    if (!graph) return;
+
+    retryix_graph_wait(graph);
+
+    for (size_t i = 0; i < graph->node_count; i++) {
+        retryix_graph_node_t* node = &graph->nodes[i];
+        release_node_events(node);
+        for (cl_uint a = 0; a < node->arg_count; a++) free(node->args[a].value);
+        free(node->args);
+        free(node->accesses);
+        free(node->explicit_deps);
+        free(node->deps);
+    }
+    free(graph->nodes);
+    free(graph->wait_scratch);
+
+    for (cl_uint q = 0; q < graph->queue_count; q++) {
+        clReleaseCommandQueue(graph->queues[q]);
+    }
+    free(graph);
+}
@@ -0,0 +1,639 @@
+// retryix_half.c - RetryIX 半精度儲存模式（設備端 IEEE half，主機端 float32 經 SIMD 轉換與 pinned 暫存區傳輸）
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// F16C 路徑：GCC / Clang 以 target 屬性單獨啟用指令集，執行期以 CPUID 確認
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #include <cpuid.h>
+  #include <immintrin.h>
+  #define RETRYIX_F16C_PATH 1
+  #define RETRYIX_F16C_TARGET __attribute__((target("avx,f16c")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  #include <intrin.h>
+  #include <immintrin.h>
+  #define RETRYIX_F16C_PATH 1
+  #define RETRYIX_F16C_TARGET
+#endif
+
+#define RETRYIX_HALF_TEMPLATE       "retryix_half"
+#define RETRYIX_HALF_MAX_LOCAL      256
+#define RETRYIX_HALF_STAGING_SLOTS  2
+#define RETRYIX_HALF_CONVERT_GRAIN  32768   // 每個池任務的轉換元素數
+
+// 半精度儲存內核：以 UNIVERSAL_VENDOR_TEMPLATE 的 RETRYIX_HALF_LOAD / STORE 存取，
+// 支援 cl_khr_fp16 時以 half 計算，否則經 vload_half / vstore_half 以 float 計算
+static const char* HALF_SOURCE =
+"__kernel void retryix_half_scale(__global half* data, uint n, float alpha) {\n"
+"    uint i = get_global_id(0);\n"
+"    if (i * 4 + 3 < n) {\n"
+"        RETRYIX_HALF4 v = RETRYIX_HALF_LOAD4(i, data);\n"
+"        RETRYIX_HALF_STORE4(v * (RETRYIX_HALF)alpha, i, data);\n"
+"    } else {\n"
+"        for (uint j = i * 4; j < n; j++) {\n"
+"            RETRYIX_HALF v = RETRYIX_HALF_LOAD(j, data);\n"
+"            RETRYIX_HALF_STORE(v * (RETRYIX_HALF)alpha, j, data);\n"
+"        }\n"
+"    }\n"
+"}\n";
+
+// 半精度配置紀錄
+typedef struct {
+    void* ptr;
+    size_t count;
+} retryix_half_record_t;
+
+typedef struct {
+    cl_context context;
+    cl_device_id device;
+    cl_command_queue queue;
+    bool device_fp16;                       // cl_khr_fp16：設備端以 half 計算
+    bool f16c;                              // 主機端 F16C 轉換可用
+    size_t local_size;
+    bool prepared;
+
+    // pinned 暫存區：轉換與 DMA 以兩個槽交替重疊
+    size_t staging_count;                   // 每個槽可容納的 half 數
+    cl_mem staging_mem[RETRYIX_HALF_STAGING_SLOTS];
+    cl_half* staging_ptr[RETRYIX_HALF_STAGING_SLOTS];
+    cl_event staging_event[RETRYIX_HALF_STAGING_SLOTS];
+    int next_slot;
+
+    retryix_half_record_t* records;
+    size_t record_count;
+    size_t record_capacity;
+
+    uint64_t uploaded_elements;
+    uint64_t downloaded_elements;
+} retryix_half_context_t;
+
+static retryix_half_context_t* g_half_context = NULL;
+
+static size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// === 主機端轉換 ===
+
+// float32 -> half，最近偶數捨入；處理次正規、溢位與 NaN（保留高位 payload 並設為 quiet）
+static cl_half float_to_half(float value) {
+    uint32_t x;
+    memcpy(&x, &value, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000u;
+    uint32_t abs = x & 0x7FFFFFFFu;
+
+    if (abs >= 0x7F800000u) {
+        return (cl_half)(sign | 0x7C00u | (abs > 0x7F800000u ? 0x200u | ((abs >> 13) & 0x3FFu) : 0u));
+    }
+    if (abs >= 0x477FF000u) return (cl_half)(sign | 0x7C00u);     // 捨入後超過 65504
+    if (abs < 0x38800000u) {                                      // half 次正規或零
+        if (abs < 0x33000000u) return (cl_half)sign;              // <= 2^-25 捨入為零
+        uint32_t exponent = abs >> 23;
+        uint32_t mantissa = (abs & 0x7FFFFFu) | 0x800000u;
+        uint32_t shift = 126 - exponent;
+        uint32_t h = mantissa >> shift;
+        uint32_t rem = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rem > halfway || (rem == halfway && (h & 1u))) h++;
+        return (cl_half)(sign | h);
+    }
+    uint32_t h = (abs - 0x38000000u) >> 13;
+    uint32_t rem = abs & 0x1FFFu;
+    if (rem > 0x1000u || (rem == 0x1000u && (h & 1u))) h++;
+    return (cl_half)(sign | h);
+}
+
+static float half_to_float(cl_half value) {
+    uint32_t sign = ((uint32_t)value & 0x8000u) << 16;
+    uint32_t exponent = ((uint32_t)value >> 10) & 0x1Fu;
+    uint32_t mantissa = (uint32_t)value & 0x3FFu;
+    uint32_t bits;
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            uint32_t e = 113;
+            while (!(mantissa & 0x400u)) {
+                mantissa <<= 1;
+                e--;
+            }
+            bits = sign | (e << 23) | ((mantissa & 0x3FFu) << 13);
+        }
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000u | (mantissa ? 0x400000u | (mantissa << 13) : 0u);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static void convert_from_float_scalar(cl_half* dst, const float* src, size_t count) {
+    for (size_t i = 0; i < count; i++) dst[i] = float_to_half(src[i]);
+}
+
+static void convert_to_float_scalar(float* dst, const cl_half* src, size_t count) {
+    for (size_t i = 0; i < count; i++) dst[i] = half_to_float(src[i]);
+}
+
+#ifdef RETRYIX_F16C_PATH
+// CPUID.1:ECX 的 F16C / AVX / OSXSAVE 位元，並確認作業系統保存 YMM 狀態
+static bool detect_f16c(void) {
+    unsigned int ecx;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    ecx = (unsigned int)info[2];
+#else
+    unsigned int eax, ebx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+#endif
+    const unsigned int required = (1u << 29) | (1u << 28) | (1u << 27);
+    if ((ecx & required) != required) return false;
+#if defined(_MSC_VER)
+    unsigned long long xcr0 = _xgetbv(0);
+#else
+    unsigned int xcr0_lo, xcr0_hi;
+    __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    unsigned long long xcr0 = ((unsigned long long)xcr0_hi << 32) | xcr0_lo;
+#endif
+    return (xcr0 & 0x6u) == 0x6u;
+}
+
+RETRYIX_F16C_TARGET
+static void convert_from_float_f16c(cl_half* dst, const float* src, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)(dst + i), h);
+    }
+    for (; i < count; i++) dst[i] = float_to_half(src[i]);
+}
+
+RETRYIX_F16C_TARGET
+static void convert_to_float_f16c(float* dst, const cl_half* src, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 f = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + i)));
+        _mm256_storeu_ps(dst + i, f);
+    }
+    for (; i < count; i++) dst[i] = half_to_float(src[i]);
+}
+#else
+static bool detect_f16c(void) {
+    return false;
+}
+#endif
+
+// 未初始化時也可使用：首次呼叫時偵測一次
+static bool host_f16c(void) {
+    static int detected = -1;
+    if (detected < 0) detected = detect_f16c() ? 1 : 0;
+    return detected == 1;
+}
+
+void retryix_half_from_float(cl_half* dst, const float* src, size_t count) {
+    if (!dst || !src) return;
+#ifdef RETRYIX_F16C_PATH
+    if (host_f16c()) {
+        convert_from_float_f16c(dst, src, count);
+        return;
+    }
+#endif
+    convert_from_float_scalar(dst, src, count);
+}
+
+void retryix_half_to_float(float* dst, const cl_half* src, size_t count) {
+    if (!dst || !src) return;
+#ifdef RETRYIX_F16C_PATH
+    if (host_f16c()) {
+        convert_to_float_f16c(dst, src, count);
+        return;
+    }
+#endif
+    convert_to_float_scalar(dst, src, count);
+}
+
+// 暫存段轉換交由共用執行緒池分段進行
+typedef struct {
+    cl_half* half;
+    float* single;
+    bool to_half;
+} retryix_half_convert_job_t;
+
+static void convert_range(void* arg, size_t begin, size_t end) {
+    const retryix_half_convert_job_t* job = (const retryix_half_convert_job_t*)arg;
+    if (job->to_half) {
+        retryix_half_from_float(job->half + begin, job->single + begin, end - begin);
+    } else {
+        retryix_half_to_float(job->single + begin, job->half + begin, end - begin);
+    }
+}
+
+static void convert_parallel(cl_half* half, float* single, size_t count, bool to_half) {
+    retryix_half_convert_job_t job = { half, single, to_half };
+    retryix_pool_parallel_for(count, RETRYIX_HALF_CONVERT_GRAIN, convert_range, &job);
+}
+
+// === 暫存區 ===
+
+static void release_staging(retryix_half_context_t* ctx) {
+    for (int s = 0; s < RETRYIX_HALF_STAGING_SLOTS; s++) {
+        if (ctx->staging_event[s]) {
+            clWaitForEvents(1, &ctx->staging_event[s]);
+            clReleaseEvent(ctx->staging_event[s]);
+            ctx->staging_event[s] = NULL;
+        }
+        if (ctx->staging_ptr[s]) {
+            clEnqueueUnmapMemObject(ctx->queue, ctx->staging_mem[s], ctx->staging_ptr[s], 0, NULL, NULL);
+            ctx->staging_ptr[s] = NULL;
+        }
+        if (ctx->staging_mem[s]) {
+            clReleaseMemObject(ctx->staging_mem[s]);
+            ctx->staging_mem[s] = NULL;
+        }
+    }
+    clFinish(ctx->queue);
+}
+
+// CL_MEM_ALLOC_HOST_PTR 緩衝區常駐映射，作為 DMA 可直接存取的主機端暫存
+static int create_staging(retryix_half_context_t* ctx) {
+    size_t bytes = ctx->staging_count * sizeof(cl_half);
+    for (int s = 0; s < RETRYIX_HALF_STAGING_SLOTS; s++) {
+        cl_int err;
+        ctx->staging_mem[s] = clCreateBuffer(ctx->context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, bytes, NULL, &err);
+        if (err != CL_SUCCESS || !ctx->staging_mem[s]) {
+            ctx->staging_mem[s] = NULL;
+            return -1;
+        }
+        ctx->staging_ptr[s] = (cl_half*)clEnqueueMapBuffer(ctx->queue, ctx->staging_mem[s], CL_TRUE,
+                                                           CL_MAP_READ | CL_MAP_WRITE, 0, bytes, 0, NULL, NULL, &err);
+        if (err != CL_SUCCESS || !ctx->staging_ptr[s]) {
+            ctx->staging_ptr[s] = NULL;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 取得可重用的暫存槽（等待其上一次傳輸完成）
+static int acquire_slot(retryix_half_context_t* ctx) {
+    int slot = ctx->next_slot;
+    ctx->next_slot = (ctx->next_slot + 1) % RETRYIX_HALF_STAGING_SLOTS;
+    if (ctx->staging_event[slot]) {
+        clWaitForEvents(1, &ctx->staging_event[slot]);
+        clReleaseEvent(ctx->staging_event[slot]);
+        ctx->staging_event[slot] = NULL;
+    }
+    return slot;
+}
+
+static void drain_slots(retryix_half_context_t* ctx) {
+    for (int s = 0; s < RETRYIX_HALF_STAGING_SLOTS; s++) {
+        if (!ctx->staging_event[s]) continue;
+        clWaitForEvents(1, &ctx->staging_event[s]);
+        clReleaseEvent(ctx->staging_event[s]);
+        ctx->staging_event[s] = NULL;
+    }
+}
+
+static retryix_half_record_t* find_record(retryix_half_context_t* ctx, const void* ptr) {
+    for (size_t i = 0; i < ctx->record_count; i++) {
+        if (ctx->records[i].ptr == ptr) return &ctx->records[i];
+    }
+    return NULL;
+}
+
+// 以 chunk 分段排入傳輸，設備緩衝區的相依追蹤與一般傳輸一致
+static int enqueue_chunk(retryix_half_context_t* ctx, void* buffer, cl_mem mem, bool write,
+                         size_t offset, size_t count, int slot) {
+    retryix_access_t access = write ? RETRYIX_ACCESS_WRITE : RETRYIX_ACCESS_READ;
+    cl_event waits[RETRYIX_MAX_HAZARD_WAITS];
+    cl_uint num_waits = 0;
+    retryix_memory_lock();                  // 收集等待至登記事件之間不可被其他執行緒插入
+    if (retryix_memory_hazard_waits(buffer, access, waits, RETRYIX_MAX_HAZARD_WAITS, &num_waits) != 0) {
+        // 等待清單溢位：改為主機端等待所有未完成存取，不可遺漏相依
+        num_waits = 0;
+        retryix_memory_sync(buffer);
+    }
+
+    cl_event ev = NULL;
+    cl_int err = write
+        ? clEnqueueWriteBuffer(ctx->queue, mem, CL_FALSE, offset * sizeof(cl_half), count * sizeof(cl_half),
+                               ctx->staging_ptr[slot], num_waits, num_waits ? waits : NULL, &ev)
+        : clEnqueueReadBuffer(ctx->queue, mem, CL_FALSE, offset * sizeof(cl_half), count * sizeof(cl_half),
+                              ctx->staging_ptr[slot], num_waits, num_waits ? waits : NULL, &ev);
+    if (err != CL_SUCCESS) {
+        retryix_memory_unlock();
+        printf("Half: transfer failed (%s)\n", rixCLErrorName(err));
+        return -1;
+    }
+    retryix_memory_hazard_record(buffer, access, ev);
+    retryix_memory_unlock();
+    ctx->staging_event[slot] = ev;
+    return 0;
+}
+
+// === 公開 API ===
+
+int retryix_half_init(cl_context context, cl_device_id device, cl_command_queue queue) {
+    if (g_half_context) return 0;
+    if (!context || !device || !queue) return -1;
+
+    if (retryix_config_get_dword("Applications\\AI", "FP16Support", 1) == 0) {
+        printf("Half storage disabled (Applications\\AI\\FP16Support = 0)\n");
+        return -1;
+    }
+    if (!retryix_memory_init(context, device)) return -1;
+
+    retryix_half_context_t* ctx = (retryix_half_context_t*)calloc(1, sizeof(retryix_half_context_t));
+    if (!ctx) return -1;
+
+    ctx->context = context;
+    ctx->device = device;
+    ctx->queue = queue;
+    ctx->f16c = host_f16c();
+
+    char extensions[4096] = {0};
+    clGetDeviceInfo(device, CL_DEVICE_EXTENSIONS, sizeof(extensions) - 1, extensions, NULL);
+    ctx->device_fp16 = (strstr(extensions, "cl_khr_fp16") != NULL);
+
+    unsigned long staging_kb = retryix_config_get_dword("Half", "StagingKB", 4096);
+    if (staging_kb < 64) staging_kb = 64;
+    ctx->staging_count = (size_t)staging_kb * 1024 / sizeof(cl_half);
+
+    if (create_staging(ctx) != 0 || retryix_kernel_register_program(RETRYIX_HALF_TEMPLATE, HALF_SOURCE) != 0) {
+        release_staging(ctx);
+        free(ctx);
+        return -1;
+    }
+
+    g_half_context = ctx;
+
+    printf("RetryIX Half Storage Initialized\n");
+    printf("  Host conversion: %s, device fp16 compute: %s, staging: 2 x %lu KB pinned\n",
+           ctx->f16c ? "F16C" : "scalar", ctx->device_fp16 ? "YES" : "NO (vload_half/vstore_half)", staging_kb);
+    return 0;
+}
+
+void retryix_half_cleanup(void) {
+    retryix_half_context_t* ctx = g_half_context;
+    if (!ctx) return;
+    release_staging(ctx);
+    free(ctx->records);
+    free(ctx);
+    g_half_context = NULL;
+}
+
+// 配置 count 個 half 的 retryix_memory 緩衝區（主機端影子為 cl_half 陣列）
+void* retryix_half_alloc(size_t count, retryix_memory_flags_t flags, const char* debug_name) {
+    retryix_half_context_t* ctx = g_half_context;
+    if (!ctx || count == 0) return NULL;
+
+    if (ctx->record_count >= ctx->record_capacity) {
+        size_t new_capacity = ctx->record_capacity ? ctx->record_capacity * 2 : 32;
+        retryix_half_record_t* grown = (retryix_half_record_t*)realloc(ctx->records,
+                                                    new_capacity * sizeof(retryix_half_record_t));
+        if (!grown) return NULL;
+        ctx->records = grown;
+        ctx->record_capacity = new_capacity;
+    }
+
+    void* ptr = retryix_memory_alloc_from(NULL, count * sizeof(cl_half), flags, debug_name);
+    if (!ptr) return NULL;
+    ctx->records[ctx->record_count].ptr = ptr;
+    ctx->records[ctx->record_count].count = count;
+    ctx->record_count++;
+    return ptr;
+}
+
+int retryix_half_free(void* buffer) {
+    retryix_half_context_t* ctx = g_half_context;
+    if (!ctx || !buffer) return -1;
+    retryix_half_record_t* record = find_record(ctx, buffer);
+    if (!record) return -1;
+    *record = ctx->records[--ctx->record_count];
+    return retryix_memory_free(buffer);
+}
+
+// float32 陣列轉換為 half 後經 pinned 暫存區上傳：下一段的轉換與上一段的 DMA 重疊。
+// 非阻塞時 src 於返回後即可重用（轉換已完成），傳輸完成由相依追蹤保證
+int retryix_half_upload(void* buffer, const float* src, size_t count, int blocking) {
+    retryix_half_context_t* ctx = g_half_context;
+    if (!ctx || !buffer || !src || count == 0) return -1;
+    retryix_half_record_t* record = find_record(ctx, buffer);
+    cl_mem mem = retryix_memory_get_device_mem(buffer);
+    if (!record || !mem || count > record->count) return -1;
+
+    for (size_t done = 0; done < count; ) {
+        size_t n = count - done < ctx->staging_count ? count - done : ctx->staging_count;
+        int slot = acquire_slot(ctx);
+        convert_parallel(ctx->staging_ptr[slot], (float*)(src + done), n, true);
+        if (enqueue_chunk(ctx, buffer, mem, true, done, n, slot) != 0) return -1;
+        done += n;
+    }
+    ctx->uploaded_elements += count;
+    if (blocking) drain_slots(ctx);
+    return 0;
+}
+
+// 讀回 half 並轉換為 float32（阻塞）：下一段的 DMA 與本段的轉換重疊
+int retryix_half_download(void* buffer, float* dst, size_t count) {
+    retryix_half_context_t* ctx = g_half_context;
+    if (!ctx || !buffer || !dst || count == 0) return -1;
+    retryix_half_record_t* record = find_record(ctx, buffer);
+    cl_mem mem = retryix_memory_get_device_mem(buffer);
+    if (!record || !mem || count > record->count) return -1;
+
+    drain_slots(ctx);
+    size_t chunk = ctx->staging_count;
+    int slot = acquire_slot(ctx);
+    if (enqueue_chunk(ctx, buffer, mem, false, 0, count < chunk ? count : chunk, slot) != 0) return -1;
+
+    for (size_t done = 0; done < count; ) {
+        size_t n = count - done < chunk ? count - done : chunk;
+        size_t next = done + n;
+        int current = slot;
+        if (next < count) {
+            slot = acquire_slot(ctx);
+            size_t next_n = count - next < chunk ? count - next : chunk;
+            if (enqueue_chunk(ctx, buffer, mem, false, next, next_n, slot) != 0) {
+                drain_slots(ctx);
+                return -1;
+            }
+        }
+        clWaitForEvents(1, &ctx->staging_event[current]);
+        clReleaseEvent(ctx->staging_event[current]);
+        ctx->staging_event[current] = NULL;
+        convert_parallel(ctx->staging_ptr[current], dst + done, n, false);
+        done = next;
+    }
+    ctx->downloaded_elements += count;
+    return 0;
+}
+
+// 設備端 data[i] *= alpha（RETRYIX_HALF 精度）
+int retryix_half_scale(void* buffer, size_t count, float alpha) {
+    retryix_half_context_t* ctx = g_half_context;
+    if (!ctx || !buffer || count == 0 || count > 0xFFFFFFFFu) return -1;
+
+    if (!ctx->prepared) {
+        cl_kernel kernel = retryix_kernel_acquire(RETRYIX_HALF_TEMPLATE, "retryix_half_scale");
+        if (!kernel) return -1;
+        size_t wg = 0;
+        clGetKernelWorkGroupInfo(kernel, ctx->device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(wg), &wg, NULL);
+        retryix_kernel_release(RETRYIX_HALF_TEMPLATE, kernel);
+        size_t limit = (wg > 0 && wg < RETRYIX_HALF_MAX_LOCAL) ? wg : RETRYIX_HALF_MAX_LOCAL;
+        ctx->local_size = 1;
+        while (ctx->local_size * 2 <= limit) ctx->local_size *= 2;
+        ctx->prepared = true;
+    }
+
+    cl_uint n = (cl_uint)count;
+    size_t items = (count + 3) / 4;
+    retryix_kernel_arg_t args[3] = {
+        { RETRYIX_ARG_BUFFER, RETRYIX_ACCESS_READ_WRITE, buffer, 0 },
+        { RETRYIX_ARG_VALUE, RETRYIX_ACCESS_AUTO, &n, sizeof(n) },
+        { RETRYIX_ARG_VALUE, RETRYIX_ACCESS_AUTO, &alpha, sizeof(alpha) }
+    };
+    return retryix_kernel_execute_tracked(RETRYIX_HALF_TEMPLATE, "retryix_half_scale",
+                                          round_up(items, ctx->local_size), ctx->local_size, args, 3, NULL);
+}
+
+int retryix_half_host_simd(void) {
+    return host_f16c() ? 1 : 0;
+}
+
+// === 量測 ===
+
+static double best_of(int iterations, double* samples) {
+    double best = -1.0;
+    for (int i = 0; i < iterations; i++) {
+        if (samples[i] > 0.0 && (best < 0.0 || samples[i] < best)) best = samples[i];
+    }
+    return best;
+}
+
+static int run_half_benchmark(retryix_half_context_t* ctx, size_t count, int iterations,
+                              float* src, float* dst, cl_half* scalar_half, cl_half* simd_half,
+                              float* f32_buffer, void* half_buffer, double* samples) {
+    int failures = 0;
+    uint32_t seed = 7u;
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        src[i] = ((float)(seed >> 8) / (float)(1u << 24) - 0.5f) * 2.0f;
+    }
+    // 邊界值：次正規、溢位、無限大、NaN
+    static const float specials[] = { 0.0f, -0.0f, 5.96e-8f, 2.98e-8f, 6.1e-5f, 65504.0f, 65520.0f, 1e10f, -1e-10f };
+    for (size_t i = 0; i < sizeof(specials) / sizeof(specials[0]) && i < count; i++) src[i] = specials[i];
+    if (count > 10) {
+        src[9] = INFINITY;
+        src[10] = NAN;
+    }
+
+    printf("\n=== RetryIX Half Storage Benchmark (%zu elements) ===\n", count);
+
+    // 主機端轉換：純量 vs SIMD，結果需逐位元一致
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        convert_from_float_scalar(scalar_half, src, count);
+        samples[it] = rixNowMs() - t0;
+    }
+    double scalar_ms = best_of(iterations, samples);
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        retryix_half_from_float(simd_half, src, count);
+        samples[it] = rixNowMs() - t0;
+    }
+    double simd_ms = best_of(iterations, samples);
+    bool identical = memcmp(scalar_half, simd_half, count * sizeof(cl_half)) == 0;
+    if (!identical) failures++;
+    printf("  f32->f16 scalar %8.3f ms (%7.1f Melem/s)  %s %8.3f ms (%7.1f Melem/s)  %s\n", scalar_ms,
+           scalar_ms > 0.0 ? count / (scalar_ms * 1e3) : 0.0, ctx->f16c ? "F16C" : "scalar", simd_ms,
+           simd_ms > 0.0 ? count / (simd_ms * 1e3) : 0.0, identical ? "PASS" : "FAIL");
+
+    // 上傳：float32 直接傳輸 vs half 轉換傳輸
+    memcpy(f32_buffer, src, count * sizeof(float));
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        samples[it] = (retryix_memory_copy_to_device(f32_buffer, ctx->queue, true) == 0) ? rixNowMs() - t0 : -1.0;
+    }
+    double f32_up = best_of(iterations, samples);
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        samples[it] = (retryix_half_upload(half_buffer, src, count, 1) == 0) ? rixNowMs() - t0 : -1.0;
+    }
+    double half_up = best_of(iterations, samples);
+
+    // 下載
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        samples[it] = (retryix_memory_copy_from_device(f32_buffer, ctx->queue, true) == 0) ? rixNowMs() - t0 : -1.0;
+    }
+    double f32_down = best_of(iterations, samples);
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        samples[it] = (retryix_half_download(half_buffer, dst, count) == 0) ? rixNowMs() - t0 : -1.0;
+    }
+    double half_down = best_of(iterations, samples);
+
+    double mb = count * sizeof(float) / 1e6;
+    printf("  upload   f32 %8.3f ms (%7.2f GB/s of f32)  half %8.3f ms (%7.2f GB/s of f32)\n",
+           f32_up, f32_up > 0.0 ? mb / f32_up : 0.0, half_up, half_up > 0.0 ? mb / half_up : 0.0);
+    printf("  download f32 %8.3f ms (%7.2f GB/s of f32)  half %8.3f ms (%7.2f GB/s of f32)\n",
+           f32_down, f32_down > 0.0 ? mb / f32_down : 0.0, half_down, half_down > 0.0 ? mb / half_down : 0.0);
+
+    // 往返：上傳 -> 設備端 x2 -> 下載，應與主機端 half 捨入後乘 2 一致
+    bool roundtrip = retryix_half_upload(half_buffer, src, count, 0) == 0 &&
+                     retryix_half_scale(half_buffer, count, 2.0f) == 0 &&
+                     retryix_half_download(half_buffer, dst, count) == 0;
+    size_t mismatches = 0;
+    for (size_t i = 0; roundtrip && i < count; i++) {
+        float expected = half_to_float(float_to_half(half_to_float(scalar_half[i]) * 2.0f));
+        if (isnan(expected) ? !isnan(dst[i]) : dst[i] != expected) mismatches++;
+    }
+    if (!roundtrip || mismatches) failures++;
+    printf("  device scale roundtrip (%s): %zu mismatches  %s\n", ctx->device_fp16 ? "half compute" : "float compute",
+           mismatches, roundtrip && !mismatches ? "PASS" : "FAIL");
+    printf("  device memory: %.2f MB as half vs %.2f MB as f32\n", count * sizeof(cl_half) / 1e6, mb);
+    printf("=====================================================\n\n");
+    return failures;
+}
+
+int retryix_half_benchmark(size_t count, int iterations) {
+    retryix_half_context_t* ctx = g_half_context;
+    if (!ctx || count == 0 || count > (1u << 28)) return -1;
+    if (iterations <= 0) iterations = 5;
+
+    float* src = (float*)malloc(count * sizeof(float));
+    float* dst = (float*)malloc(count * sizeof(float));
+    cl_half* scalar_half = (cl_half*)malloc(count * sizeof(cl_half));
+    cl_half* simd_half = (cl_half*)malloc(count * sizeof(cl_half));
+    double* samples = (double*)malloc((size_t)iterations * sizeof(double));
+    float* f32_buffer = (float*)retryix_memory_alloc(count * sizeof(float), RETRYIX_MEM_READ_WRITE, "half_bench_f32");
+    void* half_buffer = retryix_half_alloc(count, RETRYIX_MEM_READ_WRITE, "half_bench_f16");
+
+    int failures = 1;
+    if (src && dst && scalar_half && simd_half && samples && f32_buffer && half_buffer) {
+        failures = run_half_benchmark(ctx, count, iterations, src, dst, scalar_half, simd_half,
+                                      f32_buffer, half_buffer, samples);
+    }
+
+    if (half_buffer) retryix_half_free(half_buffer);
+    if (f32_buffer) retryix_memory_free(f32_buffer);
+    free(samples);
+    free(simd_half);
+    free(scalar_half);
+    free(dst);
+    free(src);
+    return failures ? -1 : 0;
+}
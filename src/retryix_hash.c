@@ -0,0 +1,695 @@
+// retryix_hash.c - RetryIX 設備端開放定址雜湊表（線性探測；批次插入 / 查詢 / 相異計數）
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include "retryix_thread.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RETRYIX_HASH_TEMPLATE       "retryix_hash"
+#define RETRYIX_HASH_MAX_LOCAL      256
+#define RETRYIX_HASH_MIN_CAPACITY   64u
+#define RETRYIX_HASH_MAX_CAPACITY   0x80000000u
+
+// 雜湊表內核：鍵以 RETRYIX_ATOMIC_INT 儲存（0xFFFFFFFF 保留為空槽），值為 cl_uint；
+// 插入以 RETRYIX_ATOMIC_CAS_VALUE 搶占空槽，統計以階層式原子聚合累加（每個工作組一次全域原子操作）
+static const char* HASH_SOURCE =
+"#ifdef RETRYIX_ATOMIC_TWO_PASS\n"
+"#error \"device hash table requires global atomics\"\n"
+"#endif\n"
+"#define RIX_HASH_EMPTY ((int)0xFFFFFFFF)\n"
+"\n"
+"// murmur3 finalizer\n"
+"uint retryix_hash_mix(uint k) {\n"
+"    k ^= k >> 16;\n"
+"    k *= 0x85ebca6bu;\n"
+"    k ^= k >> 13;\n"
+"    k *= 0xc2b2ae35u;\n"
+"    k ^= k >> 16;\n"
+"    return k;\n"
+"}\n"
+"\n"
+"__kernel void retryix_hash_clear(volatile __global RETRYIX_ATOMIC_INT* keys, __global uint* values, uint capacity) {\n"
+"    uint i = get_global_id(0);\n"
+"    if (i >= capacity) return;\n"
+"    RETRYIX_ATOMIC_STORE(keys + i, RIX_HASH_EMPTY);\n"
+"    values[i] = 0;\n"
+"}\n"
+"\n"
+"// stats[0] += 新插入的鍵數，stats[1] += 探測整張表仍找不到空槽的鍵數，stats[2] += 略過的保留鍵數\n"
+"__kernel void retryix_hash_insert(volatile __global RETRYIX_ATOMIC_INT* keys, __global uint* values, uint mask,\n"
+"                                  __global const uint* in_keys, __global const uint* in_values, uint has_values,\n"
+"                                  uint n, volatile __global RETRYIX_ATOMIC_INT* stats, __local int* scratch) {\n"
+"    uint i = get_global_id(0);\n"
+"    int inserted = 0;\n"
+"    int failed = 0;\n"
+"    int reserved = (i < n && (int)in_keys[i] == RIX_HASH_EMPTY) ? 1 : 0;\n"
+"    if (i < n && !reserved) {\n"
+"        int key = (int)in_keys[i];\n"
+"        uint slot = retryix_hash_mix((uint)key) & mask;\n"
+"        bool done = false;\n"
+"        for (uint probe = 0; probe <= mask && !done; probe++) {\n"
+"            int current = RETRYIX_ATOMIC_LOAD(keys + slot);\n"
+"            if (current == RIX_HASH_EMPTY) {\n"
+"                current = RETRYIX_ATOMIC_CAS_VALUE(keys + slot, RIX_HASH_EMPTY, key);\n"
+"                if (current == RIX_HASH_EMPTY) {\n"
+"                    inserted = 1;\n"
+"                    current = key;\n"
+"                }\n"
+"            }\n"
+"            if (current == key) {\n"
+"                if (has_values) values[slot] = in_values[i];\n"
+"                done = true;\n"
+"            } else {\n"
+"                slot = (slot + 1) & mask;\n"
+"            }\n"
+"        }\n"
+"        failed = done ? 0 : 1;\n"
+"    }\n"
+"    retryix_aggregated_atomic_add(stats, inserted, scratch);\n"
+"    retryix_aggregated_atomic_add(stats + 1, failed, scratch);\n"
+"    retryix_aggregated_atomic_add(stats + 2, reserved, scratch);\n"
+"}\n"
+"\n"
+"// out_values[i] = 對應值，找不到時為 missing；stats[0] += 命中數\n"
+"__kernel void retryix_hash_lookup(volatile __global RETRYIX_ATOMIC_INT* keys, __global const uint* values, uint mask,\n"
+"                                  __global const uint* queries, uint n, __global uint* out_values, uint missing,\n"
+"                                  volatile __global RETRYIX_ATOMIC_INT* stats, __local int* scratch) {\n"
+"    uint i = get_global_id(0);\n"
+"    int found = 0;\n"
+"    if (i < n) {\n"
+"        int key = (int)queries[i];\n"
+"        uint result = missing;\n"
+"        uint slot = retryix_hash_mix((uint)key) & mask;\n"
+"        for (uint probe = 0; probe <= mask && key != RIX_HASH_EMPTY; probe++) {\n"
+"            int current = RETRYIX_ATOMIC_LOAD(keys + slot);\n"
+"            if (current == key) {\n"
+"                result = values[slot];\n"
+"                found = 1;\n"
+"                break;\n"
+"            }\n"
+"            if (current == RIX_HASH_EMPTY) break;\n"
+"            slot = (slot + 1) & mask;\n"
+"        }\n"
+"        out_values[i] = result;\n"
+"    }\n"
+"    retryix_aggregated_atomic_add(stats, found, scratch);\n"
+"}\n"
+"\n"
+"// stats[0] += 已占用槽數（相異鍵數）\n"
+"__kernel void retryix_hash_count(volatile __global RETRYIX_ATOMIC_INT* keys, uint capacity,\n"
+"                                 volatile __global RETRYIX_ATOMIC_INT* stats, __local int* scratch) {\n"
+"    uint i = get_global_id(0);\n"
+"    int occupied = (i < capacity && RETRYIX_ATOMIC_LOAD(keys + i) != RIX_HASH_EMPTY) ? 1 : 0;\n"
+"    retryix_aggregated_atomic_add(stats, occupied, scratch);\n"
+"}\n";
+
+struct retryix_hash_table {
+    cl_uint capacity;                       // 2 的冪次
+    cl_uint* keys;
+    cl_uint* values;
+    bool svm;                               // true：retryix_svm_alloc，否則 retryix_memory_alloc
+    size_t size;                            // 已插入的相異鍵數
+    double max_load_factor;
+    uint64_t failed;                        // 累計插入失敗數
+    uint64_t skipped;                       // 累計略過的保留鍵（0xFFFFFFFF）數
+};
+
+typedef struct {
+    cl_context context;
+    cl_device_id device;
+    cl_command_queue queue;
+    retryix_svm_context_t* svm;
+    retryix_svm_level_t svm_level;
+    size_t local_size;
+    bool prepared;
+    cl_int* stats;                          // 內核統計（3 個 cl_int，retryix_memory 配置）
+    rix_mutex_t lock;                       // 串行化使用 stats 的操作與統計計數（各 API 可由多執行緒呼叫）
+
+    // 設定
+    double default_load_factor;             // Hash\MaxLoadFactorPct
+    bool auto_grow;                         // Hash\AutoGrow：預估負載超過上限時自動擴表重建
+
+    uint64_t inserts;
+    uint64_t lookups;
+    uint64_t rehashes;
+} retryix_hash_context_t;
+
+static retryix_hash_context_t* g_hash_context = NULL;
+
+static size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// retryix_memory 配置以緩衝區參數綁定，其餘視為 SVM 指標
+static retryix_kernel_arg_t buffer_arg(const void* ptr, retryix_access_t access) {
+    retryix_kernel_arg_t arg;
+    arg.kind = retryix_memory_get_device_mem((void*)ptr) ? RETRYIX_ARG_BUFFER : RETRYIX_ARG_SVM;
+    arg.access = access;
+    arg.value = ptr;
+    arg.size = 0;
+    return arg;
+}
+
+static retryix_kernel_arg_t value_arg(const void* value, size_t size) {
+    retryix_kernel_arg_t arg = { RETRYIX_ARG_VALUE, RETRYIX_ACCESS_AUTO, value, size };
+    return arg;
+}
+
+static retryix_kernel_arg_t local_arg(size_t size) {
+    retryix_kernel_arg_t arg = { RETRYIX_ARG_LOCAL, RETRYIX_ACCESS_AUTO, NULL, size };
+    return arg;
+}
+
+// 首次使用時編譯並取各內核工作組上限內的 2 的冪次 local size，呼叫端需持有 ctx->lock
+static int prepare(retryix_hash_context_t* ctx) {
+    if (ctx->prepared) return 0;
+
+    static const char* kernels[] = {
+        "retryix_hash_clear", "retryix_hash_insert", "retryix_hash_lookup", "retryix_hash_count"
+    };
+    size_t limit = RETRYIX_HASH_MAX_LOCAL;
+    for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+        cl_kernel kernel = retryix_kernel_acquire(RETRYIX_HASH_TEMPLATE, kernels[i]);
+        if (!kernel) return -1;
+        size_t wg = 0;
+        if (clGetKernelWorkGroupInfo(kernel, ctx->device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(wg), &wg, NULL) == CL_SUCCESS &&
+            wg > 0 && wg < limit) {
+            limit = wg;
+        }
+        retryix_kernel_release(RETRYIX_HASH_TEMPLATE, kernel);
+    }
+
+    size_t local = 1;
+    while (local * 2 <= limit) local *= 2;
+    ctx->local_size = local;
+    ctx->prepared = true;
+    return 0;
+}
+
+static int reset_stats(retryix_hash_context_t* ctx) {
+    ctx->stats[0] = 0;
+    ctx->stats[1] = 0;
+    ctx->stats[2] = 0;
+    return retryix_memory_copy_to_device(ctx->stats, ctx->queue, true);
+}
+
+static int read_stats(retryix_hash_context_t* ctx) {
+    return retryix_memory_copy_from_device(ctx->stats, ctx->queue, true);
+}
+
+static bool svm_usable(retryix_hash_context_t* ctx) {
+    return ctx->svm && (ctx->svm_level == RETRYIX_SVM_LEVEL_COARSE_GRAIN ||
+                        ctx->svm_level == RETRYIX_SVM_LEVEL_FINE_GRAIN ||
+                        ctx->svm_level == RETRYIX_SVM_LEVEL_FINE_GRAIN_SYSTEM);
+}
+
+static void* table_alloc(retryix_hash_context_t* ctx, size_t bytes, bool svm, const char* debug_name) {
+    if (svm) {
+        return retryix_svm_alloc(ctx->svm, bytes, (retryix_svm_flags_t)(RETRYIX_SVM_FLAG_READ_WRITE | RETRYIX_SVM_FLAG_FINE_GRAIN));
+    }
+    return retryix_memory_alloc_from(NULL, bytes, RETRYIX_MEM_READ_WRITE, debug_name);
+}
+
+static void table_free(retryix_hash_context_t* ctx, void* ptr, bool svm) {
+    if (!ptr) return;
+    if (svm) retryix_svm_free(ctx->svm, ptr);
+    else retryix_memory_free(ptr);
+}
+
+static int clear_arrays(retryix_hash_context_t* ctx, cl_uint* keys, cl_uint* values, cl_uint capacity) {
+    retryix_kernel_arg_t args[3] = {
+        buffer_arg(keys, RETRYIX_ACCESS_WRITE), buffer_arg(values, RETRYIX_ACCESS_WRITE), value_arg(&capacity, sizeof(capacity))
+    };
+    return retryix_kernel_execute_tracked(RETRYIX_HASH_TEMPLATE, "retryix_hash_clear", round_up(capacity, ctx->local_size),
+                                          ctx->local_size, args, 3, NULL);
+}
+
+// 批次插入至指定陣列；統計寫入 ctx->stats（呼叫端先 reset_stats，之後 read_stats）
+static int insert_arrays(retryix_hash_context_t* ctx, cl_uint* keys, cl_uint* values, cl_uint capacity,
+                         const void* in_keys, const void* in_values, size_t count) {
+    cl_uint mask = capacity - 1;
+    cl_uint has_values = in_values ? 1 : 0;
+    cl_uint n = (cl_uint)count;
+    retryix_kernel_arg_t args[9] = {
+        buffer_arg(keys, RETRYIX_ACCESS_READ_WRITE), buffer_arg(values, RETRYIX_ACCESS_READ_WRITE),
+        value_arg(&mask, sizeof(mask)), buffer_arg(in_keys, RETRYIX_ACCESS_READ),
+        buffer_arg(in_values ? in_values : in_keys, RETRYIX_ACCESS_READ), value_arg(&has_values, sizeof(has_values)),
+        value_arg(&n, sizeof(n)), buffer_arg(ctx->stats, RETRYIX_ACCESS_READ_WRITE), local_arg(ctx->local_size * sizeof(cl_int))
+    };
+    return retryix_kernel_execute_tracked(RETRYIX_HASH_TEMPLATE, "retryix_hash_insert", round_up(count, ctx->local_size),
+                                          ctx->local_size, args, 9, NULL);
+}
+
+// 擴表：配置新陣列，將舊表的鍵值重新插入（空槽於內核中略過），呼叫端需持有 ctx->lock
+static int rehash(retryix_hash_context_t* ctx, retryix_hash_table_t* table, size_t new_capacity) {
+    if (new_capacity > RETRYIX_HASH_MAX_CAPACITY) return -1;
+    cl_uint capacity = (cl_uint)new_capacity;
+    cl_uint* keys = (cl_uint*)table_alloc(ctx, (size_t)capacity * sizeof(cl_uint), table->svm, "hash_keys");
+    cl_uint* values = (cl_uint*)table_alloc(ctx, (size_t)capacity * sizeof(cl_uint), table->svm, "hash_values");
+    int rc = (keys && values) ? clear_arrays(ctx, keys, values, capacity) : -1;
+    if (rc == 0) rc = reset_stats(ctx);
+    if (rc == 0) rc = insert_arrays(ctx, keys, values, capacity, table->keys, table->values, table->capacity);
+    if (rc == 0) rc = read_stats(ctx);
+    if (rc != 0 || ctx->stats[1] != 0) {
+        table_free(ctx, values, table->svm);
+        table_free(ctx, keys, table->svm);
+        return -1;
+    }
+
+    table_free(ctx, table->values, table->svm);
+    table_free(ctx, table->keys, table->svm);
+    table->keys = keys;
+    table->values = values;
+    table->capacity = capacity;
+    table->size = (size_t)ctx->stats[0];
+    ctx->rehashes++;
+    return 0;
+}
+
+// === 公開 API ===
+
+int retryix_hash_init(cl_context context, cl_device_id device, cl_command_queue queue, retryix_svm_context_t* svm) {
+    if (g_hash_context) return 0;
+    if (!context || !device || !queue) return -1;
+
+    if (!retryix_memory_init(context, device)) return -1;
+
+    retryix_hash_context_t* ctx = (retryix_hash_context_t*)calloc(1, sizeof(retryix_hash_context_t));
+    if (!ctx) return -1;
+
+    ctx->context = context;
+    ctx->device = device;
+    ctx->queue = queue;
+    ctx->svm = svm;
+    cl_bitfield svm_caps = 0;
+    ctx->svm_level = retryix_svm_probe_capabilities(device, &svm_caps);
+    if (svm) retryix_kernel_set_svm_context(svm);
+
+    unsigned long load_pct = retryix_config_get_dword("Hash", "MaxLoadFactorPct", 50);
+    if (load_pct < 10 || load_pct > 95) load_pct = 50;
+    ctx->default_load_factor = load_pct / 100.0;
+    ctx->auto_grow = retryix_config_get_dword("Hash", "AutoGrow", 1) != 0;
+
+    ctx->stats = (cl_int*)retryix_memory_alloc_from(NULL, 3 * sizeof(cl_int), RETRYIX_MEM_READ_WRITE, "hash_stats");
+    if (!ctx->stats || retryix_kernel_register_program(RETRYIX_HASH_TEMPLATE, HASH_SOURCE) != 0) {
+        if (ctx->stats) retryix_memory_free(ctx->stats);
+        free(ctx);
+        return -1;
+    }
+    rix_mutex_init(&ctx->lock);
+
+    g_hash_context = ctx;
+
+    printf("RetryIX Hash Table Initialized\n");
+    printf("  Max load factor: %.2f, auto grow: %s, SVM tables: %s\n", ctx->default_load_factor,
+           ctx->auto_grow ? "YES" : "NO", svm_usable(ctx) ? "YES" : "NO");
+    return 0;
+}
+
+void retryix_hash_cleanup(void) {
+    if (!g_hash_context) return;
+    if (g_hash_context->stats) retryix_memory_free(g_hash_context->stats);
+    rix_mutex_destroy(&g_hash_context->lock);
+    free(g_hash_context);
+    g_hash_context = NULL;
+}
+
+// 容納 expected_items 個鍵且負載不超過 max_load_factor 的容量（2 的冪次）
+size_t retryix_hash_capacity_for(size_t expected_items, double max_load_factor) {
+    if (max_load_factor <= 0.0 || max_load_factor >= 1.0) {
+        max_load_factor = g_hash_context ? g_hash_context->default_load_factor : 0.5;
+    }
+    double needed = (double)expected_items / max_load_factor + 1.0;
+    size_t capacity = RETRYIX_HASH_MIN_CAPACITY;
+    while ((double)capacity < needed && capacity < RETRYIX_HASH_MAX_CAPACITY) capacity *= 2;
+    return capacity;
+}
+
+retryix_hash_table_t* retryix_hash_create(size_t expected_items, double max_load_factor, int use_svm) {
+    retryix_hash_context_t* ctx = g_hash_context;
+    if (!ctx) return NULL;
+    rix_mutex_lock(&ctx->lock);
+    int prepared = prepare(ctx);
+    rix_mutex_unlock(&ctx->lock);
+    if (prepared != 0) return NULL;
+
+    retryix_hash_table_t* table = (retryix_hash_table_t*)calloc(1, sizeof(retryix_hash_table_t));
+    if (!table) return NULL;
+    table->max_load_factor = (max_load_factor > 0.0 && max_load_factor < 1.0) ? max_load_factor : ctx->default_load_factor;
+    table->capacity = (cl_uint)retryix_hash_capacity_for(expected_items, table->max_load_factor);
+    table->svm = use_svm && svm_usable(ctx);
+    if (use_svm && !table->svm) printf("Hash: SVM not available, using device memory\n");
+
+    size_t bytes = (size_t)table->capacity * sizeof(cl_uint);
+    table->keys = (cl_uint*)table_alloc(ctx, bytes, table->svm, "hash_keys");
+    table->values = (cl_uint*)table_alloc(ctx, bytes, table->svm, "hash_values");
+    if (!table->keys || !table->values || clear_arrays(ctx, table->keys, table->values, table->capacity) != 0) {
+        table_free(ctx, table->values, table->svm);
+        table_free(ctx, table->keys, table->svm);
+        free(table);
+        return NULL;
+    }
+    return table;
+}
+
+void retryix_hash_destroy(retryix_hash_table_t* table) {
+    retryix_hash_context_t* ctx = g_hash_context;
+    if (!ctx || !table) return;
+    if (table->svm) retryix_svm_sync(ctx->svm, table->keys);
+    table_free(ctx, table->values, table->svm);
+    table_free(ctx, table->keys, table->svm);
+    free(table);
+}
+
+int retryix_hash_clear(retryix_hash_table_t* table) {
+    retryix_hash_context_t* ctx = g_hash_context;
+    if (!ctx || !table) return -1;
+    table->size = 0;
+    table->failed = 0;
+    table->skipped = 0;
+    return clear_arrays(ctx, table->keys, table->values, table->capacity);
+}
+
+// 插入本體，呼叫端需持有 ctx->lock
+static int insert_locked(retryix_hash_context_t* ctx, retryix_hash_table_t* table, const void* keys,
+                         const void* values, size_t count, size_t* out_inserted) {
+    double projected = (double)(table->size + count);
+    if (ctx->auto_grow && projected > table->max_load_factor * table->capacity) {
+        size_t capacity = retryix_hash_capacity_for(table->size + count, table->max_load_factor);
+        if (capacity > table->capacity && rehash(ctx, table, capacity) != 0) {
+            printf("Hash: failed to grow table to %zu slots\n", capacity);
+        }
+    }
+
+    if (reset_stats(ctx) != 0 ||
+        insert_arrays(ctx, table->keys, table->values, table->capacity, keys, values, count) != 0 ||
+        read_stats(ctx) != 0) {
+        return -1;
+    }
+    table->size += (size_t)ctx->stats[0];
+    table->failed += (uint64_t)ctx->stats[1];
+    table->skipped += (uint64_t)ctx->stats[2];
+    ctx->inserts += count;
+    if (out_inserted) *out_inserted = (size_t)ctx->stats[0];
+    if (ctx->stats[2] != 0) {
+        printf("Hash: %d keys equal to the reserved marker 0xFFFFFFFF were skipped\n", ctx->stats[2]);
+    }
+    if (ctx->stats[1] != 0) {
+        printf("Hash: %d keys could not be inserted (table full)\n", ctx->stats[1]);
+        return -1;
+    }
+    return 0;
+}
+
+// 批次插入（鍵已存在時以新值覆寫，同批重複鍵的勝出者不定）；values 為 NULL 時只插入鍵。
+// 以輸入數保守預估負載，超過上限且 Hash\AutoGrow 開啟時先擴表。阻塞至統計可用
+// 等於保留值 0xFFFFFFFF 的鍵無法存放，略過並計入統計（不視為錯誤）
+int retryix_hash_insert(retryix_hash_table_t* table, const void* keys, const void* values, size_t count,
+                        size_t* out_inserted) {
+    retryix_hash_context_t* ctx = g_hash_context;
+    if (!ctx || !table || !keys || count == 0 || count > 0xFFFFFFFFu) return -1;
+
+    rix_mutex_lock(&ctx->lock);
+    int rc = insert_locked(ctx, table, keys, values, count, out_inserted);
+    rix_mutex_unlock(&ctx->lock);
+    return rc;
+}
+
+// 批次查詢：out_values[i] 為對應值，找不到時為 RETRYIX_HASH_NOT_FOUND；out_found 非 NULL 時阻塞讀回命中數
+int retryix_hash_lookup(const retryix_hash_table_t* table, const void* keys, void* out_values, size_t count,
+                        size_t* out_found) {
+    retryix_hash_context_t* ctx = g_hash_context;
+    if (!ctx || !table || !keys || !out_values || count == 0 || count > 0xFFFFFFFFu) return -1;
+
+    cl_uint mask = table->capacity - 1;
+    cl_uint n = (cl_uint)count;
+    cl_uint missing = RETRYIX_HASH_NOT_FOUND;
+    rix_mutex_lock(&ctx->lock);
+    int rc = 0;
+    if (out_found && reset_stats(ctx) != 0) rc = -1;
+    retryix_kernel_arg_t args[9] = {
+        buffer_arg(table->keys, RETRYIX_ACCESS_READ), buffer_arg(table->values, RETRYIX_ACCESS_READ),
+        value_arg(&mask, sizeof(mask)), buffer_arg(keys, RETRYIX_ACCESS_READ), value_arg(&n, sizeof(n)),
+        buffer_arg(out_values, RETRYIX_ACCESS_WRITE), value_arg(&missing, sizeof(missing)),
+        buffer_arg(ctx->stats, RETRYIX_ACCESS_READ_WRITE), local_arg(ctx->local_size * sizeof(cl_int))
+    };
+    if (rc == 0 && retryix_kernel_execute_tracked(RETRYIX_HASH_TEMPLATE, "retryix_hash_lookup",
+                                                  round_up(count, ctx->local_size), ctx->local_size, args, 9, NULL) != 0) {
+        rc = -1;
+    }
+    if (rc == 0) ctx->lookups += count;
+    if (rc == 0 && out_found) {
+        if (read_stats(ctx) == 0) *out_found = (size_t)ctx->stats[0];
+        else rc = -1;
+    }
+    rix_mutex_unlock(&ctx->lock);
+    return rc;
+}
+
+// 由設備端重新計算已占用槽數（表被其他內核修改後使用）
+int retryix_hash_count(const retryix_hash_table_t* table, size_t* out_count) {
+    retryix_hash_context_t* ctx = g_hash_context;
+    if (!ctx || !table || !out_count) return -1;
+
+    cl_uint capacity = table->capacity;
+    retryix_kernel_arg_t args[4] = {
+        buffer_arg(table->keys, RETRYIX_ACCESS_READ), value_arg(&capacity, sizeof(capacity)),
+        buffer_arg(ctx->stats, RETRYIX_ACCESS_READ_WRITE), local_arg(ctx->local_size * sizeof(cl_int))
+    };
+    rix_mutex_lock(&ctx->lock);
+    int rc = -1;
+    if (reset_stats(ctx) == 0 &&
+        retryix_kernel_execute_tracked(RETRYIX_HASH_TEMPLATE, "retryix_hash_count", round_up(capacity, ctx->local_size),
+                                       ctx->local_size, args, 4, NULL) == 0 &&
+        read_stats(ctx) == 0) {
+        *out_count = (size_t)ctx->stats[0];
+        rc = 0;
+    }
+    rix_mutex_unlock(&ctx->lock);
+    return rc;
+}
+
+// 相異鍵計數：以暫存表插入全部鍵後計算占用槽數
+int retryix_hash_count_distinct(const void* keys, size_t count, size_t* out_distinct) {
+    if (!keys || !out_distinct) return -1;
+    retryix_hash_table_t* table = retryix_hash_create(count, 0.0, 0);
+    if (!table) return -1;
+    int rc = retryix_hash_insert(table, keys, NULL, count, NULL);
+    if (rc == 0) rc = retryix_hash_count(table, out_distinct);
+    retryix_hash_destroy(table);
+    return rc;
+}
+
+size_t retryix_hash_size(const retryix_hash_table_t* table) {
+    return table ? table->size : 0;
+}
+
+size_t retryix_hash_capacity(const retryix_hash_table_t* table) {
+    return table ? table->capacity : 0;
+}
+
+double retryix_hash_load_factor(const retryix_hash_table_t* table) {
+    return (table && table->capacity) ? (double)table->size / table->capacity : 0.0;
+}
+
+// 使主機端的鍵 / 值陣列反映設備結果：細粒度 SVM 表僅等待寫入完成，設備記憶體表則讀回
+int retryix_hash_sync(retryix_hash_table_t* table) {
+    retryix_hash_context_t* ctx = g_hash_context;
+    if (!ctx || !table) return -1;
+    if (table->svm) {
+        if (retryix_svm_sync(ctx->svm, table->keys) != 0) return -1;
+        return retryix_svm_sync(ctx->svm, table->values);
+    }
+    if (retryix_memory_copy_from_device(table->keys, ctx->queue, true) != 0) return -1;
+    return retryix_memory_copy_from_device(table->values, ctx->queue, true);
+}
+
+const cl_uint* retryix_hash_keys(const retryix_hash_table_t* table) {
+    return table ? table->keys : NULL;
+}
+
+const cl_uint* retryix_hash_values(const retryix_hash_table_t* table) {
+    return table ? table->values : NULL;
+}
+
+// === 量測 ===
+
+static cl_uint value_of(cl_uint key) {
+    return key * 2654435761u + 1u;
+}
+
+static int compare_uint(const void* a, const void* b) {
+    cl_uint x = *(const cl_uint*)a;
+    cl_uint y = *(const cl_uint*)b;
+    return (x > y) - (x < y);
+}
+
+// 主機端線性探測基準（單執行緒）
+static double cpu_build_probe(const cl_uint* keys, const cl_uint* queries, size_t count, cl_uint capacity,
+                              cl_uint* out_values, double* out_probe_ms) {
+    cl_uint* table_keys = (cl_uint*)malloc((size_t)capacity * sizeof(cl_uint));
+    cl_uint* table_values = (cl_uint*)malloc((size_t)capacity * sizeof(cl_uint));
+    if (!table_keys || !table_values) {
+        free(table_values);
+        free(table_keys);
+        return -1.0;
+    }
+    cl_uint mask = capacity - 1;
+    double t0 = rixNowMs();
+    memset(table_keys, 0xFF, (size_t)capacity * sizeof(cl_uint));
+    for (size_t i = 0; i < count; i++) {
+        cl_uint k = keys[i];
+        cl_uint h = k;
+        h ^= h >> 16; h *= 0x85ebca6bu; h ^= h >> 13; h *= 0xc2b2ae35u; h ^= h >> 16;
+        cl_uint slot = h & mask;
+        while (table_keys[slot] != RETRYIX_HASH_NOT_FOUND && table_keys[slot] != k) slot = (slot + 1) & mask;
+        table_keys[slot] = k;
+        table_values[slot] = value_of(k);
+    }
+    double build_ms = rixNowMs() - t0;
+
+    t0 = rixNowMs();
+    for (size_t i = 0; i < count; i++) {
+        cl_uint k = queries[i];
+        cl_uint h = k;
+        h ^= h >> 16; h *= 0x85ebca6bu; h ^= h >> 13; h *= 0xc2b2ae35u; h ^= h >> 16;
+        cl_uint slot = h & mask;
+        cl_uint result = RETRYIX_HASH_NOT_FOUND;
+        while (table_keys[slot] != RETRYIX_HASH_NOT_FOUND) {
+            if (table_keys[slot] == k) {
+                result = table_values[slot];
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+        out_values[i] = result;
+    }
+    *out_probe_ms = rixNowMs() - t0;
+
+    free(table_values);
+    free(table_keys);
+    return build_ms;
+}
+
+static int bench_table(retryix_hash_context_t* ctx, bool svm, const cl_uint* keys, const cl_uint* values,
+                       const cl_uint* queries, cl_uint* results, const cl_uint* expected, size_t count,
+                       size_t distinct, int iterations) {
+    retryix_hash_table_t* table = retryix_hash_create(count, 0.0, svm ? 1 : 0);
+    if (!table) {
+        printf("  %-6s create failed\n", svm ? "SVM" : "DEVICE");
+        return 1;
+    }
+
+    double insert_best = -1.0, lookup_best = -1.0;
+    size_t inserted = 0, found = 0;
+    int rc = 0;
+    for (int it = 0; it <= iterations && rc == 0; it++) {
+        rc = retryix_hash_clear(table);
+        if (rc == 0) rc = table->svm ? retryix_svm_sync(ctx->svm, table->keys) : retryix_memory_sync(table->keys);
+        double t0 = rixNowMs();
+        if (rc == 0) rc = retryix_hash_insert(table, keys, values, count, &inserted);
+        double insert_ms = rixNowMs() - t0;
+
+        t0 = rixNowMs();
+        if (rc == 0) rc = retryix_hash_lookup(table, queries, results, count, &found);
+        double lookup_ms = rixNowMs() - t0;
+        if (it == 0) continue;
+        if (insert_best < 0.0 || insert_ms < insert_best) insert_best = insert_ms;
+        if (lookup_best < 0.0 || lookup_ms < lookup_best) lookup_best = lookup_ms;
+    }
+
+    bool correct = (rc == 0 && inserted == distinct);
+    if (correct && retryix_memory_copy_from_device(results, ctx->queue, true) == 0) {
+        for (size_t i = 0; i < count && correct; i++) correct = (results[i] == expected[i]);
+    } else {
+        correct = false;
+    }
+    // 細粒度 SVM 表：同步後主機直接讀取表內容
+    size_t host_count = 0;
+    if (correct && retryix_hash_sync(table) == 0) {
+        for (cl_uint i = 0; i < table->capacity; i++) host_count += (table->keys[i] != RETRYIX_HASH_NOT_FOUND);
+        correct = (host_count == distinct);
+    }
+
+    printf("  %-6s insert %8.3f ms (%7.1f Mkeys/s)  lookup %8.3f ms (%7.1f Mkeys/s)  load %.2f  %s\n",
+           svm ? "SVM" : "DEVICE", insert_best, insert_best > 0.0 ? count / (insert_best * 1e3) : 0.0,
+           lookup_best, lookup_best > 0.0 ? count / (lookup_best * 1e3) : 0.0, retryix_hash_load_factor(table),
+           correct ? "PASS" : "FAIL");
+    retryix_hash_destroy(table);
+    return correct ? 0 : 1;
+}
+
+// 以含重複鍵的輸入量測插入 / 查詢吞吐量（設備記憶體與 SVM 表），並與主機線性探測比對
+int retryix_hash_benchmark(size_t count, int iterations) {
+    retryix_hash_context_t* ctx = g_hash_context;
+    if (!ctx || count == 0 || count > (1u << 28)) return -1;
+    if (iterations <= 0) iterations = 3;
+    if (prepare(ctx) != 0) return -1;
+
+    size_t bytes = count * sizeof(cl_uint);
+    cl_uint* keys = (cl_uint*)retryix_memory_alloc(bytes, RETRYIX_MEM_READ_ONLY, "hash_bench_keys");
+    cl_uint* values = (cl_uint*)retryix_memory_alloc(bytes, RETRYIX_MEM_READ_ONLY, "hash_bench_values");
+    cl_uint* queries = (cl_uint*)retryix_memory_alloc(bytes, RETRYIX_MEM_READ_ONLY, "hash_bench_queries");
+    cl_uint* results = (cl_uint*)retryix_memory_alloc(bytes, RETRYIX_MEM_READ_WRITE, "hash_bench_results");
+    cl_uint* expected = (cl_uint*)malloc(bytes);
+    cl_uint* sorted = (cl_uint*)malloc(bytes);
+    int failures = 0;
+
+    if (!keys || !values || !queries || !results || !expected || !sorted) {
+        failures = 1;
+    } else {
+        // 鍵取自 [0, count / 2)，約半數重複；查詢一半命中、一半落在鍵範圍之外
+        uint32_t seed = 2024u;
+        cl_uint range = (cl_uint)(count / 2 > 0 ? count / 2 : 1);
+        for (size_t i = 0; i < count; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            keys[i] = seed % range;
+            values[i] = value_of(keys[i]);
+            queries[i] = (i & 1) ? keys[i] : range + (seed >> 4) % range;
+        }
+        memcpy(sorted, keys, bytes);
+        qsort(sorted, count, sizeof(cl_uint), compare_uint);
+        size_t distinct = 0;
+        for (size_t i = 0; i < count; i++) distinct += (i == 0 || sorted[i] != sorted[i - 1]);
+
+        retryix_memory_copy_to_device(keys, ctx->queue, true);
+        retryix_memory_copy_to_device(values, ctx->queue, true);
+        retryix_memory_copy_to_device(queries, ctx->queue, true);
+
+        cl_uint capacity = (cl_uint)retryix_hash_capacity_for(distinct, ctx->default_load_factor);
+        double probe_ms = 0.0;
+        double build_ms = cpu_build_probe(keys, queries, count, capacity, expected, &probe_ms);
+
+        printf("\n=== RetryIX Hash Table Benchmark (%zu keys, %zu distinct) ===\n", count, distinct);
+        printf("  CPU    insert %8.3f ms (%7.1f Mkeys/s)  lookup %8.3f ms (%7.1f Mkeys/s)\n", build_ms,
+               build_ms > 0.0 ? count / (build_ms * 1e3) : 0.0, probe_ms, probe_ms > 0.0 ? count / (probe_ms * 1e3) : 0.0);
+
+        failures += bench_table(ctx, false, keys, values, queries, results, expected, count, distinct, iterations);
+        if (svm_usable(ctx)) {
+            failures += bench_table(ctx, true, keys, values, queries, results, expected, count, distinct, iterations);
+        }
+
+        size_t counted = 0;
+        double t0 = rixNowMs();
+        int rc = retryix_hash_count_distinct(keys, count, &counted);
+        double distinct_ms = rixNowMs() - t0;
+        bool ok = (rc == 0 && counted == distinct);
+        if (!ok) failures++;
+        printf("  count-distinct %8.3f ms -> %zu  %s\n", distinct_ms, counted, ok ? "PASS" : "FAIL");
+        printf("==========================================================\n\n");
+    }
+
+    free(sorted);
+    free(expected);
+    if (results) retryix_memory_free(results);
+    if (queries) retryix_memory_free(queries);
+    if (values) retryix_memory_free(values);
+    if (keys) retryix_memory_free(keys);
+    return failures ? -1 : 0;
+}
@@ -0,0 +1,120 @@
+// retryix_hazard.h
+// Per-buffer hazard tracking (last writer + outstanding readers) for RetryIX
+#ifndef RETRYIX_HAZARD_H
+#define RETRYIX_HAZARD_H
+
+#include "retryix.h"
+#include <stdbool.h>
+
+// 記憶體物件的存取紀錄：最後一次寫入與其後尚未完成的讀取
+typedef struct {
+    cl_event last_writer;
+    cl_event readers[RETRYIX_MAX_HAZARD_WAITS];
+    cl_uint reader_count;
+} retryix_hazard_t;
+
+// 事件已完成（或異常終止）
+static inline bool rix_event_complete(cl_event ev) {
+    cl_int status = CL_COMPLETE;
+    if (clGetEventInfo(ev, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(status), &status, NULL) != CL_SUCCESS) {
+        return true;
+    }
+    return status <= CL_COMPLETE;
+}
+
+// 釋放已完成的事件，避免等待清單無謂增長
+static inline void rix_hazard_prune(retryix_hazard_t* h) {
+    if (h->last_writer && rix_event_complete(h->last_writer)) {
+        clReleaseEvent(h->last_writer);
+        h->last_writer = NULL;
+    }
+    cl_uint kept = 0;
+    for (cl_uint i = 0; i < h->reader_count; i++) {
+        if (rix_event_complete(h->readers[i])) {
+            clReleaseEvent(h->readers[i]);
+        } else {
+            h->readers[kept++] = h->readers[i];
+        }
+    }
+    h->reader_count = kept;
+}
+
+// 加入等待清單（已存在者略過），空間不足回傳 -1
+static inline int rix_event_list_add(cl_event* list, cl_uint* count, cl_uint max_count, cl_event ev) {
+    for (cl_uint i = 0; i < *count; i++) {
+        if (list[i] == ev) return 0;
+    }
+    if (*count >= max_count) return -1;
+    list[(*count)++] = ev;
+    return 0;
+}
+
+// 收集存取前需等待的事件：
+//   讀取等待最後寫入（RAW）
+//   寫入等待其後的所有讀取（WAR）；無讀取時等待最後寫入（WAW）
+// 讀取事件登記前皆已等待最後寫入，因此寫入不需重複等待
+static inline int rix_hazard_waits(retryix_hazard_t* h, bool is_write,
+                                   cl_event* waits, cl_uint max_waits, cl_uint* num_waits) {
+    rix_hazard_prune(h);
+    if (is_write && h->reader_count > 0) {
+        for (cl_uint i = 0; i < h->reader_count; i++) {
+            if (rix_event_list_add(waits, num_waits, max_waits, h->readers[i]) != 0) return -1;
+        }
+        return 0;
+    }
+    if (h->last_writer) {
+        return rix_event_list_add(waits, num_waits, max_waits, h->last_writer);
+    }
+    return 0;
+}
+
+// 登記已排入的存取（事件會被保留，呼叫端仍需釋放自己的參考）
+static inline void rix_hazard_record(retryix_hazard_t* h, bool is_write, cl_event ev) {
+    if (!ev) return;
+    clRetainEvent(ev);
+
+    if (is_write) {
+        for (cl_uint i = 0; i < h->reader_count; i++) clReleaseEvent(h->readers[i]);
+        h->reader_count = 0;
+        if (h->last_writer) clReleaseEvent(h->last_writer);
+        h->last_writer = ev;
+        return;
+    }
+
+    rix_hazard_prune(h);
+    if (h->reader_count >= RETRYIX_MAX_HAZARD_WAITS) {
+        // 讀取過多：等待最舊的讀取完成以騰出位置
+        clWaitForEvents(1, &h->readers[0]);
+        clReleaseEvent(h->readers[0]);
+        for (cl_uint i = 1; i < h->reader_count; i++) h->readers[i - 1] = h->readers[i];
+        h->reader_count--;
+    }
+    h->readers[h->reader_count++] = ev;
+}
+
+// 等待所有未完成的存取並清空紀錄（主機端存取或釋放前呼叫）
+static inline void rix_hazard_sync(retryix_hazard_t* h) {
+    if (h->last_writer) {
+        clWaitForEvents(1, &h->last_writer);
+        clReleaseEvent(h->last_writer);
+        h->last_writer = NULL;
+    }
+    if (h->reader_count > 0) {
+        clWaitForEvents(h->reader_count, h->readers);
+        for (cl_uint i = 0; i < h->reader_count; i++) clReleaseEvent(h->readers[i]);
+        h->reader_count = 0;
+    }
+}
+
+// 同 rix_hazard_waits，但等待清單容量不足時改為主機端等待所有未完成存取（rix_hazard_sync），
+// 並撤回本次已加入的事件（已被釋放），確保相依不會因溢位而遺失
+static inline void rix_hazard_waits_or_sync(retryix_hazard_t* h, bool is_write,
+                                            cl_event* waits, cl_uint max_waits, cl_uint* num_waits) {
+    cl_uint before = *num_waits;
+    if (rix_hazard_waits(h, is_write, waits, max_waits, num_waits) != 0) {
+        *num_waits = before;
+        rix_hazard_sync(h);
+    }
+}
+
+#endif // RETRYIX_HAZARD_H
@@ -17,6 +17,7 @@
 
 #include "host_comm.h"
 #include "module_descriptor.h"
+#include "retryix.h"
 
 #ifdef _WIN32
 #define EXPORT __declspec(dllexport)
@@ -52,6 +53,7 @@ static cl_program       g_program  = NULL;
 static cl_kernel        g_kernels[MAX_KERNELS] = {0};
 static char             g_kernel_names[MAX_KERNELS][128] = {{0}};
 static int              g_kernel_count = 0;
+static int              g_cpu_device = 0;     // 使用 CPU 偽設備（無 OpenCL 設備或 PreferredDevice = "cpu"）
 
 // ----- optional built-in fallback kernel (name: "test") -----
 // does: data[i] = data[i] + 1.0f
@@ -180,6 +182,19 @@ static int pick_first_device(cl_device_type prefer, cl_platform_id* out_pf, cl_d
     return -1;
 }
 
+// 選用 CPU 偽設備：僅提供內建運算，自訂內核原始碼不會執行
+static int use_cpu_device(int forced, const char* kernel_source) {
+    int rc = forced ? retryix_cpu_device_init()
+                    : retryix_cpu_device_fallback("[RetryIX Host] No OpenCL device");
+    if (rc != 0) return -1;
+    if (kernel_source != kFallbackKernel) {
+        fprintf(stdout, "[RetryIX Host] CPU pseudo-device: custom kernel source ignored, built-in operations only\n");
+    }
+    g_cpu_device = 1;
+    retryix_register_self();
+    return 0;
+}
+
 // ===== Public API =====
 EXPORT int retryix_init_minimal(void) {
     return retryix_init_from_source(kFallbackKernel, "-cl-std=CL1.2");
@@ -189,9 +204,17 @@ EXPORT int retryix_init_from_source(const char* kernel_source,
                                     const char* build_opts /* can be NULL */) {
     cl_int err;
 
-    if (g_context || g_program) return 0;
+    if (g_context || g_program || g_cpu_device) return 0;
 
-    if (pick_first_device(CL_DEVICE_TYPE_GPU, &g_platform, &g_device) != 0) return -1;
+    char preferred[32] = {0};
+    if (retryix_config_get_string("DeviceManager", "PreferredDevice", preferred, sizeof(preferred)) == RETRYIX_SUCCESS &&
+        strcmp(preferred, "cpu") == 0) {
+        return use_cpu_device(1, kernel_source);
+    }
+
+    if (pick_first_device(CL_DEVICE_TYPE_GPU, &g_platform, &g_device) != 0) {
+        return use_cpu_device(0, kernel_source);
+    }
 
     g_context = clCreateContext(NULL, 1, &g_device, NULL, NULL, &err);
     check_error(err, "clCreateContext");
@@ -232,6 +255,7 @@ EXPORT int retryix_init_from_file(const char* kernel_path,
 }
 
 EXPORT cl_kernel retryix_create_kernel(const char* kernel_name) {
+    if (g_cpu_device) { fprintf(stderr, "CPU pseudo-device has no OpenCL kernels.\n"); return NULL; }
     if (!g_program) { fprintf(stderr, "Program not built.\n"); return NULL; }
     if (g_kernel_count >= MAX_KERNELS) { fprintf(stderr, "Kernel cache full.\n"); return NULL; }
 
@@ -256,6 +280,10 @@ static cl_kernel ensure_test_kernel(void) {
 }
 
 EXPORT int retryix_execute_kernel(float* host_data, size_t count) {
+    if (g_cpu_device) {
+        if (!host_data || count == 0) return -10;
+        return retryix_cpu_elementwise(RETRYIX_CPU_OP_INCREMENT, host_data, host_data, NULL, 0.0f, count) == 0 ? 0 : -12;
+    }
     if (!g_context || !g_queue) return -3;
 
     cl_int err;
@@ -303,7 +331,8 @@ EXPORT int retryix_host_receive_command(const char *input,
     if (strcmp(input, "ping") == 0) {
         snprintf(response, response_size, "pong");
     } else if (strcmp(input, "status") == 0) {
-        snprintf(response, response_size, "RetryIX v2.0 Host Ready");
+        snprintf(response, response_size, g_cpu_device ? "RetryIX v2.0 Host Ready (CPU pseudo-device)"
+                                                        : "RetryIX v2.0 Host Ready");
     } else if (strncmp(input, "eval:", 5) == 0) {
         float val = 0.0f;
         (void)sscanf(input + 5, "%f", &val);
@@ -346,6 +375,8 @@ EXPORT int retryix_shutdown(void) {
     if (g_queue)   { clReleaseCommandQueue(g_queue); g_queue=NULL; }
     if (g_context) { clReleaseContext(g_context); g_context=NULL; }
     g_device = NULL; g_platform = NULL;
+    if (g_cpu_device) { retryix_cpu_device_cleanup(); g_cpu_device = 0; }
+    retryix_pool_cleanup();
     memset(g_kernel_names, 0, sizeof(g_kernel_names));
     return 0;
 }
@@ -1,7 +1,10 @@
 
+#ifndef CL_TARGET_OPENCL_VERSION
 #define CL_TARGET_OPENCL_VERSION 200
+#endif
 #include "retryix_cl_compat.h"
 #include <stdbool.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -9,6 +12,7 @@
 #include <time.h>
 #include <assert.h>
 #include "retryix.h"
+#include "retryix_thread.h"
 
 
 // ...existing code...
@@ -25,32 +29,88 @@ typedef enum {
     RETRYIX_KERNEL_STRATEGY_OPENCL12_EXT,  // OpenCL 1.2 + 擴展
     RETRYIX_KERNEL_STRATEGY_OPENCL11_BASIC, // OpenCL 1.1 基礎
     RETRYIX_KERNEL_STRATEGY_FALLBACK,      // 完全回退
+    RETRYIX_KERNEL_STRATEGY_VENDOR_EXT,    // 廠商/擴展層（建立於最佳標準策略之上）
     RETRYIX_KERNEL_STRATEGY_COUNT
 } retryix_kernel_strategy_t;
 
-// 內核優化等級
+// 工作組調校：依 global size 的 log2 分桶
+#define RETRYIX_KERNEL_TUNING_BUCKETS 64
+#define RETRYIX_KERNEL_TUNING_RUNS    3
+#define RETRYIX_KERNEL_MAX_CANDIDATES 32
+
+// 特化快取
+#define RETRYIX_KERNEL_SPEC_DEFAULT_CAPACITY 256    // 對應 KernelEngine\CacheSize 預設值
+#define RETRYIX_KERNEL_SPEC_MAX_DEFINES      32
+#define RETRYIX_KERNEL_SPEC_MAX_OPTIONS      512
+
+// 前導（通用模板）以嵌入標頭形式提供給分離編譯
+#define RETRYIX_KERNEL_PRELUDE_NAME  "retryix_prelude.h"
+#define RETRYIX_KERNEL_PRELUDE_PARTS 7
+
+// 每執行緒快取的內核實例數
+#define RETRYIX_KERNEL_TLS_SLOTS 16
+
+// 策略名稱（持久化鍵值用，避免依賴列舉數值）
+static const char* STRATEGY_LABELS[RETRYIX_KERNEL_STRATEGY_COUNT] = {
+    "OPENCL20", "OPENCL12_EXT", "OPENCL11_BASIC", "FALLBACK", "VENDOR_EXT"
+};
+
+// 變體量測狀態
 typedef enum {
-    RETRYIX_KERNEL_OPT_NONE = 0,
-    RETRYIX_KERNEL_OPT_BASIC = 1,
-    RETRYIX_KERNEL_OPT_AGGRESSIVE = 2,
-    RETRYIX_KERNEL_OPT_VENDOR_SPECIFIC = 3
-} retryix_kernel_opt_level_t;
+    RETRYIX_KERNEL_BENCH_NOT_RUN = 0,
+    RETRYIX_KERNEL_BENCH_OK,
+    RETRYIX_KERNEL_BENCH_COMPILE_FAILED,
+    RETRYIX_KERNEL_BENCH_LAUNCH_FAILED,
+    RETRYIX_KERNEL_BENCH_INCORRECT
+} retryix_kernel_bench_status_t;
+
+static const char* BENCH_STATUS_LABELS[] = {
+    "not run", "ok", "compile failed", "launch failed", "incorrect"
+};
 
 // 內核變體描述符
+// 內核實例池（每個內核函數一個；實例供不同執行緒/啟動獨立設定參數）
+typedef struct {
+    char name[64];                          // 內核函數名稱
+    uint64_t id;                            // 全域唯一識別（TLS 快取鍵）
+    cl_program program;                     // 所屬程序（不持有參考）
+    cl_kernel prototype;                    // 原型（clCloneKernel 來源）
+    cl_kernel* instances;                   // 池擁有的所有實例
+    size_t instance_count;
+    size_t instance_capacity;
+    cl_kernel* free_list;                   // 可借出的實例
+    size_t free_count;
+    uint64_t const_args;                    // 唯讀指標參數位元遮罩（const / __constant）
+} retryix_kernel_pool_t;
+
 typedef struct {
     char name[64];                          // 內核名稱
     retryix_kernel_strategy_t strategy;     // 編譯策略
-    char* source_code;                      // 源碼
-    size_t source_length;                   // 源碼長度
-    char build_options[512];                // 編譯選項
+    char build_options[1024];               // 編譯選項
+    const char* extra_options;              // 額外編譯選項（特化常數 -D...）
     cl_program program;                     // 編譯後程序
-    cl_kernel kernel;                       // 內核對象
+    cl_kernel kernel;                       // 預設內核原型
+    retryix_kernel_pool_t* pools;           // 程序內每個內核函數的實例池
+    size_t pool_count;
     bool is_compiled;                       // 是否已編譯
     double compile_time;                    // 編譯耗時
     uint64_t last_used;                     // 最後使用時間
     uint32_t use_count;                     // 使用次數
+    size_t kernel_work_group_size;          // CL_KERNEL_WORK_GROUP_SIZE
+    size_t preferred_wg_multiple;           // CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE
+    int bench_status;                       // 變體量測結果（retryix_kernel_bench_status_t）
+    double bench_time_ms;                   // 變體量測耗時
 } retryix_kernel_variant_t;
 
+// 工作組調校結果（每個 global size 分桶一筆）
+typedef struct {
+    bool probed;                            // 已查詢過持久化快取
+    bool is_tuned;                          // 是否有調校結果
+    int strategy;                           // 調校時的變體策略
+    size_t local_size;                      // 最佳 local size（0 = 交由驅動決定）
+    double device_time_ms;                  // 最佳設備時間
+} retryix_kernel_tuning_t;
+
 // 內核模板定義
 typedef struct {
     char template_name[64];                 // 模板名稱
@@ -58,8 +118,38 @@ typedef struct {
     retryix_kernel_variant_t variants[RETRYIX_KERNEL_STRATEGY_COUNT]; // 所有變體
     int active_variant;                     // 當前活動變體
     bool is_universal;                      // 是否為通用模板
+    bool bounds_checked;                    // 內核自行檢查邊界，可補齊 global size
+    retryix_kernel_tuning_t tuning[RETRYIX_KERNEL_TUNING_BUCKETS]; // 工作組調校結果
 } retryix_kernel_template_t;
 
+// 共用程序項目（相同使用者源碼 + 編譯選項只建置一次）
+typedef struct {
+    uint64_t source_hash;
+    const char* user_source;                // 指向模板 base_source（清理前不會釋放）
+    char* build_options;
+    cl_program program;
+} retryix_kernel_program_entry_t;
+
+// 特化編譯狀態
+typedef enum {
+    RETRYIX_KERNEL_SPEC_PENDING = 0,
+    RETRYIX_KERNEL_SPEC_COMPILING,
+    RETRYIX_KERNEL_SPEC_READY,
+    RETRYIX_KERNEL_SPEC_FAILED
+} retryix_kernel_spec_state_t;
+
+// 特化快取項目（鍵：模板名稱 + 正規化後的常數集合）
+typedef struct retryix_kernel_spec {
+    char template_name[64];
+    char* options;                          // 排序後的 -D 選項，同時作為快取鍵
+    const char* user_source;                // 指向模板 base_source（清理前不會釋放）
+    retryix_kernel_variant_t variant;       // 特化變體
+    retryix_kernel_spec_state_t state;
+    uint64_t lru_tick;                      // 最近使用序號
+    int pins;                               // 進行中的啟動數，大於 0 時不可淘汰
+    struct retryix_kernel_spec* next_pending;
+} retryix_kernel_spec_t;
+
 // 內核管理上下文
 typedef struct {
     cl_context context;
@@ -73,11 +163,29 @@ typedef struct {
     bool supports_atomic_64;
     bool supports_images;
     bool supports_svm;
+    
+    // 廠商/擴展能力（VENDOR_EXT 變體使用）
+    bool supports_khr_subgroups;
+    bool supports_intel_subgroups;
+    bool supports_subgroup_shuffle;
+    bool supports_atomic_64_ext;
+    bool supports_fp16;
+    retryix_kernel_opt_level_t opt_level;
+    
     size_t max_work_group_size;
     size_t max_compute_units;
     
+    // 程序建置
+    bool separate_compile;                  // 使用 clCompileProgram + clLinkProgram（OpenCL 1.2+）
+    cl_program prelude_headers[RETRYIX_KERNEL_STRATEGY_COUNT]; // 各策略的前導標頭（巨集與原型）
+    cl_program prelude_libraries[RETRYIX_KERNEL_STRATEGY_COUNT]; // 各策略的前導函式程式庫（-create-library）
+    retryix_kernel_program_entry_t* programs;
+    size_t program_count;
+    size_t program_capacity;
+    uint64_t program_shares;
+    
     // 內核模板池
-    retryix_kernel_template_t* templates;
+    retryix_kernel_template_t** templates;  // 個別配置，擴充時既有模板位址不變
     size_t template_count;
     size_t template_capacity;
     
@@ -91,6 +199,39 @@ typedef struct {
     uint64_t total_executions;
     double total_execution_time;
     size_t peak_memory_usage;
+    
+    // 工作組自動調校
+    cl_command_queue profiling_queue;       // 量測用佇列（可能即為 queue）
+    bool owns_profiling_queue;
+    uint64_t autotune_runs;
+    
+    // 執行期常數特化（LRU，容量取自 KernelEngine\CacheSize）
+    retryix_kernel_spec_t** specs;
+    size_t spec_count;
+    size_t spec_capacity;
+    uint64_t spec_tick;
+    uint64_t spec_hits;
+    uint64_t spec_misses;
+    uint64_t spec_evictions;
+    
+    // 背景編譯（共用執行緒池任務）
+    rix_mutex_t lock;                       // 保護特化快取、待編譯佇列與編譯統計
+    rix_cond_t spec_done_cond;              // 有項目編譯完成
+    retryix_kernel_spec_t* spec_pending_head;
+    retryix_kernel_spec_t* spec_pending_tail;
+    int spec_inflight;                      // 已提交但尚未結束的編譯任務
+    bool spec_stop;
+    
+    // 內核實例
+    rix_mutex_t compile_lock;               // 序列化模板首次編譯
+    bool can_clone_kernel;                  // OpenCL 2.1+ 以 clCloneKernel 建立實例
+    retryix_kernel_pool_t** pool_registry;  // 存活的實例池（依 id 歸還 TLS 淘汰的實例）
+    size_t pool_registry_count;
+    size_t pool_registry_capacity;
+    uint64_t instances_created;
+    
+    // SVM 管理器（啟動時登記間接存取並自動解映射/映射粗粒度配置）
+    retryix_svm_context_t* svm_context;
 } retryix_kernel_context_t;
 
 // 全局內核管理器
@@ -99,23 +240,59 @@ static retryix_kernel_context_t* g_kernel_context = NULL;
 // === 內核源碼模板庫 ===
 
 // 通用原子操作模板
+// RETRYIX_ATOMIC_CAS 在 2.0 變體回傳是否成功、1.x 變體回傳舊值；需要一致語意時使用 RETRYIX_ATOMIC_CAS_VALUE（一律回傳舊值）
 static const char* UNIVERSAL_ATOMIC_TEMPLATE = 
 "// RetryIX Universal Atomic Operations Template\n"
 "#ifdef RETRYIX_OPENCL20\n"
+"  #define RETRYIX_ATOMIC_INT atomic_int\n"
 "  #define RETRYIX_ATOMIC_ADD(ptr, val) atomic_fetch_add_explicit(ptr, val, memory_order_relaxed)\n"
 "  #define RETRYIX_ATOMIC_INC(ptr) atomic_fetch_add_explicit(ptr, 1, memory_order_relaxed)\n"
 "  #define RETRYIX_ATOMIC_CAS(ptr, expected, desired) atomic_compare_exchange_weak_explicit(ptr, &expected, desired, memory_order_relaxed, memory_order_relaxed)\n"
+"  #define RETRYIX_ATOMIC_LOAD(ptr) atomic_load_explicit(ptr, memory_order_relaxed)\n"
+"  #define RETRYIX_ATOMIC_STORE(ptr, val) atomic_store_explicit(ptr, val, memory_order_relaxed)\n"
+"  #define RETRYIX_ATOMIC_CAS_VALUE(ptr, expected, desired) retryix_atomic_cas_value(ptr, expected, desired)\n"
+"  // Strong CAS returning the previous value (defined in the prelude library)\n"
+"  int retryix_atomic_cas_value(volatile __global atomic_int* ptr, int expected, int desired);\n"
 "#elif defined(RETRYIX_OPENCL12_EXT)\n"
 "  #pragma OPENCL EXTENSION cl_khr_global_int32_base_atomics : enable\n"
 "  #pragma OPENCL EXTENSION cl_khr_global_int32_extended_atomics : enable\n"
+"  #define RETRYIX_ATOMIC_INT int\n"
 "  #define RETRYIX_ATOMIC_ADD(ptr, val) atomic_add(ptr, val)\n"
 "  #define RETRYIX_ATOMIC_INC(ptr) atomic_inc(ptr)\n"
 "  #define RETRYIX_ATOMIC_CAS(ptr, expected, desired) atomic_cmpxchg(ptr, expected, desired)\n"
+"  #define RETRYIX_ATOMIC_LOAD(ptr) (*(ptr))\n"
+"  #define RETRYIX_ATOMIC_STORE(ptr, val) (*(ptr) = (val))\n"
+"  #define RETRYIX_ATOMIC_CAS_VALUE(ptr, expected, desired) atomic_cmpxchg(ptr, expected, desired)\n"
+"#elif defined(RETRYIX_OPENCL11_BASIC)\n"
+"  // OpenCL 1.1: 32-bit global atomics are core\n"
+"  #define RETRYIX_ATOMIC_INT int\n"
+"  #define RETRYIX_ATOMIC_ADD(ptr, val) atomic_add(ptr, val)\n"
+"  #define RETRYIX_ATOMIC_INC(ptr) atomic_inc(ptr)\n"
+"  #define RETRYIX_ATOMIC_CAS(ptr, expected, desired) atomic_cmpxchg(ptr, expected, desired)\n"
+"  #define RETRYIX_ATOMIC_LOAD(ptr) (*(ptr))\n"
+"  #define RETRYIX_ATOMIC_STORE(ptr, val) (*(ptr) = (val))\n"
+"  #define RETRYIX_ATOMIC_CAS_VALUE(ptr, expected, desired) atomic_cmpxchg(ptr, expected, desired)\n"
+"#elif defined(RETRYIX_ATOMIC_32)\n"
+"  #pragma OPENCL EXTENSION cl_khr_global_int32_base_atomics : enable\n"
+"  #define RETRYIX_ATOMIC_INT int\n"
+"  #define RETRYIX_ATOMIC_ADD(ptr, val) atom_add(ptr, val)\n"
+"  #define RETRYIX_ATOMIC_INC(ptr) atom_inc(ptr)\n"
+"  #define RETRYIX_ATOMIC_CAS(ptr, expected, desired) atom_cmpxchg(ptr, expected, desired)\n"
+"  #define RETRYIX_ATOMIC_LOAD(ptr) (*(ptr))\n"
+"  #define RETRYIX_ATOMIC_STORE(ptr, val) (*(ptr) = (val))\n"
+"  #define RETRYIX_ATOMIC_CAS_VALUE(ptr, expected, desired) atom_cmpxchg(ptr, expected, desired)\n"
 "#else\n"
-"  // Fallback: Use work-group level synchronization\n"
-"  #define RETRYIX_ATOMIC_ADD(ptr, val) do { barrier(CLK_GLOBAL_MEM_FENCE); *(ptr) += (val); barrier(CLK_GLOBAL_MEM_FENCE); } while(0)\n"
-"  #define RETRYIX_ATOMIC_INC(ptr) do { barrier(CLK_GLOBAL_MEM_FENCE); (*(ptr))++; barrier(CLK_GLOBAL_MEM_FENCE); } while(0)\n"
-"  #define RETRYIX_ATOMIC_CAS(ptr, expected, desired) ({ barrier(CLK_GLOBAL_MEM_FENCE); int old = *(ptr); if (old == (expected)) *(ptr) = (desired); barrier(CLK_GLOBAL_MEM_FENCE); old; })\n"
+"  // No global atomics: barriers cannot order work-groups, so kernels must use the\n"
+"  // two-pass aggregation (retryix_aggregated_store_partial + retryix_reduce_partials)\n"
+"  #define RETRYIX_ATOMIC_TWO_PASS 1\n"
+"  #define RETRYIX_ATOMIC_INT int\n"
+"  #define RETRYIX_ATOMIC_LOAD(ptr) (*(ptr))\n"
+"  #define RETRYIX_ATOMIC_STORE(ptr, val) (*(ptr) = (val))\n"
+"  // Read-modify-write atomics do not exist on this tier: any use fails to compile with a named error\n"
+"  #define RETRYIX_ATOMIC_ADD(ptr, val) retryix_error_requires_global_atomics_use_two_pass()\n"
+"  #define RETRYIX_ATOMIC_INC(ptr) retryix_error_requires_global_atomics_use_two_pass()\n"
+"  #define RETRYIX_ATOMIC_CAS(ptr, expected, desired) retryix_error_requires_global_atomics_use_two_pass()\n"
+"  #define RETRYIX_ATOMIC_CAS_VALUE(ptr, expected, desired) retryix_error_requires_global_atomics_use_two_pass()\n"
 "#endif\n\n";
 
 // 通用記憶體操作模板
@@ -140,6 +317,174 @@ static const char* UNIVERSAL_VECTOR_TEMPLATE =
 "  #define RETRYIX_REAL4 float4\n"
 "#endif\n\n";
 
+// 廠商/擴展模板：子群組 reduce/broadcast/shuffle、fp16、64 位元原子操作
+// 非 VENDOR_EXT 變體或不支援子群組時，以「每個 work-item 自成大小為 1 的子群組」作為可攜回退
+static const char* UNIVERSAL_VENDOR_TEMPLATE =
+"// RetryIX Universal Vendor Extension Template\n"
+"#if defined(RETRYIX_VENDOR_EXT) && defined(RETRYIX_HAS_INTEL_SUBGROUPS)\n"
+"  #pragma OPENCL EXTENSION cl_intel_subgroups : enable\n"
+"  #define RETRYIX_SUBGROUP_NATIVE 1\n"
+"  #define RETRYIX_SUBGROUP_SIZE() get_sub_group_size()\n"
+"  #define RETRYIX_SUBGROUP_LOCAL_ID() get_sub_group_local_id()\n"
+"  #define RETRYIX_SUBGROUP_ID() get_sub_group_id()\n"
+"  #define RETRYIX_NUM_SUBGROUPS() get_num_sub_groups()\n"
+"  #define RETRYIX_SUBGROUP_REDUCE_ADD(x) sub_group_reduce_add(x)\n"
+"  #define RETRYIX_SUBGROUP_BROADCAST(x, id) sub_group_broadcast(x, id)\n"
+"  #define RETRYIX_SUBGROUP_SHUFFLE(x, id) intel_sub_group_shuffle(x, id)\n"
+"#elif defined(RETRYIX_VENDOR_EXT) && defined(RETRYIX_HAS_KHR_SUBGROUPS)\n"
+"  #pragma OPENCL EXTENSION cl_khr_subgroups : enable\n"
+"  #define RETRYIX_SUBGROUP_NATIVE 1\n"
+"  #define RETRYIX_SUBGROUP_SIZE() get_sub_group_size()\n"
+"  #define RETRYIX_SUBGROUP_LOCAL_ID() get_sub_group_local_id()\n"
+"  #define RETRYIX_SUBGROUP_ID() get_sub_group_id()\n"
+"  #define RETRYIX_NUM_SUBGROUPS() get_num_sub_groups()\n"
+"  #define RETRYIX_SUBGROUP_REDUCE_ADD(x) sub_group_reduce_add(x)\n"
+"  #define RETRYIX_SUBGROUP_BROADCAST(x, id) sub_group_broadcast(x, id)\n"
+"  #ifdef RETRYIX_HAS_SUBGROUP_SHUFFLE\n"
+"    #pragma OPENCL EXTENSION cl_khr_subgroup_shuffle : enable\n"
+"    #define RETRYIX_SUBGROUP_SHUFFLE(x, id) sub_group_shuffle(x, id)\n"
+"  #endif\n"
+"#else\n"
+"  // Portable fallback: every work-item is a sub-group of size 1\n"
+"  #define RETRYIX_SUBGROUP_SIZE() 1u\n"
+"  #define RETRYIX_SUBGROUP_LOCAL_ID() 0u\n"
+"  #define RETRYIX_SUBGROUP_ID() ((uint)((get_local_id(2) * get_local_size(1) + get_local_id(1)) * get_local_size(0) + get_local_id(0)))\n"
+"  #define RETRYIX_NUM_SUBGROUPS() ((uint)(get_local_size(0) * get_local_size(1) * get_local_size(2)))\n"
+"  #define RETRYIX_SUBGROUP_REDUCE_ADD(x) (x)\n"
+"  #define RETRYIX_SUBGROUP_BROADCAST(x, id) (x)\n"
+"  #define RETRYIX_SUBGROUP_SHUFFLE(x, id) (x)\n"
+"#endif\n"
+"#if defined(RETRYIX_VENDOR_EXT) && defined(RETRYIX_HAS_FP16)\n"
+"  #pragma OPENCL EXTENSION cl_khr_fp16 : enable\n"
+"  #define RETRYIX_HALF_COMPUTE 1\n"
+"  #define RETRYIX_HALF half\n"
+"  #define RETRYIX_HALF4 half4\n"
+"#else\n"
+"  #define RETRYIX_HALF float\n"
+"  #define RETRYIX_HALF4 float4\n"
+"#endif\n"
+"#ifdef RETRYIX_HALF_COMPUTE\n"
+"  #define RETRYIX_HALF_LOAD(i, p) ((p)[i])\n"
+"  #define RETRYIX_HALF_LOAD4(i, p) vload4(i, p)\n"
+"  #define RETRYIX_HALF_STORE(v, i, p) ((p)[i] = (v))\n"
+"  #define RETRYIX_HALF_STORE4(v, i, p) vstore4(v, i, p)\n"
+"#else\n"
+"  #define RETRYIX_HALF_LOAD(i, p) vload_half(i, p)\n"
+"  #define RETRYIX_HALF_LOAD4(i, p) vload_half4(i, p)\n"
+"  #define RETRYIX_HALF_STORE(v, i, p) vstore_half(v, i, p)\n"
+"  #define RETRYIX_HALF_STORE4(v, i, p) vstore_half4(v, i, p)\n"
+"#endif\n"
+"#ifdef RETRYIX_HAS_INT64_ATOMICS\n"
+"  #pragma OPENCL EXTENSION cl_khr_int64_base_atomics : enable\n"
+"  #define RETRYIX_ATOMIC_ADD64(ptr, val) atom_add(ptr, val)\n"
+"  #define RETRYIX_ATOMIC_CAS64(ptr, expected, desired) atom_cmpxchg(ptr, expected, desired)\n"
+"  #ifdef RETRYIX_HAS_INT64_EXT_ATOMICS\n"
+"    #pragma OPENCL EXTENSION cl_khr_int64_extended_atomics : enable\n"
+"    #define RETRYIX_ATOMIC_MIN64(ptr, val) atom_min(ptr, val)\n"
+"    #define RETRYIX_ATOMIC_MAX64(ptr, val) atom_max(ptr, val)\n"
+"  #else\n"
+"    // Extended 64-bit atomics missing: min/max are CAS loops in the prelude library\n"
+"    long retryix_atomic_min64(volatile __global long* ptr, long val);\n"
+"    long retryix_atomic_max64(volatile __global long* ptr, long val);\n"
+"    #define RETRYIX_ATOMIC_MIN64(ptr, val) retryix_atomic_min64(ptr, val)\n"
+"    #define RETRYIX_ATOMIC_MAX64(ptr, val) retryix_atomic_max64(ptr, val)\n"
+"  #endif\n"
+"#else\n"
+"  // No 64-bit atomics on this device: any use fails to compile with a named error\n"
+"  #define RETRYIX_ATOMIC_ADD64(ptr, val) retryix_error_requires_cl_khr_int64_base_atomics()\n"
+"  #define RETRYIX_ATOMIC_CAS64(ptr, expected, desired) retryix_error_requires_cl_khr_int64_base_atomics()\n"
+"  #define RETRYIX_ATOMIC_MIN64(ptr, val) retryix_error_requires_cl_khr_int64_base_atomics()\n"
+"  #define RETRYIX_ATOMIC_MAX64(ptr, val) retryix_error_requires_cl_khr_int64_base_atomics()\n"
+"#endif\n\n";
+
+// 階層式原子聚合：子群組歸約 -> 工作組 local memory 歸約 -> 每個工作組一次全域原子操作
+// 無全域原子操作時改為兩階段：每組寫入部分和，再由單一工作組歸約
+// scratch 需為 __local int[工作組大小]
+static const char* UNIVERSAL_AGGREGATE_TEMPLATE =
+"// RetryIX Hierarchical Atomic Aggregation Template\n"
+"#define RETRYIX_LOCAL_LINEAR_ID() ((uint)((get_local_id(2) * get_local_size(1) + get_local_id(1)) * get_local_size(0) + get_local_id(0)))\n"
+"#define RETRYIX_GROUP_LINEAR_ID() ((uint)((get_group_id(2) * get_num_groups(1) + get_group_id(1)) * get_num_groups(0) + get_group_id(0)))\n"
+"\n"
+"// Work-group sum; every work-item receives the total. All work-items must call it.\n"
+"int retryix_group_reduce_add(int value, __local int* scratch);\n"
+"#ifndef RETRYIX_ATOMIC_TWO_PASS\n"
+"// One global atomic per work-group instead of one per work-item.\n"
+"void retryix_aggregated_atomic_add(volatile __global RETRYIX_ATOMIC_INT* counter, int value, __local int* scratch);\n"
+"#endif\n"
+"// Two-pass aggregation, pass 1: partials[group] = work-group sum.\n"
+"void retryix_aggregated_store_partial(__global int* partials, int value, __local int* scratch);\n"
+"// Two-pass aggregation, pass 2: launch as a single work-group; *out += sum(partials).\n"
+"void retryix_reduce_partials(__global const int* partials, uint count, __global int* out, __local int* scratch);\n\n";
+
+// 前導函式定義（標頭只有巨集與原型）：分離編譯時每策略編譯一次為程式庫供各模板連結，整體編譯時接在前導之後
+static const char* UNIVERSAL_LIBRARY_TEMPLATE =
+"// RetryIX Prelude Function Library\n"
+"#ifdef RETRYIX_OPENCL20\n"
+"// Weak CAS may fail spuriously with expected unchanged, so use the strong form\n"
+"int retryix_atomic_cas_value(volatile __global atomic_int* ptr, int expected, int desired) {\n"
+"    atomic_compare_exchange_strong_explicit(ptr, &expected, desired, memory_order_relaxed, memory_order_relaxed);\n"
+"    return expected;\n"
+"}\n"
+"#endif\n"
+"\n"
+"#if defined(RETRYIX_HAS_INT64_ATOMICS) && !defined(RETRYIX_HAS_INT64_EXT_ATOMICS)\n"
+"long retryix_atomic_min64(volatile __global long* ptr, long val) {\n"
+"    long old = *ptr;\n"
+"    while (val < old) {\n"
+"        long seen = atom_cmpxchg(ptr, old, val);\n"
+"        if (seen == old) break;\n"
+"        old = seen;\n"
+"    }\n"
+"    return old;\n"
+"}\n"
+"long retryix_atomic_max64(volatile __global long* ptr, long val) {\n"
+"    long old = *ptr;\n"
+"    while (val > old) {\n"
+"        long seen = atom_cmpxchg(ptr, old, val);\n"
+"        if (seen == old) break;\n"
+"        old = seen;\n"
+"    }\n"
+"    return old;\n"
+"}\n"
+"#endif\n"
+"\n"
+"int retryix_group_reduce_add(int value, __local int* scratch) {\n"
+"    uint lid = RETRYIX_LOCAL_LINEAR_ID();\n"
+"    int partial = RETRYIX_SUBGROUP_REDUCE_ADD(value);\n"
+"    if (RETRYIX_SUBGROUP_LOCAL_ID() == 0) scratch[RETRYIX_SUBGROUP_ID()] = partial;\n"
+"    barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    for (uint active = RETRYIX_NUM_SUBGROUPS(); active > 1; ) {\n"
+"        uint half_count = (active + 1) >> 1;\n"
+"        if (lid < active - half_count) scratch[lid] += scratch[lid + half_count];\n"
+"        barrier(CLK_LOCAL_MEM_FENCE);\n"
+"        active = half_count;\n"
+"    }\n"
+"    int total = scratch[0];\n"
+"    barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    return total;\n"
+"}\n"
+"\n"
+"#ifndef RETRYIX_ATOMIC_TWO_PASS\n"
+"void retryix_aggregated_atomic_add(volatile __global RETRYIX_ATOMIC_INT* counter, int value, __local int* scratch) {\n"
+"    int total = retryix_group_reduce_add(value, scratch);\n"
+"    if (RETRYIX_LOCAL_LINEAR_ID() == 0 && total != 0) RETRYIX_ATOMIC_ADD(counter, total);\n"
+"}\n"
+"#endif\n"
+"\n"
+"void retryix_aggregated_store_partial(__global int* partials, int value, __local int* scratch) {\n"
+"    int total = retryix_group_reduce_add(value, scratch);\n"
+"    if (RETRYIX_LOCAL_LINEAR_ID() == 0) partials[RETRYIX_GROUP_LINEAR_ID()] = total;\n"
+"}\n"
+"\n"
+"void retryix_reduce_partials(__global const int* partials, uint count, __global int* out, __local int* scratch) {\n"
+"    uint lid = RETRYIX_LOCAL_LINEAR_ID();\n"
+"    uint size = (uint)(get_local_size(0) * get_local_size(1) * get_local_size(2));\n"
+"    int sum = 0;\n"
+"    for (uint i = lid; i < count; i += size) sum += partials[i];\n"
+"    int total = retryix_group_reduce_add(sum, scratch);\n"
+"    if (lid == 0) *out += total;\n"
+"}\n\n";
+
 // === 內部函數 ===
 
 // 檢測設備能力
@@ -159,6 +504,13 @@ static void probe_device_capabilities(retryix_kernel_context_t* ctx) {
     ctx->supports_atomic_64 = (strstr(extensions, "cl_khr_int64_base_atomics") != NULL);
     ctx->supports_images = (strstr(extensions, "cl_khr_image2d_from_buffer") != NULL);
     
+    // 廠商/擴展能力
+    ctx->supports_khr_subgroups = (strstr(extensions, "cl_khr_subgroups") != NULL);
+    ctx->supports_intel_subgroups = (strstr(extensions, "cl_intel_subgroups") != NULL);
+    ctx->supports_subgroup_shuffle = (strstr(extensions, "cl_khr_subgroup_shuffle") != NULL);
+    ctx->supports_atomic_64_ext = (strstr(extensions, "cl_khr_int64_extended_atomics") != NULL);
+    ctx->supports_fp16 = (strstr(extensions, "cl_khr_fp16") != NULL);
+    
     // SVM 支援檢測
     if (ctx->opencl_major >= 2) {
         cl_bitfield svm_caps = 0;
@@ -176,6 +528,9 @@ static void probe_device_capabilities(retryix_kernel_context_t* ctx) {
     printf("  32-bit Atomics: %s\n", ctx->supports_atomic_32 ? "YES" : "NO");
     printf("  64-bit Atomics: %s\n", ctx->supports_atomic_64 ? "YES" : "NO");
     printf("  SVM Support: %s\n", ctx->supports_svm ? "YES" : "NO");
+    printf("  Subgroups: %s\n", ctx->supports_intel_subgroups ? "cl_intel_subgroups" :
+                                 ctx->supports_khr_subgroups ? "cl_khr_subgroups" : "NO");
+    printf("  FP16 Support: %s\n", ctx->supports_fp16 ? "YES" : "NO");
     printf("  Max Work Group: %zu\n", ctx->max_work_group_size);
     printf("  Compute Units: %zu\n", ctx->max_compute_units);
 }
@@ -184,20 +539,44 @@ static void probe_device_capabilities(retryix_kernel_context_t* ctx) {
 static retryix_kernel_strategy_t select_optimal_strategy(retryix_kernel_context_t* ctx) {
     if (ctx->opencl_major >= 2 && ctx->supports_atomic_32) {
         return RETRYIX_KERNEL_STRATEGY_OPENCL20;
-    } else if (ctx->opencl_major >= 1 && ctx->opencl_minor >= 2 && ctx->supports_atomic_32) {
+    } else if ((ctx->opencl_major > 1 || ctx->opencl_minor >= 2) && ctx->supports_atomic_32) {
         return RETRYIX_KERNEL_STRATEGY_OPENCL12_EXT;
-    } else if (ctx->opencl_major >= 1 && ctx->opencl_minor >= 1) {
+    } else if (ctx->opencl_major > 1 || (ctx->opencl_major == 1 && ctx->opencl_minor >= 1)) {
         return RETRYIX_KERNEL_STRATEGY_OPENCL11_BASIC;
     } else {
         return RETRYIX_KERNEL_STRATEGY_FALLBACK;
     }
 }
 
+// 是否有可用的廠商/擴展功能
+// 64 位原子操作在所有層皆依設備能力輸出，不足以單獨啟用廠商層
+static bool has_vendor_features(retryix_kernel_context_t* ctx) {
+    return ctx->supports_khr_subgroups || ctx->supports_intel_subgroups || ctx->supports_fp16;
+}
+
+// 廠商層需優化等級為 VENDOR_SPECIFIC 且設備具備擴展
+static bool vendor_tier_enabled(retryix_kernel_context_t* ctx) {
+    return ctx->opt_level >= RETRYIX_KERNEL_OPT_VENDOR_SPECIFIC && has_vendor_features(ctx);
+}
+
+// 策略對應的標準層（VENDOR_EXT 建立於最佳標準策略之上）
+static retryix_kernel_strategy_t base_strategy(retryix_kernel_context_t* ctx, retryix_kernel_strategy_t strategy) {
+    return (strategy == RETRYIX_KERNEL_STRATEGY_VENDOR_EXT) ? select_optimal_strategy(ctx) : strategy;
+}
+
+// 各標準層的編譯旗標（依 base_strategy 索引）
+static const char* STRATEGY_BUILD_FLAGS[RETRYIX_KERNEL_STRATEGY_COUNT] = {
+    "-cl-std=CL2.0 -cl-fast-relaxed-math -cl-kernel-arg-info",
+    "-cl-std=CL1.2 -cl-fast-relaxed-math -cl-kernel-arg-info",
+    "-cl-std=CL1.1 -cl-unsafe-math-optimizations",
+    "-cl-std=CL1.0"
+};
+
 // 生成預處理器定義
 static void generate_preprocessor_defines(retryix_kernel_context_t* ctx, retryix_kernel_strategy_t strategy, char* defines, size_t max_len) {
     snprintf(defines, max_len, "#define RETRYIX_DEVICE_COMPUTE_UNITS %zu\n", ctx->max_compute_units);
     
-    switch (strategy) {
+    switch (base_strategy(ctx, strategy)) {
         case RETRYIX_KERNEL_STRATEGY_OPENCL20:
             strncat(defines, "#define RETRYIX_OPENCL20 1\n", max_len - strlen(defines) - 1);
             break;
@@ -223,218 +602,1221 @@ static void generate_preprocessor_defines(retryix_kernel_context_t* ctx, retryix
     if (ctx->supports_atomic_32) {
         strncat(defines, "#define RETRYIX_ATOMIC_32 1\n", max_len - strlen(defines) - 1);
     }
+    
+    // 64 位原子操作：擴展版需基礎版同時存在
+    if (ctx->supports_atomic_64) {
+        strncat(defines, "#define RETRYIX_HAS_INT64_ATOMICS 1\n", max_len - strlen(defines) - 1);
+        if (ctx->supports_atomic_64_ext) {
+            strncat(defines, "#define RETRYIX_HAS_INT64_EXT_ATOMICS 1\n", max_len - strlen(defines) - 1);
+        }
+    }
+    
+    // 廠商層：輸出擴展功能旗標，由 UNIVERSAL_VENDOR_TEMPLATE 展開對應巨集
+    if (strategy == RETRYIX_KERNEL_STRATEGY_VENDOR_EXT) {
+        strncat(defines, "#define RETRYIX_VENDOR_EXT 1\n", max_len - strlen(defines) - 1);
+        if (ctx->supports_intel_subgroups) {
+            strncat(defines, "#define RETRYIX_HAS_INTEL_SUBGROUPS 1\n", max_len - strlen(defines) - 1);
+        }
+        if (ctx->supports_khr_subgroups) {
+            strncat(defines, "#define RETRYIX_HAS_KHR_SUBGROUPS 1\n", max_len - strlen(defines) - 1);
+        }
+        if (ctx->supports_subgroup_shuffle) {
+            strncat(defines, "#define RETRYIX_HAS_SUBGROUP_SHUFFLE 1\n", max_len - strlen(defines) - 1);
+        }
+        if (ctx->supports_fp16) {
+            strncat(defines, "#define RETRYIX_HAS_FP16 1\n", max_len - strlen(defines) - 1);
+        }
+    }
 }
 
-// 生成完整內核源碼
-static char* generate_kernel_source(retryix_kernel_context_t* ctx, const char* user_source, retryix_kernel_strategy_t strategy) {
-    char defines[1024] = {0};
-    generate_preprocessor_defines(ctx, strategy, defines, sizeof(defines));
+// 收集前導源碼片段（預處理器定義 + 通用模板），回傳片段數
+static cl_uint collect_prelude_sources(retryix_kernel_context_t* ctx, retryix_kernel_strategy_t strategy,
+                                       char* defines, size_t max_len, const char** strings) {
+    generate_preprocessor_defines(ctx, strategy, defines, max_len);
+    
+    cl_uint count = 0;
+    strings[count++] = defines;
+    strings[count++] = "\n";
+    strings[count++] = UNIVERSAL_ATOMIC_TEMPLATE;
+    strings[count++] = UNIVERSAL_MEMORY_TEMPLATE;
+    strings[count++] = UNIVERSAL_VECTOR_TEMPLATE;
+    strings[count++] = UNIVERSAL_VENDOR_TEMPLATE;
+    strings[count++] = UNIVERSAL_AGGREGATE_TEMPLATE;
+    return count;
+}
+
+// 打印編譯/連結日誌
+static void print_build_log(retryix_kernel_context_t* ctx, cl_program program, const char* name) {
+    size_t log_size = 0;
+    clGetProgramBuildInfo(program, ctx->device, CL_PROGRAM_BUILD_LOG, 0, NULL, &log_size);
+    if (log_size > 1) {
+        char* build_log = (char*)malloc(log_size);
+        if (!build_log) return;
+        clGetProgramBuildInfo(program, ctx->device, CL_PROGRAM_BUILD_LOG, log_size, build_log, NULL);
+        printf("Kernel compilation failed for %s:\n%s\n", name, build_log);
+        free(build_log);
+    }
+}
+
+// 取得策略的前導標頭程序（每策略只建立一次）
+static cl_program get_prelude_header(retryix_kernel_context_t* ctx, retryix_kernel_strategy_t strategy) {
+    rix_mutex_lock(&ctx->lock);
+    cl_program header = ctx->prelude_headers[strategy];
+    if (!header) {
+        char defines[1024] = {0};
+        const char* strings[RETRYIX_KERNEL_PRELUDE_PARTS];
+        cl_uint count = collect_prelude_sources(ctx, strategy, defines, sizeof(defines), strings);
+        
+        cl_int err;
+        header = clCreateProgramWithSource(ctx->context, count, strings, NULL, &err);
+        if (err != CL_SUCCESS) header = NULL;
+        ctx->prelude_headers[strategy] = header;
+    }
+    rix_mutex_unlock(&ctx->lock);
+    return header;
+}
+
+// 取得策略的前導函式程式庫（每策略只編譯一次；鎖外編譯，競爭時保留先發佈者）
+static cl_program get_prelude_library(retryix_kernel_context_t* ctx, retryix_kernel_strategy_t strategy,
+                                      cl_program header, cl_int* out_err) {
+    rix_mutex_lock(&ctx->lock);
+    cl_program library = ctx->prelude_libraries[strategy];
+    rix_mutex_unlock(&ctx->lock);
+    if (library) {
+        *out_err = CL_SUCCESS;
+        return library;
+    }
+    
+    const char* strings[2] = {
+        "#include \"" RETRYIX_KERNEL_PRELUDE_NAME "\"\n",
+        UNIVERSAL_LIBRARY_TEMPLATE
+    };
+    const char* header_names[1] = { RETRYIX_KERNEL_PRELUDE_NAME };
     
-    // 計算所需緩衝區大小
-    size_t total_size = strlen(defines) + strlen(UNIVERSAL_ATOMIC_TEMPLATE) + 
-                       strlen(UNIVERSAL_MEMORY_TEMPLATE) + strlen(UNIVERSAL_VECTOR_TEMPLATE) + 
-                       strlen(user_source) + 512; // 額外空間
+    cl_int err;
+    cl_program object = clCreateProgramWithSource(ctx->context, 2, strings, NULL, &err);
+    if (err != CL_SUCCESS) {
+        *out_err = err;
+        return NULL;
+    }
     
-    char* complete_source = (char*)malloc(total_size);
-    if (!complete_source) return NULL;
+    const char* flags = STRATEGY_BUILD_FLAGS[base_strategy(ctx, strategy)];
+    err = clCompileProgram(object, 1, &ctx->device, flags, 1, &header, header_names, NULL, NULL);
+    if (err != CL_SUCCESS) {
+        if (err == CL_COMPILE_PROGRAM_FAILURE) print_build_log(ctx, object, "prelude library");
+        clReleaseProgram(object);
+        *out_err = err;
+        return NULL;
+    }
     
-    // 組裝完整源碼
-    snprintf(complete_source, total_size,
-        "%s\n%s%s%s\n// === User Kernel Code ===\n%s\n",
-        defines, UNIVERSAL_ATOMIC_TEMPLATE, UNIVERSAL_MEMORY_TEMPLATE, 
-        UNIVERSAL_VECTOR_TEMPLATE, user_source);
+    library = clLinkProgram(ctx->context, 1, &ctx->device, "-create-library", 1, &object, NULL, NULL, &err);
+    clReleaseProgram(object);
+    if (err != CL_SUCCESS) {
+        if (library) {
+            print_build_log(ctx, library, "prelude library");
+            clReleaseProgram(library);
+        }
+        *out_err = err;
+        return NULL;
+    }
     
-    return complete_source;
+    rix_mutex_lock(&ctx->lock);
+    if (ctx->prelude_libraries[strategy]) {
+        clReleaseProgram(library);
+        library = ctx->prelude_libraries[strategy];
+    } else {
+        ctx->prelude_libraries[strategy] = library;
+    }
+    rix_mutex_unlock(&ctx->lock);
+    *out_err = CL_SUCCESS;
+    return library;
 }
 
-// 編譯內核變體
-static int compile_kernel_variant(retryix_kernel_context_t* ctx, retryix_kernel_variant_t* variant, const char* user_source) {
-    if (variant->is_compiled) return 0; // 已編譯
+// 分離編譯：使用者源碼以嵌入標頭引入前導巨集與原型，再與策略的前導程式庫連結為可執行程序
+static cl_program build_program_separate(retryix_kernel_context_t* ctx, retryix_kernel_variant_t* variant,
+                                         const char* user_source, cl_int* out_err) {
+    cl_program header = get_prelude_header(ctx, variant->strategy);
+    if (!header) {
+        *out_err = CL_OUT_OF_HOST_MEMORY;
+        return NULL;
+    }
     
-    clock_t start = clock();
+    cl_int err;
+    cl_program library = get_prelude_library(ctx, variant->strategy, header, &err);
+    if (!library) {
+        // 前導程式庫失敗並非使用者源碼錯誤，交由呼叫端改用整體編譯
+        *out_err = (err == CL_COMPILE_PROGRAM_FAILURE) ? CL_LINK_PROGRAM_FAILURE : err;
+        return NULL;
+    }
     
-    // 生成完整源碼
-    char* complete_source = generate_kernel_source(ctx, user_source, variant->strategy);
-    if (!complete_source) return -1;
+    const char* strings[2] = {
+        "#include \"" RETRYIX_KERNEL_PRELUDE_NAME "\"\n// === User Kernel Code ===\n",
+        user_source
+    };
+    const char* header_names[1] = { RETRYIX_KERNEL_PRELUDE_NAME };
     
-    variant->source_code = complete_source;
-    variant->source_length = strlen(complete_source);
+    cl_program object = clCreateProgramWithSource(ctx->context, 2, strings, NULL, &err);
+    if (err != CL_SUCCESS) {
+        *out_err = err;
+        return NULL;
+    }
     
-    // 創建程序
-    cl_int err;
-    variant->program = clCreateProgramWithSource(ctx->context, 1, (const char**)&variant->source_code, 
-                                               &variant->source_length, &err);
+    err = clCompileProgram(object, 1, &ctx->device, variant->build_options, 1, &header, header_names, NULL, NULL);
     if (err != CL_SUCCESS) {
-        printf("Failed to create program for variant %s: %d\n", variant->name, err);
-        free(complete_source);
-        return -1;
+        if (err == CL_COMPILE_PROGRAM_FAILURE) print_build_log(ctx, object, variant->name);
+        clReleaseProgram(object);
+        *out_err = err;
+        return NULL;
     }
     
-    // 設定編譯選項
-    const char* strategy_names[] = {
-        "-cl-std=CL2.0 -cl-fast-relaxed-math",
-        "-cl-std=CL1.2 -cl-fast-relaxed-math", 
-        "-cl-std=CL1.1 -cl-unsafe-math-optimizations",
-        "-cl-std=CL1.0"
-    };
+    cl_program inputs[2] = { object, library };
+    cl_program linked = clLinkProgram(ctx->context, 1, &ctx->device, NULL, 2, inputs, NULL, NULL, &err);
+    clReleaseProgram(object);
+    if (err != CL_SUCCESS) {
+        if (linked) {
+            print_build_log(ctx, linked, variant->name);
+            clReleaseProgram(linked);
+        }
+        *out_err = err;
+        return NULL;
+    }
     
-    snprintf(variant->build_options, sizeof(variant->build_options), "%s -DRETRYIX_VARIANT_%d=1", 
-             strategy_names[variant->strategy], (int)variant->strategy);
+    *out_err = CL_SUCCESS;
+    return linked;
+}
+
+// 整體編譯：前導、前導函式與使用者源碼以多段字串交給 clBuildProgram（OpenCL 1.1 或分離編譯不可用時）
+static cl_program build_program_concatenated(retryix_kernel_context_t* ctx, retryix_kernel_variant_t* variant,
+                                             const char* user_source) {
+    char defines[1024] = {0};
+    const char* strings[RETRYIX_KERNEL_PRELUDE_PARTS + 3];
+    cl_uint count = collect_prelude_sources(ctx, variant->strategy, defines, sizeof(defines), strings);
+    strings[count++] = UNIVERSAL_LIBRARY_TEMPLATE;
+    strings[count++] = "\n// === User Kernel Code ===\n";
+    strings[count++] = user_source;
     
-    // 編譯程序
-    err = clBuildProgram(variant->program, 1, &ctx->device, variant->build_options, NULL, NULL);
+    cl_int err;
+    cl_program program = clCreateProgramWithSource(ctx->context, count, strings, NULL, &err);
+    if (err != CL_SUCCESS) {
+        printf("Failed to create program for variant %s: %d\n", variant->name, err);
+        return NULL;
+    }
     
+    err = clBuildProgram(program, 1, &ctx->device, variant->build_options, NULL, NULL);
     if (err != CL_SUCCESS) {
-        // 獲取編譯日誌
-        size_t log_size;
-        clGetProgramBuildInfo(variant->program, ctx->device, CL_PROGRAM_BUILD_LOG, 0, NULL, &log_size);
-        if (log_size > 1) {
-            char* build_log = (char*)malloc(log_size);
-            clGetProgramBuildInfo(variant->program, ctx->device, CL_PROGRAM_BUILD_LOG, log_size, build_log, NULL);
-            printf("Kernel compilation failed for %s:\n%s\n", variant->name, build_log);
-            free(build_log);
-        }
+        print_build_log(ctx, program, variant->name);
+        clReleaseProgram(program);
+        return NULL;
+    }
+    return program;
+}
+
+static cl_program build_variant_program(retryix_kernel_context_t* ctx, retryix_kernel_variant_t* variant,
+                                        const char* user_source) {
+    if (ctx->separate_compile) {
+        cl_int err;
+        cl_program program = build_program_separate(ctx, variant, user_source, &err);
+        if (program || err == CL_COMPILE_PROGRAM_FAILURE) return program; // 源碼錯誤不需重試
         
-        clReleaseProgram(variant->program);
-        variant->program = NULL;
+        // 編譯器/連結器不支援分離編譯，之後一律改用整體編譯
+        printf("Separate compilation unavailable (%d), falling back to full builds\n", err);
+        ctx->separate_compile = false;
+    }
+    return build_program_concatenated(ctx, variant, user_source);
+}
+
+// 64 位 FNV-1a
+static uint64_t hash_source(const char* text) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (const unsigned char* p = (const unsigned char*)text; *p; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// 查找相同源碼與選項的已編譯程序，命中時回傳新增參考
+static cl_program lookup_shared_program(retryix_kernel_context_t* ctx, uint64_t hash, const char* user_source,
+                                        const char* build_options) {
+    cl_program program = NULL;
+    rix_mutex_lock(&ctx->lock);
+    for (size_t i = 0; i < ctx->program_count; i++) {
+        retryix_kernel_program_entry_t* entry = &ctx->programs[i];
+        if (entry->source_hash == hash && strcmp(entry->build_options, build_options) == 0 &&
+            strcmp(entry->user_source, user_source) == 0) {
+            program = entry->program;
+            clRetainProgram(program);
+            ctx->program_shares++;
+            break;
+        }
+    }
+    rix_mutex_unlock(&ctx->lock);
+    return program;
+}
+
+// 登記新程序供其他模板共用（失敗時僅不共用）
+static void publish_shared_program(retryix_kernel_context_t* ctx, uint64_t hash, const char* user_source,
+                                   const char* build_options, cl_program program) {
+    rix_mutex_lock(&ctx->lock);
+    if (ctx->program_count >= ctx->program_capacity) {
+        size_t new_capacity = ctx->program_capacity ? ctx->program_capacity * 2 : 32;
+        retryix_kernel_program_entry_t* grown = (retryix_kernel_program_entry_t*)realloc(ctx->programs,
+                                                  new_capacity * sizeof(retryix_kernel_program_entry_t));
+        if (!grown) {
+            rix_mutex_unlock(&ctx->lock);
+            return;
+        }
+        ctx->programs = grown;
+        ctx->program_capacity = new_capacity;
+    }
+    
+    retryix_kernel_program_entry_t* entry = &ctx->programs[ctx->program_count];
+    entry->build_options = strdup(build_options);
+    if (entry->build_options) {
+        entry->source_hash = hash;
+        entry->user_source = user_source;
+        entry->program = program;
+        clRetainProgram(program);
+        ctx->program_count++;
+    }
+    rix_mutex_unlock(&ctx->lock);
+}
+
+// === 內核實例池 ===
+
+// 實例池識別序號（跨管理器生命週期遞增，TLS 快取不會誤用舊池的實例）
+static volatile uint64_t g_kernel_pool_ids = 0;
+
+// 每執行緒實例快取：快速路徑無鎖
+typedef struct {
+    uint64_t pool_id;
+    cl_kernel kernel;
+} retryix_kernel_tls_slot_t;
+
+static RIX_THREAD_LOCAL retryix_kernel_tls_slot_t t_instance_slots[RETRYIX_KERNEL_TLS_SLOTS];
+static RIX_THREAD_LOCAL unsigned int t_instance_victim;
+
+// 查詢唯讀指標參數（需以 -cl-kernel-arg-info 建置；無資訊時回傳 0，所有緩衝區視為讀寫）
+static uint64_t query_const_args(cl_kernel kernel) {
+    uint64_t mask = 0;
+#if CL_TARGET_OPENCL_VERSION >= 120
+    cl_uint num_args = 0;
+    if (clGetKernelInfo(kernel, CL_KERNEL_NUM_ARGS, sizeof(num_args), &num_args, NULL) != CL_SUCCESS) return 0;
+    
+    for (cl_uint i = 0; i < num_args && i < 64; i++) {
+        cl_kernel_arg_address_qualifier address = 0;
+        cl_kernel_arg_type_qualifier type = 0;
+        if (clGetKernelArgInfo(kernel, i, CL_KERNEL_ARG_ADDRESS_QUALIFIER, sizeof(address), &address, NULL) != CL_SUCCESS ||
+            clGetKernelArgInfo(kernel, i, CL_KERNEL_ARG_TYPE_QUALIFIER, sizeof(type), &type, NULL) != CL_SUCCESS) {
+            return 0;
+        }
+        if (address == CL_KERNEL_ARG_ADDRESS_CONSTANT ||
+            (address == CL_KERNEL_ARG_ADDRESS_GLOBAL && (type & CL_KERNEL_ARG_TYPE_CONST))) {
+            mask |= (uint64_t)1 << i;
+        }
+    }
+#else
+    (void)kernel;
+#endif
+    return mask;
+}
+
+// 為程序內所有內核函數建立實例池，variant->kernel 指向預設內核的原型
+static int create_variant_pools(retryix_kernel_context_t* ctx, retryix_kernel_variant_t* variant) {
+    cl_uint count = 0;
+    cl_int err = clCreateKernelsInProgram(variant->program, 0, NULL, &count);
+    if (err != CL_SUCCESS || count == 0) {
+        printf("Failed to create kernels for %s: %d\n", variant->name, err);
         return -1;
     }
     
-    // 創建內核對象
-    variant->kernel = clCreateKernel(variant->program, variant->name, &err);
-    if (err != CL_SUCCESS) {
-        printf("Failed to create kernel %s: %d\n", variant->name, err);
-        clReleaseProgram(variant->program);
-        variant->program = NULL;
+    cl_kernel* kernels = (cl_kernel*)malloc(count * sizeof(cl_kernel));
+    retryix_kernel_pool_t* pools = (retryix_kernel_pool_t*)calloc(count, sizeof(retryix_kernel_pool_t));
+    if (!kernels || !pools || clCreateKernelsInProgram(variant->program, count, kernels, NULL) != CL_SUCCESS) {
+        printf("Failed to create kernels for %s\n", variant->name);
+        free(kernels);
+        free(pools);
         return -1;
     }
     
-    variant->is_compiled = true;
-    variant->compile_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+    variant->kernel = NULL;
+    for (cl_uint i = 0; i < count; i++) {
+        retryix_kernel_pool_t* pool = &pools[i];
+        pool->prototype = kernels[i];
+        pool->program = variant->program;
+        pool->id = rix_atomic_inc_u64(&g_kernel_pool_ids);
+        clGetKernelInfo(kernels[i], CL_KERNEL_FUNCTION_NAME, sizeof(pool->name) - 1, pool->name, NULL);
+        pool->const_args = query_const_args(kernels[i]);
+        
+        // 指定名稱的模板以該內核為預設，整個程序註冊的模板以第一個內核為預設
+        if (variant->name[0] ? strcmp(pool->name, variant->name) == 0 : i == 0) {
+            variant->kernel = kernels[i];
+        }
+    }
+    free(kernels);
     
-    // 更新統計
-    ctx->total_compiles++;
-    ctx->total_compile_time += variant->compile_time;
+    if (!variant->kernel) {
+        printf("Failed to create kernel %s: not found in program\n", variant->name);
+        for (cl_uint i = 0; i < count; i++) clReleaseKernel(pools[i].prototype);
+        free(pools);
+        return -1;
+    }
     
-    printf("Kernel variant compiled: %s (%.3f seconds, strategy %d)\n", 
-           variant->name, variant->compile_time, variant->strategy);
+    // 登記實例池，供 TLS 快取淘汰時依 id 歸還實例
+    rix_mutex_lock(&ctx->lock);
+    if (ctx->pool_registry_count + count > ctx->pool_registry_capacity) {
+        size_t new_capacity = ctx->pool_registry_capacity ? ctx->pool_registry_capacity : 64;
+        while (new_capacity < ctx->pool_registry_count + count) new_capacity *= 2;
+        retryix_kernel_pool_t** grown = (retryix_kernel_pool_t**)realloc(ctx->pool_registry,
+                                                                       new_capacity * sizeof(retryix_kernel_pool_t*));
+        if (grown) {
+            ctx->pool_registry = grown;
+            ctx->pool_registry_capacity = new_capacity;
+        }
+    }
+    for (cl_uint i = 0; i < count && ctx->pool_registry_count < ctx->pool_registry_capacity; i++) {
+        ctx->pool_registry[ctx->pool_registry_count++] = &pools[i];
+    }
+    rix_mutex_unlock(&ctx->lock);
     
+    variant->pools = pools;
+    variant->pool_count = count;
     return 0;
 }
 
-// === 公開 API ===
+// 釋放變體的所有實例池，呼叫端需持有 ctx->lock
+static void destroy_variant_pools(retryix_kernel_context_t* ctx, retryix_kernel_variant_t* variant) {
+    for (size_t i = 0; i < variant->pool_count; i++) {
+        retryix_kernel_pool_t* pool = &variant->pools[i];
+        
+        for (size_t r = 0; r < ctx->pool_registry_count; r++) {
+            if (ctx->pool_registry[r] == pool) {
+                ctx->pool_registry[r] = ctx->pool_registry[--ctx->pool_registry_count];
+                break;
+            }
+        }
+        
+        for (size_t k = 0; k < pool->instance_count; k++) {
+            clReleaseKernel(pool->instances[k]);
+        }
+        free(pool->instances);
+        free(pool->free_list);
+        clReleaseKernel(pool->prototype);
+    }
+    free(variant->pools);
+    variant->pools = NULL;
+    variant->pool_count = 0;
+    variant->kernel = NULL;
+}
 
-// 初始化內核管理器
-int retryix_kernel_init(cl_context context, cl_device_id device, cl_command_queue queue) {
-    if (g_kernel_context) return 0; // 已初始化
-    
-    retryix_kernel_context_t* ctx = (retryix_kernel_context_t*)calloc(1, sizeof(retryix_kernel_context_t));
-    if (!ctx) return -1;
-    
-    ctx->context = context;
-    ctx->device = device;
-    ctx->queue = queue;
-    
-    // 檢測設備能力
-    probe_device_capabilities(ctx);
+// 依內核函數名稱查找實例池（NULL 表示預設內核）
+static retryix_kernel_pool_t* find_pool(retryix_kernel_variant_t* variant, const char* kernel_name) {
+    for (size_t i = 0; i < variant->pool_count; i++) {
+        retryix_kernel_pool_t* pool = &variant->pools[i];
+        if (kernel_name ? strcmp(pool->name, kernel_name) == 0 : pool->prototype == variant->kernel) {
+            return pool;
+        }
+    }
+    return NULL;
+}
+
+// 取出閒置實例或建立新實例，呼叫端需持有 ctx->lock
+static cl_kernel take_pool_instance(retryix_kernel_context_t* ctx, retryix_kernel_pool_t* pool) {
+    if (pool->free_count > 0) {
+        return pool->free_list[--pool->free_count];
+    }
     
-    // 初始化模板池
-    ctx->template_capacity = 32;
-    ctx->templates = (retryix_kernel_template_t*)calloc(ctx->template_capacity, sizeof(retryix_kernel_template_t));
-    if (!ctx->templates) {
-        free(ctx);
-        return -1;
+    if (pool->instance_count >= pool->instance_capacity) {
+        size_t new_capacity = pool->instance_capacity ? pool->instance_capacity * 2 : 4;
+        cl_kernel* instances = (cl_kernel*)realloc(pool->instances, new_capacity * sizeof(cl_kernel));
+        if (!instances) return NULL;
+        pool->instances = instances;
+        cl_kernel* free_list = (cl_kernel*)realloc(pool->free_list, new_capacity * sizeof(cl_kernel));
+        if (!free_list) return NULL;
+        pool->free_list = free_list;
+        pool->instance_capacity = new_capacity;
     }
     
-    g_kernel_context = ctx;
+    cl_int err;
+    cl_kernel kernel;
+#if CL_TARGET_OPENCL_VERSION >= 210
+    if (ctx->can_clone_kernel) {
+        kernel = clCloneKernel(pool->prototype, &err);
+    } else
+#endif
+    {
+        kernel = clCreateKernel(pool->program, pool->name, &err);
+    }
+    if (err != CL_SUCCESS) {
+        printf("Failed to create kernel instance %s: %d\n", pool->name, err);
+        return NULL;
+    }
     
-    printf("RetryIX Kernel Manager initialized\n");
-    return 0;
+    pool->instances[pool->instance_count++] = kernel;
+    ctx->instances_created++;
+    return kernel;
 }
 
-// 註冊內核模板
-int retryix_kernel_register_template(const char* template_name, const char* kernel_name, const char* source_code) {
-    if (!g_kernel_context || !template_name || !kernel_name || !source_code) return -1;
+// 將實例歸還所屬池，呼叫端需持有 ctx->lock
+static bool return_pool_instance(retryix_kernel_pool_t* pool, cl_kernel kernel) {
+    for (size_t k = 0; k < pool->instance_count; k++) {
+        if (pool->instances[k] == kernel) {
+            pool->free_list[pool->free_count++] = kernel;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 取得呼叫執行緒專屬的實例（同一執行緒重複啟動不需加鎖）
+static cl_kernel thread_instance(retryix_kernel_context_t* ctx, retryix_kernel_pool_t* pool) {
+    retryix_kernel_tls_slot_t* slot = NULL;
+    for (int i = 0; i < RETRYIX_KERNEL_TLS_SLOTS; i++) {
+        if (t_instance_slots[i].kernel && t_instance_slots[i].pool_id == pool->id) {
+            return t_instance_slots[i].kernel;
+        }
+        if (!slot && !t_instance_slots[i].kernel) slot = &t_instance_slots[i];
+    }
+    if (!slot) {
+        slot = &t_instance_slots[t_instance_victim++ % RETRYIX_KERNEL_TLS_SLOTS];
+    }
     
-    retryix_kernel_context_t* ctx = g_kernel_context;
+    rix_mutex_lock(&ctx->lock);
+    // 被替換的實例歸還原池（池已釋放時其實例亦已釋放，直接丟棄）
+    if (slot->kernel) {
+        for (size_t r = 0; r < ctx->pool_registry_count; r++) {
+            if (ctx->pool_registry[r]->id == slot->pool_id) {
+                return_pool_instance(ctx->pool_registry[r], slot->kernel);
+                break;
+            }
+        }
+        slot->kernel = NULL;
+    }
+    cl_kernel kernel = take_pool_instance(ctx, pool);
+    rix_mutex_unlock(&ctx->lock);
     
-    // 檢查容量
-    if (ctx->template_count >= ctx->template_capacity) {
-        ctx->template_capacity *= 2;
-        ctx->templates = (retryix_kernel_template_t*)realloc(ctx->templates, 
-                                                           ctx->template_capacity * sizeof(retryix_kernel_template_t));
-        if (!ctx->templates) return -1;
+    if (kernel) {
+        slot->pool_id = pool->id;
+        slot->kernel = kernel;
     }
+    return kernel;
+}
+
+// 編譯內核變體
+static int compile_kernel_variant(retryix_kernel_context_t* ctx, retryix_kernel_variant_t* variant, const char* user_source) {
+    if (variant->is_compiled) return 0; // 已編譯
     
-    retryix_kernel_template_t* tmpl = &ctx->templates[ctx->template_count];
-    strncpy(tmpl->template_name, template_name, sizeof(tmpl->template_name) - 1);
+    clock_t start = clock();
     
-    tmpl->base_source = strdup(source_code);
-    tmpl->active_variant = -1;
-    tmpl->is_universal = true;
+    // 設定編譯選項
+    snprintf(variant->build_options, sizeof(variant->build_options), "%s -DRETRYIX_VARIANT_%d=1 %s", 
+             STRATEGY_BUILD_FLAGS[base_strategy(ctx, variant->strategy)], (int)variant->strategy,
+             variant->extra_options ? variant->extra_options : "");
+    
+    // 相同源碼與選項的模板共用程序（特化變體有自己的 LRU，不共用）
+    bool shareable = (variant->extra_options == NULL);
+    uint64_t hash = shareable ? hash_source(user_source) : 0;
+    variant->program = shareable ? lookup_shared_program(ctx, hash, user_source, variant->build_options) : NULL;
+    
+    if (!variant->program) {
+        variant->program = build_variant_program(ctx, variant, user_source);
+        if (!variant->program) return -1;
+        if (shareable) publish_shared_program(ctx, hash, user_source, variant->build_options, variant->program);
+    }
     
-    // 為所有策略創建變體
-    for (int i = 0; i < RETRYIX_KERNEL_STRATEGY_COUNT; i++) {
-        retryix_kernel_variant_t* variant = &tmpl->variants[i];
-        strncpy(variant->name, kernel_name, sizeof(variant->name) - 1);
-        variant->strategy = (retryix_kernel_strategy_t)i;
-        variant->is_compiled = false;
+    // 創建程序內所有內核的實例池
+    if (create_variant_pools(ctx, variant) != 0) {
+        clReleaseProgram(variant->program);
         variant->program = NULL;
-        variant->kernel = NULL;
-        variant->source_code = NULL;
+        return -1;
     }
     
-    ctx->template_count++;
+    // 查詢內核工作組限制
+    variant->kernel_work_group_size = 0;
+    variant->preferred_wg_multiple = 0;
+    clGetKernelWorkGroupInfo(variant->kernel, ctx->device, CL_KERNEL_WORK_GROUP_SIZE,
+                             sizeof(size_t), &variant->kernel_work_group_size, NULL);
+    clGetKernelWorkGroupInfo(variant->kernel, ctx->device, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE,
+                             sizeof(size_t), &variant->preferred_wg_multiple, NULL);
+    
+    variant->is_compiled = true;
+    variant->compile_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+    
+    // 更新統計（特化變體由背景執行緒編譯）
+    rix_mutex_lock(&ctx->lock);
+    ctx->total_compiles++;
+    ctx->total_compile_time += variant->compile_time;
+    rix_mutex_unlock(&ctx->lock);
+    
+    printf("Kernel variant compiled: %s (%.3f seconds, strategy %d)\n", 
+           variant->name, variant->compile_time, variant->strategy);
     
-    printf("Kernel template registered: %s (%s)\n", template_name, kernel_name);
     return 0;
 }
 
-// 編譯最佳內核變體
-cl_kernel retryix_kernel_compile_best(const char* template_name) {
-    if (!g_kernel_context || !template_name) return NULL;
-    
-    retryix_kernel_context_t* ctx = g_kernel_context;
-    
-    // 查找模板
-    retryix_kernel_template_t* tmpl = NULL;
+// 查找模板，呼叫端需持有 ctx->lock
+static retryix_kernel_template_t* find_template_locked(retryix_kernel_context_t* ctx, const char* template_name) {
     for (size_t i = 0; i < ctx->template_count; i++) {
-        if (strcmp(ctx->templates[i].template_name, template_name) == 0) {
-            tmpl = &ctx->templates[i];
-            break;
+        if (strcmp(ctx->templates[i]->template_name, template_name) == 0) {
+            return ctx->templates[i];
         }
     }
-    
-    if (!tmpl) {
-        printf("Template not found: %s\n", template_name);
+    return NULL;
+}
+
+// 查找模板（模板註冊後不會移動或釋放，回傳指標可於解鎖後使用）
+static retryix_kernel_template_t* find_template(retryix_kernel_context_t* ctx, const char* template_name) {
+    rix_mutex_lock(&ctx->lock);
+    retryix_kernel_template_t* tmpl = find_template_locked(ctx, template_name);
+    rix_mutex_unlock(&ctx->lock);
+    return tmpl;
+}
+
+// 設定內核參數（value, size, ..., NULL）
+static int set_kernel_args_va(cl_kernel kernel, va_list args) {
+    int arg_index = 0;
+    while (1) {
+        void* arg_value = va_arg(args, void*);
+        if (!arg_value) break; // NULL 表示參數結束
+        
+        size_t arg_size = va_arg(args, size_t);
+        cl_int err = clSetKernelArg(kernel, arg_index++, arg_size, arg_value);
+        if (err != CL_SUCCESS) {
+            printf("Failed to set kernel argument %d: %d\n", arg_index - 1, err);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// === 工作組自動調校 ===
+
+// global size 分桶（floor(log2)）
+static int tuning_bucket(size_t global_work_size) {
+    int bucket = 0;
+    while (global_work_size > 1 && bucket < RETRYIX_KERNEL_TUNING_BUCKETS - 1) {
+        global_work_size >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+// 計算實際啟動的 global size，無法安全啟動時回傳 false
+static bool resolve_launch_geometry(retryix_kernel_context_t* ctx, retryix_kernel_template_t* tmpl,
+                                    retryix_kernel_variant_t* variant,
+                                    size_t global_work_size, size_t local_size, size_t* out_global) {
+    *out_global = global_work_size;
+    if (local_size == 0 || global_work_size % local_size == 0) return true;
+    
+    // OpenCL 2.0 允許非均勻工作組（廠商層依其標準層判斷）
+    if (base_strategy(ctx, variant->strategy) == RETRYIX_KERNEL_STRATEGY_OPENCL20) return true;
+    
+    // 其餘策略需補齊 global size，內核必須自行檢查邊界
+    if (tmpl->bounds_checked) {
+        *out_global = (global_work_size + local_size - 1) / local_size * local_size;
+        return true;
+    }
+    return false;
+}
+
+// 候選 local size：偏好倍數的 1,2,3,4,8,16... 倍，上限為內核與設備限制
+static size_t build_local_candidates(retryix_kernel_context_t* ctx, retryix_kernel_variant_t* variant,
+                                     size_t* out, size_t max_out) {
+    size_t limit = variant->kernel_work_group_size ? variant->kernel_work_group_size : ctx->max_work_group_size;
+    if (ctx->max_work_group_size && ctx->max_work_group_size < limit) limit = ctx->max_work_group_size;
+    size_t multiple = variant->preferred_wg_multiple ? variant->preferred_wg_multiple : 1;
+    
+    size_t count = 0;
+    out[count++] = 0; // 驅動預設作為基準
+    if (limit == 0 || multiple > limit) return count;
+    
+    for (size_t k = 1; multiple * k <= limit && count < max_out; k = (k < 4) ? k + 1 : k * 2) {
+        out[count++] = multiple * k;
+    }
+    
+    size_t top = (limit / multiple) * multiple;
+    if (count < max_out && out[count - 1] != top) {
+        out[count++] = top;
+    }
+    return count;
+}
+
+// 量測一組啟動配置的最佳設備時間
+static int measure_launch(retryix_kernel_context_t* ctx, cl_kernel kernel, size_t global, size_t local, double* out_ms) {
+    double best = -1.0;
+    for (int run = 0; run <= RETRYIX_KERNEL_TUNING_RUNS; run++) {
+        cl_event ev = NULL;
+        cl_int err = clEnqueueNDRangeKernel(ctx->profiling_queue, kernel, 1, NULL, &global,
+                                            local ? &local : NULL, 0, NULL, &ev);
+        if (err != CL_SUCCESS) return -1;
+        clWaitForEvents(1, &ev);
+        double ms = rixEventElapsedMs(ev);
+        clReleaseEvent(ev);
+        
+        if (run == 0) continue; // 第一次為預熱
+        if (ms >= 0.0 && (best < 0.0 || ms < best)) best = ms;
+    }
+    if (best < 0.0) return -1;
+    *out_ms = best;
+    return 0;
+}
+
+static int ensure_profiling_queue(retryix_kernel_context_t* ctx) {
+    if (ctx->profiling_queue) return 0;
+    
+    cl_command_queue_properties props = 0;
+    clGetCommandQueueInfo(ctx->queue, CL_QUEUE_PROPERTIES, sizeof(props), &props, NULL);
+    if (props & CL_QUEUE_PROFILING_ENABLE) {
+        ctx->profiling_queue = ctx->queue;
+        return 0;
+    }
+    
+    cl_int err = CL_SUCCESS;
+    ctx->profiling_queue = rixCreateProfilingQueue(ctx->context, ctx->device, &err);
+    if (err != CL_SUCCESS || !ctx->profiling_queue) {
+        printf("Failed to create profiling queue: %s\n", rixCLErrorName(err));
+        ctx->profiling_queue = NULL;
+        return -1;
+    }
+    ctx->owns_profiling_queue = true;
+    return 0;
+}
+
+// 持久化鍵：wg/<template>/<strategy>/<bucket>
+static void tuning_cache_key(retryix_kernel_template_t* tmpl, int strategy, int bucket, char* out, size_t max_len) {
+    snprintf(out, max_len, "wg/%s/%s/%d", tmpl->template_name, STRATEGY_LABELS[strategy], bucket);
+}
+
+// 對目前參數執行調校（參數須已設定於 kernel）
+static int autotune_variant(retryix_kernel_context_t* ctx, retryix_kernel_template_t* tmpl,
+                            retryix_kernel_variant_t* variant, cl_kernel kernel, size_t global_work_size) {
+    if (ensure_profiling_queue(ctx) != 0) return -1;
+    
+    // 確保主佇列上的資料傳輸已完成
+    clFinish(ctx->queue);
+    
+    size_t candidates[RETRYIX_KERNEL_MAX_CANDIDATES];
+    size_t count = build_local_candidates(ctx, variant, candidates, RETRYIX_KERNEL_MAX_CANDIDATES);
+    
+    size_t best_local = 0;
+    double best_ms = -1.0;
+    for (size_t i = 0; i < count; i++) {
+        size_t local = candidates[i];
+        if (local > global_work_size && i > 1) continue;
+        
+        size_t launch_global = global_work_size;
+        if (!resolve_launch_geometry(ctx, tmpl, variant, global_work_size, local, &launch_global)) continue;
+        
+        double ms = 0.0;
+        if (measure_launch(ctx, kernel, launch_global, local, &ms) != 0) continue;
+        
+        printf("  autotune %s: local=%zu global=%zu -> %.4f ms\n",
+               tmpl->template_name, local, launch_global, ms);
+        if (best_ms < 0.0 || ms < best_ms) {
+            best_ms = ms;
+            best_local = local;
+        }
+    }
+    ctx->autotune_runs++;
+    
+    if (best_ms < 0.0) {
+        printf("Autotune failed for %s (no runnable candidate)\n", tmpl->template_name);
+        return -1;
+    }
+    
+    // 一般啟動於 ctx->lock 內讀取調校結果，發布亦需持鎖
+    int bucket = tuning_bucket(global_work_size);
+    rix_mutex_lock(&ctx->lock);
+    retryix_kernel_tuning_t* entry = &tmpl->tuning[bucket];
+    entry->probed = true;
+    entry->is_tuned = true;
+    entry->strategy = (int)variant->strategy;
+    entry->local_size = best_local;
+    entry->device_time_ms = best_ms;
+    rix_mutex_unlock(&ctx->lock);
+    
+    char key[160], value[64];
+    tuning_cache_key(tmpl, (int)variant->strategy, bucket, key, sizeof(key));
+    snprintf(value, sizeof(value), "%zu %.6f", best_local, best_ms);
+    retryix_tuning_put(ctx->device, key, value);
+    
+    printf("Autotune selected local=%zu for %s (global bucket 2^%d, %.4f ms)\n",
+           best_local, tmpl->template_name, bucket, best_ms);
+    return 0;
+}
+
+// 查詢已調校的 local size（記憶體 -> 持久化快取），呼叫端需持有 ctx->lock；
+// 一般啟動不在此調校：重複執行使用者內核會破壞非冪等內核的結果，調校僅經由 retryix_kernel_autotune
+static bool lookup_tuned_local(retryix_kernel_context_t* ctx, retryix_kernel_template_t* tmpl,
+                               retryix_kernel_variant_t* variant, size_t global_work_size, size_t* out_local) {
+    int bucket = tuning_bucket(global_work_size);
+    retryix_kernel_tuning_t* entry = &tmpl->tuning[bucket];
+    
+    if (entry->is_tuned && entry->strategy != (int)variant->strategy) {
+        entry->is_tuned = false;
+        entry->probed = false;
+    }
+    
+    if (!entry->is_tuned && !entry->probed) {
+        entry->probed = true;
+        char key[160], value[64];
+        tuning_cache_key(tmpl, (int)variant->strategy, bucket, key, sizeof(key));
+        size_t local = 0;
+        double ms = 0.0;
+        if (retryix_tuning_get(ctx->device, key, value, sizeof(value)) == RETRYIX_SUCCESS &&
+            sscanf(value, "%zu %lf", &local, &ms) >= 1) {
+            entry->is_tuned = true;
+            entry->strategy = (int)variant->strategy;
+            entry->local_size = local;
+            entry->device_time_ms = ms;
+        }
+    }
+    
+    if (!entry->is_tuned) return false;
+    *out_local = entry->local_size;
+    return true;
+}
+
+// === 變體量測 ===
+
+static int strategy_from_label(const char* label) {
+    for (int i = 0; i < RETRYIX_KERNEL_STRATEGY_COUNT; i++) {
+        if (strcmp(STRATEGY_LABELS[i], label) == 0) return i;
+    }
+    return -1;
+}
+
+// 讀取持久化的變體選擇，未找到回傳 -1
+static int load_persisted_variant(retryix_kernel_context_t* ctx, retryix_kernel_template_t* tmpl) {
+    char key[128], value[64], label[32] = {0};
+    snprintf(key, sizeof(key), "variant/%s", tmpl->template_name);
+    if (retryix_tuning_get(ctx->device, key, value, sizeof(value)) != RETRYIX_SUCCESS) return -1;
+    if (sscanf(value, "%31s", label) != 1) return -1;
+    return strategy_from_label(label);
+}
+
+// 執行一次使用者啟動並回傳耗時（優先採用設備事件時間）
+static int run_user_launch(retryix_kernel_context_t* ctx, cl_kernel kernel, retryix_kernel_launch_fn launch,
+                           void* user_data, double* out_ms) {
+    cl_event ev = NULL;
+    double host_start = rixNowMs();
+    if (launch(kernel, ctx->profiling_queue, &ev, user_data) != 0) {
+        if (ev) clReleaseEvent(ev);
+        return -1;
+    }
+    clFinish(ctx->profiling_queue);
+    double host_ms = rixNowMs() - host_start;
+    
+    double ms = -1.0;
+    if (ev) {
+        ms = rixEventElapsedMs(ev);
+        clReleaseEvent(ev);
+    }
+    *out_ms = (ms >= 0.0) ? ms : host_ms;
+    return 0;
+}
+
+// 量測單一變體：先驗證一次，再取多次執行的最佳時間
+static void benchmark_variant(retryix_kernel_context_t* ctx, retryix_kernel_template_t* tmpl,
+                              retryix_kernel_variant_t* variant, retryix_kernel_launch_fn launch,
+                              retryix_kernel_verify_fn verify, void* user_data) {
+    variant->bench_time_ms = 0.0;
+    
+    if (variant->strategy == RETRYIX_KERNEL_STRATEGY_VENDOR_EXT && !vendor_tier_enabled(ctx)) {
+        variant->bench_status = RETRYIX_KERNEL_BENCH_NOT_RUN;
+        return;
+    }
+    
+    if (compile_kernel_variant(ctx, variant, tmpl->base_source) != 0) {
+        variant->bench_status = RETRYIX_KERNEL_BENCH_COMPILE_FAILED;
+        return;
+    }
+    
+    double ms = 0.0;
+    if (run_user_launch(ctx, variant->kernel, launch, user_data, &ms) != 0) {
+        variant->bench_status = RETRYIX_KERNEL_BENCH_LAUNCH_FAILED;
+        return;
+    }
+    if (verify && verify(user_data) != 0) {
+        variant->bench_status = RETRYIX_KERNEL_BENCH_INCORRECT;
+        return;
+    }
+    
+    double best = -1.0;
+    for (int run = 0; run < RETRYIX_KERNEL_TUNING_RUNS; run++) {
+        if (run_user_launch(ctx, variant->kernel, launch, user_data, &ms) != 0) {
+            variant->bench_status = RETRYIX_KERNEL_BENCH_LAUNCH_FAILED;
+            return;
+        }
+        if (best < 0.0 || ms < best) best = ms;
+    }
+    
+    variant->bench_status = RETRYIX_KERNEL_BENCH_OK;
+    variant->bench_time_ms = best;
+}
+
+// === 執行期常數特化 ===
+
+static int compare_define_ptr(const void* a, const void* b) {
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+// 僅接受識別字/數值字元，避免注入其他編譯選項
+static bool valid_define(const char* define) {
+    if (!define[0] || define[0] == '=') return false;
+    for (const char* p = define; *p; p++) {
+        char c = *p;
+        if (!((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+              c == '_' || c == '=' || c == '.' || c == '+' || c == '-')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 將 NULL 結尾的 "NAME=VALUE" 陣列正規化為排序後的 -D 選項字串
+static int build_spec_options(const char* const* defines, char* out, size_t max_len) {
+    const char* sorted[RETRYIX_KERNEL_SPEC_MAX_DEFINES];
+    size_t count = 0;
+    
+    while (defines[count]) {
+        if (count >= RETRYIX_KERNEL_SPEC_MAX_DEFINES || !valid_define(defines[count])) return -1;
+        sorted[count] = defines[count];
+        count++;
+    }
+    qsort(sorted, count, sizeof(sorted[0]), compare_define_ptr);
+    
+    size_t used = 0;
+    out[0] = '\0';
+    for (size_t i = 0; i < count; i++) {
+        int n = snprintf(out + used, max_len - used, "%s-D%s", i ? " " : "", sorted[i]);
+        if (n < 0 || (size_t)n >= max_len - used) return -1;
+        used += (size_t)n;
+    }
+    return 0;
+}
+
+// 呼叫端需持有 ctx->lock
+static retryix_kernel_spec_t* find_spec(retryix_kernel_context_t* ctx, const char* template_name, const char* options) {
+    for (size_t i = 0; i < ctx->spec_count; i++) {
+        retryix_kernel_spec_t* spec = ctx->specs[i];
+        if (strcmp(spec->template_name, template_name) == 0 && strcmp(spec->options, options) == 0) {
+            return spec;
+        }
+    }
+    return NULL;
+}
+
+// 呼叫端需持有 ctx->lock
+static void release_spec(retryix_kernel_context_t* ctx, retryix_kernel_spec_t* spec) {
+    destroy_variant_pools(ctx, &spec->variant);
+    if (spec->variant.program) clReleaseProgram(spec->variant.program);
+    free(spec->options);
+    free(spec);
+}
+
+// 淘汰最久未使用、不在編譯中且未被釘住的項目，呼叫端需持有 ctx->lock
+static bool evict_spec_lru(retryix_kernel_context_t* ctx) {
+    size_t victim = ctx->spec_count;
+    for (size_t i = 0; i < ctx->spec_count; i++) {
+        retryix_kernel_spec_t* spec = ctx->specs[i];
+        if (spec->state == RETRYIX_KERNEL_SPEC_PENDING || spec->state == RETRYIX_KERNEL_SPEC_COMPILING) continue;
+        if (spec->pins > 0) continue;
+        if (victim == ctx->spec_count || spec->lru_tick < ctx->specs[victim]->lru_tick) victim = i;
+    }
+    if (victim == ctx->spec_count) return false;
+    
+    release_spec(ctx, ctx->specs[victim]);
+    ctx->specs[victim] = ctx->specs[--ctx->spec_count];
+    ctx->spec_evictions++;
+    return true;
+}
+
+// 背景編譯任務：每個任務自待編譯佇列取出一項編譯（停止後僅遞減計數）
+static void spec_compile_task(void* arg) {
+    retryix_kernel_context_t* ctx = (retryix_kernel_context_t*)arg;
+    
+    rix_mutex_lock(&ctx->lock);
+    retryix_kernel_spec_t* spec = ctx->spec_stop ? NULL : ctx->spec_pending_head;
+    if (spec) {
+        ctx->spec_pending_head = spec->next_pending;
+        if (!ctx->spec_pending_head) ctx->spec_pending_tail = NULL;
+        spec->next_pending = NULL;
+        spec->state = RETRYIX_KERNEL_SPEC_COMPILING;
+        rix_mutex_unlock(&ctx->lock);
+        
+        int rc = compile_kernel_variant(ctx, &spec->variant, spec->user_source);
+        
+        rix_mutex_lock(&ctx->lock);
+        spec->state = (rc == 0) ? RETRYIX_KERNEL_SPEC_READY : RETRYIX_KERNEL_SPEC_FAILED;
+    }
+    ctx->spec_inflight--;
+    rix_cond_broadcast(&ctx->spec_done_cond);
+    rix_mutex_unlock(&ctx->lock);
+}
+
+// 取得（必要時建立並排入背景編譯）特化項目，呼叫端需持有 ctx->lock；
+// 新排入時 *submit 設為真，由呼叫端於釋放鎖後提交編譯任務
+static retryix_kernel_spec_t* acquire_spec(retryix_kernel_context_t* ctx, retryix_kernel_template_t* tmpl,
+                                           const char* options, bool* submit) {
+    retryix_kernel_spec_t* spec = find_spec(ctx, tmpl->template_name, options);
+    if (spec) {
+        spec->lru_tick = ++ctx->spec_tick;
+        if (spec->state == RETRYIX_KERNEL_SPEC_READY) ctx->spec_hits++;
+        return spec;
+    }
+    
+    ctx->spec_misses++;
+    if (!ctx->specs) {
+        ctx->specs = (retryix_kernel_spec_t**)calloc(ctx->spec_capacity, sizeof(retryix_kernel_spec_t*));
+        if (!ctx->specs) return NULL;
+    }
+    if (ctx->spec_count >= ctx->spec_capacity && !evict_spec_lru(ctx)) {
+        return NULL; // 全部仍在編譯中或使用中，暫由通用變體服務
+    }
+    
+    spec = (retryix_kernel_spec_t*)calloc(1, sizeof(retryix_kernel_spec_t));
+    if (!spec) return NULL;
+    spec->options = strdup(options);
+    if (!spec->options) {
+        free(spec);
         return NULL;
     }
     
-    // 如果已有活動變體且已編譯，返回快取結果
+    retryix_kernel_variant_t* active = &tmpl->variants[rix_atomic_load_int(&tmpl->active_variant)];
+    memcpy(spec->template_name, tmpl->template_name, sizeof(spec->template_name));
+    strncpy(spec->variant.name, active->name, sizeof(spec->variant.name) - 1);
+    spec->variant.strategy = active->strategy;
+    spec->variant.extra_options = spec->options;
+    spec->user_source = tmpl->base_source;
+    spec->state = RETRYIX_KERNEL_SPEC_PENDING;
+    spec->lru_tick = ++ctx->spec_tick;
+    ctx->specs[ctx->spec_count++] = spec;
+    
+    if (ctx->spec_pending_tail) {
+        ctx->spec_pending_tail->next_pending = spec;
+    } else {
+        ctx->spec_pending_head = spec;
+    }
+    ctx->spec_pending_tail = spec;
+    ctx->spec_inflight++;
+    *submit = true;
+    return spec;
+}
+
+// 取得特化內核；未就緒時回傳通用變體（wait 為真時阻塞至編譯完成）
+// out_spec 非空且回傳特化版本時，項目已被釘住，呼叫端用畢需 unpin_spec
+static cl_kernel get_specialized_kernel(const char* template_name, const char* const* defines, bool wait,
+                                        retryix_kernel_template_t** out_tmpl, retryix_kernel_variant_t** out_variant,
+                                        retryix_kernel_spec_t** out_spec) {
+    if (!g_kernel_context || !template_name || !defines) return NULL;
+    
+    retryix_kernel_context_t* ctx = g_kernel_context;
+    if (out_spec) *out_spec = NULL;
+    cl_kernel generic = retryix_kernel_compile_best(template_name);
+    if (!generic) return NULL;
+    
+    retryix_kernel_template_t* tmpl = find_template(ctx, template_name);
+    retryix_kernel_variant_t* variant = &tmpl->variants[rix_atomic_load_int(&tmpl->active_variant)];
+    cl_kernel kernel = generic;
+    
+    char options[RETRYIX_KERNEL_SPEC_MAX_OPTIONS];
+    if (build_spec_options(defines, options, sizeof(options)) != 0) {
+        printf("Invalid specialization constants for %s\n", template_name);
+        return NULL;
+    }
+    
+    rix_mutex_lock(&ctx->lock);
+    bool submit = false;
+    retryix_kernel_spec_t* spec = acquire_spec(ctx, tmpl, options, &submit);
+    if (submit) {
+        // 任務可能同步執行（無執行緒池時），提交前先釋放鎖；阻塞呼叫端直接於本執行緒編譯
+        rix_mutex_unlock(&ctx->lock);
+        if (wait) {
+            spec_compile_task(ctx);
+        } else {
+            retryix_pool_submit(spec_compile_task, ctx);
+        }
+        rix_mutex_lock(&ctx->lock);
+    }
+    if (spec && wait) {
+        while (spec->state == RETRYIX_KERNEL_SPEC_PENDING || spec->state == RETRYIX_KERNEL_SPEC_COMPILING) {
+            rix_cond_wait(&ctx->spec_done_cond, &ctx->lock);
+        }
+    }
+    if (spec && spec->state == RETRYIX_KERNEL_SPEC_READY) {
+        kernel = spec->variant.kernel;
+        variant = &spec->variant;
+        variant->use_count++;
+        variant->last_used = (uint64_t)time(NULL);
+        if (out_spec) {
+            spec->pins++;
+            *out_spec = spec;
+        }
+    }
+    rix_mutex_unlock(&ctx->lock);
+    
+    if (out_tmpl) *out_tmpl = tmpl;
+    if (out_variant) *out_variant = variant;
+    return kernel;
+}
+
+// 解除 get_specialized_kernel 的釘住
+static void unpin_spec(retryix_kernel_context_t* ctx, retryix_kernel_spec_t* spec) {
+    if (!spec) return;
+    rix_mutex_lock(&ctx->lock);
+    spec->pins--;
+    rix_mutex_unlock(&ctx->lock);
+}
+
+// === 公開 API ===
+
+// 初始化內核管理器
+int retryix_kernel_init(cl_context context, cl_device_id device, cl_command_queue queue) {
+    if (g_kernel_context) return 0; // 已初始化
+    if (!context || !device || !queue) {
+        // 無設備：內核管理器不啟用，內建運算改由 CPU 偽設備執行（平行原語自動轉送）
+        return retryix_cpu_device_fallback("RetryIX Kernel Manager: no OpenCL device");
+    }
+    
+    retryix_kernel_context_t* ctx = (retryix_kernel_context_t*)calloc(1, sizeof(retryix_kernel_context_t));
+    if (!ctx) return -1;
+    
+    ctx->context = context;
+    ctx->device = device;
+    ctx->queue = queue;
+    
+    // 檢測設備能力
+    probe_device_capabilities(ctx);
+    ctx->opt_level = (retryix_kernel_opt_level_t)retryix_config_get_dword("KernelEngine", "OptimizationLevel",
+                                                                        RETRYIX_KERNEL_OPT_AGGRESSIVE);
+    ctx->spec_capacity = retryix_config_get_dword("KernelEngine", "CacheSize", RETRYIX_KERNEL_SPEC_DEFAULT_CAPACITY);
+    if (ctx->spec_capacity == 0) ctx->spec_capacity = RETRYIX_KERNEL_SPEC_DEFAULT_CAPACITY;
+    ctx->separate_compile = (ctx->opencl_major > 1 || (ctx->opencl_major == 1 && ctx->opencl_minor >= 2));
+    ctx->can_clone_kernel = (ctx->opencl_major > 2 || (ctx->opencl_major == 2 && ctx->opencl_minor >= 1));
+    rix_mutex_init(&ctx->lock);
+    rix_mutex_init(&ctx->compile_lock);
+    rix_cond_init(&ctx->spec_done_cond);
+    
+    // 初始化模板池
+    ctx->template_capacity = 32;
+    ctx->templates = (retryix_kernel_template_t**)calloc(ctx->template_capacity, sizeof(retryix_kernel_template_t*));
+    if (!ctx->templates) {
+        rix_cond_destroy(&ctx->spec_done_cond);
+        rix_mutex_destroy(&ctx->compile_lock);
+        rix_mutex_destroy(&ctx->lock);
+        free(ctx);
+        return -1;
+    }
+    
+    g_kernel_context = ctx;
+    
+    printf("RetryIX Kernel Manager initialized\n");
+    return 0;
+}
+
+// 註冊內核模板
+int retryix_kernel_register_template(const char* template_name, const char* kernel_name, const char* source_code) {
+    if (!g_kernel_context || !template_name || !kernel_name || !source_code) return -1;
+    
+    retryix_kernel_context_t* ctx = g_kernel_context;
+    
+    retryix_kernel_template_t* tmpl = (retryix_kernel_template_t*)calloc(1, sizeof(retryix_kernel_template_t));
+    if (!tmpl) return -1;
+    strncpy(tmpl->template_name, template_name, sizeof(tmpl->template_name) - 1);
+    
+    tmpl->base_source = strdup(source_code);
+    if (!tmpl->base_source) {
+        free(tmpl);
+        return -1;
+    }
+    tmpl->active_variant = -1;
+    tmpl->is_universal = true;
+    
+    // 為所有策略創建變體
+    for (int i = 0; i < RETRYIX_KERNEL_STRATEGY_COUNT; i++) {
+        retryix_kernel_variant_t* variant = &tmpl->variants[i];
+        strncpy(variant->name, kernel_name, sizeof(variant->name) - 1);
+        variant->strategy = (retryix_kernel_strategy_t)i;
+        variant->is_compiled = false;
+        variant->program = NULL;
+        variant->kernel = NULL;
+    }
+    
+    // 擴充與加入皆在鎖內，與其他執行緒的查找互斥
+    rix_mutex_lock(&ctx->lock);
+    if (ctx->template_count >= ctx->template_capacity) {
+        size_t new_capacity = ctx->template_capacity * 2;
+        retryix_kernel_template_t** templates = (retryix_kernel_template_t**)realloc(ctx->templates,
+                                                                                   new_capacity * sizeof(retryix_kernel_template_t*));
+        if (!templates) {
+            rix_mutex_unlock(&ctx->lock);
+            free(tmpl->base_source);
+            free(tmpl);
+            return -1;
+        }
+        ctx->templates = templates;
+        ctx->template_capacity = new_capacity;
+    }
+    ctx->templates[ctx->template_count++] = tmpl;
+    rix_mutex_unlock(&ctx->lock);
+    
+    printf("Kernel template registered: %s (%s)\n", template_name, kernel_name[0] ? kernel_name : "all kernels");
+    return 0;
+}
+
+// 註冊多內核程序：整個源碼只建置一次，所有內核經由 retryix_kernel_execute_kernel 使用
+int retryix_kernel_register_program(const char* template_name, const char* source_code) {
+    return retryix_kernel_register_template(template_name, "", source_code);
+}
+
+// 編譯最佳變體並設為活動變體，呼叫端需持有 ctx->compile_lock
+static cl_kernel compile_best_locked(retryix_kernel_context_t* ctx, retryix_kernel_template_t* tmpl) {
+    const char* template_name = tmpl->template_name;
+    
+    // 其他執行緒可能已完成編譯
     if (tmpl->active_variant >= 0 && tmpl->variants[tmpl->active_variant].is_compiled) {
-        ctx->cache_hits++;
-        tmpl->variants[tmpl->active_variant].use_count++;
-        tmpl->variants[tmpl->active_variant].last_used = (uint64_t)time(NULL);
         return tmpl->variants[tmpl->active_variant].kernel;
     }
     
     ctx->cache_misses++;
     
+    // 優先使用量測後持久化的變體
+    int persisted = load_persisted_variant(ctx, tmpl);
+    if (persisted >= 0) {
+        retryix_kernel_variant_t* variant = &tmpl->variants[persisted];
+        if (compile_kernel_variant(ctx, variant, tmpl->base_source) == 0) {
+            variant->use_count++;
+            variant->last_used = (uint64_t)time(NULL);
+            rix_atomic_store_int(&tmpl->active_variant, persisted);
+            
+            printf("Using benchmarked variant for %s: strategy %s\n", template_name, STRATEGY_LABELS[persisted]);
+            return variant->kernel;
+        }
+    }
+    
     // 選擇最佳策略
     retryix_kernel_strategy_t best_strategy = select_optimal_strategy(ctx);
     
-    // 按優先級嘗試編譯
-    retryix_kernel_strategy_t try_order[] = {best_strategy, RETRYIX_KERNEL_STRATEGY_OPENCL12_EXT, 
-                                           RETRYIX_KERNEL_STRATEGY_OPENCL11_BASIC, RETRYIX_KERNEL_STRATEGY_FALLBACK};
+    // 按優先級嘗試編譯（廠商層失敗時自動退回標準策略）
+    retryix_kernel_strategy_t try_order[RETRYIX_KERNEL_STRATEGY_COUNT];
+    int try_count = 0;
+    if (vendor_tier_enabled(ctx)) {
+        try_order[try_count++] = RETRYIX_KERNEL_STRATEGY_VENDOR_EXT;
+    }
+    try_order[try_count++] = best_strategy;
+    try_order[try_count++] = RETRYIX_KERNEL_STRATEGY_OPENCL12_EXT;
+    try_order[try_count++] = RETRYIX_KERNEL_STRATEGY_OPENCL11_BASIC;
+    try_order[try_count++] = RETRYIX_KERNEL_STRATEGY_FALLBACK;
     
-    for (int i = 0; i < 4; i++) {
+    for (int i = 0; i < try_count; i++) {
         retryix_kernel_strategy_t strategy = try_order[i];
         retryix_kernel_variant_t* variant = &tmpl->variants[strategy];
         
         if (compile_kernel_variant(ctx, variant, tmpl->base_source) == 0) {
-            tmpl->active_variant = strategy;
             variant->use_count++;
             variant->last_used = (uint64_t)time(NULL);
+            rix_atomic_store_int(&tmpl->active_variant, (int)strategy);
             
             printf("Successfully compiled kernel: %s with strategy %d\n", template_name, strategy);
             return variant->kernel;
@@ -447,56 +1829,478 @@ cl_kernel retryix_kernel_compile_best(const char* template_name) {
     return NULL;
 }
 
-// 執行內核
+// 編譯最佳內核變體（可多執行緒呼叫；已編譯時不加鎖）
+cl_kernel retryix_kernel_compile_best(const char* template_name) {
+    if (!g_kernel_context || !template_name) return NULL;
+    
+    retryix_kernel_context_t* ctx = g_kernel_context;
+    
+    // 查找模板
+    retryix_kernel_template_t* tmpl = find_template(ctx, template_name);
+    if (!tmpl) {
+        printf("Template not found: %s\n", template_name);
+        return NULL;
+    }
+    
+    // 如果已有活動變體且已編譯，返回快取結果
+    int active = rix_atomic_load_int(&tmpl->active_variant);
+    if (active >= 0 && tmpl->variants[active].is_compiled) {
+        retryix_kernel_variant_t* variant = &tmpl->variants[active];
+        rix_atomic_inc_u64(&ctx->cache_hits);
+        rix_atomic_inc_u32(&variant->use_count);
+        rix_atomic_store_u64(&variant->last_used, (uint64_t)time(NULL));
+        return variant->kernel;
+    }
+    
+    rix_mutex_lock(&ctx->compile_lock);
+    cl_kernel kernel = compile_best_locked(ctx, tmpl);
+    rix_mutex_unlock(&ctx->compile_lock);
+    return kernel;
+}
+
+// 排入已設定參數的內核（各 execute 變體共用）；tunable 為假時不套用工作組調校結果
+// out_event 為 NULL 時等待完成，否則回傳啟動事件且不阻塞
+static int enqueue_launch(retryix_kernel_context_t* ctx, retryix_kernel_template_t* tmpl,
+                          retryix_kernel_variant_t* variant, cl_kernel kernel, bool tunable,
+                          size_t global_work_size, size_t local_work_size,
+                          cl_uint num_waits, const cl_event* waits,
+                          void* const* svm_ptrs, const retryix_access_t* svm_access, cl_uint svm_count,
+                          cl_event* out_event) {
+    const char* template_name = tmpl->template_name;
+    
+    // 未指定 local size 時使用調校結果
+    size_t local = local_work_size;
+    size_t launch_global = global_work_size;
+    if (local == 0 && tunable) {
+        size_t tuned = 0;
+        rix_mutex_lock(&ctx->lock);
+        bool found = lookup_tuned_local(ctx, tmpl, variant, global_work_size, &tuned);
+        rix_mutex_unlock(&ctx->lock);
+        if (found && resolve_launch_geometry(ctx, tmpl, variant, global_work_size, tuned, &launch_global)) {
+            local = tuned;
+        } else {
+            launch_global = global_work_size;
+        }
+    }
+    
+    clock_t start = clock();
+    
+    // SVM：登記間接存取的配置、解映射主機持有的粗粒度配置，並補上其相依等待
+    // 自 begin_launch 收集等待至 end_launch 登記事件期間持有 SVM 管理器鎖
+    retryix_svm_context_t* svm = ctx->svm_context;
+    const cl_event* launch_waits = waits;
+    cl_event* svm_waits = NULL;
+    if (svm) {
+        cl_uint capacity = num_waits + (svm_count + 1) * RETRYIX_MAX_HAZARD_WAITS;
+        svm_waits = (cl_event*)malloc(capacity * sizeof(cl_event));
+        if (!svm_waits) return -1;
+        if (num_waits) memcpy(svm_waits, waits, num_waits * sizeof(cl_event));
+        retryix_svm_lock(svm);
+        if (retryix_svm_begin_launch(svm, kernel, ctx->queue, svm_ptrs, svm_access, svm_count,
+                                     svm_waits, capacity, &num_waits) != 0) {
+            retryix_svm_unlock(svm);
+            free(svm_waits);
+            return -1;
+        }
+        launch_waits = svm_waits;
+    }
+    
+    // 執行內核
+    cl_event ev = NULL;
+    cl_int err = clEnqueueNDRangeKernel(ctx->queue, kernel, 1, NULL, &launch_global, 
+                                       local > 0 ? &local : NULL, num_waits, num_waits ? launch_waits : NULL, &ev);
+    free(svm_waits);
+    
+    if (err != CL_SUCCESS) {
+        if (svm) {
+            retryix_svm_abort_launch(svm, ctx->queue);
+            retryix_svm_unlock(svm);
+        }
+        printf("Kernel execution failed: %d\n", err);
+        return -1;
+    }
+    
+    if (svm) {
+        retryix_svm_end_launch(svm, ctx->queue, svm_ptrs, svm_access, svm_count, ev);
+        retryix_svm_unlock(svm);
+    }
+    
+    if (out_event) {
+        *out_event = ev;
+    } else {
+        clFinish(ctx->queue);
+        clReleaseEvent(ev);
+    }
+    
+    double execution_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+    
+    // 更新統計
+    rix_mutex_lock(&ctx->lock);
+    ctx->total_executions++;
+    ctx->total_execution_time += execution_time;
+    rix_mutex_unlock(&ctx->lock);
+    
+    printf("Kernel %s: %s (%.3f ms, global=%zu, local=%zu, waits=%u)\n", out_event ? "enqueued" : "executed",
+           template_name, execution_time * 1000.0, launch_global, local, num_waits);
+    
+    return 0;
+}
+
+// 設定可變參數並同步執行
+static int launch_kernel_va(retryix_kernel_context_t* ctx, retryix_kernel_template_t* tmpl,
+                            retryix_kernel_variant_t* variant, cl_kernel kernel, bool tunable,
+                            size_t global_work_size, size_t local_work_size, va_list args) {
+    if (set_kernel_args_va(kernel, args) != 0) return -1;
+    return enqueue_launch(ctx, tmpl, variant, kernel, tunable, global_work_size, local_work_size,
+                          0, NULL, NULL, NULL, 0, NULL);
+}
+
+// 執行內核（每個執行緒使用自己的內核實例，可並行呼叫）
 int retryix_kernel_execute(const char* template_name, size_t global_work_size, size_t local_work_size, ...) {
     if (!g_kernel_context || !template_name) return -1;
     
     retryix_kernel_context_t* ctx = g_kernel_context;
-    cl_kernel kernel = retryix_kernel_compile_best(template_name);
+    if (!retryix_kernel_compile_best(template_name)) return -1;
+    
+    retryix_kernel_template_t* tmpl = find_template(ctx, template_name);
+    retryix_kernel_variant_t* variant = &tmpl->variants[rix_atomic_load_int(&tmpl->active_variant)];
+    cl_kernel kernel = thread_instance(ctx, find_pool(variant, NULL));
     if (!kernel) return -1;
     
-    // 處理可變參數（內核參數）
     va_list args;
     va_start(args, local_work_size);
+    int rc = launch_kernel_va(ctx, tmpl, variant, kernel, true, global_work_size, local_work_size, args);
+    va_end(args);
+    return rc;
+}
+
+// 執行多內核程序中的指定內核（kernel_name 為 NULL 時使用預設內核）
+int retryix_kernel_execute_kernel(const char* template_name, const char* kernel_name,
+                                  size_t global_work_size, size_t local_work_size, ...) {
+    if (!g_kernel_context || !template_name) return -1;
     
-    int arg_index = 0;
-    while (1) {
-        void* arg_value = va_arg(args, void*);
-        if (!arg_value) break; // NULL 表示參數結束
-        
-        size_t arg_size = va_arg(args, size_t);
-        cl_int err = clSetKernelArg(kernel, arg_index++, arg_size, arg_value);
+    retryix_kernel_context_t* ctx = g_kernel_context;
+    if (!retryix_kernel_compile_best(template_name)) return -1;
+    
+    retryix_kernel_template_t* tmpl = find_template(ctx, template_name);
+    retryix_kernel_variant_t* variant = &tmpl->variants[rix_atomic_load_int(&tmpl->active_variant)];
+    retryix_kernel_pool_t* pool = find_pool(variant, kernel_name);
+    if (!pool) {
+        printf("Kernel %s not found in template %s\n", kernel_name, template_name);
+        return -1;
+    }
+    cl_kernel kernel = thread_instance(ctx, pool);
+    if (!kernel) return -1;
+    
+    // 工作組調校結果以模板預設內核為準
+    bool tunable = (pool->prototype == variant->kernel);
+    
+    va_list args;
+    va_start(args, local_work_size);
+    int rc = launch_kernel_va(ctx, tmpl, variant, kernel, tunable, global_work_size, local_work_size, args);
+    va_end(args);
+    return rc;
+}
+
+// 追蹤式啟動：依緩衝區參數的存取模式只等待必要的事件（RAW / WAR / WAW），不阻塞
+int retryix_kernel_execute_tracked(const char* template_name, const char* kernel_name,
+                                   size_t global_work_size, size_t local_work_size,
+                                   const retryix_kernel_arg_t* args, cl_uint num_args, cl_event* out_event) {
+    if (!g_kernel_context || !template_name || (num_args && !args)) return -1;
+    
+    retryix_kernel_context_t* ctx = g_kernel_context;
+    if (!retryix_kernel_compile_best(template_name)) return -1;
+    
+    retryix_kernel_template_t* tmpl = find_template(ctx, template_name);
+    retryix_kernel_variant_t* variant = &tmpl->variants[rix_atomic_load_int(&tmpl->active_variant)];
+    retryix_kernel_pool_t* pool = find_pool(variant, kernel_name);
+    if (!pool) {
+        printf("Kernel %s not found in template %s\n", kernel_name ? kernel_name : "(default)", template_name);
+        return -1;
+    }
+    cl_kernel kernel = thread_instance(ctx, pool);
+    if (!kernel) return -1;
+    
+    cl_uint max_waits = num_args * RETRYIX_MAX_HAZARD_WAITS;
+    cl_event* waits = max_waits ? (cl_event*)malloc(max_waits * sizeof(cl_event)) : NULL;
+    retryix_access_t* access = num_args ? (retryix_access_t*)calloc(num_args, sizeof(retryix_access_t)) : NULL;
+    void** svm_ptrs = num_args ? (void**)malloc(num_args * sizeof(void*)) : NULL;
+    retryix_access_t* svm_access = num_args ? (retryix_access_t*)malloc(num_args * sizeof(retryix_access_t)) : NULL;
+    cl_uint svm_count = 0;
+    if (num_args && (!waits || !access || !svm_ptrs || !svm_access)) {
+        free(waits);
+        free(access);
+        free(svm_ptrs);
+        free(svm_access);
+        return -1;
+    }
+    
+    // 設定參數並收集等待事件；至登記本次啟動為止持有記憶體管理器鎖，
+    // 避免其他執行緒在兩者之間更新同一緩衝區的存取紀錄（遺失相依或釋放收集到的事件）
+    int rc = 0;
+    cl_uint num_waits = 0;
+    retryix_memory_lock();
+    for (cl_uint i = 0; i < num_args && rc == 0; i++) {
+        const retryix_kernel_arg_t* arg = &args[i];
+        cl_int err = CL_SUCCESS;
+        if (arg->kind == RETRYIX_ARG_BUFFER || arg->kind == RETRYIX_ARG_SVM) {
+            access[i] = arg->access;
+            if (access[i] == RETRYIX_ACCESS_AUTO) {
+                bool read_only = i < 64 && ((pool->const_args >> i) & 1);
+                access[i] = read_only ? RETRYIX_ACCESS_READ : RETRYIX_ACCESS_READ_WRITE;
+            }
+        }
+        switch (arg->kind) {
+            case RETRYIX_ARG_VALUE:
+                err = clSetKernelArg(kernel, i, arg->size, arg->value);
+                break;
+            case RETRYIX_ARG_LOCAL:
+                err = clSetKernelArg(kernel, i, arg->size, NULL);
+                break;
+            case RETRYIX_ARG_BUFFER: {
+                cl_mem mem = retryix_memory_get_device_mem((void*)arg->value);
+                if (!mem) {
+                    printf("Kernel argument %u is not a RetryIX buffer\n", i);
+                    rc = -1;
+                    break;
+                }
+                err = clSetKernelArg(kernel, i, sizeof(cl_mem), &mem);
+                if (err == CL_SUCCESS &&
+                    retryix_memory_hazard_waits((void*)arg->value, access[i], waits, max_waits, &num_waits) != 0) {
+                    rc = -1;
+                }
+                break;
+            }
+            case RETRYIX_ARG_SVM:
+                // 相依等待與粗粒度解映射由 enqueue_launch 透過 SVM 管理器處理
+                if (!ctx->svm_context ||
+                    retryix_svm_set_kernel_arg(ctx->svm_context, kernel, i, (void*)arg->value) != 0) {
+                    printf("Kernel argument %u is not a registered SVM pointer\n", i);
+                    rc = -1;
+                    break;
+                }
+                svm_ptrs[svm_count] = (void*)arg->value;
+                svm_access[svm_count++] = access[i];
+                break;
+            default:
+                rc = -1;
+                break;
+        }
         if (err != CL_SUCCESS) {
-            va_end(args);
-            printf("Failed to set kernel argument %d: %d\n", arg_index - 1, err);
-            return -1;
+            printf("Failed to set kernel argument %u: %d\n", i, err);
+            rc = -1;
+        }
+    }
+    
+    cl_event ev = NULL;
+    if (rc == 0) {
+        rc = enqueue_launch(ctx, tmpl, variant, kernel, pool->prototype == variant->kernel,
+                            global_work_size, local_work_size, num_waits, waits,
+                            svm_ptrs, svm_access, svm_count, &ev);
+    }
+    
+    // 登記本次啟動：先登記讀取，同一緩衝區同時讀寫時以寫入為準
+    if (rc == 0) {
+        for (int pass = 0; pass < 2; pass++) {
+            for (cl_uint i = 0; i < num_args; i++) {
+                if (args[i].kind != RETRYIX_ARG_BUFFER) continue;
+                bool is_write = (access[i] & RETRYIX_ACCESS_WRITE) != 0;
+                if (is_write == (pass == 1)) {
+                    retryix_memory_hazard_record((void*)args[i].value, access[i], ev);
+                }
+            }
+        }
+    }
+    retryix_memory_unlock();
+    if (rc == 0) {
+        if (out_event) {
+            *out_event = ev;
+        } else {
+            clReleaseEvent(ev);
         }
     }
     
+    free(waits);
+    free(access);
+    free(svm_ptrs);
+    free(svm_access);
+    return rc;
+}
+
+// 連結 SVM 管理器（NULL 表示解除）；之後的啟動會處理 SVM 參數、間接存取登記與粗粒度映射
+int retryix_kernel_set_svm_context(retryix_svm_context_t* svm_context) {
+    if (!g_kernel_context) return -1;
+    g_kernel_context->svm_context = svm_context;
+    return 0;
+}
+
+// 借出獨立的內核實例（逐次啟動使用，用畢以 retryix_kernel_release 歸還）
+cl_kernel retryix_kernel_acquire(const char* template_name, const char* kernel_name) {
+    if (!g_kernel_context || !template_name) return NULL;
+    
+    retryix_kernel_context_t* ctx = g_kernel_context;
+    if (!retryix_kernel_compile_best(template_name)) return NULL;
+    
+    retryix_kernel_template_t* tmpl = find_template(ctx, template_name);
+    retryix_kernel_variant_t* variant = &tmpl->variants[rix_atomic_load_int(&tmpl->active_variant)];
+    retryix_kernel_pool_t* pool = find_pool(variant, kernel_name);
+    if (!pool) return NULL;
+    
+    rix_mutex_lock(&ctx->lock);
+    cl_kernel kernel = take_pool_instance(ctx, pool);
+    rix_mutex_unlock(&ctx->lock);
+    return kernel;
+}
+
+// 歸還 retryix_kernel_acquire 借出的實例
+int retryix_kernel_release(const char* template_name, cl_kernel kernel) {
+    if (!g_kernel_context || !template_name || !kernel) return -1;
+    
+    retryix_kernel_context_t* ctx = g_kernel_context;
+    retryix_kernel_template_t* tmpl = find_template(ctx, template_name);
+    if (!tmpl) return -1;
+    
+    // 活動變體可能已切換，逐一檢查所有變體的實例池
+    int rc = -1;
+    rix_mutex_lock(&ctx->lock);
+    for (int v = 0; v < RETRYIX_KERNEL_STRATEGY_COUNT && rc != 0; v++) {
+        retryix_kernel_variant_t* variant = &tmpl->variants[v];
+        for (size_t i = 0; i < variant->pool_count; i++) {
+            if (return_pool_instance(&variant->pools[i], kernel)) {
+                rc = 0;
+                break;
+            }
+        }
+    }
+    rix_mutex_unlock(&ctx->lock);
+    return rc;
+}
+
+// 以執行期常數特化模板；特化版本於背景編譯，完成前回傳通用變體
+cl_kernel retryix_kernel_compile_specialized(const char* template_name, const char* const* defines) {
+    return get_specialized_kernel(template_name, defines, false, NULL, NULL, NULL);
+}
+
+// 同上，但阻塞至特化版本編譯完成（失敗時回傳通用變體）
+cl_kernel retryix_kernel_compile_specialized_wait(const char* template_name, const char* const* defines) {
+    return get_specialized_kernel(template_name, defines, true, NULL, NULL, NULL);
+}
+
+// 以特化內核執行（未就緒時以通用變體執行）
+int retryix_kernel_execute_specialized(const char* template_name, const char* const* defines,
+                                       size_t global_work_size, size_t local_work_size, ...) {
+    retryix_kernel_template_t* tmpl = NULL;
+    retryix_kernel_variant_t* variant = NULL;
+    retryix_kernel_spec_t* spec = NULL;
+    if (!get_specialized_kernel(template_name, defines, false, &tmpl, &variant, &spec)) return -1;
+    
+    // 釘住至啟動入列完成，期間項目不會被 LRU 淘汰
+    cl_kernel kernel = thread_instance(g_kernel_context, find_pool(variant, NULL));
+    int rc = -1;
+    if (kernel) {
+        va_list args;
+        va_start(args, local_work_size);
+        rc = launch_kernel_va(g_kernel_context, tmpl, variant, kernel, true, global_work_size, local_work_size, args);
+        va_end(args);
+    }
+    unpin_spec(g_kernel_context, spec);
+    return rc;
+}
+
+// 以給定參數調校工作組大小並持久化結果
+int retryix_kernel_autotune(const char* template_name, size_t global_work_size, ...) {
+    if (!g_kernel_context || !template_name || global_work_size == 0) return -1;
+    
+    retryix_kernel_context_t* ctx = g_kernel_context;
+    if (!retryix_kernel_compile_best(template_name)) return -1;
+    
+    retryix_kernel_template_t* tmpl = find_template(ctx, template_name);
+    retryix_kernel_variant_t* variant = &tmpl->variants[rix_atomic_load_int(&tmpl->active_variant)];
+    retryix_kernel_pool_t* pool = find_pool(variant, NULL);
+    if (!pool) return -1;
+    
+    // 於借出的獨立實例上設參數與調校，不動共用原型內核
+    rix_mutex_lock(&ctx->lock);
+    cl_kernel kernel = take_pool_instance(ctx, pool);
+    rix_mutex_unlock(&ctx->lock);
+    if (!kernel) return -1;
+    
+    va_list args;
+    va_start(args, global_work_size);
+    int rc = set_kernel_args_va(kernel, args);
     va_end(args);
+    if (rc == 0) rc = autotune_variant(ctx, tmpl, variant, kernel, global_work_size);
     
-    // 執行內核
-    clock_t start = clock();
-    size_t local = (local_work_size > 0) ? local_work_size : 0;
-    cl_int err = clEnqueueNDRangeKernel(ctx->queue, kernel, 1, NULL, &global_work_size, 
-                                       local > 0 ? &local : NULL, 0, NULL, NULL);
+    rix_mutex_lock(&ctx->lock);
+    return_pool_instance(pool, kernel);
+    rix_mutex_unlock(&ctx->lock);
+    return rc;
+}
+
+// 量測模板所有可行變體，將最快且正確的變體設為活動變體並持久化
+int retryix_kernel_benchmark_variants(const char* template_name, retryix_kernel_launch_fn launch,
+                                      retryix_kernel_verify_fn verify, void* user_data) {
+    if (!g_kernel_context || !template_name || !launch) return -1;
     
-    if (err != CL_SUCCESS) {
-        printf("Kernel execution failed: %d\n", err);
+    retryix_kernel_context_t* ctx = g_kernel_context;
+    retryix_kernel_template_t* tmpl = find_template(ctx, template_name);
+    if (!tmpl) {
+        printf("Template not found: %s\n", template_name);
         return -1;
     }
+    if (ensure_profiling_queue(ctx) != 0) return -1;
     
+    // 確保主佇列上的輸入已就緒
     clFinish(ctx->queue);
     
-    double execution_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+    int best = -1;
+    for (int i = 0; i < RETRYIX_KERNEL_STRATEGY_COUNT; i++) {
+        retryix_kernel_variant_t* variant = &tmpl->variants[i];
+        benchmark_variant(ctx, tmpl, variant, launch, verify, user_data);
+        if (variant->bench_status == RETRYIX_KERNEL_BENCH_NOT_RUN) continue;
+        
+        printf("  variant %s/%s: %s", template_name, STRATEGY_LABELS[i], BENCH_STATUS_LABELS[variant->bench_status]);
+        if (variant->bench_status == RETRYIX_KERNEL_BENCH_OK) {
+            printf(" (%.4f ms)", variant->bench_time_ms);
+            if (best < 0 || variant->bench_time_ms < tmpl->variants[best].bench_time_ms) best = i;
+        }
+        printf("\n");
+    }
     
-    // 更新統計
-    ctx->total_executions++;
-    ctx->total_execution_time += execution_time;
+    if (best < 0) {
+        printf("No correct variant found for template: %s\n", template_name);
+        return -1;
+    }
+    
+    rix_atomic_store_int(&tmpl->active_variant, best);
+    
+    char key[128], value[64];
+    snprintf(key, sizeof(key), "variant/%s", template_name);
+    snprintf(value, sizeof(value), "%s %.6f", STRATEGY_LABELS[best], tmpl->variants[best].bench_time_ms);
+    retryix_tuning_put(ctx->device, key, value);
+    
+    printf("Benchmark selected variant %s for %s (%.4f ms)\n",
+           STRATEGY_LABELS[best], template_name, tmpl->variants[best].bench_time_ms);
+    return best;
+}
+
+// 設定優化等級；VENDOR_SPECIFIC 會啟用廠商/擴展變體層
+int retryix_kernel_set_opt_level(retryix_kernel_opt_level_t level) {
+    if (!g_kernel_context) return -1;
+    if (level < RETRYIX_KERNEL_OPT_NONE || level > RETRYIX_KERNEL_OPT_VENDOR_SPECIFIC) return -1;
+    
+    g_kernel_context->opt_level = level;
+    return 0;
+}
+
+// 標記模板內核會檢查 gid 邊界，允許調校時補齊 global size
+int retryix_kernel_set_bounds_checked(const char* template_name, int bounds_checked) {
+    if (!g_kernel_context || !template_name) return -1;
     
-    printf("Kernel executed: %s (%.3f ms, global=%zu, local=%zu)\n", 
-           template_name, execution_time * 1000.0, global_work_size, local_work_size);
+    retryix_kernel_template_t* tmpl = find_template(g_kernel_context, template_name);
+    if (!tmpl) return -1;
     
+    tmpl->bounds_checked = (bounds_checked != 0);
     return 0;
 }
 
@@ -526,15 +2330,45 @@ void retryix_kernel_print_stats(void) {
     
     printf("\nActive Templates:\n");
     for (size_t i = 0; i < ctx->template_count; i++) {
-        retryix_kernel_template_t* tmpl = &ctx->templates[i];
+        retryix_kernel_template_t* tmpl = ctx->templates[i];
         if (tmpl->active_variant >= 0) {
             retryix_kernel_variant_t* variant = &tmpl->variants[tmpl->active_variant];
-            printf("  %s: Strategy %d, Used %u times, Compile time %.3fs\n",
-                   tmpl->template_name, tmpl->active_variant, variant->use_count, variant->compile_time);
+            printf("  %s: Strategy %d, Used %u times, Compile time %.3fs, %zu kernel(s)\n",
+                   tmpl->template_name, tmpl->active_variant, variant->use_count, variant->compile_time,
+                   variant->pool_count);
         } else {
             printf("  %s: Not compiled\n", tmpl->template_name);
         }
+        
+        for (int v = 0; v < RETRYIX_KERNEL_STRATEGY_COUNT; v++) {
+            retryix_kernel_variant_t* variant = &tmpl->variants[v];
+            if (variant->bench_status == RETRYIX_KERNEL_BENCH_NOT_RUN) continue;
+            if (variant->bench_status == RETRYIX_KERNEL_BENCH_OK) {
+                printf("    Variant %s: %.4f ms%s\n", STRATEGY_LABELS[v], variant->bench_time_ms,
+                       v == tmpl->active_variant ? " (active)" : "");
+            } else {
+                printf("    Variant %s: %s\n", STRATEGY_LABELS[v], BENCH_STATUS_LABELS[variant->bench_status]);
+            }
+        }
+        
+        for (int b = 0; b < RETRYIX_KERNEL_TUNING_BUCKETS; b++) {
+            retryix_kernel_tuning_t* entry = &tmpl->tuning[b];
+            if (entry->is_tuned) {
+                printf("    Tuned: global~2^%d -> local %zu (%.4f ms, %s)\n",
+                       b, entry->local_size, entry->device_time_ms, STRATEGY_LABELS[entry->strategy]);
+            }
+        }
     }
+    printf("Autotune Runs: %llu\n", (unsigned long long)ctx->autotune_runs);
+    rix_mutex_lock(&ctx->lock);
+    printf("Kernel Instances: %llu (%s)\n", (unsigned long long)ctx->instances_created,
+           ctx->can_clone_kernel ? "clCloneKernel" : "clCreateKernel");
+    printf("Shared Programs: %zu (reused %llu times, %s builds)\n", ctx->program_count,
+           (unsigned long long)ctx->program_shares, ctx->separate_compile ? "separate" : "full");
+    printf("Specializations: %zu/%zu (hits %llu, misses %llu, evictions %llu)\n",
+           ctx->spec_count, ctx->spec_capacity, (unsigned long long)ctx->spec_hits,
+           (unsigned long long)ctx->spec_misses, (unsigned long long)ctx->spec_evictions);
+    rix_mutex_unlock(&ctx->lock);
     printf("==================================\n\n");
 }
 
@@ -546,9 +2380,15 @@ void retryix_kernel_cleanup(void) {
     
     printf("RetryIX Kernel Manager Cleanup\n");
     
+    // 停止背景編譯並等待已提交的任務結束（未開始的特化直接丟棄）
+    rix_mutex_lock(&ctx->lock);
+    ctx->spec_stop = true;
+    while (ctx->spec_inflight > 0) rix_cond_wait(&ctx->spec_done_cond, &ctx->lock);
+    rix_mutex_unlock(&ctx->lock);
+    
     // 釋放所有內核資源
     for (size_t i = 0; i < ctx->template_count; i++) {
-        retryix_kernel_template_t* tmpl = &ctx->templates[i];
+        retryix_kernel_template_t* tmpl = ctx->templates[i];
         
         if (tmpl->base_source) {
             free(tmpl->base_source);
@@ -556,21 +2396,47 @@ void retryix_kernel_cleanup(void) {
         
         for (int j = 0; j < RETRYIX_KERNEL_STRATEGY_COUNT; j++) {
             retryix_kernel_variant_t* variant = &tmpl->variants[j];
-            if (variant->kernel) {
-                clReleaseKernel(variant->kernel);
-            }
+            rix_mutex_lock(&ctx->lock);
+            destroy_variant_pools(ctx, variant);
+            rix_mutex_unlock(&ctx->lock);
             if (variant->program) {
                 clReleaseProgram(variant->program);
             }
-            if (variant->source_code) {
-                free(variant->source_code);
-            }
         }
     }
     
+    // 釋放共用程序、前導標頭與前導程式庫
+    for (size_t i = 0; i < ctx->program_count; i++) {
+        clReleaseProgram(ctx->programs[i].program);
+        free(ctx->programs[i].build_options);
+    }
+    free(ctx->programs);
+    for (int s = 0; s < RETRYIX_KERNEL_STRATEGY_COUNT; s++) {
+        if (ctx->prelude_headers[s]) clReleaseProgram(ctx->prelude_headers[s]);
+        if (ctx->prelude_libraries[s]) clReleaseProgram(ctx->prelude_libraries[s]);
+    }
+    
     // 打印最終統計
     retryix_kernel_print_stats();
     
+    if (ctx->owns_profiling_queue && ctx->profiling_queue) {
+        clReleaseCommandQueue(ctx->profiling_queue);
+    }
+    
+    rix_mutex_lock(&ctx->lock);
+    for (size_t i = 0; i < ctx->spec_count; i++) {
+        release_spec(ctx, ctx->specs[i]);
+    }
+    rix_mutex_unlock(&ctx->lock);
+    free(ctx->specs);
+    free(ctx->pool_registry);
+    rix_mutex_destroy(&ctx->compile_lock);
+    rix_cond_destroy(&ctx->spec_done_cond);
+    rix_mutex_destroy(&ctx->lock);
+    
+    for (size_t i = 0; i < ctx->template_count; i++) {
+        free(ctx->templates[i]);
+    }
     free(ctx->templates);
     free(ctx);
     g_kernel_context = NULL;
@@ -578,6 +2444,157 @@ void retryix_kernel_cleanup(void) {
     printf("Kernel manager cleanup complete\n");
 }
 
+// === 原子聚合量測 ===
+
+#define RETRYIX_ATOMIC_BENCH_TEMPLATE "retryix_atomic_bench"
+
+// 單一計數器的競爭量測：naive 與 retryix_kernel_atomic_add_demo 相同（每個 work-item 一次全域原子加法）
+static const char* ATOMIC_BENCH_SOURCE =
+"#ifndef RETRYIX_ATOMIC_TWO_PASS\n"
+"__kernel void retryix_atomic_naive(volatile __global RETRYIX_ATOMIC_INT* counter, uint n) {\n"
+"    if (get_global_id(0) < n) RETRYIX_ATOMIC_ADD(counter, 1);\n"
+"}\n"
+"__kernel void retryix_atomic_aggregated(volatile __global RETRYIX_ATOMIC_INT* counter, uint n, __local int* scratch) {\n"
+"    retryix_aggregated_atomic_add(counter, get_global_id(0) < n ? 1 : 0, scratch);\n"
+"}\n"
+"#endif\n"
+"__kernel void retryix_atomic_partials(__global int* partials, uint n, __local int* scratch) {\n"
+"    retryix_aggregated_store_partial(partials, get_global_id(0) < n ? 1 : 0, scratch);\n"
+"}\n"
+"__kernel void retryix_atomic_finish(__global const int* partials, uint count, __global int* out, __local int* scratch) {\n"
+"    retryix_reduce_partials(partials, count, out, scratch);\n"
+"}\n";
+
+// 執行一次計數（兩階段時 finish 非 NULL），回傳設備時間（毫秒）與計數結果
+static double run_atomic_case(retryix_kernel_context_t* ctx, cl_kernel kernel, cl_kernel finish,
+                              cl_mem counter, cl_mem partials, cl_uint n, size_t global, size_t local,
+                              bool use_scratch, int* out_result) {
+    cl_int zero = 0;
+    cl_uint groups = (cl_uint)(global / local);
+    if (clEnqueueWriteBuffer(ctx->profiling_queue, counter, CL_TRUE, 0, sizeof(zero), &zero, 0, NULL, NULL) != CL_SUCCESS) {
+        return -1.0;
+    }
+    
+    cl_mem target = finish ? partials : counter;
+    clSetKernelArg(kernel, 0, sizeof(cl_mem), &target);
+    clSetKernelArg(kernel, 1, sizeof(cl_uint), &n);
+    if (use_scratch) clSetKernelArg(kernel, 2, local * sizeof(cl_int), NULL);
+    
+    cl_event ev[2] = { NULL, NULL };
+    if (clEnqueueNDRangeKernel(ctx->profiling_queue, kernel, 1, NULL, &global, &local, 0, NULL, &ev[0]) != CL_SUCCESS) {
+        return -1.0;
+    }
+    if (finish) {
+        clSetKernelArg(finish, 0, sizeof(cl_mem), &partials);
+        clSetKernelArg(finish, 1, sizeof(cl_uint), &groups);
+        clSetKernelArg(finish, 2, sizeof(cl_mem), &counter);
+        clSetKernelArg(finish, 3, local * sizeof(cl_int), NULL);
+        if (clEnqueueNDRangeKernel(ctx->profiling_queue, finish, 1, NULL, &local, &local, 0, NULL, &ev[1]) != CL_SUCCESS) {
+            clReleaseEvent(ev[0]);
+            return -1.0;
+        }
+    }
+    clFinish(ctx->profiling_queue);
+    
+    double ms = rixEventElapsedMs(ev[0]);
+    clReleaseEvent(ev[0]);
+    if (ev[1]) {
+        double finish_ms = rixEventElapsedMs(ev[1]);
+        ms = (ms < 0.0 || finish_ms < 0.0) ? -1.0 : ms + finish_ms;
+        clReleaseEvent(ev[1]);
+    }
+    
+    clEnqueueReadBuffer(ctx->profiling_queue, counter, CL_TRUE, 0, sizeof(*out_result), out_result, 0, NULL, NULL);
+    return ms;
+}
+
+// 取最佳時間並驗證每次計數皆正確
+static double bench_atomic_case(retryix_kernel_context_t* ctx, const char* label, cl_kernel kernel, cl_kernel finish,
+                                cl_mem counter, cl_mem partials, cl_uint n, size_t global, size_t local,
+                                bool use_scratch, int iterations, double baseline_ms) {
+    if (!kernel) {
+        printf("  %-22s n/a\n", label);
+        return -1.0;
+    }
+    
+    double best = -1.0;
+    bool correct = true;
+    for (int it = 0; it <= iterations; it++) {
+        int result = 0;
+        double ms = run_atomic_case(ctx, kernel, finish, counter, partials, n, global, local, use_scratch, &result);
+        if (result != (int)n) correct = false;
+        if (it == 0 || ms < 0.0) continue; // 第一次為預熱
+        if (best < 0.0 || ms < best) best = ms;
+    }
+    
+    if (best <= 0.0) {
+        printf("  %-22s failed\n", label);
+        return -1.0;
+    }
+    printf("  %-22s %9.4f ms  %10.2f Mupdates/s  %s", label, best, (double)n / (best * 1e3),
+           correct ? "PASS" : "FAIL");
+    if (baseline_ms > 0.0) printf("  (%.2fx vs naive)", baseline_ms / best);
+    printf("\n");
+    return correct ? best : -1.0;
+}
+
+// 比較單一計數器上 naive 全域原子加法、階層式聚合與兩階段歸約的競爭吞吐量
+int retryix_kernel_atomic_benchmark(size_t num_items, int iterations) {
+    if (!g_kernel_context || num_items == 0 || num_items > 0x7FFFFFFF) return -1;
+    if (iterations <= 0) iterations = 5;
+    
+    retryix_kernel_context_t* ctx = g_kernel_context;
+    if (!find_template(ctx, RETRYIX_ATOMIC_BENCH_TEMPLATE) &&
+        retryix_kernel_register_program(RETRYIX_ATOMIC_BENCH_TEMPLATE, ATOMIC_BENCH_SOURCE) != 0) {
+        return -1;
+    }
+    if (ensure_profiling_queue(ctx) != 0) return -1;
+    
+    cl_kernel naive = retryix_kernel_acquire(RETRYIX_ATOMIC_BENCH_TEMPLATE, "retryix_atomic_naive");
+    cl_kernel aggregated = retryix_kernel_acquire(RETRYIX_ATOMIC_BENCH_TEMPLATE, "retryix_atomic_aggregated");
+    cl_kernel partial = retryix_kernel_acquire(RETRYIX_ATOMIC_BENCH_TEMPLATE, "retryix_atomic_partials");
+    cl_kernel finish = retryix_kernel_acquire(RETRYIX_ATOMIC_BENCH_TEMPLATE, "retryix_atomic_finish");
+    
+    // local size：不超過 256 與各內核限制
+    size_t local = 256;
+    if (ctx->max_work_group_size && ctx->max_work_group_size < local) local = ctx->max_work_group_size;
+    cl_kernel limits[4] = { naive, aggregated, partial, finish };
+    for (int i = 0; i < 4; i++) {
+        size_t wg = 0;
+        if (limits[i] && clGetKernelWorkGroupInfo(limits[i], ctx->device, CL_KERNEL_WORK_GROUP_SIZE,
+                                                  sizeof(wg), &wg, NULL) == CL_SUCCESS && wg && wg < local) {
+            local = wg;
+        }
+    }
+    size_t global = (num_items + local - 1) / local * local;
+    cl_uint n = (cl_uint)num_items;
+    
+    cl_int err;
+    cl_mem counter = clCreateBuffer(ctx->context, CL_MEM_READ_WRITE, sizeof(cl_int), NULL, &err);
+    cl_mem partials = clCreateBuffer(ctx->context, CL_MEM_READ_WRITE, (global / local) * sizeof(cl_int), NULL, &err);
+    
+    int rc = -1;
+    if (counter && partials && partial && finish) {
+        printf("\n=== RetryIX Atomic Contention Benchmark ===\n");
+        printf("Updates: %u, local size: %zu, work-groups: %zu\n", n, local, global / local);
+        double naive_ms = bench_atomic_case(ctx, "naive (per work-item)", naive, NULL, counter, partials,
+                                            n, global, local, false, iterations, 0.0);
+        double aggregated_ms = bench_atomic_case(ctx, "hierarchical", aggregated, NULL, counter, partials,
+                                                 n, global, local, true, iterations, naive_ms);
+        double two_pass_ms = bench_atomic_case(ctx, "two-pass", partial, finish, counter, partials,
+                                               n, global, local, true, iterations, naive_ms);
+        printf("===========================================\n\n");
+        rc = (aggregated_ms > 0.0 || two_pass_ms > 0.0) ? 0 : -1;
+    }
+    
+    if (partials) clReleaseMemObject(partials);
+    if (counter) clReleaseMemObject(counter);
+    for (int i = 0; i < 4; i++) {
+        if (limits[i]) retryix_kernel_release(RETRYIX_ATOMIC_BENCH_TEMPLATE, limits[i]);
+    }
+    return rc;
+}
+
 // 強化版 OpenCL 原子加法 demo，可被 Python 呼叫
 #ifdef _WIN32
 #define RETRYIX_API __declspec(dllexport)
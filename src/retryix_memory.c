@@ -2,6 +2,8 @@
 #define CL_TARGET_OPENCL_VERSION 200
 
 #include "retryix.h"
+#include "retryix_hazard.h"
+#include "retryix_thread.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,18 +22,6 @@
 // Forward declaration for unmap function
 int retryix_memory_unmap(void* ptr, cl_command_queue queue);
 
-// 記憶體類型定義
-typedef enum {
-    RETRYIX_MEM_READ_ONLY = 0x1,
-    RETRYIX_MEM_WRITE_ONLY = 0x2,
-    RETRYIX_MEM_READ_WRITE = 0x4,
-    RETRYIX_MEM_HOST_PTR = 0x8,
-    RETRYIX_MEM_ALLOC_HOST_PTR = 0x10,
-    RETRYIX_MEM_COPY_HOST_PTR = 0x20,
-    RETRYIX_MEM_PERSISTENT = 0x40,
-    RETRYIX_MEM_ZERO_COPY = 0x80
-} retryix_memory_flags_t;
-
 // 記憶體描述符
 typedef struct {
     void* host_ptr;                 // 主機端指針
@@ -42,15 +32,20 @@ typedef struct {
     cl_device_id device;            // 關聯設備
     bool is_mapped;                 // 是否已映射
     void* mapped_ptr;               // 映射指針
+    cl_map_flags map_flags;         // 映射模式（解映射時判斷是否寫回）
+    retryix_hazard_t hazard;        // 設備緩衝區的存取紀錄
     uint32_t ref_count;             // 引用計數
     char debug_name[64];            // 調試名稱
 } retryix_memory_descriptor_t;
 
-// 記憶體管理上下文
-typedef struct {
+// 記憶體管理上下文（retryix.h 中為不透明型別）
+struct retryix_memory_context {
     cl_context context;
     cl_device_id device;
     
+    // 保護描述符陣列、存取紀錄與統計（可重入：執行器以 retryix_memory_lock 包住 waits -> 排入 -> record）
+    rix_mutex_t lock;
+    
     // 記憶體池
     retryix_memory_descriptor_t* descriptors;
     size_t descriptor_count;
@@ -73,19 +68,20 @@ typedef struct {
     // 性能統計
     double total_transfer_time;
     double peak_bandwidth;
-} retryix_memory_context_t;
+};
 
 // 全局記憶體管理器
 static retryix_memory_context_t* g_memory_context = NULL;
+// 呼叫執行緒綁定的管理器（例如子設備各自的管理器），未綁定時使用全局管理器
+static RIX_THREAD_LOCAL retryix_memory_context_t* t_memory_bound = NULL;
 
 // === 內部函數 ===
 
-// 初始化記憶體管理器
-retryix_memory_context_t* retryix_memory_init(cl_context context, cl_device_id device) {
-    if (g_memory_context) {
-        return g_memory_context; // 已初始化
-    }
-    
+static retryix_memory_context_t* memory_current(void) {
+    return t_memory_bound ? t_memory_bound : g_memory_context;
+}
+
+static retryix_memory_context_t* memory_create(cl_context context, cl_device_id device) {
     retryix_memory_context_t* ctx = (retryix_memory_context_t*)calloc(1, sizeof(retryix_memory_context_t));
     if (!ctx) return NULL;
     
@@ -106,6 +102,33 @@ retryix_memory_context_t* retryix_memory_init(cl_context context, cl_device_id d
         free(ctx);
         return NULL;
     }
+    rix_mutex_init_recursive(&ctx->lock);
+    return ctx;
+}
+
+// 釋放管理器持有的所有區塊
+static void memory_destroy(retryix_memory_context_t* ctx, bool report) {
+    retryix_memory_context_t* previous = t_memory_bound;
+    t_memory_bound = ctx;
+    while (ctx->descriptor_count > 0) {
+        retryix_memory_free(ctx->descriptors[0].host_ptr);
+    }
+    if (report) retryix_memory_print_stats();
+    t_memory_bound = (previous == ctx) ? NULL : previous;
+    
+    rix_mutex_destroy(&ctx->lock);
+    free(ctx->descriptors);
+    free(ctx);
+}
+
+// 初始化記憶體管理器
+retryix_memory_context_t* retryix_memory_init(cl_context context, cl_device_id device) {
+    if (g_memory_context) {
+        return g_memory_context; // 已初始化
+    }
+    
+    retryix_memory_context_t* ctx = memory_create(context, device);
+    if (!ctx) return NULL;
     
     g_memory_context = ctx;
     
@@ -116,32 +139,74 @@ retryix_memory_context_t* retryix_memory_init(cl_context context, cl_device_id d
     return ctx;
 }
 
-// 查找記憶體描述符
-static retryix_memory_descriptor_t* find_memory_descriptor(void* ptr) {
-    if (!g_memory_context || !ptr) return NULL;
-    
-    for (size_t i = 0; i < g_memory_context->descriptor_count; i++) {
-        if (g_memory_context->descriptors[i].host_ptr == ptr) {
-            return &g_memory_context->descriptors[i];
+// 建立獨立的記憶體管理器（不影響全局管理器），以 retryix_memory_bind 切換
+retryix_memory_context_t* retryix_memory_create(cl_context context, cl_device_id device) {
+    if (!context || !device) return NULL;
+    return memory_create(context, device);
+}
+
+// 自指定的管理器配置（NULL 為全局管理器），不受呼叫執行緒的綁定影響
+void* retryix_memory_alloc_from(retryix_memory_context_t* ctx, size_t size, retryix_memory_flags_t flags,
+                                const char* debug_name) {
+    retryix_memory_context_t* previous = t_memory_bound;
+    t_memory_bound = ctx ? ctx : g_memory_context;
+    void* ptr = retryix_memory_alloc(size, flags, debug_name);
+    t_memory_bound = previous;
+    return ptr;
+}
+
+// 綁定呼叫執行緒使用的管理器，回傳先前綁定者；NULL 恢復為全局管理器
+retryix_memory_context_t* retryix_memory_bind(retryix_memory_context_t* ctx) {
+    retryix_memory_context_t* previous = t_memory_bound;
+    t_memory_bound = ctx;
+    return previous;
+}
+
+void retryix_memory_destroy(retryix_memory_context_t* ctx) {
+    if (!ctx || ctx == g_memory_context) return;
+    memory_destroy(ctx, false);
+}
+
+static retryix_memory_descriptor_t* find_descriptor_in(retryix_memory_context_t* mem, void* ptr) {
+    for (size_t i = 0; i < mem->descriptor_count; i++) {
+        if (mem->descriptors[i].host_ptr == ptr) {
+            return &mem->descriptors[i];
         }
     }
     return NULL;
 }
 
-// 添加記憶體描述符
-static int add_memory_descriptor(retryix_memory_descriptor_t* desc) {
-    if (!g_memory_context) return -1;
-    
+// 查找記憶體描述符：先找綁定的管理器，再找全局管理器（模組內部緩衝區不受呼叫端綁定影響）；
+// owner 設為持有該區塊的管理器。找到時回傳前已鎖定 owner->lock，呼叫端用完描述符後解鎖
+static retryix_memory_descriptor_t* find_memory_descriptor(void* ptr, retryix_memory_context_t** owner) {
+    if (!ptr) return NULL;
+    retryix_memory_context_t* candidates[2] = { t_memory_bound, g_memory_context };
+    for (int c = 0; c < 2; c++) {
+        if (!candidates[c] || (c == 1 && candidates[1] == candidates[0])) continue;
+        rix_mutex_lock(&candidates[c]->lock);
+        retryix_memory_descriptor_t* desc = find_descriptor_in(candidates[c], ptr);
+        if (desc) {
+            *owner = candidates[c];
+            return desc;
+        }
+        rix_mutex_unlock(&candidates[c]->lock);
+    }
+    return NULL;
+}
+
+// 添加記憶體描述符（呼叫端持有 mem->lock）
+static int add_memory_descriptor(retryix_memory_context_t* mem, retryix_memory_descriptor_t* desc) {
     // 擴展容量
-    if (g_memory_context->descriptor_count >= g_memory_context->descriptor_capacity) {
-        g_memory_context->descriptor_capacity *= 2;
-        g_memory_context->descriptors = (retryix_memory_descriptor_t*)realloc(
-            g_memory_context->descriptors,
-            g_memory_context->descriptor_capacity * sizeof(retryix_memory_descriptor_t));
-        if (!g_memory_context->descriptors) return -1;
+    if (mem->descriptor_count >= mem->descriptor_capacity) {
+        size_t capacity = mem->descriptor_capacity * 2;
+        retryix_memory_descriptor_t* grown = (retryix_memory_descriptor_t*)realloc(
+            mem->descriptors, capacity * sizeof(retryix_memory_descriptor_t));
+        if (!grown) return -1;
+        mem->descriptors = grown;
+        mem->descriptor_capacity = capacity;
     }
     
-    g_memory_context->descriptors[g_memory_context->descriptor_count++] = *desc;
+    mem->descriptors[mem->descriptor_count++] = *desc;
     return 0;
 }
 
@@ -149,10 +214,11 @@ static int add_memory_descriptor(retryix_memory_descriptor_t* desc) {
 
 // 通用記憶體分配
 void* retryix_memory_alloc(size_t size, retryix_memory_flags_t flags, const char* debug_name) {
-    if (!g_memory_context || size == 0) return NULL;
+    retryix_memory_context_t* mem = memory_current();
+    if (!mem || size == 0) return NULL;
     
     // 對齊大小
-    size_t alignment = (flags & RETRYIX_MEM_ZERO_COPY) ? g_memory_context->preferred_alignment : g_memory_context->base_alignment;
+    size_t alignment = (flags & RETRYIX_MEM_ZERO_COPY) ? mem->preferred_alignment : mem->base_alignment;
     size_t aligned_size = (size + alignment - 1) & ~(alignment - 1);
     
     void* host_ptr = NULL;
@@ -174,7 +240,7 @@ void* retryix_memory_alloc(size_t size, retryix_memory_flags_t flags, const char
             else if (flags & RETRYIX_MEM_WRITE_ONLY) cl_flags |= CL_MEM_WRITE_ONLY;
             else cl_flags |= CL_MEM_READ_WRITE;
             
-            device_mem = clCreateBuffer(g_memory_context->context, cl_flags, aligned_size, host_ptr, &err);
+            device_mem = clCreateBuffer(mem->context, cl_flags, aligned_size, host_ptr, &err);
             if (err != CL_SUCCESS) {
                 aligned_free(host_ptr);
                 return NULL;
@@ -192,9 +258,9 @@ void* retryix_memory_alloc(size_t size, retryix_memory_flags_t flags, const char
             
             if (flags & RETRYIX_MEM_COPY_HOST_PTR) {
                 cl_flags |= CL_MEM_COPY_HOST_PTR;
-                device_mem = clCreateBuffer(g_memory_context->context, cl_flags, aligned_size, host_ptr, &err);
+                device_mem = clCreateBuffer(mem->context, cl_flags, aligned_size, host_ptr, &err);
             } else {
-                device_mem = clCreateBuffer(g_memory_context->context, cl_flags, aligned_size, NULL, &err);
+                device_mem = clCreateBuffer(mem->context, cl_flags, aligned_size, NULL, &err);
             }
             
             if (err != CL_SUCCESS) {
@@ -212,8 +278,8 @@ void* retryix_memory_alloc(size_t size, retryix_memory_flags_t flags, const char
         desc.device_mem = device_mem;
         desc.size = aligned_size;
         desc.flags = flags;
-        desc.context = g_memory_context->context;
-        desc.device = g_memory_context->device;
+        desc.context = mem->context;
+        desc.device = mem->device;
         desc.is_mapped = false;
         desc.mapped_ptr = NULL;
         desc.ref_count = 1;
@@ -224,16 +290,21 @@ void* retryix_memory_alloc(size_t size, retryix_memory_flags_t flags, const char
             snprintf(desc.debug_name, sizeof(desc.debug_name), "mem_%p", host_ptr);
         }
         
-        if (add_memory_descriptor(&desc) == 0) {
+        rix_mutex_lock(&mem->lock);
+        int added = add_memory_descriptor(mem, &desc);
+        if (added == 0) {
             // 更新統計
-            g_memory_context->total_allocated += aligned_size;
-            g_memory_context->host_allocated += aligned_size;
-            g_memory_context->alloc_count++;
+            mem->total_allocated += aligned_size;
+            mem->host_allocated += aligned_size;
+            mem->alloc_count++;
             
-            if (g_memory_context->total_allocated > g_memory_context->peak_allocated) {
-                g_memory_context->peak_allocated = g_memory_context->total_allocated;
+            if (mem->total_allocated > mem->peak_allocated) {
+                mem->peak_allocated = mem->total_allocated;
             }
-            
+        }
+        rix_mutex_unlock(&mem->lock);
+        
+        if (added == 0) {
             return host_ptr;
         } else {
             // 清理失敗的分配
@@ -247,13 +318,15 @@ void* retryix_memory_alloc(size_t size, retryix_memory_flags_t flags, const char
 
 // 記憶體釋放
 int retryix_memory_free(void* ptr) {
-    if (!g_memory_context || !ptr) return -1;
+    retryix_memory_context_t* mem = memory_current();
+    if (!mem || !ptr) return -1;
     
-    retryix_memory_descriptor_t* desc = find_memory_descriptor(ptr);
+    retryix_memory_descriptor_t* desc = find_memory_descriptor(ptr, &mem);
     if (!desc) return -1;
     
     // 減少引用計數
     if (--desc->ref_count > 0) {
+        rix_mutex_unlock(&mem->lock);
         return 0; // 仍有其他引用
     }
     
@@ -262,6 +335,9 @@ int retryix_memory_free(void* ptr) {
         retryix_memory_unmap(ptr, NULL);
     }
     
+    // 等待仍在使用此緩衝區的命令
+    rix_hazard_sync(&desc->hazard);
+    
     // 釋放 OpenCL 記憶體對象
     if (desc->device_mem) {
         clReleaseMemObject(desc->device_mem);
@@ -274,30 +350,34 @@ int retryix_memory_free(void* ptr) {
     }
     
     // 更新統計
-    g_memory_context->total_allocated -= desc->size;
-    g_memory_context->host_allocated -= desc->size;
-    g_memory_context->free_count++;
+    mem->total_allocated -= desc->size;
+    mem->host_allocated -= desc->size;
+    mem->free_count++;
     
     // 從描述符陣列中移除
-    for (size_t i = 0; i < g_memory_context->descriptor_count; i++) {
-        if (&g_memory_context->descriptors[i] == desc) {
-            g_memory_context->descriptors[i] = g_memory_context->descriptors[--g_memory_context->descriptor_count];
+    for (size_t i = 0; i < mem->descriptor_count; i++) {
+        if (&mem->descriptors[i] == desc) {
+            mem->descriptors[i] = mem->descriptors[--mem->descriptor_count];
             break;
         }
     }
     
+    rix_mutex_unlock(&mem->lock);
     return 0;
 }
 
 // 記憶體映射
 void* retryix_memory_map(void* ptr, cl_command_queue queue, retryix_memory_flags_t map_flags) {
-    if (!g_memory_context || !ptr || !queue) return NULL;
+    retryix_memory_context_t* mem = memory_current();
+    if (!mem || !ptr || !queue) return NULL;
     
-    retryix_memory_descriptor_t* desc = find_memory_descriptor(ptr);
-    if (!desc || !desc->device_mem) return NULL;
+    retryix_memory_descriptor_t* desc = find_memory_descriptor(ptr, &mem);
+    if (!desc) return NULL;
     
-    if (desc->is_mapped) {
-        return desc->mapped_ptr; // 已映射
+    if (!desc->device_mem || desc->is_mapped) {
+        void* existing = desc->is_mapped ? desc->mapped_ptr : NULL; // 已映射
+        rix_mutex_unlock(&mem->lock);
+        return existing;
     }
     
     // 轉換映射標誌
@@ -306,127 +386,224 @@ void* retryix_memory_map(void* ptr, cl_command_queue queue, retryix_memory_flags
     else if (map_flags & RETRYIX_MEM_WRITE_ONLY) cl_flags = CL_MAP_WRITE;
     else cl_flags = CL_MAP_READ | CL_MAP_WRITE;
     
+    cl_event waits[RETRYIX_MAX_HAZARD_WAITS];
+    cl_uint num_waits = 0;
+    rix_hazard_waits_or_sync(&desc->hazard, (cl_flags & CL_MAP_WRITE) != 0, waits, RETRYIX_MAX_HAZARD_WAITS, &num_waits);
+    
     cl_int err;
-    void* mapped = clEnqueueMapBuffer(queue, desc->device_mem, CL_TRUE, cl_flags, 0, desc->size, 0, NULL, NULL, &err);
+    void* mapped = clEnqueueMapBuffer(queue, desc->device_mem, CL_TRUE, cl_flags, 0, desc->size,
+                                      num_waits, num_waits ? waits : NULL, NULL, &err);
     
     if (err == CL_SUCCESS && mapped) {
         desc->is_mapped = true;
         desc->mapped_ptr = mapped;
+        desc->map_flags = cl_flags;
         printf("Memory mapped: %s -> %p\n", desc->debug_name, mapped);
-        return mapped;
+    } else {
+        mapped = NULL;
     }
     
-    return NULL;
+    rix_mutex_unlock(&mem->lock);
+    return mapped;
 }
 
 // 記憶體解映射
 int retryix_memory_unmap(void* ptr, cl_command_queue queue) {
-    if (!g_memory_context || !ptr) return -1;
+    retryix_memory_context_t* mem = memory_current();
+    if (!mem || !ptr) return -1;
     
-    retryix_memory_descriptor_t* desc = find_memory_descriptor(ptr);
-    if (!desc || !desc->is_mapped) return -1;
+    retryix_memory_descriptor_t* desc = find_memory_descriptor(ptr, &mem);
+    if (!desc) return -1;
     
-    if (queue && desc->device_mem && desc->mapped_ptr) {
-        cl_int err = clEnqueueUnmapMemObject(queue, desc->device_mem, desc->mapped_ptr, 0, NULL, NULL);
+    int rc = -1;
+    if (desc->is_mapped && queue && desc->device_mem && desc->mapped_ptr) {
+        // 可寫映射在解映射時寫回，視為一次寫入
+        cl_event ev = NULL;
+        cl_int err = clEnqueueUnmapMemObject(queue, desc->device_mem, desc->mapped_ptr, 0, NULL, &ev);
         if (err == CL_SUCCESS) {
+            rix_hazard_record(&desc->hazard, (desc->map_flags & CL_MAP_WRITE) != 0, ev);
+            clReleaseEvent(ev);
             desc->is_mapped = false;
             desc->mapped_ptr = NULL;
             printf("Memory unmapped: %s\n", desc->debug_name);
-            return 0;
+            rc = 0;
         }
     }
     
-    return -1;
+    rix_mutex_unlock(&mem->lock);
+    return rc;
 }
 
 // 記憶體拷貝（主機到設備）
 int retryix_memory_copy_to_device(void* host_ptr, cl_command_queue queue, bool blocking) {
-    if (!g_memory_context || !host_ptr || !queue) return -1;
+    retryix_memory_context_t* mem = memory_current();
+    if (!mem || !host_ptr || !queue) return -1;
     
-    retryix_memory_descriptor_t* desc = find_memory_descriptor(host_ptr);
-    if (!desc || !desc->device_mem) return -1;
+    retryix_memory_descriptor_t* desc = find_memory_descriptor(host_ptr, &mem);
+    if (!desc) return -1;
     
     // 如果是零拷貝記憶體，不需要拷貝
-    if (desc->flags & RETRYIX_MEM_ZERO_COPY) {
-        return 0; // 成功但無操作
+    if (!desc->device_mem || (desc->flags & RETRYIX_MEM_ZERO_COPY)) {
+        int rc = desc->device_mem ? 0 : -1; // 零拷貝：成功但無操作
+        rix_mutex_unlock(&mem->lock);
+        return rc;
     }
     
+    // 寫入設備緩衝區：等待先前的讀取（WAR）或寫入（WAW）
+    cl_event waits[RETRYIX_MAX_HAZARD_WAITS];
+    cl_uint num_waits = 0;
+    rix_hazard_waits_or_sync(&desc->hazard, true, waits, RETRYIX_MAX_HAZARD_WAITS, &num_waits);
+    
+    cl_event ev = NULL;
     cl_int err = clEnqueueWriteBuffer(queue, desc->device_mem, blocking ? CL_TRUE : CL_FALSE,
-                                     0, desc->size, desc->host_ptr, 0, NULL, NULL);
+                                     0, desc->size, desc->host_ptr, num_waits, num_waits ? waits : NULL, &ev);
     
     if (err == CL_SUCCESS) {
-        g_memory_context->transfer_count++;
-        g_memory_context->total_transferred += desc->size;
+        rix_hazard_record(&desc->hazard, true, ev);
+        clReleaseEvent(ev);
+        mem->transfer_count++;
+        mem->total_transferred += desc->size;
         printf("Host->Device: %s (%zu bytes)\n", desc->debug_name, desc->size);
-        return 0;
     }
     
-    return -1;
+    rix_mutex_unlock(&mem->lock);
+    return err == CL_SUCCESS ? 0 : -1;
 }
 
 // 記憶體拷貝（設備到主機）
 int retryix_memory_copy_from_device(void* host_ptr, cl_command_queue queue, bool blocking) {
-    if (!g_memory_context || !host_ptr || !queue) return -1;
+    retryix_memory_context_t* mem = memory_current();
+    if (!mem || !host_ptr || !queue) return -1;
     
-    retryix_memory_descriptor_t* desc = find_memory_descriptor(host_ptr);
-    if (!desc || !desc->device_mem) return -1;
+    retryix_memory_descriptor_t* desc = find_memory_descriptor(host_ptr, &mem);
+    if (!desc) return -1;
     
     // 如果是零拷貝記憶體，不需要拷貝
-    if (desc->flags & RETRYIX_MEM_ZERO_COPY) {
-        return 0; // 成功但無操作
+    if (!desc->device_mem || (desc->flags & RETRYIX_MEM_ZERO_COPY)) {
+        int rc = desc->device_mem ? 0 : -1; // 零拷貝：成功但無操作
+        rix_mutex_unlock(&mem->lock);
+        return rc;
     }
     
+    // 讀取設備緩衝區：等待最後寫入（RAW）
+    // 非阻塞讀取登記為讀取者，之後寫回 host_ptr 的傳輸會等待它完成
+    cl_event waits[RETRYIX_MAX_HAZARD_WAITS];
+    cl_uint num_waits = 0;
+    rix_hazard_waits_or_sync(&desc->hazard, false, waits, RETRYIX_MAX_HAZARD_WAITS, &num_waits);
+    
+    cl_event ev = NULL;
     cl_int err = clEnqueueReadBuffer(queue, desc->device_mem, blocking ? CL_TRUE : CL_FALSE,
-                                    0, desc->size, desc->host_ptr, 0, NULL, NULL);
+                                    0, desc->size, desc->host_ptr, num_waits, num_waits ? waits : NULL, &ev);
     
     if (err == CL_SUCCESS) {
-        g_memory_context->transfer_count++;
-        g_memory_context->total_transferred += desc->size;
+        rix_hazard_record(&desc->hazard, false, ev);
+        clReleaseEvent(ev);
+        mem->transfer_count++;
+        mem->total_transferred += desc->size;
         printf("Device->Host: %s (%zu bytes)\n", desc->debug_name, desc->size);
-        return 0;
     }
     
-    return -1;
+    rix_mutex_unlock(&mem->lock);
+    return err == CL_SUCCESS ? 0 : -1;
 }
 
 // 取得設備記憶體對象
 cl_mem retryix_memory_get_device_mem(void* host_ptr) {
-    if (!g_memory_context || !host_ptr) return NULL;
+    retryix_memory_context_t* mem = memory_current();
+    if (!mem || !host_ptr) return NULL;
+    
+    retryix_memory_descriptor_t* desc = find_memory_descriptor(host_ptr, &mem);
+    if (!desc) return NULL;
+    
+    cl_mem device_mem = desc->device_mem;
+    rix_mutex_unlock(&mem->lock);
+    return device_mem;
+}
+
+// 收集存取設備緩衝區前需等待的事件（寫入模式需等待讀取者，讀取只需等待最後寫入）
+int retryix_memory_hazard_waits(void* host_ptr, retryix_access_t access,
+                                cl_event* waits, cl_uint max_waits, cl_uint* num_waits) {
+    retryix_memory_context_t* mem = memory_current();
+    if (!mem || !host_ptr || !num_waits || (max_waits && !waits)) return -1;
     
-    retryix_memory_descriptor_t* desc = find_memory_descriptor(host_ptr);
-    return desc ? desc->device_mem : NULL;
+    retryix_memory_descriptor_t* desc = find_memory_descriptor(host_ptr, &mem);
+    if (!desc) return -1;
+    
+    int rc = rix_hazard_waits(&desc->hazard, (access & RETRYIX_ACCESS_WRITE) != 0, waits, max_waits, num_waits);
+    rix_mutex_unlock(&mem->lock);
+    return rc;
+}
+
+// 登記已排入的存取事件
+int retryix_memory_hazard_record(void* host_ptr, retryix_access_t access, cl_event event) {
+    retryix_memory_context_t* mem = memory_current();
+    if (!mem || !host_ptr || !event) return -1;
+    
+    retryix_memory_descriptor_t* desc = find_memory_descriptor(host_ptr, &mem);
+    if (!desc) return -1;
+    
+    rix_hazard_record(&desc->hazard, (access & RETRYIX_ACCESS_WRITE) != 0, event);
+    rix_mutex_unlock(&mem->lock);
+    return 0;
+}
+
+// 等待緩衝區所有未完成的存取（主機端讀寫 host_ptr 前呼叫）
+int retryix_memory_sync(void* host_ptr) {
+    retryix_memory_context_t* mem = memory_current();
+    if (!mem || !host_ptr) return -1;
+    
+    retryix_memory_descriptor_t* desc = find_memory_descriptor(host_ptr, &mem);
+    if (!desc) return -1;
+    
+    rix_hazard_sync(&desc->hazard);
+    rix_mutex_unlock(&mem->lock);
+    return 0;
+}
+
+// 鎖定呼叫執行緒可見的管理器（綁定者在前、全局在後，各執行緒順序一致）
+void retryix_memory_lock(void) {
+    if (t_memory_bound) rix_mutex_lock(&t_memory_bound->lock);
+    if (g_memory_context && g_memory_context != t_memory_bound) rix_mutex_lock(&g_memory_context->lock);
+}
+
+void retryix_memory_unlock(void) {
+    if (g_memory_context && g_memory_context != t_memory_bound) rix_mutex_unlock(&g_memory_context->lock);
+    if (t_memory_bound) rix_mutex_unlock(&t_memory_bound->lock);
 }
 
 // 記憶體統計報告
 void retryix_memory_print_stats(void) {
-    if (!g_memory_context) {
+    retryix_memory_context_t* mem = memory_current();
+    if (!mem) {
         printf("Memory manager not initialized\n");
         return;
     }
     
+    rix_mutex_lock(&mem->lock);
     printf("\n=== RetryIX Memory Statistics ===\n");
-    printf("Total Allocations: %llu\n", (unsigned long long)g_memory_context->alloc_count);
-    printf("Total Frees: %llu\n", (unsigned long long)g_memory_context->free_count);
-    printf("Active Allocations: %zu\n", g_memory_context->descriptor_count);
-    printf("Current Allocated: %.2f MB\n", (double)g_memory_context->total_allocated / (1024*1024));
-    printf("Peak Allocated: %.2f MB\n", (double)g_memory_context->peak_allocated / (1024*1024));
-    printf("Total Transfers: %llu\n", (unsigned long long)g_memory_context->transfer_count);
-    printf("Total Transferred: %.2f MB\n", (double)g_memory_context->total_transferred / (1024*1024));
-    
-    if (g_memory_context->total_transfer_time > 0) {
-        double bandwidth = (g_memory_context->total_transferred / (1024*1024)) / g_memory_context->total_transfer_time;
+    printf("Total Allocations: %llu\n", (unsigned long long)mem->alloc_count);
+    printf("Total Frees: %llu\n", (unsigned long long)mem->free_count);
+    printf("Active Allocations: %zu\n", mem->descriptor_count);
+    printf("Current Allocated: %.2f MB\n", (double)mem->total_allocated / (1024*1024));
+    printf("Peak Allocated: %.2f MB\n", (double)mem->peak_allocated / (1024*1024));
+    printf("Total Transfers: %llu\n", (unsigned long long)mem->transfer_count);
+    printf("Total Transferred: %.2f MB\n", (double)mem->total_transferred / (1024*1024));
+    
+    if (mem->total_transfer_time > 0) {
+        double bandwidth = (mem->total_transferred / (1024*1024)) / mem->total_transfer_time;
         printf("Average Bandwidth: %.2f MB/s\n", bandwidth);
-        printf("Peak Bandwidth: %.2f MB/s\n", g_memory_context->peak_bandwidth);
+        printf("Peak Bandwidth: %.2f MB/s\n", mem->peak_bandwidth);
     }
     
     printf("\nActive Memory Blocks:\n");
-    for (size_t i = 0; i < g_memory_context->descriptor_count; i++) {
-        retryix_memory_descriptor_t* desc = &g_memory_context->descriptors[i];
+    for (size_t i = 0; i < mem->descriptor_count; i++) {
+        retryix_memory_descriptor_t* desc = &mem->descriptors[i];
         printf("  %s: %p (%zu bytes, refs=%u, mapped=%s)\n",
                desc->debug_name, desc->host_ptr, desc->size, desc->ref_count,
                desc->is_mapped ? "YES" : "NO");
     }
     printf("===================================\n\n");
+    rix_mutex_unlock(&mem->lock);
 }
 
 // 清理記憶體管理器
@@ -435,16 +612,8 @@ void retryix_memory_cleanup(void) {
     
     printf("RetryIX Memory Manager Cleanup\n");
     
-    // 釋放所有未釋放的記憶體
-    while (g_memory_context->descriptor_count > 0) {
-        retryix_memory_free(g_memory_context->descriptors[0].host_ptr);
-    }
-    
-    // 打印最終統計
-    retryix_memory_print_stats();
-    
-    free(g_memory_context->descriptors);
-    free(g_memory_context);
+    // 釋放所有未釋放的記憶體並打印最終統計
+    memory_destroy(g_memory_context, true);
     g_memory_context = NULL;
     
     printf("Memory manager cleanup complete\n");
@@ -452,12 +621,14 @@ void retryix_memory_cleanup(void) {
 
 // 記憶體完整性檢查
 int retryix_memory_validate(void) {
-    if (!g_memory_context) return -1;
+    retryix_memory_context_t* mem = memory_current();
+    if (!mem) return -1;
     
     int errors = 0;
+    rix_mutex_lock(&mem->lock);
     
-    for (size_t i = 0; i < g_memory_context->descriptor_count; i++) {
-        retryix_memory_descriptor_t* desc = &g_memory_context->descriptors[i];
+    for (size_t i = 0; i < mem->descriptor_count; i++) {
+        retryix_memory_descriptor_t* desc = &mem->descriptors[i];
         
         // 檢查基本指針
         if (!desc->host_ptr) {
@@ -483,8 +654,10 @@ int retryix_memory_validate(void) {
         }
     }
     
+    rix_mutex_unlock(&mem->lock);
+    
     if (errors == 0) {
-        printf("Memory validation passed (%zu blocks checked)\n", g_memory_context->descriptor_count);
+        printf("Memory validation passed (%zu blocks checked)\n", mem->descriptor_count);
     } else {
         printf("Memory validation failed with %d errors\n", errors);
     }
@@ -0,0 +1,796 @@
+// retryix_multi.c - RetryIX 多設備 NDRange：依觀測吞吐量動態分派區塊（guided self-scheduling）並合併各設備輸出
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include "retryix_thread.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define RETRYIX_MULTI_MAX_DEVICES    16
+#define RETRYIX_MULTI_MAX_TEMPLATES  32
+#define RETRYIX_MULTI_GUIDE_FACTOR   2.0     // 每次取自身剩餘份額的 1/2，尾段區塊自然縮小
+#define RETRYIX_MULTI_PROBE_DIVISOR  8       // 尚無吞吐量時首塊為平均份額的 1/8
+#define RETRYIX_MULTI_EWMA           0.5     // 吞吐量平滑係數
+#define RETRYIX_MULTI_BENCH_ROUNDS   256
+
+typedef struct {
+    cl_device_id device;
+    cl_context context;
+    cl_command_queue queue;
+    char name[128];
+    cl_device_type type;
+
+    uint64_t chunks;
+    uint64_t items;
+    uint64_t failures;
+    double busy_ms;
+} retryix_multi_device_t;
+
+typedef struct {
+    char template_name[64];
+    char kernel_name[64];
+    char* source;
+    cl_program programs[RETRYIX_MULTI_MAX_DEVICES];
+    cl_kernel kernels[RETRYIX_MULTI_MAX_DEVICES];
+    bool build_failed[RETRYIX_MULTI_MAX_DEVICES];
+    double throughput[RETRYIX_MULTI_MAX_DEVICES];   // 歷史吞吐量（work-item/ms），0 = 未量測
+} retryix_multi_template_t;
+
+typedef struct {
+    retryix_multi_device_t devices[RETRYIX_MULTI_MAX_DEVICES];
+    int device_count;
+    int max_devices;
+    retryix_multi_template_t templates[RETRYIX_MULTI_MAX_TEMPLATES];
+    int template_count;
+    rix_mutex_t exec_lock;                  // 各設備的內核物件跨呼叫共用，執行序列化
+} retryix_multi_context_t;
+
+static retryix_multi_context_t* g_multi_context = NULL;
+static rix_mutex_t g_multi_init_lock;       // 序列化建立 / 清除（首次使用時可能由多個執行緒同時觸發）
+static rix_once_t g_multi_once = RIX_ONCE_INIT;
+
+// 以切分維度的單位計（有 local size 時為一個工作組寬度）
+typedef struct {
+    size_t begin;
+    size_t count;
+} retryix_multi_range_t;
+
+// 單次執行的共用排程狀態
+typedef struct {
+    retryix_multi_context_t* ctx;
+    retryix_multi_template_t* tmpl;
+    cl_uint work_dim;
+    size_t global[2];
+    size_t local[2];
+    bool has_local;
+    cl_uint split_dim;                      // 1-D 切第 0 維，2-D 切第 1 維（列）
+    size_t unit;
+    size_t total_units;
+    size_t items_per_unit;
+    size_t min_units;
+    const retryix_multi_arg_t* args;
+    cl_uint num_args;
+
+    rix_mutex_t lock;
+    size_t next;
+    retryix_multi_range_t returned[RETRYIX_MULTI_MAX_DEVICES];  // 失敗設備退回的區塊
+    int returned_count;
+    bool active[RETRYIX_MULTI_MAX_DEVICES];
+    int live;
+    double weight[RETRYIX_MULTI_MAX_DEVICES];
+} retryix_multi_run_t;
+
+typedef struct {
+    retryix_multi_run_t* run;
+    int device;
+} retryix_multi_driver_t;
+
+static const char* device_type_label(cl_device_type type) {
+    if (type & CL_DEVICE_TYPE_GPU) return "GPU";
+    if (type & CL_DEVICE_TYPE_CPU) return "CPU";
+    if (type & CL_DEVICE_TYPE_ACCELERATOR) return "ACC";
+    return "OTHER";
+}
+
+// DeviceManager\DeviceBlacklist：以逗號分隔的設備名稱片段
+static bool blacklisted(const char* name) {
+    char list[512] = {0};
+    if (retryix_config_get_string("DeviceManager", "DeviceBlacklist", list, sizeof(list)) != RETRYIX_SUCCESS) return false;
+    for (char* tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+        while (*tok == ' ') tok++;
+        size_t len = strlen(tok);
+        while (len > 0 && tok[len - 1] == ' ') tok[--len] = '\0';
+        if (len > 0 && strstr(name, tok)) return true;
+    }
+    return false;
+}
+
+static void init_multi_lock(void) {
+    rix_mutex_init(&g_multi_init_lock);
+}
+
+// 已發布的管理器（建立完成後才可見）
+static retryix_multi_context_t* multi_current(void) {
+    return (retryix_multi_context_t*)rix_atomic_load_ptr((void* volatile*)&g_multi_context);
+}
+
+// 首次使用時建立；多個執行緒同時首次呼叫時只會建立一個管理器
+static retryix_multi_context_t* multi_get(void) {
+    retryix_multi_context_t* ctx = multi_current();
+    if (ctx) return ctx;
+
+    rix_call_once(&g_multi_once, init_multi_lock);
+    rix_mutex_lock(&g_multi_init_lock);
+    ctx = g_multi_context;
+    if (!ctx) {
+        ctx = (retryix_multi_context_t*)calloc(1, sizeof(retryix_multi_context_t));
+        if (ctx) {
+            unsigned long max_devices = retryix_config_get_dword("DeviceManager", "MaxDevices", 8);
+            if (max_devices == 0) max_devices = 1;
+            if (max_devices > RETRYIX_MULTI_MAX_DEVICES) max_devices = RETRYIX_MULTI_MAX_DEVICES;
+            ctx->max_devices = (int)max_devices;
+            rix_mutex_init(&ctx->exec_lock);
+            rix_atomic_store_ptr((void* volatile*)&g_multi_context, ctx);
+        }
+    }
+    rix_mutex_unlock(&g_multi_init_lock);
+    return ctx;
+}
+
+static retryix_multi_template_t* find_template(retryix_multi_context_t* ctx, const char* template_name) {
+    for (int t = 0; t < ctx->template_count; t++) {
+        if (strcmp(ctx->templates[t].template_name, template_name) == 0) return &ctx->templates[t];
+    }
+    return NULL;
+}
+
+static void release_template(retryix_multi_template_t* tmpl) {
+    for (int d = 0; d < RETRYIX_MULTI_MAX_DEVICES; d++) {
+        if (tmpl->kernels[d]) clReleaseKernel(tmpl->kernels[d]);
+        if (tmpl->programs[d]) clReleaseProgram(tmpl->programs[d]);
+    }
+    free(tmpl->source);
+    memset(tmpl, 0, sizeof(*tmpl));
+}
+
+// 首次於該設備使用時編譯；失敗的設備於此模板不再參與
+static bool ensure_kernel(retryix_multi_context_t* ctx, retryix_multi_template_t* tmpl, int d) {
+    if (tmpl->kernels[d]) return true;
+    if (tmpl->build_failed[d]) return false;
+
+    retryix_multi_device_t* dev = &ctx->devices[d];
+    cl_int err = CL_SUCCESS;
+    tmpl->programs[d] = rixBuildProgram(dev->context, dev->device, tmpl->source, NULL);
+    if (tmpl->programs[d]) tmpl->kernels[d] = clCreateKernel(tmpl->programs[d], tmpl->kernel_name, &err);
+    if (!tmpl->kernels[d]) {
+        printf("RetryIX Multi-Device: %s unavailable on [%d] %s\n", tmpl->template_name, d, dev->name);
+        if (tmpl->programs[d]) clReleaseProgram(tmpl->programs[d]);
+        tmpl->programs[d] = NULL;
+        tmpl->build_failed[d] = true;
+        return false;
+    }
+    return true;
+}
+
+// === 排程 ===
+
+// 依各設備吞吐量比例取剩餘工作的 1/GUIDE_FACTOR；未量測的設備以已知平均估計並先取小塊探測
+static bool next_chunk(retryix_multi_run_t* run, int d, retryix_multi_range_t* out) {
+    bool ok = false;
+    rix_mutex_lock(&run->lock);
+    if (run->returned_count > 0) {
+        *out = run->returned[--run->returned_count];
+        ok = true;
+    } else if (run->next < run->total_units) {
+        size_t remaining = run->total_units - run->next;
+        double known = 0.0;
+        int known_count = 0;
+        for (int i = 0; i < RETRYIX_MULTI_MAX_DEVICES; i++) {
+            if (run->active[i] && run->weight[i] > 0.0) {
+                known += run->weight[i];
+                known_count++;
+            }
+        }
+        double fallback = known_count ? known / known_count : 1.0;
+        double sum = 0.0, mine = fallback;
+        for (int i = 0; i < RETRYIX_MULTI_MAX_DEVICES; i++) {
+            if (!run->active[i]) continue;
+            double w = run->weight[i] > 0.0 ? run->weight[i] : fallback;
+            sum += w;
+            if (i == d) mine = w;
+        }
+
+        size_t n = (size_t)ceil((double)remaining * (mine / sum) / RETRYIX_MULTI_GUIDE_FACTOR);
+        if (run->weight[d] <= 0.0) {
+            size_t probe = remaining / ((size_t)(run->live > 0 ? run->live : 1) * RETRYIX_MULTI_PROBE_DIVISOR);
+            if (n > probe) n = probe;
+        }
+        if (n < run->min_units) n = run->min_units;
+        if (n > remaining) n = remaining;
+
+        out->begin = run->next;
+        out->count = n;
+        run->next += n;
+        ok = true;
+    }
+    rix_mutex_unlock(&run->lock);
+    return ok;
+}
+
+static void record_chunk(retryix_multi_run_t* run, int d, size_t items, double ms) {
+    retryix_multi_device_t* dev = &run->ctx->devices[d];
+    double tp = (double)items / (ms > 1e-3 ? ms : 1e-3);
+    rix_mutex_lock(&run->lock);
+    run->weight[d] = run->weight[d] > 0.0 ? RETRYIX_MULTI_EWMA * tp + (1.0 - RETRYIX_MULTI_EWMA) * run->weight[d] : tp;
+    dev->chunks++;
+    dev->items += items;
+    dev->busy_ms += ms;
+    rix_mutex_unlock(&run->lock);
+}
+
+// 設備失敗：退回手上的區塊由其他設備接手，本次執行不再使用該設備
+static void retire_device(retryix_multi_run_t* run, int d, const retryix_multi_range_t* range, cl_int err) {
+    retryix_multi_device_t* dev = &run->ctx->devices[d];
+    rix_mutex_lock(&run->lock);
+    if (range) run->returned[run->returned_count++] = *range;
+    if (run->active[d]) {
+        run->active[d] = false;
+        run->live--;
+    }
+    dev->failures++;
+    rix_mutex_unlock(&run->lock);
+    printf("RetryIX Multi-Device: [%d] %s failed (%s)%s\n", d, dev->name, rixCLErrorName(err),
+           range ? ", chunk reassigned" : "");
+}
+
+// 每個設備一個池任務：上傳輸入後持續領取區塊，執行完只讀回該區塊的輸出列
+static void driver_task(void* arg) {
+    retryix_multi_driver_t* driver = (retryix_multi_driver_t*)arg;
+    retryix_multi_run_t* run = driver->run;
+    int d = driver->device;
+    retryix_multi_device_t* dev = &run->ctx->devices[d];
+    cl_kernel kernel = run->tmpl->kernels[d];
+    cl_mem mems[RETRYIX_MULTI_MAX_ARGS] = { NULL };
+    cl_int err = CL_SUCCESS;
+
+    for (cl_uint a = 0; a < run->num_args && err == CL_SUCCESS; a++) {
+        const retryix_multi_arg_t* ka = &run->args[a];
+        switch (ka->kind) {
+        case RETRYIX_MULTI_ARG_SCALAR:
+            err = clSetKernelArg(kernel, a, ka->size, ka->ptr);
+            break;
+        case RETRYIX_MULTI_ARG_LOCAL:
+            err = clSetKernelArg(kernel, a, ka->size, NULL);
+            break;
+        case RETRYIX_MULTI_ARG_INPUT:
+            mems[a] = clCreateBuffer(dev->context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, ka->size, ka->ptr, &err);
+            if (err == CL_SUCCESS) err = clSetKernelArg(kernel, a, sizeof(cl_mem), &mems[a]);
+            break;
+        case RETRYIX_MULTI_ARG_OUTPUT:
+            mems[a] = clCreateBuffer(dev->context, CL_MEM_WRITE_ONLY, ka->size, NULL, &err);
+            if (err == CL_SUCCESS) err = clSetKernelArg(kernel, a, sizeof(cl_mem), &mems[a]);
+            break;
+        default:
+            err = CL_INVALID_ARG_VALUE;
+            break;
+        }
+    }
+    if (err != CL_SUCCESS) retire_device(run, d, NULL, err);
+
+    retryix_multi_range_t range;
+    while (err == CL_SUCCESS && next_chunk(run, d, &range)) {
+        size_t offset[2] = { 0, 0 };
+        size_t global[2] = { run->global[0], run->global[1] };
+        offset[run->split_dim] = range.begin * run->unit;
+        global[run->split_dim] = range.count * run->unit;
+
+        double t0 = rixNowMs();
+        err = clEnqueueNDRangeKernel(dev->queue, kernel, run->work_dim, offset, global,
+                                     run->has_local ? run->local : NULL, 0, NULL, NULL);
+        for (cl_uint a = 0; a < run->num_args && err == CL_SUCCESS; a++) {
+            const retryix_multi_arg_t* ka = &run->args[a];
+            if (ka->kind != RETRYIX_MULTI_ARG_OUTPUT) continue;
+            size_t first = offset[run->split_dim] * ka->row_bytes;
+            size_t bytes = global[run->split_dim] * ka->row_bytes;
+            if (first >= ka->size) continue;
+            if (bytes > ka->size - first) bytes = ka->size - first;
+            err = clEnqueueReadBuffer(dev->queue, mems[a], CL_FALSE, first, bytes, (char*)ka->ptr + first, 0, NULL, NULL);
+        }
+        if (err == CL_SUCCESS) err = clFinish(dev->queue);
+        if (err != CL_SUCCESS) {
+            clFinish(dev->queue);
+            retire_device(run, d, &range, err);
+            break;
+        }
+        record_chunk(run, d, range.count * run->items_per_unit, rixNowMs() - t0);
+    }
+
+    for (cl_uint a = 0; a < run->num_args; a++) {
+        if (mems[a]) clReleaseMemObject(mems[a]);
+    }
+}
+
+static bool work_remains(retryix_multi_run_t* run) {
+    rix_mutex_lock(&run->lock);
+    bool remains = run->returned_count > 0 || run->next < run->total_units;
+    rix_mutex_unlock(&run->lock);
+    return remains;
+}
+
+static int execute_devices(uint32_t mask, const char* template_name, cl_uint work_dim, const size_t* global,
+                           const size_t* local, const retryix_multi_arg_t* args, cl_uint num_args) {
+    retryix_multi_context_t* ctx = multi_current();
+    if (!ctx || !template_name || !global || work_dim < 1 || work_dim > 2) return -1;
+    if (num_args > RETRYIX_MULTI_MAX_ARGS || (num_args > 0 && !args)) return -1;
+    for (cl_uint i = 0; i < work_dim; i++) {
+        if (global[i] == 0) return -1;
+        if (local && (local[i] == 0 || global[i] % local[i] != 0)) return -1;
+    }
+    for (cl_uint a = 0; a < num_args; a++) {
+        const retryix_multi_arg_t* ka = &args[a];
+        if (ka->size == 0) return -1;
+        if (ka->kind != RETRYIX_MULTI_ARG_LOCAL && !ka->ptr) return -1;
+        if (ka->kind == RETRYIX_MULTI_ARG_OUTPUT && ka->row_bytes == 0) return -1;
+    }
+
+    rix_mutex_lock(&ctx->exec_lock);
+    retryix_multi_template_t* tmpl = find_template(ctx, template_name);
+    if (!tmpl) {
+        rix_mutex_unlock(&ctx->exec_lock);
+        printf("RetryIX Multi-Device: template %s not registered\n", template_name);
+        return -1;
+    }
+
+    retryix_multi_run_t run;
+    memset(&run, 0, sizeof(run));
+    run.ctx = ctx;
+    run.tmpl = tmpl;
+    run.work_dim = work_dim;
+    run.global[0] = global[0];
+    run.global[1] = work_dim > 1 ? global[1] : 1;
+    run.has_local = (local != NULL);
+    run.local[0] = local ? local[0] : 0;
+    run.local[1] = (local && work_dim > 1) ? local[1] : 0;
+    run.split_dim = work_dim - 1;
+    run.unit = local ? local[run.split_dim] : 1;
+    run.total_units = global[run.split_dim] / run.unit;
+    run.items_per_unit = run.unit * (work_dim > 1 ? global[0] : 1);
+    unsigned long min_items = retryix_config_get_dword("MultiDevice", "MinChunkItems", 16384);
+    run.min_units = (min_items + run.items_per_unit - 1) / run.items_per_unit;
+    if (run.min_units == 0) run.min_units = 1;
+    run.args = args;
+    run.num_args = num_args;
+    rix_mutex_init(&run.lock);
+
+    for (int d = 0; d < ctx->device_count; d++) {
+        if (!(mask & (1u << d)) || !ensure_kernel(ctx, tmpl, d)) continue;
+        run.active[d] = true;
+        run.weight[d] = tmpl->throughput[d];
+        run.live++;
+    }
+
+    // 一輪結束仍有剩餘表示有設備失敗退回區塊，由仍可用的設備再跑一輪
+    retryix_multi_driver_t drivers[RETRYIX_MULTI_MAX_DEVICES];
+    while (run.live > 0 && work_remains(&run)) {
+        retryix_pool_group_t group;
+        retryix_pool_group_init(&group);
+        for (int d = 0; d < ctx->device_count; d++) {
+            if (!run.active[d]) continue;
+            drivers[d].run = &run;
+            drivers[d].device = d;
+            retryix_pool_spawn(&group, driver_task, &drivers[d]);
+        }
+        retryix_pool_wait(&group);
+    }
+
+    int rc = work_remains(&run) ? -1 : 0;
+    for (int d = 0; d < ctx->device_count; d++) {
+        if (run.weight[d] > 0.0) tmpl->throughput[d] = run.weight[d];
+    }
+    rix_mutex_destroy(&run.lock);
+    rix_mutex_unlock(&ctx->exec_lock);
+
+    if (rc != 0) printf("RetryIX Multi-Device: %s incomplete, no usable device left\n", template_name);
+    return rc;
+}
+
+// context 非 NULL 時共用（各設備各持一個參考），否則為該設備建立獨立 context
+static int add_device(retryix_multi_context_t* ctx, cl_device_id device, cl_context context) {
+    rix_mutex_lock(&ctx->exec_lock);
+    for (int d = 0; d < ctx->device_count; d++) {
+        if (ctx->devices[d].device == device) {
+            rix_mutex_unlock(&ctx->exec_lock);
+            return d;
+        }
+    }
+    if (ctx->device_count >= ctx->max_devices) {
+        rix_mutex_unlock(&ctx->exec_lock);
+        return -1;
+    }
+
+    retryix_multi_device_t* dev = &ctx->devices[ctx->device_count];
+    memset(dev, 0, sizeof(*dev));
+    cl_int err = CL_SUCCESS;
+    if (context) {
+        err = clRetainContext(context);
+        if (err == CL_SUCCESS) dev->context = context;
+    } else {
+        cl_platform_id platform = NULL;
+        clGetDeviceInfo(device, CL_DEVICE_PLATFORM, sizeof(platform), &platform, NULL);
+        cl_context_properties props[] = { CL_CONTEXT_PLATFORM, (cl_context_properties)platform, 0 };
+        dev->context = clCreateContext(platform ? props : NULL, 1, &device, NULL, NULL, &err);
+    }
+    if (err == CL_SUCCESS) dev->queue = rixCreateQueue(dev->context, device, &err);
+    if (err != CL_SUCCESS) {
+        if (dev->context) clReleaseContext(dev->context);
+        dev->context = NULL;
+        rix_mutex_unlock(&ctx->exec_lock);
+        printf("RetryIX Multi-Device: cannot open device (%s)\n", rixCLErrorName(err));
+        return -1;
+    }
+    dev->device = device;
+    clRetainDevice(device); // 子設備由管理器持有參考，呼叫端可先行釋放
+    clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(dev->name) - 1, dev->name, NULL);
+    clGetDeviceInfo(device, CL_DEVICE_TYPE, sizeof(dev->type), &dev->type, NULL);
+
+    int index = ctx->device_count++;
+    rix_mutex_unlock(&ctx->exec_lock);
+    return index;
+}
+
+// === 公開 API ===
+
+int retryix_multi_init(cl_device_type type) {
+    retryix_multi_context_t* ctx = multi_get();
+    if (!ctx) return -1;
+    if (type == 0) type = CL_DEVICE_TYPE_ALL;
+
+    cl_platform_id platforms[RETRYIX_MAX_PLATFORMS];
+    cl_uint num_platforms = 0;
+    if (clGetPlatformIDs(RETRYIX_MAX_PLATFORMS, platforms, &num_platforms) != CL_SUCCESS || num_platforms == 0) {
+        printf("RetryIX Multi-Device: no OpenCL platforms\n");
+        return -1;
+    }
+    if (num_platforms > RETRYIX_MAX_PLATFORMS) num_platforms = RETRYIX_MAX_PLATFORMS;
+
+    // 同平台的設備預設共用一個 context，設備間可直接 clEnqueueCopyBuffer（MultiDevice\SharedContext = 0 時各自獨立）
+    bool shared = retryix_config_get_dword("MultiDevice", "SharedContext", 1) != 0;
+    for (cl_uint p = 0; p < num_platforms; p++) {
+        cl_device_id devices[RETRYIX_MAX_DEVICES];
+        cl_uint num_devices = 0;
+        if (clGetDeviceIDs(platforms[p], type, RETRYIX_MAX_DEVICES, devices, &num_devices) != CL_SUCCESS) continue;
+        if (num_devices > RETRYIX_MAX_DEVICES) num_devices = RETRYIX_MAX_DEVICES;
+
+        cl_uint kept = 0;
+        for (cl_uint i = 0; i < num_devices; i++) {
+            char name[128] = {0};
+            clGetDeviceInfo(devices[i], CL_DEVICE_NAME, sizeof(name) - 1, name, NULL);
+            if (blacklisted(name)) {
+                printf("RetryIX Multi-Device: skipping blacklisted device %s\n", name);
+                continue;
+            }
+            if (ctx->device_count + (int)kept >= ctx->max_devices) break;
+            devices[kept++] = devices[i];
+        }
+        if (kept == 0) continue;
+
+        cl_context context = NULL;
+        if (shared && kept > 1) {
+            cl_int err = CL_SUCCESS;
+            cl_context_properties props[] = { CL_CONTEXT_PLATFORM, (cl_context_properties)platforms[p], 0 };
+            context = clCreateContext(props, kept, devices, NULL, NULL, &err);
+            if (err != CL_SUCCESS) context = NULL; // 無法共用時退回每個設備各自的 context
+        }
+        for (cl_uint i = 0; i < kept; i++) add_device(ctx, devices[i], context);
+        if (context) clReleaseContext(context);
+    }
+
+    if (ctx->device_count == 0) {
+        printf("RetryIX Multi-Device: no usable devices\n");
+        return -1;
+    }
+
+    printf("RetryIX Multi-Device Initialized\n");
+    for (int d = 0; d < ctx->device_count; d++) {
+        printf("  [%d] %s (%s)\n", d, ctx->devices[d].name, device_type_label(ctx->devices[d].type));
+    }
+    return 0;
+}
+
+int retryix_multi_add_device(cl_device_id device) {
+    retryix_multi_context_t* ctx = multi_get();
+    if (!ctx || !device) return -1;
+    return add_device(ctx, device, NULL);
+}
+
+void retryix_multi_cleanup(void) {
+    if (!multi_current()) return;
+    rix_call_once(&g_multi_once, init_multi_lock);
+    rix_mutex_lock(&g_multi_init_lock);
+    retryix_multi_context_t* ctx = g_multi_context;
+    if (!ctx) {
+        rix_mutex_unlock(&g_multi_init_lock);
+        return;
+    }
+
+    for (int t = 0; t < ctx->template_count; t++) release_template(&ctx->templates[t]);
+    for (int d = 0; d < ctx->device_count; d++) {
+        if (ctx->devices[d].queue) clReleaseCommandQueue(ctx->devices[d].queue);
+        if (ctx->devices[d].context) clReleaseContext(ctx->devices[d].context);
+        clReleaseDevice(ctx->devices[d].device);
+    }
+    rix_mutex_destroy(&ctx->exec_lock);
+    free(ctx);
+    rix_atomic_store_ptr((void* volatile*)&g_multi_context, NULL);
+    rix_mutex_unlock(&g_multi_init_lock);
+}
+
+int retryix_multi_device_count(void) {
+    retryix_multi_context_t* ctx = multi_current();
+    return ctx ? ctx->device_count : 0;
+}
+
+int retryix_multi_get_device(int device_index, cl_device_id* device, cl_context* context, cl_command_queue* queue) {
+    retryix_multi_context_t* ctx = multi_current();
+    if (!ctx || device_index < 0 || device_index >= ctx->device_count) return -1;
+    if (device) *device = ctx->devices[device_index].device;
+    if (context) *context = ctx->devices[device_index].context;
+    if (queue) *queue = ctx->devices[device_index].queue;
+    return 0;
+}
+
+cl_kernel retryix_multi_get_kernel(const char* template_name, int device_index) {
+    retryix_multi_context_t* ctx = multi_current();
+    if (!ctx || !template_name || device_index < 0 || device_index >= ctx->device_count) return NULL;
+    rix_mutex_lock(&ctx->exec_lock);
+    retryix_multi_template_t* tmpl = find_template(ctx, template_name);
+    cl_kernel kernel = (tmpl && ensure_kernel(ctx, tmpl, device_index)) ? tmpl->kernels[device_index] : NULL;
+    rix_mutex_unlock(&ctx->exec_lock);
+    return kernel;
+}
+
+int retryix_multi_has_template(const char* template_name) {
+    retryix_multi_context_t* ctx = multi_current();
+    if (!ctx || !template_name) return 0;
+    rix_mutex_lock(&ctx->exec_lock);
+    bool found = find_template(ctx, template_name) != NULL;
+    rix_mutex_unlock(&ctx->exec_lock);
+    return found ? 1 : 0;
+}
+
+// 模板在該設備編譯出的程序；同一程序內的其他內核可由呼叫端以 clCreateKernel 建立
+cl_program retryix_multi_get_program(const char* template_name, int device_index) {
+    retryix_multi_context_t* ctx = multi_current();
+    if (!ctx || !template_name || device_index < 0 || device_index >= ctx->device_count) return NULL;
+    rix_mutex_lock(&ctx->exec_lock);
+    retryix_multi_template_t* tmpl = find_template(ctx, template_name);
+    cl_program program = (tmpl && ensure_kernel(ctx, tmpl, device_index)) ? tmpl->programs[device_index] : NULL;
+    rix_mutex_unlock(&ctx->exec_lock);
+    return program;
+}
+
+// 由模板程序另建一個內核物件：參數狀態獨立，可與其他呼叫端並行設定參數
+cl_kernel retryix_multi_create_kernel(const char* template_name, int device_index) {
+    retryix_multi_context_t* ctx = multi_current();
+    if (!ctx || !template_name || device_index < 0 || device_index >= ctx->device_count) return NULL;
+    rix_mutex_lock(&ctx->exec_lock);
+    retryix_multi_template_t* tmpl = find_template(ctx, template_name);
+    cl_kernel kernel = NULL;
+    if (tmpl && ensure_kernel(ctx, tmpl, device_index)) {
+        cl_int err = CL_SUCCESS;
+        kernel = clCreateKernel(tmpl->programs[device_index], tmpl->kernel_name, &err);
+        if (err != CL_SUCCESS) kernel = NULL;
+    }
+    rix_mutex_unlock(&ctx->exec_lock);
+    return kernel;
+}
+
+int retryix_multi_register_template(const char* template_name, const char* kernel_name, const char* source_code) {
+    retryix_multi_context_t* ctx = multi_get();
+    if (!ctx || !template_name || !kernel_name || !source_code) return -1;
+    if (strlen(template_name) >= sizeof(ctx->templates[0].template_name) ||
+        strlen(kernel_name) >= sizeof(ctx->templates[0].kernel_name)) {
+        return -1;
+    }
+    char* source = strdup(source_code);
+    if (!source) return -1;
+
+    rix_mutex_lock(&ctx->exec_lock);
+    retryix_multi_template_t* tmpl = find_template(ctx, template_name);
+    if (tmpl) {
+        release_template(tmpl); // 重新註冊：舊的程序與吞吐量歷史一併丟棄
+    } else if (ctx->template_count < RETRYIX_MULTI_MAX_TEMPLATES) {
+        tmpl = &ctx->templates[ctx->template_count++];
+    } else {
+        rix_mutex_unlock(&ctx->exec_lock);
+        free(source);
+        return -1;
+    }
+    strcpy(tmpl->template_name, template_name);
+    strcpy(tmpl->kernel_name, kernel_name);
+    tmpl->source = source;
+    rix_mutex_unlock(&ctx->exec_lock);
+    return 0;
+}
+
+int retryix_multi_execute(const char* template_name, cl_uint work_dim, const size_t* global, const size_t* local,
+                          const retryix_multi_arg_t* args, cl_uint num_args) {
+    return execute_devices(0xFFFFFFFFu, template_name, work_dim, global, local, args, num_args);
+}
+
+int retryix_multi_execute_on(int device_index, const char* template_name, cl_uint work_dim, const size_t* global,
+                             const size_t* local, const retryix_multi_arg_t* args, cl_uint num_args) {
+    retryix_multi_context_t* ctx = multi_current();
+    if (!ctx || device_index < 0 || device_index >= ctx->device_count) return -1;
+    return execute_devices(1u << device_index, template_name, work_dim, global, local, args, num_args);
+}
+
+int retryix_multi_get_stats(int device_index, retryix_multi_device_stats_t* out) {
+    retryix_multi_context_t* ctx = multi_current();
+    if (!ctx || !out || device_index < 0 || device_index >= ctx->device_count) return -1;
+    const retryix_multi_device_t* dev = &ctx->devices[device_index];
+    memset(out, 0, sizeof(*out));
+    memcpy(out->name, dev->name, sizeof(out->name));
+    out->type = dev->type;
+    out->chunks = dev->chunks;
+    out->items = dev->items;
+    out->failures = dev->failures;
+    out->busy_ms = dev->busy_ms;
+    out->throughput = dev->busy_ms > 0.0 ? (double)dev->items / dev->busy_ms : 0.0;
+    return 0;
+}
+
+void retryix_multi_reset_stats(void) {
+    retryix_multi_context_t* ctx = multi_current();
+    if (!ctx) return;
+    for (int d = 0; d < ctx->device_count; d++) {
+        ctx->devices[d].chunks = 0;
+        ctx->devices[d].items = 0;
+        ctx->devices[d].failures = 0;
+        ctx->devices[d].busy_ms = 0.0;
+    }
+}
+
+void retryix_multi_print_stats(void) {
+    retryix_multi_context_t* ctx = multi_current();
+    if (!ctx) return;
+    uint64_t total = 0;
+    for (int d = 0; d < ctx->device_count; d++) total += ctx->devices[d].items;
+
+    printf("  Multi-device distribution:\n");
+    printf("    device                                 chunks        items   share   items/ms  failures\n");
+    for (int d = 0; d < ctx->device_count; d++) {
+        retryix_multi_device_stats_t s;
+        retryix_multi_get_stats(d, &s);
+        printf("    [%d] %-28.28s %-4s %7llu %12llu  %5.1f%% %10.1f  %8llu\n", d, s.name, device_type_label(s.type),
+               (unsigned long long)s.chunks, (unsigned long long)s.items,
+               total ? 100.0 * (double)s.items / (double)total : 0.0, s.throughput, (unsigned long long)s.failures);
+    }
+}
+
+// 各設備單獨執行與全部設備一起執行的最佳時間比較；最後一次執行為全部設備，輸出即為多設備結果
+int retryix_multi_scaling_report(const char* template_name, cl_uint work_dim, const size_t* global, const size_t* local,
+                                 const retryix_multi_arg_t* args, cl_uint num_args, int iterations) {
+    retryix_multi_context_t* ctx = multi_current();
+    if (!ctx || ctx->device_count == 0 || !global || work_dim < 1 || work_dim > 2) return -1;
+    if (iterations <= 0) iterations = 3;
+
+    double items = (double)global[0] * (work_dim > 1 ? (double)global[1] : 1.0);
+    double single_ms[RETRYIX_MULTI_MAX_DEVICES];
+    double sum_rate = 0.0, best_single = 0.0;
+
+    printf("\n=== RetryIX Multi-Device Scaling (%s, %zu", template_name, global[0]);
+    if (work_dim > 1) printf(" x %zu", global[1]);
+    printf(", best of %d) ===\n", iterations);
+    printf("  %-40s %10s %12s\n", "devices", "ms", "items/ms");
+
+    for (int d = 0; d < ctx->device_count; d++) {
+        single_ms[d] = -1.0;
+        for (int it = 0; it < iterations; it++) {
+            double t0 = rixNowMs();
+            if (retryix_multi_execute_on(d, template_name, work_dim, global, local, args, num_args) != 0) break;
+            double ms = rixNowMs() - t0;
+            if (single_ms[d] < 0.0 || ms < single_ms[d]) single_ms[d] = ms;
+        }
+        if (single_ms[d] < 0.0) {
+            printf("  [%d] %-35.35s %10s\n", d, ctx->devices[d].name, "failed");
+            continue;
+        }
+        double rate = items / single_ms[d];
+        sum_rate += rate;
+        if (rate > best_single) best_single = rate;
+        printf("  [%d] %-35.35s %10.3f %12.1f\n", d, ctx->devices[d].name, single_ms[d], rate);
+    }
+
+    retryix_multi_reset_stats();
+    double multi_ms = -1.0;
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        if (retryix_multi_execute(template_name, work_dim, global, local, args, num_args) != 0) break;
+        double ms = rixNowMs() - t0;
+        if (multi_ms < 0.0 || ms < multi_ms) multi_ms = ms;
+    }
+    if (multi_ms < 0.0 || sum_rate <= 0.0) {
+        printf("  all devices: failed\n");
+        return -1;
+    }
+
+    double multi_rate = items / multi_ms;
+    printf("  %-40s %10.3f %12.1f\n", "all devices", multi_ms, multi_rate);
+    printf("  Speedup vs fastest single device: %.2fx, scaling efficiency: %.1f%% of summed single-device throughput\n",
+           multi_rate / best_single, 100.0 * multi_rate / sum_rate);
+    retryix_multi_print_stats();
+    printf("=====================================================\n\n");
+    return 0;
+}
+
+// === 量測 ===
+
+static const char* MULTI_BENCH_SOURCE =
+"__kernel void retryix_multi_bench(__global const float* in, __global float* out, uint width, uint rounds) {\n"
+"    size_t x = get_global_id(0);\n"
+"    size_t y = get_global_id(1);\n"
+"    float v = in[y * width + x];\n"
+"    for (uint r = 0; r < rounds; r++) v = v * 0.999f + 0.001f;\n"
+"    out[y * width + x] = v;\n"
+"}\n";
+
+static float bench_reference(float v) {
+    for (int r = 0; r < RETRYIX_MULTI_BENCH_ROUNDS; r++) v = v * 0.999f + 0.001f;
+    return v;
+}
+
+// 2-D 計算密集內核：輸出每列檢查首、中、尾三欄，可發現遺漏或重疊的區塊
+int retryix_multi_benchmark(size_t width, size_t height, int iterations) {
+    if (retryix_multi_device_count() == 0) {
+        if (retryix_multi_init(0) != 0) return -1;
+    }
+    if (width == 0) width = 2048;
+    if (height == 0) height = 2048;
+    if (retryix_multi_register_template("retryix_multi_bench", "retryix_multi_bench", MULTI_BENCH_SOURCE) != 0) return -1;
+
+    size_t count = width * height;
+    float* input = (float*)malloc(count * sizeof(float));
+    float* output = (float*)malloc(count * sizeof(float));
+    if (!input || !output) {
+        free(input);
+        free(output);
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) input[i] = (float)(i % 1024) / 1024.0f;
+    for (size_t i = 0; i < count; i++) output[i] = NAN;
+
+    cl_uint width_arg = (cl_uint)width;
+    cl_uint rounds_arg = RETRYIX_MULTI_BENCH_ROUNDS;
+    retryix_multi_arg_t args[4] = {
+        { RETRYIX_MULTI_ARG_INPUT, input, count * sizeof(float), 0 },
+        { RETRYIX_MULTI_ARG_OUTPUT, output, count * sizeof(float), width * sizeof(float) },
+        { RETRYIX_MULTI_ARG_SCALAR, &width_arg, sizeof(cl_uint), 0 },
+        { RETRYIX_MULTI_ARG_SCALAR, &rounds_arg, sizeof(cl_uint), 0 },
+    };
+    size_t global[2] = { width, height };
+
+    int rc = retryix_multi_scaling_report("retryix_multi_bench", 2, global, NULL, args, 4, iterations);
+    size_t mismatches = 0;
+    if (rc == 0) {
+        size_t columns[3] = { 0, width / 2, width - 1 };
+        for (size_t y = 0; y < height; y++) {
+            for (int c = 0; c < 3; c++) {
+                size_t i = y * width + columns[c];
+                if (!(fabsf(output[i] - bench_reference(input[i])) <= 1e-4f)) mismatches++;
+            }
+        }
+    }
+    printf("  Merged output check: %s (%zu mismatches in %zu sampled items)\n",
+           rc == 0 && mismatches == 0 ? "PASS" : "FAIL", mismatches, height * 3);
+
+    free(input);
+    free(output);
+    return (rc == 0 && mismatches == 0) ? 0 : -1;
+}
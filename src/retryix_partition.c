@@ -0,0 +1,446 @@
+// retryix_partition.c - RetryIX 設備分割：clCreateSubDevices 依等分、指定數量或親和網域（NUMA/快取）切分 CPU 設備
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include <ctype.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RETRYIX_PARTITION_BENCH_ROUNDS 64
+
+typedef struct {
+    cl_device_id device;                    // 子設備（本模組持有一個參考）
+    cl_context context;                     // 子設備專用；不加入多設備管理器，避免與父設備重複排程
+    cl_command_queue queue;
+    cl_uint compute_units;
+    retryix_memory_context_t* memory;       // 子設備專用的記憶體管理器
+} retryix_partition_unit_t;
+
+struct retryix_partition {
+    cl_device_id parent;
+    retryix_partition_spec_t spec;
+    int count;
+    retryix_partition_unit_t units[RETRYIX_PARTITION_MAX_UNITS];
+};
+
+static const struct {
+    const char* name;
+    cl_device_affinity_domain domain;
+} PARTITION_DOMAINS[] = {
+    { "numa", CL_DEVICE_AFFINITY_DOMAIN_NUMA },
+    { "l4", CL_DEVICE_AFFINITY_DOMAIN_L4_CACHE },
+    { "l3", CL_DEVICE_AFFINITY_DOMAIN_L3_CACHE },
+    { "l2", CL_DEVICE_AFFINITY_DOMAIN_L2_CACHE },
+    { "l1", CL_DEVICE_AFFINITY_DOMAIN_L1_CACHE },
+    { "next", CL_DEVICE_AFFINITY_DOMAIN_NEXT_PARTITIONABLE },
+};
+#define PARTITION_DOMAIN_COUNT (sizeof(PARTITION_DOMAINS) / sizeof(PARTITION_DOMAINS[0]))
+
+static const char* domain_name(cl_device_affinity_domain domain) {
+    for (size_t i = 0; i < PARTITION_DOMAIN_COUNT; i++) {
+        if (PARTITION_DOMAINS[i].domain == domain) return PARTITION_DOMAINS[i].name;
+    }
+    return "unknown";
+}
+
+// 第一個 CPU 設備
+static cl_device_id find_cpu_device(void) {
+    cl_platform_id platforms[RETRYIX_MAX_PLATFORMS];
+    cl_uint num_platforms = 0;
+    if (clGetPlatformIDs(RETRYIX_MAX_PLATFORMS, platforms, &num_platforms) != CL_SUCCESS) return NULL;
+    if (num_platforms > RETRYIX_MAX_PLATFORMS) num_platforms = RETRYIX_MAX_PLATFORMS;
+    for (cl_uint p = 0; p < num_platforms; p++) {
+        cl_device_id device = NULL;
+        if (clGetDeviceIDs(platforms[p], CL_DEVICE_TYPE_CPU, 1, &device, NULL) == CL_SUCCESS && device) return device;
+    }
+    return NULL;
+}
+
+static bool supports_property(cl_device_id device, cl_device_partition_property property) {
+    cl_device_partition_property supported[8] = { 0 };
+    size_t bytes = 0;
+    if (clGetDeviceInfo(device, CL_DEVICE_PARTITION_PROPERTIES, sizeof(supported), supported, &bytes) != CL_SUCCESS) {
+        return false;
+    }
+    for (size_t i = 0; i < bytes / sizeof(supported[0]); i++) {
+        if (supported[i] == property) return true;
+    }
+    return false;
+}
+
+// 子設備專用的 context、queue 與記憶體管理器
+static int open_unit(retryix_partition_unit_t* unit) {
+    cl_int err = CL_SUCCESS;
+    unit->context = clCreateContext(NULL, 1, &unit->device, NULL, NULL, &err);
+    if (err != CL_SUCCESS) {
+        unit->context = NULL;
+        return -1;
+    }
+    unit->queue = rixCreateQueue(unit->context, unit->device, &err);
+    if (err != CL_SUCCESS) {
+        unit->queue = NULL;
+        return -1;
+    }
+    clGetDeviceInfo(unit->device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(unit->compute_units), &unit->compute_units, NULL);
+    unit->memory = retryix_memory_create(unit->context, unit->device);
+    return unit->memory ? 0 : -1;
+}
+
+// === 公開 API ===
+
+// "numa" / "l4" / "l3" / "l2" / "l1" / "next"、"equally:N"、"counts:A,B,..."
+int retryix_partition_parse(const char* text, retryix_partition_spec_t* out) {
+    if (!text || !out) return -1;
+    char buffer[128];
+    size_t length = strlen(text);
+    if (length == 0 || length >= sizeof(buffer)) return -1;
+    for (size_t i = 0; i <= length; i++) buffer[i] = (char)tolower((unsigned char)text[i]);
+
+    memset(out, 0, sizeof(*out));
+    for (size_t i = 0; i < PARTITION_DOMAIN_COUNT; i++) {
+        if (strcmp(buffer, PARTITION_DOMAINS[i].name) == 0) {
+            out->mode = RETRYIX_PARTITION_BY_AFFINITY;
+            out->domain = PARTITION_DOMAINS[i].domain;
+            return 0;
+        }
+    }
+    if (strncmp(buffer, "equally:", 8) == 0) {
+        out->mode = RETRYIX_PARTITION_EQUALLY;
+        out->units = (cl_uint)strtoul(buffer + 8, NULL, 10);
+        return out->units > 0 ? 0 : -1;
+    }
+    if (strncmp(buffer, "counts:", 7) == 0) {
+        out->mode = RETRYIX_PARTITION_BY_COUNTS;
+        for (char* tok = strtok(buffer + 7, ","); tok; tok = strtok(NULL, ",")) {
+            cl_uint units = (cl_uint)strtoul(tok, NULL, 10);
+            if (units == 0 || out->num_counts >= RETRYIX_PARTITION_MAX_UNITS) return -1;
+            out->counts[out->num_counts++] = units;
+        }
+        return out->num_counts > 0 ? 0 : -1;
+    }
+    return -1;
+}
+
+retryix_partition_t* retryix_partition_create(cl_device_id parent, const retryix_partition_spec_t* spec) {
+    retryix_partition_spec_t configured;
+    if (!spec) {
+        char scheme[64] = "numa";
+        retryix_config_get_string("DevicePartition", "Scheme", scheme, sizeof(scheme));
+        if (retryix_partition_parse(scheme, &configured) != 0) {
+            printf("RetryIX Partition: invalid DevicePartition\\Scheme \"%s\"\n", scheme);
+            return NULL;
+        }
+        spec = &configured;
+    }
+    if (!parent) parent = find_cpu_device();
+    if (!parent) {
+        printf("RetryIX Partition: no CPU device\n");
+        return NULL;
+    }
+
+    cl_device_partition_property props[RETRYIX_PARTITION_MAX_UNITS + 3];
+    int n = 0;
+    switch (spec->mode) {
+    case RETRYIX_PARTITION_EQUALLY:
+        if (spec->units == 0) return NULL;
+        props[n++] = CL_DEVICE_PARTITION_EQUALLY;
+        props[n++] = (cl_device_partition_property)spec->units;
+        break;
+    case RETRYIX_PARTITION_BY_COUNTS:
+        if (spec->num_counts <= 0 || spec->num_counts > RETRYIX_PARTITION_MAX_UNITS) return NULL;
+        props[n++] = CL_DEVICE_PARTITION_BY_COUNTS;
+        for (int i = 0; i < spec->num_counts; i++) props[n++] = (cl_device_partition_property)spec->counts[i];
+        props[n++] = CL_DEVICE_PARTITION_BY_COUNTS_LIST_END;
+        break;
+    case RETRYIX_PARTITION_BY_AFFINITY:
+        props[n++] = CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN;
+        props[n++] = (cl_device_partition_property)spec->domain;
+        break;
+    default:
+        return NULL;
+    }
+    props[n] = 0;
+
+    if (!supports_property(parent, props[0])) {
+        printf("RetryIX Partition: device does not support %s partitioning\n",
+               spec->mode == RETRYIX_PARTITION_EQUALLY ? "equal" : (spec->mode == RETRYIX_PARTITION_BY_COUNTS ? "by-counts" : "affinity"));
+        return NULL;
+    }
+    if (spec->mode == RETRYIX_PARTITION_BY_AFFINITY) {
+        cl_device_affinity_domain domains = 0;
+        clGetDeviceInfo(parent, CL_DEVICE_PARTITION_AFFINITY_DOMAIN, sizeof(domains), &domains, NULL);
+        if (!(domains & spec->domain)) {
+            printf("RetryIX Partition: affinity domain %s not supported\n", domain_name(spec->domain));
+            return NULL;
+        }
+    }
+
+    cl_uint available = 0;
+    cl_int err = clCreateSubDevices(parent, props, 0, NULL, &available);
+    if (err != CL_SUCCESS || available == 0) {
+        printf("RetryIX Partition: clCreateSubDevices failed (%s)\n", rixCLErrorName(err));
+        return NULL;
+    }
+    if (available > RETRYIX_PARTITION_MAX_UNITS) {
+        printf("RetryIX Partition: %u sub-devices exceed the limit of %d\n", available, RETRYIX_PARTITION_MAX_UNITS);
+        return NULL;
+    }
+
+    retryix_partition_t* partition = (retryix_partition_t*)calloc(1, sizeof(retryix_partition_t));
+    if (!partition) return NULL;
+    cl_device_id devices[RETRYIX_PARTITION_MAX_UNITS];
+    err = clCreateSubDevices(parent, props, available, devices, NULL);
+    if (err != CL_SUCCESS) {
+        printf("RetryIX Partition: clCreateSubDevices failed (%s)\n", rixCLErrorName(err));
+        free(partition);
+        return NULL;
+    }
+    partition->parent = parent;
+    partition->spec = *spec;
+    partition->count = (int)available;
+    for (int i = 0; i < partition->count; i++) partition->units[i].device = devices[i];
+    for (int i = 0; i < partition->count; i++) {
+        if (open_unit(&partition->units[i]) != 0) {
+            printf("RetryIX Partition: cannot open sub-device %d\n", i);
+            retryix_partition_destroy(partition);
+            return NULL;
+        }
+    }
+
+    printf("RetryIX Partition: %d sub-devices\n", partition->count);
+    for (int i = 0; i < partition->count; i++) {
+        printf("  [%d] %u compute units\n", i, partition->units[i].compute_units);
+    }
+    return partition;
+}
+
+void retryix_partition_destroy(retryix_partition_t* partition) {
+    if (!partition) return;
+    for (int i = 0; i < partition->count; i++) {
+        retryix_partition_unit_t* unit = &partition->units[i];
+        if (unit->memory) retryix_memory_destroy(unit->memory);
+        if (unit->queue) clReleaseCommandQueue(unit->queue);
+        if (unit->context) clReleaseContext(unit->context);
+        if (unit->device) clReleaseDevice(unit->device);
+    }
+    free(partition);
+}
+
+int retryix_partition_count(const retryix_partition_t* partition) {
+    return partition ? partition->count : 0;
+}
+
+int retryix_partition_get_info(const retryix_partition_t* partition, int index, retryix_partition_info_t* out) {
+    if (!partition || !out || index < 0 || index >= partition->count) return -1;
+    const retryix_partition_unit_t* unit = &partition->units[index];
+    memset(out, 0, sizeof(*out));
+    out->device = unit->device;
+    out->context = unit->context;
+    out->queue = unit->queue;
+    out->compute_units = unit->compute_units;
+    out->memory = unit->memory;
+    return 0;
+}
+
+// 呼叫執行緒的記憶體 API 改用該子設備的管理器；只影響呼叫執行緒
+int retryix_partition_bind(const retryix_partition_t* partition, int index) {
+    if (!partition || index < 0 || index >= partition->count) return -1;
+    retryix_memory_bind(partition->units[index].memory);
+    return 0;
+}
+
+void retryix_partition_unbind(void) {
+    retryix_memory_bind(NULL);
+}
+
+// === 量測 ===
+
+static const char* PARTITION_BENCH_SOURCE =
+"__kernel void retryix_partition_bench(__global const float* in, __global float* out, uint rounds) {\n"
+"    size_t i = get_global_id(0);\n"
+"    float v = in[i];\n"
+"    for (uint r = 0; r < rounds; r++) v = v * 0.999f + 0.001f;\n"
+"    out[i] = v;\n"
+"}\n";
+
+// 一個獨立工作負載：自己的記憶體管理器、佇列與內核
+typedef struct {
+    retryix_memory_context_t* memory;
+    cl_command_queue queue;
+    cl_kernel kernel;
+    size_t count;
+    int iterations;
+    double ms;
+    bool ok;
+} retryix_partition_job_t;
+
+static float bench_reference(float v) {
+    for (int r = 0; r < RETRYIX_PARTITION_BENCH_ROUNDS; r++) v = v * 0.999f + 0.001f;
+    return v;
+}
+
+static void job_task(void* arg) {
+    retryix_partition_job_t* job = (retryix_partition_job_t*)arg;
+    retryix_memory_context_t* previous = retryix_memory_bind(job->memory);
+    size_t bytes = job->count * sizeof(float);
+    float* input = (float*)retryix_memory_alloc(bytes, RETRYIX_MEM_READ_ONLY, "partition_in");
+    float* output = (float*)retryix_memory_alloc(bytes, RETRYIX_MEM_WRITE_ONLY, "partition_out");
+    job->ok = false;
+    if (input && output) {
+        for (size_t i = 0; i < job->count; i++) input[i] = (float)(i % 1024) / 1024.0f;
+        cl_mem in_mem = retryix_memory_get_device_mem(input);
+        cl_mem out_mem = retryix_memory_get_device_mem(output);
+        cl_uint rounds = RETRYIX_PARTITION_BENCH_ROUNDS;
+        cl_int err = clSetKernelArg(job->kernel, 0, sizeof(cl_mem), &in_mem);
+        if (err == CL_SUCCESS) err = clSetKernelArg(job->kernel, 1, sizeof(cl_mem), &out_mem);
+        if (err == CL_SUCCESS) err = clSetKernelArg(job->kernel, 2, sizeof(cl_uint), &rounds);
+
+        double t0 = rixNowMs();
+        if (err == CL_SUCCESS && retryix_memory_copy_to_device(input, job->queue, true) != 0) err = CL_INVALID_VALUE;
+        for (int it = 0; it < job->iterations && err == CL_SUCCESS; it++) {
+            err = clEnqueueNDRangeKernel(job->queue, job->kernel, 1, NULL, &job->count, NULL, 0, NULL, NULL);
+        }
+        if (err == CL_SUCCESS) err = clFinish(job->queue);
+        if (err == CL_SUCCESS && retryix_memory_copy_from_device(output, job->queue, true) != 0) err = CL_INVALID_VALUE;
+        job->ms = rixNowMs() - t0;
+
+        if (err == CL_SUCCESS) {
+            job->ok = true;
+            size_t samples[3] = { 0, job->count / 2, job->count - 1 };
+            for (int s = 0; s < 3; s++) {
+                if (!(fabsf(output[samples[s]] - bench_reference(input[samples[s]])) <= 1e-4f)) job->ok = false;
+            }
+        }
+    }
+    if (input) retryix_memory_free(input);
+    if (output) retryix_memory_free(output);
+    retryix_memory_bind(previous);
+}
+
+// 所有工作負載同時執行，回傳總耗時
+static double run_jobs(retryix_partition_job_t* jobs, int count, bool* all_ok) {
+    retryix_pool_group_t group;
+    retryix_pool_group_init(&group);
+    double t0 = rixNowMs();
+    for (int j = 0; j < count; j++) retryix_pool_spawn(&group, job_task, &jobs[j]);
+    retryix_pool_wait(&group);
+    double ms = rixNowMs() - t0;
+    *all_ok = true;
+    for (int j = 0; j < count; j++) *all_ok = *all_ok && jobs[j].ok;
+    return ms;
+}
+
+static void print_jobs(const char* label, const retryix_partition_job_t* jobs, int count, double wall_ms, bool ok) {
+    double slowest = 0.0;
+    for (int j = 0; j < count; j++) slowest = jobs[j].ms > slowest ? jobs[j].ms : slowest;
+    printf("  %-24s wall %9.2f ms  slowest job %9.2f ms  %s\n", label, wall_ms, slowest, ok ? "PASS" : "FAIL");
+}
+
+// 同時執行的獨立工作負載：共用整個 CPU 設備（每個工作負載各自的 queue）對比各自固定在一個子設備上
+int retryix_partition_benchmark(size_t count, int iterations) {
+    if (count == 0) count = (size_t)4 << 20;
+    if (iterations <= 0) iterations = 5;
+    cl_device_id parent = find_cpu_device();
+    if (!parent) {
+        printf("RetryIX Partition: no CPU device\n");
+        return -1;
+    }
+
+    char name[128] = { 0 };
+    cl_uint compute_units = 0, max_sub = 0;
+    cl_device_affinity_domain domains = 0;
+    clGetDeviceInfo(parent, CL_DEVICE_NAME, sizeof(name) - 1, name, NULL);
+    clGetDeviceInfo(parent, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(compute_units), &compute_units, NULL);
+    clGetDeviceInfo(parent, CL_DEVICE_PARTITION_MAX_SUB_DEVICES, sizeof(max_sub), &max_sub, NULL);
+    clGetDeviceInfo(parent, CL_DEVICE_PARTITION_AFFINITY_DOMAIN, sizeof(domains), &domains, NULL);
+    printf("\n=== RetryIX Device Partition Benchmark ===\n");
+    printf("  Device: %s, %u compute units, up to %u sub-devices\n", name, compute_units, max_sub);
+    printf("  Partition modes:%s%s%s  affinity domains:", supports_property(parent, CL_DEVICE_PARTITION_EQUALLY) ? " equally" : "",
+           supports_property(parent, CL_DEVICE_PARTITION_BY_COUNTS) ? " by-counts" : "",
+           supports_property(parent, CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN) ? " by-affinity" : "");
+    for (size_t i = 0; i < PARTITION_DOMAIN_COUNT; i++) {
+        if (domains & PARTITION_DOMAINS[i].domain) printf(" %s", PARTITION_DOMAINS[i].name);
+    }
+    printf("\n");
+
+    // 設定的方案（預設 NUMA），單一網域或不支援時改為兩等分
+    retryix_partition_t* partition = retryix_partition_create(parent, NULL);
+    if (partition && partition->count < 2) {
+        retryix_partition_destroy(partition);
+        partition = NULL;
+    }
+    if (!partition && compute_units >= 2) {
+        retryix_partition_spec_t halves = { RETRYIX_PARTITION_EQUALLY };
+        halves.units = compute_units / 2;
+        partition = retryix_partition_create(parent, &halves);
+    }
+    if (!partition) {
+        printf("  Partitioning unavailable on this device\n");
+        return -1;
+    }
+    int jobs_count = partition->count;
+
+    // 基準：整個設備一個 context，每個工作負載各自 queue 與內核
+    cl_int err = CL_SUCCESS;
+    cl_context context = clCreateContext(NULL, 1, &parent, NULL, NULL, &err);
+    cl_program program = (err == CL_SUCCESS) ? rixBuildProgram(context, parent, PARTITION_BENCH_SOURCE, NULL) : NULL;
+    retryix_partition_job_t shared[RETRYIX_PARTITION_MAX_UNITS];
+    retryix_partition_job_t pinned[RETRYIX_PARTITION_MAX_UNITS];
+    cl_program pinned_programs[RETRYIX_PARTITION_MAX_UNITS] = { NULL };
+    memset(shared, 0, sizeof(shared));
+    memset(pinned, 0, sizeof(pinned));
+    int failures = program ? 0 : 1;
+    for (int j = 0; j < jobs_count && !failures; j++) {
+        shared[j].count = count;
+        shared[j].iterations = iterations;
+        shared[j].memory = retryix_memory_create(context, parent);
+        shared[j].queue = rixCreateQueue(context, parent, &err);
+        if (err == CL_SUCCESS) shared[j].kernel = clCreateKernel(program, "retryix_partition_bench", &err);
+        if (err != CL_SUCCESS || !shared[j].memory) failures++;
+    }
+    // 子設備：各自的 context、queue 與記憶體管理器
+    for (int j = 0; j < jobs_count && !failures; j++) {
+        retryix_partition_unit_t* unit = &partition->units[j];
+        pinned[j].count = count;
+        pinned[j].iterations = iterations;
+        pinned[j].memory = unit->memory;
+        pinned[j].queue = unit->queue;
+        pinned_programs[j] = rixBuildProgram(unit->context, unit->device, PARTITION_BENCH_SOURCE, NULL);
+        if (pinned_programs[j]) pinned[j].kernel = clCreateKernel(pinned_programs[j], "retryix_partition_bench", &err);
+        if (!pinned_programs[j] || err != CL_SUCCESS) {
+            pinned[j].kernel = NULL;
+            failures++;
+        }
+    }
+
+    if (!failures) {
+        printf("  %d concurrent workloads x %zu items x %d launches\n", jobs_count, count, iterations);
+        bool ok = false;
+        double shared_ms = run_jobs(shared, jobs_count, &ok);
+        print_jobs("whole device (shared)", shared, jobs_count, shared_ms, ok);
+        if (!ok) failures++;
+        double pinned_ms = run_jobs(pinned, jobs_count, &ok);
+        print_jobs("sub-devices (pinned)", pinned, jobs_count, pinned_ms, ok);
+        if (!ok) failures++;
+        if (pinned_ms > 0.0) printf("  Partitioned speedup: %.2fx\n", shared_ms / pinned_ms);
+    }
+    printf("==========================================\n\n");
+
+    for (int j = 0; j < jobs_count; j++) {
+        if (shared[j].kernel) clReleaseKernel(shared[j].kernel);
+        if (shared[j].queue) clReleaseCommandQueue(shared[j].queue);
+        if (shared[j].memory) retryix_memory_destroy(shared[j].memory);
+        if (pinned[j].kernel) clReleaseKernel(pinned[j].kernel);
+        if (pinned_programs[j]) clReleaseProgram(pinned_programs[j]);
+    }
+    if (program) clReleaseProgram(program);
+    if (context) clReleaseContext(context);
+    retryix_partition_destroy(partition);
+    return failures ? -1 : 0;
+}
@@ -0,0 +1,482 @@
+// retryix_placement.c - RetryIX 自動配置前端（依用途提示選擇 SVM / 零拷貝 / 設備常駐）
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <malloc.h>
+    #define aligned_alloc(alignment, size) _aligned_malloc(size, alignment)
+    #define aligned_free(ptr) _aligned_free(ptr)
+#else
+    #define aligned_free(ptr) free(ptr)
+#endif
+
+#define RETRYIX_PLACEMENT_PROBE_KEY      "placement.probe"
+#define RETRYIX_PLACEMENT_PROBE_RUNS     3
+
+static const char* PLACEMENT_LABELS[RETRYIX_PLACEMENT_COUNT] = { "DEVICE", "ZERO_COPY", "SVM" };
+
+// 頻寬探測結果（GB/s，0 表示不可用）
+typedef struct {
+    double host_to_device;
+    double device_to_host;
+    double device_read;                     // 內核讀取設備常駐緩衝區
+    double zero_copy_read;                  // 內核讀取主機端零拷貝緩衝區
+    double svm_read;                        // 內核讀取 SVM 配置
+    bool measured;
+} retryix_placement_probe_t;
+
+// 配置紀錄
+typedef struct {
+    void* ptr;
+    size_t size;
+    unsigned int hints;
+    retryix_placement_t placement;
+    double estimated_ms[RETRYIX_PLACEMENT_COUNT]; // 各配置的預估成本（負值表示不可用）
+    char debug_name[64];
+} retryix_placement_record_t;
+
+// 自動配置上下文
+typedef struct {
+    cl_context context;
+    cl_device_id device;
+    cl_command_queue queue;
+    retryix_svm_context_t* svm;
+
+    // 設備能力
+    bool host_unified_memory;
+    retryix_svm_level_t svm_level;
+    bool svm_atomics;
+    retryix_placement_probe_t probe;
+
+    // 設定
+    unsigned long read_many_factor;         // DEVICE_READ_MANY 假設的讀取次數
+    unsigned long forced;                   // 0 = 自動，1..3 = 強制 DEVICE / ZERO_COPY / SVM
+
+    retryix_placement_record_t* records;
+    size_t record_count;
+    size_t record_capacity;
+    uint64_t placement_counts[RETRYIX_PLACEMENT_COUNT];
+} retryix_placement_context_t;
+
+static retryix_placement_context_t* g_placement_context = NULL;
+
+// 探測用讀取內核：每個工作項讀取一個 uint4，條件寫入防止被最佳化移除
+static const char* PLACEMENT_PROBE_SOURCE =
+"__kernel void retryix_probe_read(__global const uint4* src, __global uint* sink) {\n"
+"    uint4 v = src[get_global_id(0)];\n"
+"    if ((v.x ^ v.y ^ v.z ^ v.w) == 0x9E3779B9u) sink[0] = v.x;\n"
+"}\n";
+
+// === 頻寬探測 ===
+
+static double gbps(size_t bytes, double ms) {
+    return (ms > 0.0) ? (double)bytes / (ms * 1e6) : 0.0;
+}
+
+// 量測內核讀取頻寬；svm_ptr 非 NULL 時以 SVM 指標綁定
+static double probe_kernel_read(retryix_placement_context_t* ctx, cl_kernel kernel, cl_mem buffer,
+                                void* svm_ptr, cl_mem sink, size_t bytes) {
+    cl_int err = svm_ptr ? clSetKernelArgSVMPointer(kernel, 0, svm_ptr)
+                         : clSetKernelArg(kernel, 0, sizeof(cl_mem), &buffer);
+    if (err != CL_SUCCESS) return 0.0;
+    if (clSetKernelArg(kernel, 1, sizeof(cl_mem), &sink) != CL_SUCCESS) return 0.0;
+
+    size_t global = bytes / 16;
+    double best = -1.0;
+    for (int run = 0; run <= RETRYIX_PLACEMENT_PROBE_RUNS; run++) {
+        double t0 = rixNowMs();
+        if (clEnqueueNDRangeKernel(ctx->queue, kernel, 1, NULL, &global, NULL, 0, NULL, NULL) != CL_SUCCESS) {
+            return 0.0;
+        }
+        clFinish(ctx->queue);
+        double ms = rixNowMs() - t0;
+        if (run == 0) continue; // 第一次為預熱（含零拷貝頁面建立）
+        if (best < 0.0 || ms < best) best = ms;
+    }
+    return gbps(bytes, best);
+}
+
+// 量測傳輸頻寬（is_write 為真時量測主機 -> 設備）
+static double probe_transfer(retryix_placement_context_t* ctx, cl_mem buffer, void* host, size_t bytes, bool is_write) {
+    double best = -1.0;
+    for (int run = 0; run <= RETRYIX_PLACEMENT_PROBE_RUNS; run++) {
+        double t0 = rixNowMs();
+        cl_int err = is_write
+            ? clEnqueueWriteBuffer(ctx->queue, buffer, CL_TRUE, 0, bytes, host, 0, NULL, NULL)
+            : clEnqueueReadBuffer(ctx->queue, buffer, CL_TRUE, 0, bytes, host, 0, NULL, NULL);
+        if (err != CL_SUCCESS) return 0.0;
+        double ms = rixNowMs() - t0;
+        if (run == 0) continue;
+        if (best < 0.0 || ms < best) best = ms;
+    }
+    return gbps(bytes, best);
+}
+
+static void run_bandwidth_probe(retryix_placement_context_t* ctx, size_t bytes) {
+    retryix_placement_probe_t* probe = &ctx->probe;
+    memset(probe, 0, sizeof(*probe));
+
+    // CL_MEM_USE_HOST_PTR 需對齊頁面與設備基底位址對齊，否則驅動會改用複本，量到的不是零拷貝頻寬
+    cl_uint align_bits = 0;
+    clGetDeviceInfo(ctx->device, CL_DEVICE_MEM_BASE_ADDR_ALIGN, sizeof(align_bits), &align_bits, NULL);
+    size_t alignment = align_bits / 8 > 4096 ? align_bits / 8 : 4096;
+    bytes = (bytes + alignment - 1) & ~(alignment - 1);
+
+    void* host = aligned_alloc(alignment, bytes);
+    if (!host) return;
+    memset(host, 0x5A, bytes);
+
+    cl_int err;
+    cl_mem device_buf = clCreateBuffer(ctx->context, CL_MEM_READ_WRITE, bytes, NULL, &err);
+    cl_mem zero_copy_buf = clCreateBuffer(ctx->context, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, bytes, host, &err);
+    cl_mem sink = clCreateBuffer(ctx->context, CL_MEM_READ_WRITE, sizeof(cl_uint), NULL, &err);
+
+    if (device_buf) {
+        probe->host_to_device = probe_transfer(ctx, device_buf, host, bytes, true);
+        probe->device_to_host = probe_transfer(ctx, device_buf, host, bytes, false);
+    }
+
+    cl_program program = clCreateProgramWithSource(ctx->context, 1, &PLACEMENT_PROBE_SOURCE, NULL, &err);
+    if (program && clBuildProgram(program, 1, &ctx->device, NULL, NULL, NULL) == CL_SUCCESS && sink) {
+        cl_kernel kernel = clCreateKernel(program, "retryix_probe_read", &err);
+        if (kernel) {
+            if (device_buf) probe->device_read = probe_kernel_read(ctx, kernel, device_buf, NULL, sink, bytes);
+            if (zero_copy_buf) probe->zero_copy_read = probe_kernel_read(ctx, kernel, zero_copy_buf, NULL, sink, bytes);
+
+            if (ctx->svm_level == RETRYIX_SVM_LEVEL_COARSE_GRAIN || ctx->svm_level == RETRYIX_SVM_LEVEL_FINE_GRAIN ||
+                ctx->svm_level == RETRYIX_SVM_LEVEL_FINE_GRAIN_SYSTEM) {
+                cl_svm_mem_flags flags = CL_MEM_READ_WRITE;
+                if (ctx->svm_level != RETRYIX_SVM_LEVEL_COARSE_GRAIN) flags |= CL_MEM_SVM_FINE_GRAIN_BUFFER;
+                void* svm_ptr = clSVMAlloc(ctx->context, flags, bytes, 0);
+                if (svm_ptr) {
+                    probe->svm_read = probe_kernel_read(ctx, kernel, NULL, svm_ptr, sink, bytes);
+                    clSVMFree(ctx->context, svm_ptr);
+                }
+            }
+            clReleaseKernel(kernel);
+        }
+    }
+    if (program) clReleaseProgram(program);
+
+    if (sink) clReleaseMemObject(sink);
+    if (zero_copy_buf) clReleaseMemObject(zero_copy_buf);
+    if (device_buf) clReleaseMemObject(device_buf);
+    aligned_free(host);
+
+    probe->measured = (probe->device_read > 0.0 || probe->host_to_device > 0.0);
+}
+
+// 探測結果以設備為單位存入調校快取，避免每次啟動重新量測
+static void load_or_probe(retryix_placement_context_t* ctx) {
+    char value[128];
+    retryix_placement_probe_t* probe = &ctx->probe;
+    if (retryix_tuning_get(ctx->device, RETRYIX_PLACEMENT_PROBE_KEY, value, sizeof(value)) == RETRYIX_SUCCESS &&
+        sscanf(value, "%lf %lf %lf %lf %lf", &probe->host_to_device, &probe->device_to_host,
+               &probe->device_read, &probe->zero_copy_read, &probe->svm_read) == 5) {
+        probe->measured = true;
+        return;
+    }
+
+    size_t bytes = (size_t)retryix_config_get_dword("Placement", "ProbeSizeKB", 8192) * 1024;
+    if (bytes < 64 * 1024) bytes = 64 * 1024;
+    run_bandwidth_probe(ctx, bytes);
+
+    if (probe->measured) {
+        snprintf(value, sizeof(value), "%.3f %.3f %.3f %.3f %.3f", probe->host_to_device, probe->device_to_host,
+                 probe->device_read, probe->zero_copy_read, probe->svm_read);
+        retryix_tuning_put(ctx->device, RETRYIX_PLACEMENT_PROBE_KEY, value);
+    }
+}
+
+// === 配置決策 ===
+
+static bool svm_native(retryix_placement_context_t* ctx) {
+    return ctx->svm && (ctx->svm_level == RETRYIX_SVM_LEVEL_COARSE_GRAIN ||
+                        ctx->svm_level == RETRYIX_SVM_LEVEL_FINE_GRAIN ||
+                        ctx->svm_level == RETRYIX_SVM_LEVEL_FINE_GRAIN_SYSTEM);
+}
+
+static double transfer_ms(size_t bytes, double gb_per_s) {
+    return (gb_per_s > 0.0) ? (double)bytes / (gb_per_s * 1e6) : -1.0;
+}
+
+// 預估各配置的成本：主機寫入 + 設備讀取次數 + 讀回
+static void estimate_costs(retryix_placement_context_t* ctx, size_t size, unsigned int hints, double* out) {
+    const retryix_placement_probe_t* p = &ctx->probe;
+    double reads = (hints & RETRYIX_USAGE_DEVICE_READ_MANY) ? (double)ctx->read_many_factor : 1.0;
+    bool host_writes = (hints & RETRYIX_USAGE_HOST_WRITE_ONCE) != 0;
+    bool read_back = (hints & RETRYIX_USAGE_HOST_READ_BACK) != 0;
+
+    // 設備常駐：需顯式傳輸
+    double device_read = transfer_ms(size, p->device_read);
+    double upload = host_writes ? transfer_ms(size, p->host_to_device) : 0.0;
+    double download = read_back ? transfer_ms(size, p->device_to_host) : 0.0;
+    out[RETRYIX_PLACEMENT_DEVICE] = (device_read < 0.0 || upload < 0.0 || download < 0.0)
+                                    ? -1.0 : upload + reads * device_read + download;
+
+    // 零拷貝 / SVM：主機直接存取，設備每次讀取都經過共享路徑
+    double zero_copy_read = transfer_ms(size, p->zero_copy_read);
+    out[RETRYIX_PLACEMENT_ZERO_COPY] = (zero_copy_read < 0.0) ? -1.0 : reads * zero_copy_read;
+
+    double svm_read = transfer_ms(size, p->svm_read);
+    out[RETRYIX_PLACEMENT_SVM] = (!svm_native(ctx) || svm_read < 0.0) ? -1.0 : reads * svm_read;
+}
+
+static retryix_placement_t choose_placement(retryix_placement_context_t* ctx, size_t size, unsigned int hints,
+                                            double* costs) {
+    estimate_costs(ctx, size, hints, costs);
+
+    if (ctx->forced >= 1 && ctx->forced <= RETRYIX_PLACEMENT_COUNT) {
+        retryix_placement_t forced = (retryix_placement_t)(ctx->forced - 1);
+        if (forced != RETRYIX_PLACEMENT_SVM || ctx->svm) return forced;
+    }
+
+    // 主機與設備共用原子操作需細粒度 SVM + 原子支援，否則只能留在設備端
+    if (hints & RETRYIX_USAGE_SHARED_ATOMIC) {
+        if (ctx->svm && ctx->svm_atomics &&
+            (ctx->svm_level == RETRYIX_SVM_LEVEL_FINE_GRAIN || ctx->svm_level == RETRYIX_SVM_LEVEL_FINE_GRAIN_SYSTEM)) {
+            return RETRYIX_PLACEMENT_SVM;
+        }
+        return RETRYIX_PLACEMENT_DEVICE;
+    }
+
+    // 無量測結果時：統一記憶體的設備偏好零拷貝，獨立顯卡偏好設備常駐
+    if (!ctx->probe.measured) {
+        return ctx->host_unified_memory ? RETRYIX_PLACEMENT_ZERO_COPY : RETRYIX_PLACEMENT_DEVICE;
+    }
+
+    retryix_placement_t best = RETRYIX_PLACEMENT_DEVICE;
+    double best_cost = -1.0;
+    for (int i = 0; i < RETRYIX_PLACEMENT_COUNT; i++) {
+        if (costs[i] < 0.0) continue;
+        // 成本相近（5% 內）時偏好較簡單的配置（順序即偏好）
+        if (best_cost < 0.0 || costs[i] < best_cost * 0.95) {
+            best = (retryix_placement_t)i;
+            best_cost = costs[i];
+        }
+    }
+    return best;
+}
+
+static retryix_placement_record_t* find_record(void* ptr) {
+    if (!g_placement_context || !ptr) return NULL;
+    for (size_t i = 0; i < g_placement_context->record_count; i++) {
+        if (g_placement_context->records[i].ptr == ptr) return &g_placement_context->records[i];
+    }
+    return NULL;
+}
+
+// === 公開 API ===
+
+// 初始化自動配置器：探測統一記憶體與 SVM 能力並量測頻寬（結果快取於調校快取）
+// svm 可為 NULL（不使用 SVM 配置）
+int retryix_placement_init(cl_context context, cl_device_id device, cl_command_queue queue,
+                           retryix_svm_context_t* svm) {
+    if (g_placement_context) return 0;
+    if (!context || !device || !queue) return -1;
+
+    if (!retryix_memory_init(context, device)) return -1;
+
+    retryix_placement_context_t* ctx = (retryix_placement_context_t*)calloc(1, sizeof(retryix_placement_context_t));
+    if (!ctx) return -1;
+
+    ctx->context = context;
+    ctx->device = device;
+    ctx->queue = queue;
+    ctx->svm = svm;
+
+    cl_bool unified = CL_FALSE;
+    clGetDeviceInfo(device, CL_DEVICE_HOST_UNIFIED_MEMORY, sizeof(unified), &unified, NULL);
+    ctx->host_unified_memory = (unified == CL_TRUE);
+
+    cl_bitfield svm_caps = 0;
+    ctx->svm_level = retryix_svm_probe_capabilities(device, &svm_caps);
+    ctx->svm_atomics = (svm_caps & CL_DEVICE_SVM_ATOMICS) != 0;
+
+    ctx->read_many_factor = retryix_config_get_dword("Placement", "ReadManyFactor", 8);
+    if (ctx->read_many_factor == 0) ctx->read_many_factor = 1;
+    ctx->forced = retryix_config_get_dword("Placement", "Force", 0);
+
+    load_or_probe(ctx);
+    g_placement_context = ctx;
+
+    printf("RetryIX Placement Initialized\n");
+    printf("  Host Unified Memory: %s\n", ctx->host_unified_memory ? "YES" : "NO");
+    printf("  SVM Level: %d (atomics %s)\n", ctx->svm_level, ctx->svm_atomics ? "YES" : "NO");
+    if (ctx->probe.measured) {
+        printf("  H2D %.2f GB/s, D2H %.2f GB/s, device read %.2f GB/s, zero-copy read %.2f GB/s, SVM read %.2f GB/s\n",
+               ctx->probe.host_to_device, ctx->probe.device_to_host, ctx->probe.device_read,
+               ctx->probe.zero_copy_read, ctx->probe.svm_read);
+    }
+    return 0;
+}
+
+const char* retryix_placement_name(retryix_placement_t placement) {
+    return (placement >= 0 && placement < RETRYIX_PLACEMENT_COUNT) ? PLACEMENT_LABELS[placement] : "UNKNOWN";
+}
+
+// 依用途提示配置記憶體，out_placement 回報所選配置
+void* retryix_alloc_auto(size_t size, unsigned int hints, const char* debug_name, retryix_placement_t* out_placement) {
+    retryix_placement_context_t* ctx = g_placement_context;
+    if (!ctx || size == 0) return NULL;
+
+    double costs[RETRYIX_PLACEMENT_COUNT];
+    retryix_placement_t placement = choose_placement(ctx, size, hints, costs);
+
+    void* ptr = NULL;
+    switch (placement) {
+        case RETRYIX_PLACEMENT_SVM: {
+            retryix_svm_flags_t flags = RETRYIX_SVM_FLAG_READ_WRITE;
+            if (hints & RETRYIX_USAGE_SHARED_ATOMIC) flags = (retryix_svm_flags_t)(flags | RETRYIX_SVM_FLAG_ATOMIC);
+            ptr = retryix_svm_alloc(ctx->svm, size, flags);
+            break;
+        }
+        case RETRYIX_PLACEMENT_ZERO_COPY:
+            ptr = retryix_memory_alloc_from(NULL, size, (retryix_memory_flags_t)(RETRYIX_MEM_READ_WRITE | RETRYIX_MEM_ZERO_COPY), debug_name);
+            break;
+        case RETRYIX_PLACEMENT_DEVICE:
+        default:
+            ptr = retryix_memory_alloc_from(NULL, size, RETRYIX_MEM_READ_WRITE, debug_name);
+            break;
+    }
+    if (!ptr) return NULL;
+
+    if (ctx->record_count >= ctx->record_capacity) {
+        size_t new_capacity = ctx->record_capacity ? ctx->record_capacity * 2 : 32;
+        retryix_placement_record_t* grown = (retryix_placement_record_t*)realloc(ctx->records,
+                                                        new_capacity * sizeof(retryix_placement_record_t));
+        if (!grown) {
+            if (placement == RETRYIX_PLACEMENT_SVM) retryix_svm_free(ctx->svm, ptr);
+            else retryix_memory_free(ptr);
+            return NULL;
+        }
+        ctx->records = grown;
+        ctx->record_capacity = new_capacity;
+    }
+
+    retryix_placement_record_t* record = &ctx->records[ctx->record_count++];
+    memset(record, 0, sizeof(*record));
+    record->ptr = ptr;
+    record->size = size;
+    record->hints = hints;
+    record->placement = placement;
+    memcpy(record->estimated_ms, costs, sizeof(costs));
+    snprintf(record->debug_name, sizeof(record->debug_name), "%s", debug_name ? debug_name : "auto");
+    ctx->placement_counts[placement]++;
+
+    printf("Auto placement: %s -> %s (%zu bytes)\n", record->debug_name, retryix_placement_name(placement), size);
+    if (out_placement) *out_placement = placement;
+    return ptr;
+}
+
+int retryix_free_auto(void* ptr) {
+    retryix_placement_context_t* ctx = g_placement_context;
+    retryix_placement_record_t* record = find_record(ptr);
+    if (!record) return -1;
+
+    int rc = (record->placement == RETRYIX_PLACEMENT_SVM) ? retryix_svm_free(ctx->svm, ptr) : retryix_memory_free(ptr);
+    *record = ctx->records[--ctx->record_count];
+    return rc;
+}
+
+// 查詢配置結果
+int retryix_alloc_auto_placement(void* ptr, retryix_placement_t* out_placement) {
+    retryix_placement_record_t* record = find_record(ptr);
+    if (!record || !out_placement) return -1;
+    *out_placement = record->placement;
+    return 0;
+}
+
+// 建立對應配置的追蹤式內核參數
+int retryix_alloc_auto_arg(void* ptr, retryix_access_t access, retryix_kernel_arg_t* out_arg) {
+    retryix_placement_record_t* record = find_record(ptr);
+    if (!record || !out_arg) return -1;
+    out_arg->kind = (record->placement == RETRYIX_PLACEMENT_SVM) ? RETRYIX_ARG_SVM : RETRYIX_ARG_BUFFER;
+    out_arg->access = access;
+    out_arg->value = ptr;
+    out_arg->size = 0;
+    return 0;
+}
+
+// 主機寫入後讓設備可見（設備常駐需上傳，其餘配置由啟動時的相依追蹤處理）
+int retryix_alloc_auto_publish(void* ptr, cl_command_queue queue) {
+    retryix_placement_record_t* record = find_record(ptr);
+    if (!record || !queue) return -1;
+    if (record->placement == RETRYIX_PLACEMENT_DEVICE) {
+        return retryix_memory_copy_to_device(ptr, queue, false);
+    }
+    return 0;
+}
+
+// 設備寫入後讓主機可讀（設備常駐需讀回並等待）
+int retryix_alloc_auto_acquire(void* ptr, cl_command_queue queue) {
+    retryix_placement_context_t* ctx = g_placement_context;
+    retryix_placement_record_t* record = find_record(ptr);
+    if (!record || !queue) return -1;
+
+    switch (record->placement) {
+        case RETRYIX_PLACEMENT_SVM:
+            return retryix_svm_sync(ctx->svm, ptr);
+        case RETRYIX_PLACEMENT_ZERO_COPY:
+            return retryix_memory_sync(ptr);
+        case RETRYIX_PLACEMENT_DEVICE:
+        default:
+            if (retryix_memory_copy_from_device(ptr, queue, false) != 0) return -1;
+            return retryix_memory_sync(ptr);
+    }
+}
+
+// 配置報告：探測結果與每筆配置的選擇依據
+void retryix_placement_print_report(void) {
+    retryix_placement_context_t* ctx = g_placement_context;
+    if (!ctx) {
+        printf("Placement not initialized\n");
+        return;
+    }
+
+    printf("\n=== RetryIX Placement Report ===\n");
+    printf("Host Unified Memory: %s, SVM Level: %d, SVM Atomics: %s\n",
+           ctx->host_unified_memory ? "YES" : "NO", ctx->svm_level, ctx->svm_atomics ? "YES" : "NO");
+    if (ctx->probe.measured) {
+        printf("Bandwidth (GB/s): H2D %.2f | D2H %.2f | device read %.2f | zero-copy read %.2f | SVM read %.2f\n",
+               ctx->probe.host_to_device, ctx->probe.device_to_host, ctx->probe.device_read,
+               ctx->probe.zero_copy_read, ctx->probe.svm_read);
+    } else {
+        printf("Bandwidth probe unavailable; using unified-memory heuristic\n");
+    }
+    if (ctx->forced) printf("Forced placement: %s\n", retryix_placement_name((retryix_placement_t)(ctx->forced - 1)));
+    printf("Placements: DEVICE %llu, ZERO_COPY %llu, SVM %llu\n",
+           (unsigned long long)ctx->placement_counts[RETRYIX_PLACEMENT_DEVICE],
+           (unsigned long long)ctx->placement_counts[RETRYIX_PLACEMENT_ZERO_COPY],
+           (unsigned long long)ctx->placement_counts[RETRYIX_PLACEMENT_SVM]);
+
+    printf("\nActive Allocations:\n");
+    for (size_t i = 0; i < ctx->record_count; i++) {
+        retryix_placement_record_t* r = &ctx->records[i];
+        printf("  %s: %zu bytes, hints 0x%x -> %s (est. ms: DEVICE %.3f, ZERO_COPY %.3f, SVM %.3f)\n",
+               r->debug_name, r->size, r->hints, retryix_placement_name(r->placement),
+               r->estimated_ms[RETRYIX_PLACEMENT_DEVICE], r->estimated_ms[RETRYIX_PLACEMENT_ZERO_COPY],
+               r->estimated_ms[RETRYIX_PLACEMENT_SVM]);
+    }
+    printf("================================\n\n");
+}
+
+void retryix_placement_cleanup(void) {
+    retryix_placement_context_t* ctx = g_placement_context;
+    if (!ctx) return;
+
+    while (ctx->record_count > 0) {
+        retryix_free_auto(ctx->records[0].ptr);
+    }
+    free(ctx->records);
+    free(ctx);
+    g_placement_context = NULL;
+}
@@ -0,0 +1,613 @@
+// retryix_pool.c - RetryIX 共用工作竊取執行緒池（Chase-Lev 雙端佇列、fork/join 與 parallel_for）
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // pthread_setaffinity_np
+#endif
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include "retryix_thread.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <unistd.h>
+#endif
+
+#define RETRYIX_POOL_MAX_WORKERS     64
+#define RETRYIX_POOL_DEQUE_CAPACITY  4096   // 2 的次方；佇列滿時任務於推入端直接執行
+#define RETRYIX_POOL_SPIN_ROUNDS     64     // 進入睡眠前的竊取嘗試輪數
+
+typedef struct retryix_pool_task {
+    retryix_pool_fn fn;
+    void* arg;
+    retryix_pool_range_fn range_fn;         // 非 NULL 時為 parallel_for 的區間任務
+    size_t begin;
+    size_t end;
+    size_t grain;
+    retryix_pool_group_t* group;
+    struct retryix_pool_task* next;         // 注入佇列
+} retryix_pool_task_t;
+
+// Chase-Lev 雙端佇列：擁有者於 bottom 推入/取出，竊取者以 CAS 自 top 取走
+typedef struct {
+    volatile int64_t top;
+    char pad0[64 - sizeof(int64_t)];
+    volatile int64_t bottom;
+    char pad1[64 - sizeof(int64_t)];
+    void* volatile buffer[RETRYIX_POOL_DEQUE_CAPACITY];
+
+    // 統計（executed / steals 等由擁有者更新，外部執行緒使用 external 欄位）
+    volatile uint64_t executed;
+    volatile uint64_t steals;
+    volatile uint64_t failed_steals;
+    volatile uint64_t idle_waits;
+    double idle_ms;
+    size_t max_depth;
+} retryix_pool_worker_t;
+
+typedef struct retryix_pool_context retryix_pool_context_t;
+
+typedef struct {
+    retryix_pool_context_t* ctx;
+    int id;
+} retryix_pool_thread_arg_t;
+
+struct retryix_pool_context {
+    int worker_count;                       // 佇列數（竊取輪詢範圍）
+    int thread_count;                       // 實際執行中的 worker 執行緒
+    bool affinity;
+    retryix_pool_worker_t* workers;
+    rix_thread_t threads[RETRYIX_POOL_MAX_WORKERS];
+    retryix_pool_thread_arg_t thread_args[RETRYIX_POOL_MAX_WORKERS];
+
+    // 非池內執行緒提交的任務
+    rix_mutex_t inject_lock;
+    retryix_pool_task_t* inject_head;
+    retryix_pool_task_t* inject_tail;
+    volatile int64_t inject_count;
+
+    rix_mutex_t sleep_lock;
+    rix_cond_t sleep_cond;
+    volatile int64_t sleepers;
+    volatile int shutdown;
+
+    volatile uint64_t external_executed;
+    volatile uint64_t external_steals;
+};
+
+static retryix_pool_context_t* g_pool_context = NULL;
+static rix_mutex_t g_pool_init_lock;        // 序列化 init / cleanup（首次使用時可能由多個執行緒同時觸發）
+static rix_once_t g_pool_once = RIX_ONCE_INIT;
+static RIX_THREAD_LOCAL int t_pool_worker = -1;
+
+static void init_pool_lock(void) {
+    rix_mutex_init(&g_pool_init_lock);
+}
+
+// 已發布的執行緒池（init 完成後才可見）
+static retryix_pool_context_t* pool_current(void) {
+    return (retryix_pool_context_t*)rix_atomic_load_ptr((void* volatile*)&g_pool_context);
+}
+
+static int processor_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+static void pin_current_thread(int core) {
+#if defined(_WIN32)
+    SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << (core % (int)(sizeof(DWORD_PTR) * 8)));
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % CPU_SETSIZE, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)core; // 其他平台不支援綁定
+#endif
+}
+
+// === Chase-Lev 佇列 ===
+
+static bool deque_push(retryix_pool_worker_t* w, retryix_pool_task_t* task) {
+    int64_t b = w->bottom;
+    int64_t t = rix_atomic_load_i64(&w->top);
+    if (b - t >= RETRYIX_POOL_DEQUE_CAPACITY) return false;
+    rix_atomic_store_ptr(&w->buffer[b & (RETRYIX_POOL_DEQUE_CAPACITY - 1)], task);
+    rix_atomic_store_i64(&w->bottom, b + 1);
+    if ((size_t)(b + 1 - t) > w->max_depth) w->max_depth = (size_t)(b + 1 - t);
+    return true;
+}
+
+static retryix_pool_task_t* deque_take(retryix_pool_worker_t* w) {
+    int64_t b = w->bottom - 1;
+    rix_atomic_store_i64(&w->bottom, b);
+    rix_atomic_fence();
+    int64_t t = rix_atomic_load_i64(&w->top);
+    if (t > b) {
+        rix_atomic_store_i64(&w->bottom, b + 1);
+        return NULL;
+    }
+    retryix_pool_task_t* task = (retryix_pool_task_t*)rix_atomic_load_ptr(&w->buffer[b & (RETRYIX_POOL_DEQUE_CAPACITY - 1)]);
+    if (t == b) {
+        // 最後一個元素：與竊取者競爭
+        if (!rix_atomic_cas_i64(&w->top, t, t + 1)) task = NULL;
+        rix_atomic_store_i64(&w->bottom, b + 1);
+    }
+    return task;
+}
+
+static retryix_pool_task_t* deque_steal(retryix_pool_worker_t* w, bool* contended) {
+    int64_t t = rix_atomic_load_i64(&w->top);
+    rix_atomic_fence();
+    int64_t b = rix_atomic_load_i64(&w->bottom);
+    if (t >= b) return NULL;
+    retryix_pool_task_t* task = (retryix_pool_task_t*)rix_atomic_load_ptr(&w->buffer[t & (RETRYIX_POOL_DEQUE_CAPACITY - 1)]);
+    if (!rix_atomic_cas_i64(&w->top, t, t + 1)) {
+        *contended = true;
+        return NULL;
+    }
+    return task;
+}
+
+static size_t deque_depth(retryix_pool_worker_t* w) {
+    int64_t depth = rix_atomic_load_i64(&w->bottom) - rix_atomic_load_i64(&w->top);
+    return depth > 0 ? (size_t)depth : 0;
+}
+
+// === 排程 ===
+
+static retryix_pool_task_t* pop_injected(retryix_pool_context_t* ctx) {
+    if (rix_atomic_load_i64(&ctx->inject_count) == 0) return NULL;
+    rix_mutex_lock(&ctx->inject_lock);
+    retryix_pool_task_t* task = ctx->inject_head;
+    if (task) {
+        ctx->inject_head = task->next;
+        if (!ctx->inject_head) ctx->inject_tail = NULL;
+        rix_atomic_add_i64(&ctx->inject_count, -1);
+    }
+    rix_mutex_unlock(&ctx->inject_lock);
+    return task;
+}
+
+// 依序嘗試：自身佇列、注入佇列、竊取其他 worker（由自身下一個開始輪詢）
+static retryix_pool_task_t* find_task(retryix_pool_context_t* ctx, int self) {
+    retryix_pool_task_t* task = NULL;
+    if (self >= 0) {
+        task = deque_take(&ctx->workers[self]);
+        if (task) return task;
+    }
+    task = pop_injected(ctx);
+    if (task) return task;
+
+    int start = self >= 0 ? self + 1 : 0;
+    for (int k = 0; k < ctx->worker_count; k++) {
+        int victim = (start + k) % ctx->worker_count;
+        if (victim == self) continue;
+        bool contended = false;
+        task = deque_steal(&ctx->workers[victim], &contended);
+        if (task) {
+            if (self >= 0) rix_atomic_inc_u64(&ctx->workers[self].steals);
+            else rix_atomic_inc_u64(&ctx->external_steals);
+            return task;
+        }
+        if (contended && self >= 0) rix_atomic_inc_u64(&ctx->workers[self].failed_steals);
+    }
+    return NULL;
+}
+
+static bool has_work(retryix_pool_context_t* ctx) {
+    if (rix_atomic_load_i64(&ctx->inject_count) > 0) return true;
+    for (int w = 0; w < ctx->worker_count; w++) {
+        if (deque_depth(&ctx->workers[w]) > 0) return true;
+    }
+    return false;
+}
+
+static void wake_one(retryix_pool_context_t* ctx) {
+    rix_atomic_fence();
+    if (rix_atomic_load_i64(&ctx->sleepers) > 0) {
+        rix_mutex_lock(&ctx->sleep_lock);
+        rix_cond_signal(&ctx->sleep_cond);
+        rix_mutex_unlock(&ctx->sleep_lock);
+    }
+}
+
+static void execute_task(retryix_pool_context_t* ctx, retryix_pool_task_t* task);
+
+// 池內執行緒推入自身佇列（滿時直接執行），其他執行緒推入注入佇列
+static void push_task(retryix_pool_context_t* ctx, retryix_pool_task_t* task) {
+    int self = t_pool_worker;
+    if (self >= 0 && self < ctx->worker_count) {
+        if (!deque_push(&ctx->workers[self], task)) {
+            execute_task(ctx, task);
+            return;
+        }
+    } else {
+        task->next = NULL;
+        rix_mutex_lock(&ctx->inject_lock);
+        if (ctx->inject_tail) ctx->inject_tail->next = task;
+        else ctx->inject_head = task;
+        ctx->inject_tail = task;
+        rix_atomic_add_i64(&ctx->inject_count, 1);
+        rix_mutex_unlock(&ctx->inject_lock);
+    }
+    wake_one(ctx);
+}
+
+static void spawn_range(retryix_pool_context_t* ctx, retryix_pool_group_t* group, retryix_pool_range_fn fn, void* arg,
+                        size_t begin, size_t end, size_t grain);
+
+// 區間大於 grain 時持續對半切分，後半交給佇列供其他 worker 竊取
+static void run_range(retryix_pool_context_t* ctx, retryix_pool_group_t* group, retryix_pool_range_fn fn, void* arg,
+                      size_t begin, size_t end, size_t grain) {
+    while (end - begin > grain) {
+        size_t mid = begin + (end - begin) / 2;
+        spawn_range(ctx, group, fn, arg, mid, end, grain);
+        end = mid;
+    }
+    fn(arg, begin, end);
+}
+
+static void execute_task(retryix_pool_context_t* ctx, retryix_pool_task_t* task) {
+    if (task->range_fn) {
+        run_range(ctx, task->group, task->range_fn, task->arg, task->begin, task->end, task->grain);
+    } else {
+        task->fn(task->arg);
+    }
+    if (t_pool_worker >= 0) rix_atomic_inc_u64(&ctx->workers[t_pool_worker].executed);
+    else rix_atomic_inc_u64(&ctx->external_executed);
+    if (task->group) rix_atomic_add_i64(&task->group->pending, -1);
+    free(task);
+}
+
+static void spawn_range(retryix_pool_context_t* ctx, retryix_pool_group_t* group, retryix_pool_range_fn fn, void* arg,
+                        size_t begin, size_t end, size_t grain) {
+    retryix_pool_task_t* task = (retryix_pool_task_t*)calloc(1, sizeof(retryix_pool_task_t));
+    if (!task) {
+        run_range(ctx, group, fn, arg, begin, end, grain); // 配置失敗時就地執行
+        return;
+    }
+    task->range_fn = fn;
+    task->arg = arg;
+    task->begin = begin;
+    task->end = end;
+    task->grain = grain;
+    task->group = group;
+    rix_atomic_add_i64(&group->pending, 1);
+    push_task(ctx, task);
+}
+
+static rix_thread_ret_t RIX_THREAD_CALL worker_main(void* arg) {
+    retryix_pool_thread_arg_t* self = (retryix_pool_thread_arg_t*)arg;
+    retryix_pool_context_t* ctx = self->ctx;
+    retryix_pool_worker_t* w = &ctx->workers[self->id];
+    t_pool_worker = self->id;
+    if (ctx->affinity) pin_current_thread(self->id);
+
+    int idle_rounds = 0;
+    while (!rix_atomic_load_int(&ctx->shutdown)) {
+        retryix_pool_task_t* task = find_task(ctx, self->id);
+        if (task) {
+            execute_task(ctx, task);
+            idle_rounds = 0;
+            continue;
+        }
+        if (++idle_rounds < RETRYIX_POOL_SPIN_ROUNDS) {
+            rix_thread_yield();
+            continue;
+        }
+
+        // 登記為睡眠者後再確認一次，避免與推入端錯過喚醒
+        rix_mutex_lock(&ctx->sleep_lock);
+        rix_atomic_add_i64(&ctx->sleepers, 1);
+        rix_atomic_fence();
+        if (!rix_atomic_load_int(&ctx->shutdown) && !has_work(ctx)) {
+            double t0 = rixNowMs();
+            rix_cond_wait(&ctx->sleep_cond, &ctx->sleep_lock);
+            w->idle_ms += rixNowMs() - t0;
+            w->idle_waits++;
+        }
+        rix_atomic_add_i64(&ctx->sleepers, -1);
+        rix_mutex_unlock(&ctx->sleep_lock);
+        idle_rounds = 0;
+    }
+    t_pool_worker = -1;
+    return RIX_THREAD_RETURN;
+}
+
+// === 公開 API ===
+
+int retryix_pool_init(int threads) {
+    if (pool_current()) return 0;
+    rix_call_once(&g_pool_once, init_pool_lock);
+    rix_mutex_lock(&g_pool_init_lock);
+    if (g_pool_context) {
+        rix_mutex_unlock(&g_pool_init_lock);
+        return 0;
+    }
+
+    if (threads <= 0) threads = (int)retryix_config_get_dword("Performance", "ThreadPoolSize", 0);
+    if (threads <= 0) threads = processor_count();
+    if (threads > RETRYIX_POOL_MAX_WORKERS) threads = RETRYIX_POOL_MAX_WORKERS;
+
+    retryix_pool_context_t* ctx = (retryix_pool_context_t*)calloc(1, sizeof(retryix_pool_context_t));
+    if (!ctx) {
+        rix_mutex_unlock(&g_pool_init_lock);
+        return -1;
+    }
+    ctx->workers = (retryix_pool_worker_t*)calloc((size_t)threads, sizeof(retryix_pool_worker_t));
+    if (!ctx->workers) {
+        free(ctx);
+        rix_mutex_unlock(&g_pool_init_lock);
+        return -1;
+    }
+    ctx->affinity = retryix_config_get_dword("Performance", "ThreadAffinity", 0) != 0;
+    rix_mutex_init(&ctx->inject_lock);
+    rix_mutex_init(&ctx->sleep_lock);
+    rix_cond_init(&ctx->sleep_cond);
+
+    // worker_count 需在執行緒啟動前確定；部分建立失敗時未啟動的佇列保持為空，不影響竊取
+    ctx->worker_count = threads;
+    for (int w = 0; w < threads; w++) {
+        ctx->thread_args[w].ctx = ctx;
+        ctx->thread_args[w].id = w;
+        if (rix_thread_create(&ctx->threads[w], worker_main, &ctx->thread_args[w]) != 0) break;
+        ctx->thread_count++;
+    }
+    if (ctx->thread_count == 0) ctx->worker_count = 0; // 全部失敗：任務一律同步執行
+
+    rix_atomic_store_ptr((void* volatile*)&g_pool_context, ctx);
+    rix_mutex_unlock(&g_pool_init_lock);
+
+    printf("RetryIX Thread Pool Initialized\n");
+    printf("  Workers: %d, affinity: %s\n", ctx->thread_count, ctx->affinity ? "ON" : "OFF");
+    return 0;
+}
+
+void retryix_pool_cleanup(void) {
+    if (!pool_current()) return;
+    rix_call_once(&g_pool_once, init_pool_lock);
+    rix_mutex_lock(&g_pool_init_lock);
+    retryix_pool_context_t* ctx = g_pool_context;
+    if (!ctx) {
+        rix_mutex_unlock(&g_pool_init_lock);
+        return;
+    }
+
+    rix_atomic_store_int(&ctx->shutdown, 1);
+    rix_mutex_lock(&ctx->sleep_lock);
+    rix_cond_broadcast(&ctx->sleep_cond);
+    rix_mutex_unlock(&ctx->sleep_lock);
+    for (int w = 0; w < ctx->thread_count; w++) rix_thread_join(ctx->threads[w]);
+
+    // 尚未執行的任務由呼叫端完成，確保等待中的群組與回呼都能結束
+    retryix_pool_task_t* task;
+    while ((task = find_task(ctx, -1)) != NULL) execute_task(ctx, task);
+
+    rix_cond_destroy(&ctx->sleep_cond);
+    rix_mutex_destroy(&ctx->sleep_lock);
+    rix_mutex_destroy(&ctx->inject_lock);
+    free(ctx->workers);
+    free(ctx);
+    rix_atomic_store_ptr((void* volatile*)&g_pool_context, NULL);
+    rix_mutex_unlock(&g_pool_init_lock);
+}
+
+// 首次使用時以設定值初始化；多個執行緒同時首次呼叫時只會建立一個執行緒池
+static retryix_pool_context_t* pool_get(void) {
+    retryix_pool_context_t* ctx = pool_current();
+    if (!ctx) {
+        retryix_pool_init(0);
+        ctx = pool_current();
+    }
+    return ctx;
+}
+
+int retryix_pool_size(void) {
+    retryix_pool_context_t* ctx = pool_get();
+    return ctx ? ctx->thread_count : 0;
+}
+
+int retryix_pool_current_worker(void) {
+    return t_pool_worker;
+}
+
+void retryix_pool_group_init(retryix_pool_group_t* group) {
+    if (group) group->pending = 0;
+}
+
+int retryix_pool_spawn(retryix_pool_group_t* group, retryix_pool_fn fn, void* arg) {
+    if (!fn) return -1;
+    retryix_pool_context_t* ctx = pool_get();
+    retryix_pool_task_t* task = ctx ? (retryix_pool_task_t*)calloc(1, sizeof(retryix_pool_task_t)) : NULL;
+    if (!task || ctx->thread_count == 0) {
+        free(task);
+        fn(arg); // 無執行緒池時同步執行
+        return 0;
+    }
+    task->fn = fn;
+    task->arg = arg;
+    task->group = group;
+    if (group) rix_atomic_add_i64(&group->pending, 1);
+    push_task(ctx, task);
+    return 0;
+}
+
+int retryix_pool_submit(retryix_pool_fn fn, void* arg) {
+    return retryix_pool_spawn(NULL, fn, arg);
+}
+
+// 等待期間協助執行任務（包含其他群組的任務），池內執行緒不會因等待而閒置
+void retryix_pool_wait(retryix_pool_group_t* group) {
+    if (!group) return;
+    retryix_pool_context_t* ctx = pool_current();
+    while (rix_atomic_load_i64(&group->pending) > 0) {
+        retryix_pool_task_t* task = ctx ? find_task(ctx, t_pool_worker) : NULL;
+        if (task) execute_task(ctx, task);
+        else rix_thread_yield();
+    }
+}
+
+void retryix_pool_parallel_for(size_t count, size_t grain, retryix_pool_range_fn fn, void* arg) {
+    if (count == 0 || !fn) return;
+    retryix_pool_context_t* ctx = pool_get();
+    if (!ctx || ctx->thread_count == 0) {
+        fn(arg, 0, count);
+        return;
+    }
+    if (grain == 0) {
+        grain = count / ((size_t)(ctx->thread_count + 1) * 8);
+        if (grain == 0) grain = 1;
+    }
+    if (count <= grain) {
+        fn(arg, 0, count);
+        return;
+    }
+    retryix_pool_group_t group;
+    retryix_pool_group_init(&group);
+    run_range(ctx, &group, fn, arg, 0, count, grain);
+    retryix_pool_wait(&group);
+}
+
+int retryix_pool_get_stats(int worker, retryix_pool_worker_stats_t* out) {
+    retryix_pool_context_t* ctx = pool_current();
+    if (!ctx || !out || worker < 0 || worker >= ctx->worker_count) return -1;
+    retryix_pool_worker_t* w = &ctx->workers[worker];
+    out->executed = w->executed;
+    out->steals = w->steals;
+    out->failed_steals = w->failed_steals;
+    out->idle_waits = w->idle_waits;
+    out->idle_ms = w->idle_ms;
+    out->queue_depth = deque_depth(w);
+    out->max_queue_depth = w->max_depth;
+    return 0;
+}
+
+void retryix_pool_reset_stats(void) {
+    retryix_pool_context_t* ctx = pool_current();
+    if (!ctx) return;
+    for (int w = 0; w < ctx->worker_count; w++) {
+        ctx->workers[w].executed = 0;
+        ctx->workers[w].steals = 0;
+        ctx->workers[w].failed_steals = 0;
+        ctx->workers[w].idle_waits = 0;
+        ctx->workers[w].idle_ms = 0.0;
+        ctx->workers[w].max_depth = 0;
+    }
+    ctx->external_executed = 0;
+    ctx->external_steals = 0;
+}
+
+void retryix_pool_print_stats(void) {
+    retryix_pool_context_t* ctx = pool_current();
+    if (!ctx) return;
+    printf("  Thread pool (%d workers):\n", ctx->thread_count);
+    printf("    worker   executed     steals  failed  idle_waits   idle_ms  depth  max_depth\n");
+    for (int w = 0; w < ctx->worker_count; w++) {
+        retryix_pool_worker_stats_t s;
+        retryix_pool_get_stats(w, &s);
+        printf("    %6d %10llu %10llu %7llu %11llu %9.1f %6zu %10zu\n", w, (unsigned long long)s.executed,
+               (unsigned long long)s.steals, (unsigned long long)s.failed_steals, (unsigned long long)s.idle_waits,
+               s.idle_ms, s.queue_depth, s.max_queue_depth);
+    }
+    printf("    caller %10llu %10llu\n", (unsigned long long)ctx->external_executed,
+           (unsigned long long)ctx->external_steals);
+}
+
+// === 量測 ===
+
+typedef struct {
+    const float* input;
+    double* partials;
+    size_t block;
+    size_t count;
+} retryix_pool_bench_job_t;
+
+static void bench_range(void* arg, size_t begin, size_t end) {
+    retryix_pool_bench_job_t* job = (retryix_pool_bench_job_t*)arg;
+    for (size_t b = begin; b < end; b++) {
+        size_t first = b * job->block;
+        size_t last = first + job->block < job->count ? first + job->block : job->count;
+        double acc = 0.0;
+        for (size_t i = first; i < last; i++) acc += job->input[i] * (double)job->input[i];
+        job->partials[b] = acc;
+    }
+}
+
+static void bench_noop(void* arg) {
+    (void)arg;
+}
+
+// parallel_for 與 fork/join 的吞吐量與分派成本
+int retryix_pool_benchmark(size_t count, int iterations) {
+    retryix_pool_context_t* ctx = pool_get();
+    if (!ctx || count == 0) return -1;
+    if (iterations <= 0) iterations = 5;
+
+    const size_t block = 4096;
+    size_t blocks = (count + block - 1) / block;
+    float* input = (float*)malloc(count * sizeof(float));
+    double* partials = (double*)malloc(blocks * sizeof(double));
+    if (!input || !partials) {
+        free(partials);
+        free(input);
+        return -1;
+    }
+    for (size_t i = 0; i < count; i++) input[i] = (float)(i % 97) * 0.01f;
+
+    retryix_pool_bench_job_t job = { input, partials, block, count };
+    double serial_best = -1.0, pool_best = -1.0, serial_sum = 0.0, pool_sum = 0.0;
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        bench_range(&job, 0, blocks);
+        double ms = rixNowMs() - t0;
+        if (serial_best < 0.0 || ms < serial_best) serial_best = ms;
+        serial_sum = 0.0;
+        for (size_t b = 0; b < blocks; b++) serial_sum += partials[b];
+    }
+    retryix_pool_reset_stats();
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        retryix_pool_parallel_for(blocks, 1, bench_range, &job);
+        double ms = rixNowMs() - t0;
+        if (pool_best < 0.0 || ms < pool_best) pool_best = ms;
+        pool_sum = 0.0;
+        for (size_t b = 0; b < blocks; b++) pool_sum += partials[b];
+    }
+
+    // fork/join：大量空任務的分派成本
+    const int spawn_count = 10000;
+    retryix_pool_group_t group;
+    retryix_pool_group_init(&group);
+    double t0 = rixNowMs();
+    for (int i = 0; i < spawn_count; i++) retryix_pool_spawn(&group, bench_noop, NULL);
+    retryix_pool_wait(&group);
+    double spawn_ms = rixNowMs() - t0;
+
+    bool ok = (serial_sum == pool_sum);
+    printf("\n=== RetryIX Thread Pool Benchmark (%zu elements, %d workers) ===\n", count, ctx->thread_count);
+    printf("  parallel_for  serial %8.3f ms  pool %8.3f ms  speedup %.2fx  %s\n", serial_best, pool_best,
+           pool_best > 0.0 ? serial_best / pool_best : 0.0, ok ? "PASS" : "FAIL");
+    printf("  fork/join     %d empty tasks in %.3f ms (%.2f us/task)\n", spawn_count, spawn_ms,
+           spawn_ms * 1000.0 / spawn_count);
+    retryix_pool_print_stats();
+    printf("=====================================================\n\n");
+
+    free(partials);
+    free(input);
+    return ok ? 0 : -1;
+}
@@ -0,0 +1,918 @@
+// retryix_primitives.c - RetryIX 內建平行原語（reduce / scan / compact）與多執行緒 CPU 基準
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define RETRYIX_PRIM_ITEMS_PER_THREAD 4      // 每個 work-item 以一次向量載入處理 4 個元素
+#define RETRYIX_PRIM_MAX_LOCAL        256
+#define RETRYIX_PRIM_MAX_SCRATCH      16
+#define RETRYIX_PRIM_MAX_COUNT        0x7FFFFFFFu // 內核以 uint 索引
+#define RETRYIX_PRIM_MAX_CPU_THREADS  64
+
+static const char* PRIM_TYPE_LABELS[RETRYIX_PRIM_TYPE_COUNT] = { "int", "float", "double" };
+static const char* PRIM_TEMPLATE_NAMES[RETRYIX_PRIM_TYPE_COUNT] = {
+    "retryix_prim_int", "retryix_prim_float", "retryix_prim_double"
+};
+static const size_t PRIM_ELEMENT_SIZES[RETRYIX_PRIM_TYPE_COUNT] = {
+    sizeof(cl_int), sizeof(cl_float), sizeof(cl_double)
+};
+
+// === 內核源碼 ===
+
+// 元素型別標頭：double 使用 UNIVERSAL_VECTOR_TEMPLATE 的 RETRYIX_REAL / RETRYIX_REAL4
+// （設備支援 fp64 時兩者即為 double / double4）；float 固定寬度，因 RETRYIX_REAL 在 fp64 設備上會升為 double
+static const char* PRIM_TYPE_HEADERS[RETRYIX_PRIM_TYPE_COUNT] = {
+    "#define RIX_T int\n"
+    "#define RIX_T4 int4\n"
+    "#define RIX_T_MAX INT_MAX\n"
+    "#define RIX_T_LOWEST INT_MIN\n",
+
+    "#define RIX_T float\n"
+    "#define RIX_T4 float4\n"
+    "#define RIX_T_MAX INFINITY\n"
+    "#define RIX_T_LOWEST (-INFINITY)\n",
+
+    "#ifndef RETRYIX_NATIVE_DOUBLE\n"
+    "#error \"retryix_prim_double requires cl_khr_fp64\"\n"
+    "#endif\n"
+    "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+    "#define RIX_T RETRYIX_REAL\n"
+    "#define RIX_T4 RETRYIX_REAL4\n"
+    "#define RIX_T_MAX ((RETRYIX_REAL)INFINITY)\n"
+    "#define RIX_T_LOWEST ((RETRYIX_REAL)-INFINITY)\n"
+};
+
+// 型別無關的內核主體：每個 work-group 處理 local_size * 4 個元素（一個 tile），
+// local size 需為 2 的冪次；多階段由主機端依 tile 逐層派送
+static const char* PRIM_KERNEL_BODY =
+"// op: 0 = sum, 1 = min, 2 = max\n"
+"inline RIX_T rix_prim_identity(uint op) {\n"
+"    return op == 1 ? RIX_T_MAX : (op == 2 ? RIX_T_LOWEST : (RIX_T)0);\n"
+"}\n"
+"inline RIX_T rix_prim_combine(RIX_T a, RIX_T b, uint op) {\n"
+"    return op == 1 ? min(a, b) : (op == 2 ? max(a, b) : a + b);\n"
+"}\n"
+"\n"
+"// 完整 tile 以 vload4 向量載入，尾端以 fill 補齊\n"
+"inline RIX_T4 rix_prim_load4(__global const RIX_T* in, uint base, uint n, RIX_T fill) {\n"
+"    if (base + 3 < n) return vload4(0, in + base);\n"
+"    RIX_T4 v = (RIX_T4)(fill);\n"
+"    if (base < n) v.s0 = in[base];\n"
+"    if (base + 1 < n) v.s1 = in[base + 1];\n"
+"    if (base + 2 < n) v.s2 = in[base + 2];\n"
+"    return v;\n"
+"}\n"
+"inline void rix_prim_store4(__global RIX_T* out, uint base, uint n, RIX_T4 v) {\n"
+"    if (base + 3 < n) { vstore4(v, 0, out + base); return; }\n"
+"    if (base < n) out[base] = v.s0;\n"
+"    if (base + 1 < n) out[base + 1] = v.s1;\n"
+"    if (base + 2 < n) out[base + 2] = v.s2;\n"
+"}\n"
+"\n"
+"// 每個 work-group 歸約一個 tile，結果寫入 partials[group]\n"
+"__kernel void retryix_prim_reduce(__global const RIX_T* in, uint n, __global RIX_T* partials,\n"
+"                                  uint op, __local RIX_T* scratch) {\n"
+"    uint lid = get_local_id(0);\n"
+"    uint lsize = get_local_size(0);\n"
+"    uint base = (uint)get_global_id(0) * 4;\n"
+"    RIX_T4 v = rix_prim_load4(in, base, n, rix_prim_identity(op));\n"
+"    scratch[lid] = rix_prim_combine(rix_prim_combine(v.s0, v.s1, op), rix_prim_combine(v.s2, v.s3, op), op);\n"
+"    barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    for (uint s = lsize >> 1; s > 0; s >>= 1) {\n"
+"        if (lid < s) scratch[lid] = rix_prim_combine(scratch[lid], scratch[lid + s], op);\n"
+"        barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    }\n"
+"    if (lid == 0) partials[get_group_id(0)] = scratch[0];\n"
+"}\n"
+"\n"
+"// tile 內掃描（工作項內序列前綴 + local memory 上的 Blelloch 上掃/下掃），\n"
+"// tile 總和寫入 block_sums[group]；in 與 out 可為同一緩衝區\n"
+"__kernel void retryix_prim_scan_block(__global const RIX_T* in, __global RIX_T* out, uint n,\n"
+"                                      __global RIX_T* block_sums, uint inclusive, __local RIX_T* scratch) {\n"
+"    uint lid = get_local_id(0);\n"
+"    uint lsize = get_local_size(0);\n"
+"    uint base = (uint)get_global_id(0) * 4;\n"
+"    RIX_T4 v = rix_prim_load4(in, base, n, (RIX_T)0);\n"
+"    RIX_T4 incl;\n"
+"    incl.s0 = v.s0;\n"
+"    incl.s1 = incl.s0 + v.s1;\n"
+"    incl.s2 = incl.s1 + v.s2;\n"
+"    incl.s3 = incl.s2 + v.s3;\n"
+"    scratch[lid] = incl.s3;\n"
+"    barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    for (uint d = 1; d < lsize; d <<= 1) {\n"
+"        uint i = (lid + 1) * (d << 1) - 1;\n"
+"        if (i < lsize) scratch[i] += scratch[i - d];\n"
+"        barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    }\n"
+"    if (lid == 0) {\n"
+"        block_sums[get_group_id(0)] = scratch[lsize - 1];\n"
+"        scratch[lsize - 1] = (RIX_T)0;\n"
+"    }\n"
+"    barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    for (uint d = lsize >> 1; d > 0; d >>= 1) {\n"
+"        uint i = (lid + 1) * (d << 1) - 1;\n"
+"        if (i < lsize) {\n"
+"            RIX_T t = scratch[i - d];\n"
+"            scratch[i - d] = scratch[i];\n"
+"            scratch[i] += t;\n"
+"        }\n"
+"        barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    }\n"
+"    RIX_T4 result = inclusive ? incl : (RIX_T4)((RIX_T)0, incl.s0, incl.s1, incl.s2);\n"
+"    rix_prim_store4(out, base, n, result + (RIX_T4)(scratch[lid]));\n"
+"}\n"
+"\n"
+"// 加上前面各 tile 的總和（block_offsets 為已做排他掃描的 block_sums）\n"
+"__kernel void retryix_prim_scan_add(__global RIX_T* out, uint n, __global const RIX_T* block_offsets) {\n"
+"    uint base = (uint)get_global_id(0) * 4;\n"
+"    if (base >= n) return;\n"
+"    RIX_T offset = block_offsets[get_group_id(0)];\n"
+"    rix_prim_store4(out, base, n, rix_prim_load4(out, base, n, (RIX_T)0) + (RIX_T4)(offset));\n"
+"}\n"
+"\n"
+"// 保留旗標：非零元素為 1\n"
+"__kernel void retryix_prim_predicate(__global const RIX_T* in, uint n, __global int* keep) {\n"
+"    uint i = (uint)get_global_id(0);\n"
+"    if (i < n) keep[i] = (in[i] != (RIX_T)0) ? 1 : 0;\n"
+"}\n"
+"\n"
+"// 依排他掃描後的位置寫出保留元素，最後一個 work-item 寫出保留總數\n"
+"__kernel void retryix_prim_scatter(__global const RIX_T* in, __global const int* keep,\n"
+"                                   __global const int* positions, uint n,\n"
+"                                   __global RIX_T* out, __global int* count) {\n"
+"    uint i = (uint)get_global_id(0);\n"
+"    if (i >= n) return;\n"
+"    int k = keep[i];\n"
+"    if (k) out[positions[i]] = in[i];\n"
+"    if (i == n - 1) count[0] = positions[i] + k;\n"
+"}\n";
+
+// === 上下文 ===
+
+// 暫存緩衝區（retryix_memory 配置，重用時由相依追蹤保證順序）
+typedef struct {
+    void* ptr;
+    size_t size;
+    bool in_use;
+} retryix_prim_scratch_t;
+
+typedef struct {
+    bool registered;
+    bool prepared;
+    size_t local_size;                      // 2 的冪次
+} retryix_prim_type_state_t;
+
+typedef struct {
+    cl_context context;
+    cl_device_id device;
+    cl_command_queue queue;
+    bool supports_fp64;
+    retryix_prim_type_state_t types[RETRYIX_PRIM_TYPE_COUNT];
+    retryix_prim_scratch_t scratch[RETRYIX_PRIM_MAX_SCRATCH];
+    unsigned long cpu_threads;              // Primitives\CpuThreads（0 = 處理器數）
+    uint64_t launches;
+} retryix_primitives_context_t;
+
+static retryix_primitives_context_t* g_primitives_context = NULL;
+
+typedef union {
+    cl_int i;
+    cl_float f;
+    cl_double d;
+} retryix_prim_value_t;
+
+static size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+static retryix_prim_scratch_t* find_scratch(retryix_primitives_context_t* ctx, void* ptr) {
+    for (int i = 0; i < RETRYIX_PRIM_MAX_SCRATCH; i++) {
+        if (ctx->scratch[i].ptr == ptr) return &ctx->scratch[i];
+    }
+    return NULL;
+}
+
+// 取得至少 bytes 大小的暫存緩衝區（優先重用最小的閒置項）
+static void* acquire_scratch(retryix_primitives_context_t* ctx, size_t bytes) {
+    retryix_prim_scratch_t* best = NULL;
+    retryix_prim_scratch_t* empty = NULL;
+    retryix_prim_scratch_t* undersized = NULL;
+    for (int i = 0; i < RETRYIX_PRIM_MAX_SCRATCH; i++) {
+        retryix_prim_scratch_t* s = &ctx->scratch[i];
+        if (s->in_use) continue;
+        if (!s->ptr) {
+            if (!empty) empty = s;
+        } else if (s->size >= bytes) {
+            if (!best || s->size < best->size) best = s;
+        } else if (!undersized) {
+            undersized = s;
+        }
+    }
+    if (best) {
+        best->in_use = true;
+        return best->ptr;
+    }
+
+    retryix_prim_scratch_t* slot = empty ? empty : undersized;
+    if (!slot) {
+        printf("Primitives: scratch pool exhausted\n");
+        return NULL;
+    }
+    if (slot->ptr) {
+        retryix_memory_free(slot->ptr);
+        slot->ptr = NULL;
+    }
+    slot->ptr = retryix_memory_alloc_from(NULL, bytes, RETRYIX_MEM_READ_WRITE, "prim_scratch");
+    if (!slot->ptr) return NULL;
+    slot->size = bytes;
+    slot->in_use = true;
+    return slot->ptr;
+}
+
+static void release_scratch(retryix_primitives_context_t* ctx, void* ptr) {
+    retryix_prim_scratch_t* s = find_scratch(ctx, ptr);
+    if (s) s->in_use = false;
+}
+
+// retryix_memory 配置以緩衝區參數綁定，其餘視為 SVM 指標
+static retryix_kernel_arg_t buffer_arg(const void* ptr, retryix_access_t access) {
+    retryix_kernel_arg_t arg;
+    arg.kind = retryix_memory_get_device_mem((void*)ptr) ? RETRYIX_ARG_BUFFER : RETRYIX_ARG_SVM;
+    arg.access = access;
+    arg.value = ptr;
+    arg.size = 0;
+    return arg;
+}
+
+static retryix_kernel_arg_t value_arg(const void* value, size_t size) {
+    retryix_kernel_arg_t arg = { RETRYIX_ARG_VALUE, RETRYIX_ACCESS_AUTO, value, size };
+    return arg;
+}
+
+static retryix_kernel_arg_t local_arg(size_t size) {
+    retryix_kernel_arg_t arg = { RETRYIX_ARG_LOCAL, RETRYIX_ACCESS_AUTO, NULL, size };
+    return arg;
+}
+
+// 註冊型別模板（型別標頭 + 共用主體）
+static int register_type(retryix_primitives_context_t* ctx, retryix_prim_type_t type) {
+    if (ctx->types[type].registered) return 0;
+
+    size_t len = strlen(PRIM_TYPE_HEADERS[type]) + strlen(PRIM_KERNEL_BODY) + 2;
+    char* source = (char*)malloc(len);
+    if (!source) return -1;
+    snprintf(source, len, "%s\n%s", PRIM_TYPE_HEADERS[type], PRIM_KERNEL_BODY);
+
+    int rc = retryix_kernel_register_program(PRIM_TEMPLATE_NAMES[type], source);
+    free(source);
+    if (rc == 0) ctx->types[type].registered = true;
+    return rc;
+}
+
+// 首次使用時編譯模板並決定 local size（不超過各內核的工作組上限）
+static int prepare_type(retryix_primitives_context_t* ctx, retryix_prim_type_t type) {
+    if (type < 0 || type >= RETRYIX_PRIM_TYPE_COUNT) return -1;
+    retryix_prim_type_state_t* state = &ctx->types[type];
+    if (state->prepared) return 0;
+    if (type == RETRYIX_PRIM_DOUBLE && !ctx->supports_fp64) {
+        printf("Primitives: device does not support double precision\n");
+        return -1;
+    }
+    if (register_type(ctx, type) != 0) return -1;
+
+    static const char* kernels[] = {
+        "retryix_prim_reduce", "retryix_prim_scan_block", "retryix_prim_scan_add",
+        "retryix_prim_predicate", "retryix_prim_scatter"
+    };
+    size_t limit = RETRYIX_PRIM_MAX_LOCAL;
+    for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+        cl_kernel kernel = retryix_kernel_acquire(PRIM_TEMPLATE_NAMES[type], kernels[i]);
+        if (!kernel) return -1;
+        size_t wg = 0;
+        if (clGetKernelWorkGroupInfo(kernel, ctx->device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(wg), &wg, NULL) == CL_SUCCESS &&
+            wg > 0 && wg < limit) {
+            limit = wg;
+        }
+        retryix_kernel_release(PRIM_TEMPLATE_NAMES[type], kernel);
+    }
+
+    size_t local = 1;
+    while (local * 2 <= limit) local *= 2;
+    state->local_size = local;
+    state->prepared = true;
+    return 0;
+}
+
+static int launch(retryix_primitives_context_t* ctx, retryix_prim_type_t type, const char* kernel_name,
+                  size_t global, const retryix_kernel_arg_t* args, cl_uint num_args) {
+    ctx->launches++;
+    return retryix_kernel_execute_tracked(PRIM_TEMPLATE_NAMES[type], kernel_name, global,
+                                          ctx->types[type].local_size, args, num_args, NULL);
+}
+
+// 一個 tile 對應的 global size
+static size_t tile_global(retryix_primitives_context_t* ctx, retryix_prim_type_t type, cl_uint n) {
+    size_t local = ctx->types[type].local_size;
+    size_t items = ((size_t)n + RETRYIX_PRIM_ITEMS_PER_THREAD - 1) / RETRYIX_PRIM_ITEMS_PER_THREAD;
+    return round_up(items, local);
+}
+
+// 讀回暫存緩衝區開頭的值
+static int read_scratch(retryix_primitives_context_t* ctx, void* scratch, void* out, size_t size) {
+    if (retryix_memory_copy_from_device(scratch, ctx->queue, true) != 0) return -1;
+    memcpy(out, scratch, size);
+    return 0;
+}
+
+// === 公開 API ===
+
+int retryix_primitives_init(cl_context context, cl_device_id device, cl_command_queue queue) {
+    if (g_primitives_context) return 0;
+    if (!context || !device || !queue) return retryix_cpu_device_active() ? 0 : -1; // CPU 偽設備由各 API 轉送
+
+    if (!retryix_memory_init(context, device)) return -1;
+
+    retryix_primitives_context_t* ctx = (retryix_primitives_context_t*)calloc(1, sizeof(retryix_primitives_context_t));
+    if (!ctx) return -1;
+
+    ctx->context = context;
+    ctx->device = device;
+    ctx->queue = queue;
+
+    char extensions[4096] = {0};
+    clGetDeviceInfo(device, CL_DEVICE_EXTENSIONS, sizeof(extensions) - 1, extensions, NULL);
+    ctx->supports_fp64 = (strstr(extensions, "cl_khr_fp64") != NULL);
+
+    ctx->cpu_threads = retryix_config_get_dword("Primitives", "CpuThreads", 0);
+    if (ctx->cpu_threads == 0) ctx->cpu_threads = (unsigned long)retryix_pool_size() + 1;
+    if (ctx->cpu_threads > RETRYIX_PRIM_MAX_CPU_THREADS) ctx->cpu_threads = RETRYIX_PRIM_MAX_CPU_THREADS;
+
+    // 模板於初始化時註冊（需在並行啟動前完成），編譯延後至首次使用
+    for (int t = 0; t < RETRYIX_PRIM_TYPE_COUNT; t++) {
+        if (t == RETRYIX_PRIM_DOUBLE && !ctx->supports_fp64) continue;
+        if (register_type(ctx, (retryix_prim_type_t)t) != 0) {
+            free(ctx);
+            return -1;
+        }
+    }
+
+    g_primitives_context = ctx;
+
+    printf("RetryIX Primitives Initialized\n");
+    printf("  FP64: %s, CPU baseline threads: %lu\n", ctx->supports_fp64 ? "YES" : "NO", ctx->cpu_threads);
+    return 0;
+}
+
+void retryix_primitives_cleanup(void) {
+    retryix_primitives_context_t* ctx = g_primitives_context;
+    if (!ctx) return;
+
+    for (int i = 0; i < RETRYIX_PRIM_MAX_SCRATCH; i++) {
+        if (ctx->scratch[i].ptr) retryix_memory_free(ctx->scratch[i].ptr);
+    }
+    free(ctx);
+    g_primitives_context = NULL;
+}
+
+// 多階段歸約：每階段將元素數縮小 tile 倍，直到剩下一個值
+int retryix_prim_reduce(retryix_prim_type_t type, retryix_prim_op_t op, const void* input, size_t count, void* out_value) {
+    retryix_primitives_context_t* ctx = g_primitives_context;
+    if (!ctx && retryix_cpu_device_active()) return retryix_cpu_reduce(type, op, input, count, out_value);
+    if (!ctx || !input || !out_value || count == 0 || count > RETRYIX_PRIM_MAX_COUNT) return -1;
+    if (op < 0 || op >= RETRYIX_PRIM_OP_COUNT || prepare_type(ctx, type) != 0) return -1;
+
+    size_t elem = PRIM_ELEMENT_SIZES[type];
+    size_t local = ctx->types[type].local_size;
+    size_t tile = local * RETRYIX_PRIM_ITEMS_PER_THREAD;
+    size_t groups = (count + tile - 1) / tile;
+    size_t second = (groups + tile - 1) / tile;
+
+    // 兩個交替使用的中間緩衝區與最終結果
+    void* ping = acquire_scratch(ctx, groups * elem);
+    void* pong = acquire_scratch(ctx, second * elem);
+    void* result = acquire_scratch(ctx, elem);
+    int rc = (ping && pong && result) ? 0 : -1;
+
+    cl_uint n = (cl_uint)count;
+    cl_uint op_value = (cl_uint)op;
+    const void* src = input;
+    for (int level = 0; rc == 0; level++) {
+        size_t level_groups = (n + tile - 1) / tile;
+        void* dst = (level_groups == 1) ? result : ((level & 1) ? pong : ping);
+        retryix_kernel_arg_t args[5] = {
+            buffer_arg(src, RETRYIX_ACCESS_READ), value_arg(&n, sizeof(n)),
+            buffer_arg(dst, RETRYIX_ACCESS_WRITE), value_arg(&op_value, sizeof(op_value)), local_arg(local * elem)
+        };
+        rc = launch(ctx, type, "retryix_prim_reduce", tile_global(ctx, type, n), args, 5);
+        if (level_groups == 1) break;
+        src = dst;
+        n = (cl_uint)level_groups;
+    }
+
+    if (rc == 0) rc = read_scratch(ctx, result, out_value, elem);
+
+    if (result) release_scratch(ctx, result);
+    if (pong) release_scratch(ctx, pong);
+    if (ping) release_scratch(ctx, ping);
+    return rc;
+}
+
+// 遞迴掃描：tile 內掃描後，對 tile 總和做排他掃描，再加回各 tile
+static int scan_level(retryix_primitives_context_t* ctx, retryix_prim_type_t type,
+                      const void* input, void* output, cl_uint n, cl_uint inclusive) {
+    size_t elem = PRIM_ELEMENT_SIZES[type];
+    size_t local = ctx->types[type].local_size;
+    size_t tile = local * RETRYIX_PRIM_ITEMS_PER_THREAD;
+    cl_uint groups = (cl_uint)((n + tile - 1) / tile);
+    size_t global = tile_global(ctx, type, n);
+
+    void* sums = acquire_scratch(ctx, groups * elem);
+    if (!sums) return -1;
+
+    retryix_kernel_arg_t block_args[6] = {
+        buffer_arg(input, RETRYIX_ACCESS_READ), buffer_arg(output, RETRYIX_ACCESS_WRITE),
+        value_arg(&n, sizeof(n)), buffer_arg(sums, RETRYIX_ACCESS_WRITE),
+        value_arg(&inclusive, sizeof(inclusive)), local_arg(local * elem)
+    };
+    int rc = launch(ctx, type, "retryix_prim_scan_block", global, block_args, 6);
+
+    if (rc == 0 && groups > 1) {
+        rc = scan_level(ctx, type, sums, sums, groups, 0);
+        if (rc == 0) {
+            retryix_kernel_arg_t add_args[3] = {
+                buffer_arg(output, RETRYIX_ACCESS_READ_WRITE), value_arg(&n, sizeof(n)),
+                buffer_arg(sums, RETRYIX_ACCESS_READ)
+            };
+            rc = launch(ctx, type, "retryix_prim_scan_add", global, add_args, 3);
+        }
+    }
+
+    release_scratch(ctx, sums);
+    return rc;
+}
+
+int retryix_prim_scan(retryix_prim_type_t type, const void* input, void* output, size_t count, int inclusive) {
+    retryix_primitives_context_t* ctx = g_primitives_context;
+    if (!ctx && retryix_cpu_device_active()) return retryix_cpu_scan(type, input, output, count, inclusive);
+    if (!ctx || !input || !output || count == 0 || count > RETRYIX_PRIM_MAX_COUNT) return -1;
+    if (prepare_type(ctx, type) != 0) return -1;
+    return scan_level(ctx, type, input, output, (cl_uint)count, inclusive ? 1u : 0u);
+}
+
+// 串流壓縮：保留旗標 -> 排他掃描得到輸出位置 -> 分散寫出
+int retryix_prim_compact(retryix_prim_type_t type, const void* input, const void* flags, void* output,
+                         size_t count, size_t* out_count) {
+    retryix_primitives_context_t* ctx = g_primitives_context;
+    if (!ctx && retryix_cpu_device_active()) return retryix_prim_cpu_compact(type, input, flags, output, count, out_count);
+    if (!ctx || !input || !output || count == 0 || count > RETRYIX_PRIM_MAX_COUNT) return -1;
+    if (prepare_type(ctx, type) != 0 || prepare_type(ctx, RETRYIX_PRIM_INT) != 0) return -1;
+
+    void* keep = acquire_scratch(ctx, count * sizeof(cl_int));
+    void* positions = acquire_scratch(ctx, count * sizeof(cl_int));
+    void* kept = acquire_scratch(ctx, sizeof(cl_int));
+    int rc = (keep && positions && kept) ? 0 : -1;
+
+    cl_uint n = (cl_uint)count;
+    if (rc == 0) {
+        // 使用者旗標同樣正規化為 0/1，掃描結果才是正確的輸出位置
+        retryix_prim_type_t flag_type = flags ? RETRYIX_PRIM_INT : type;
+        retryix_kernel_arg_t args[3] = {
+            buffer_arg(flags ? flags : input, RETRYIX_ACCESS_READ), value_arg(&n, sizeof(n)),
+            buffer_arg(keep, RETRYIX_ACCESS_WRITE)
+        };
+        size_t global = round_up(count, ctx->types[flag_type].local_size);
+        rc = launch(ctx, flag_type, "retryix_prim_predicate", global, args, 3);
+    }
+    if (rc == 0) rc = scan_level(ctx, RETRYIX_PRIM_INT, keep, positions, n, 0);
+    if (rc == 0) {
+        retryix_kernel_arg_t args[6] = {
+            buffer_arg(input, RETRYIX_ACCESS_READ), buffer_arg(keep, RETRYIX_ACCESS_READ),
+            buffer_arg(positions, RETRYIX_ACCESS_READ), value_arg(&n, sizeof(n)),
+            buffer_arg(output, RETRYIX_ACCESS_WRITE), buffer_arg(kept, RETRYIX_ACCESS_WRITE)
+        };
+        rc = launch(ctx, type, "retryix_prim_scatter", round_up(count, ctx->types[type].local_size), args, 6);
+    }
+    if (rc == 0 && out_count) {
+        cl_int total = 0;
+        rc = read_scratch(ctx, kept, &total, sizeof(total));
+        *out_count = (size_t)total;
+    }
+
+    if (kept) release_scratch(ctx, kept);
+    if (positions) release_scratch(ctx, positions);
+    if (keep) release_scratch(ctx, keep);
+    return rc;
+}
+
+// === 多執行緒 CPU 基準 ===
+
+typedef enum {
+    PRIM_CPU_REDUCE = 0,
+    PRIM_CPU_SCAN,
+    PRIM_CPU_COMPACT
+} retryix_prim_cpu_kind_t;
+
+typedef struct {
+    retryix_prim_cpu_kind_t kind;
+    retryix_prim_type_t type;
+    retryix_prim_op_t op;
+    const void* input;
+    const cl_int* flags;
+    void* output;
+    int inclusive;
+} retryix_prim_cpu_job_t;
+
+// 每個執行緒處理一段連續區間；兩階段演算法先求區間總和/保留數，再以前綴偏移寫出
+typedef struct {
+    const retryix_prim_cpu_job_t* job;
+    size_t begin;
+    size_t end;
+    int phase;
+    retryix_prim_value_t partial;
+    retryix_prim_value_t offset;
+    size_t kept;
+    size_t out_offset;
+} retryix_prim_cpu_task_t;
+
+static retryix_prim_value_t value_combine(retryix_prim_type_t type, retryix_prim_op_t op,
+                                          retryix_prim_value_t a, retryix_prim_value_t b) {
+    retryix_prim_value_t r;
+    switch (type) {
+        case RETRYIX_PRIM_INT:
+            r.i = (op == RETRYIX_PRIM_OP_MIN) ? (a.i < b.i ? a.i : b.i)
+                : (op == RETRYIX_PRIM_OP_MAX) ? (a.i > b.i ? a.i : b.i)
+                : (cl_int)((uint32_t)a.i + (uint32_t)b.i);
+            break;
+        case RETRYIX_PRIM_FLOAT:
+            r.f = (op == RETRYIX_PRIM_OP_MIN) ? fminf(a.f, b.f) : (op == RETRYIX_PRIM_OP_MAX) ? fmaxf(a.f, b.f) : a.f + b.f;
+            break;
+        default:
+            r.d = (op == RETRYIX_PRIM_OP_MIN) ? fmin(a.d, b.d) : (op == RETRYIX_PRIM_OP_MAX) ? fmax(a.d, b.d) : a.d + b.d;
+            break;
+    }
+    return r;
+}
+
+static retryix_prim_value_t value_identity(retryix_prim_type_t type, retryix_prim_op_t op) {
+    retryix_prim_value_t r;
+    switch (type) {
+        case RETRYIX_PRIM_INT:
+            r.i = (op == RETRYIX_PRIM_OP_MIN) ? INT32_MAX : (op == RETRYIX_PRIM_OP_MAX) ? INT32_MIN : 0;
+            break;
+        case RETRYIX_PRIM_FLOAT:
+            r.f = (op == RETRYIX_PRIM_OP_MIN) ? INFINITY : (op == RETRYIX_PRIM_OP_MAX) ? -INFINITY : 0.0f;
+            break;
+        default:
+            r.d = (op == RETRYIX_PRIM_OP_MIN) ? INFINITY : (op == RETRYIX_PRIM_OP_MAX) ? -INFINITY : 0.0;
+            break;
+    }
+    return r;
+}
+
+static retryix_prim_value_t value_load(retryix_prim_type_t type, const void* base, size_t index) {
+    retryix_prim_value_t r;
+    switch (type) {
+        case RETRYIX_PRIM_INT: r.i = ((const cl_int*)base)[index]; break;
+        case RETRYIX_PRIM_FLOAT: r.f = ((const cl_float*)base)[index]; break;
+        default: r.d = ((const cl_double*)base)[index]; break;
+    }
+    return r;
+}
+
+static bool value_nonzero(retryix_prim_type_t type, const void* base, size_t index) {
+    switch (type) {
+        case RETRYIX_PRIM_INT: return ((const cl_int*)base)[index] != 0;
+        case RETRYIX_PRIM_FLOAT: return ((const cl_float*)base)[index] != 0.0f;
+        default: return ((const cl_double*)base)[index] != 0.0;
+    }
+}
+
+// 區間歸約（內層迴圈依型別展開，避免逐元素分派）
+static retryix_prim_value_t cpu_reduce_range(const retryix_prim_cpu_job_t* job, size_t begin, size_t end) {
+    retryix_prim_value_t acc = value_identity(job->type, job->op);
+    if (job->op != RETRYIX_PRIM_OP_SUM) {
+        for (size_t i = begin; i < end; i++) acc = value_combine(job->type, job->op, acc, value_load(job->type, job->input, i));
+        return acc;
+    }
+    switch (job->type) {
+        case RETRYIX_PRIM_INT: {
+            const cl_int* in = (const cl_int*)job->input;
+            uint32_t sum = 0;
+            for (size_t i = begin; i < end; i++) sum += (uint32_t)in[i];
+            acc.i = (cl_int)sum;
+            break;
+        }
+        case RETRYIX_PRIM_FLOAT: {
+            const cl_float* in = (const cl_float*)job->input;
+            for (size_t i = begin; i < end; i++) acc.f += in[i];
+            break;
+        }
+        default: {
+            const cl_double* in = (const cl_double*)job->input;
+            for (size_t i = begin; i < end; i++) acc.d += in[i];
+            break;
+        }
+    }
+    return acc;
+}
+
+// 區間掃描（offset 為前面各區間的總和）
+static void cpu_scan_range(const retryix_prim_cpu_job_t* job, size_t begin, size_t end, retryix_prim_value_t offset) {
+    switch (job->type) {
+        case RETRYIX_PRIM_INT: {
+            const cl_int* in = (const cl_int*)job->input;
+            cl_int* out = (cl_int*)job->output;
+            uint32_t running = (uint32_t)offset.i;
+            for (size_t i = begin; i < end; i++) {
+                uint32_t v = (uint32_t)in[i];
+                if (job->inclusive) running += v;
+                out[i] = (cl_int)running;
+                if (!job->inclusive) running += v;
+            }
+            break;
+        }
+        case RETRYIX_PRIM_FLOAT: {
+            const cl_float* in = (const cl_float*)job->input;
+            cl_float* out = (cl_float*)job->output;
+            cl_float running = offset.f;
+            for (size_t i = begin; i < end; i++) {
+                cl_float v = in[i];
+                if (job->inclusive) running += v;
+                out[i] = running;
+                if (!job->inclusive) running += v;
+            }
+            break;
+        }
+        default: {
+            const cl_double* in = (const cl_double*)job->input;
+            cl_double* out = (cl_double*)job->output;
+            cl_double running = offset.d;
+            for (size_t i = begin; i < end; i++) {
+                cl_double v = in[i];
+                if (job->inclusive) running += v;
+                out[i] = running;
+                if (!job->inclusive) running += v;
+            }
+            break;
+        }
+    }
+}
+
+static bool cpu_keep(const retryix_prim_cpu_job_t* job, size_t index) {
+    return job->flags ? job->flags[index] != 0 : value_nonzero(job->type, job->input, index);
+}
+
+static void cpu_task_main(retryix_prim_cpu_task_t* task) {
+    const retryix_prim_cpu_job_t* job = task->job;
+    size_t elem = PRIM_ELEMENT_SIZES[job->type];
+
+    switch (job->kind) {
+        case PRIM_CPU_REDUCE:
+            task->partial = cpu_reduce_range(job, task->begin, task->end);
+            break;
+        case PRIM_CPU_SCAN:
+            if (task->phase == 0) {
+                retryix_prim_cpu_job_t sum_job = *job;
+                sum_job.op = RETRYIX_PRIM_OP_SUM;
+                task->partial = cpu_reduce_range(&sum_job, task->begin, task->end);
+            } else {
+                cpu_scan_range(job, task->begin, task->end, task->offset);
+            }
+            break;
+        case PRIM_CPU_COMPACT:
+            if (task->phase == 0) {
+                task->kept = 0;
+                for (size_t i = task->begin; i < task->end; i++) {
+                    if (cpu_keep(job, i)) task->kept++;
+                }
+            } else {
+                char* out = (char*)job->output + task->out_offset * elem;
+                const char* in = (const char*)job->input;
+                for (size_t i = task->begin; i < task->end; i++) {
+                    if (cpu_keep(job, i)) {
+                        memcpy(out, in + i * elem, elem);
+                        out += elem;
+                    }
+                }
+            }
+            break;
+    }
+}
+
+static void cpu_phase_range(void* arg, size_t begin, size_t end) {
+    retryix_prim_cpu_task_t* tasks = (retryix_prim_cpu_task_t*)arg;
+    for (size_t t = begin; t < end; t++) cpu_task_main(&tasks[t]);
+}
+
+// 執行一個階段：各段交由共用執行緒池分派，呼叫端亦參與執行
+static void cpu_run_phase(retryix_prim_cpu_task_t* tasks, int task_count, int phase) {
+    for (int t = 0; t < task_count; t++) tasks[t].phase = phase;
+    retryix_pool_parallel_for((size_t)task_count, 1, cpu_phase_range, tasks);
+}
+
+// 依執行緒數切分區間；資料量小時減少分段避免分派開銷超過計算
+static int cpu_split(retryix_prim_cpu_task_t* tasks, const retryix_prim_cpu_job_t* job, size_t count) {
+    int threads = g_primitives_context ? (int)g_primitives_context->cpu_threads : retryix_pool_size() + 1;
+    if (threads > RETRYIX_PRIM_MAX_CPU_THREADS) threads = RETRYIX_PRIM_MAX_CPU_THREADS;
+    size_t max_by_size = count / 16384 + 1;
+    if ((size_t)threads > max_by_size) threads = (int)max_by_size;
+    if (threads < 1) threads = 1;
+
+    size_t chunk = (count + threads - 1) / threads;
+    for (int t = 0; t < threads; t++) {
+        memset(&tasks[t], 0, sizeof(tasks[t]));
+        tasks[t].job = job;
+        tasks[t].begin = (size_t)t * chunk < count ? (size_t)t * chunk : count;
+        tasks[t].end = tasks[t].begin + chunk < count ? tasks[t].begin + chunk : count;
+    }
+    return threads;
+}
+
+int retryix_prim_cpu_reduce(retryix_prim_type_t type, retryix_prim_op_t op, const void* input, size_t count, void* out_value) {
+    if (!input || !out_value || count == 0 || type < 0 || type >= RETRYIX_PRIM_TYPE_COUNT) return -1;
+    if (op < 0 || op >= RETRYIX_PRIM_OP_COUNT) return -1;
+
+    retryix_prim_cpu_job_t job = { PRIM_CPU_REDUCE, type, op, input, NULL, NULL, 0 };
+    retryix_prim_cpu_task_t tasks[RETRYIX_PRIM_MAX_CPU_THREADS];
+    int task_count = cpu_split(tasks, &job, count);
+    cpu_run_phase(tasks, task_count, 0);
+
+    retryix_prim_value_t acc = value_identity(type, op);
+    for (int t = 0; t < task_count; t++) acc = value_combine(type, op, acc, tasks[t].partial);
+    memcpy(out_value, &acc, PRIM_ELEMENT_SIZES[type]);
+    return 0;
+}
+
+int retryix_prim_cpu_scan(retryix_prim_type_t type, const void* input, void* output, size_t count, int inclusive) {
+    if (!input || !output || count == 0 || type < 0 || type >= RETRYIX_PRIM_TYPE_COUNT) return -1;
+
+    retryix_prim_cpu_job_t job = { PRIM_CPU_SCAN, type, RETRYIX_PRIM_OP_SUM, input, NULL, output, inclusive };
+    retryix_prim_cpu_task_t tasks[RETRYIX_PRIM_MAX_CPU_THREADS];
+    int task_count = cpu_split(tasks, &job, count);
+    cpu_run_phase(tasks, task_count, 0);
+
+    retryix_prim_value_t running = value_identity(type, RETRYIX_PRIM_OP_SUM);
+    for (int t = 0; t < task_count; t++) {
+        tasks[t].offset = running;
+        running = value_combine(type, RETRYIX_PRIM_OP_SUM, running, tasks[t].partial);
+    }
+    cpu_run_phase(tasks, task_count, 1);
+    return 0;
+}
+
+int retryix_prim_cpu_compact(retryix_prim_type_t type, const void* input, const void* flags, void* output,
+                             size_t count, size_t* out_count) {
+    if (!input || !output || count == 0 || type < 0 || type >= RETRYIX_PRIM_TYPE_COUNT) return -1;
+
+    retryix_prim_cpu_job_t job = { PRIM_CPU_COMPACT, type, RETRYIX_PRIM_OP_SUM, input, (const cl_int*)flags, output, 0 };
+    retryix_prim_cpu_task_t tasks[RETRYIX_PRIM_MAX_CPU_THREADS];
+    int task_count = cpu_split(tasks, &job, count);
+    cpu_run_phase(tasks, task_count, 0);
+
+    size_t total = 0;
+    for (int t = 0; t < task_count; t++) {
+        tasks[t].out_offset = total;
+        total += tasks[t].kept;
+    }
+    cpu_run_phase(tasks, task_count, 1);
+    if (out_count) *out_count = total;
+    return 0;
+}
+
+// === 量測 ===
+
+// 比對結果（浮點依相對誤差）
+static bool values_match(retryix_prim_type_t type, const void* a, const void* b, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        retryix_prim_value_t x = value_load(type, a, i);
+        retryix_prim_value_t y = value_load(type, b, i);
+        switch (type) {
+            case RETRYIX_PRIM_INT:
+                if (x.i != y.i) return false;
+                break;
+            case RETRYIX_PRIM_FLOAT:
+                if (fabsf(x.f - y.f) > 1e-4f * fmaxf(1.0f, fabsf(y.f))) return false;
+                break;
+            default:
+                if (fabs(x.d - y.d) > 1e-9 * fmax(1.0, fabs(y.d))) return false;
+                break;
+        }
+    }
+    return true;
+}
+
+static void print_bench_row(const char* label, size_t bytes, double gpu_ms, double cpu_ms, bool correct) {
+    printf("  %-16s GPU %9.3f ms (%7.2f GB/s)  CPU %9.3f ms (%7.2f GB/s)  %6.2fx  %s\n", label,
+           gpu_ms, gpu_ms > 0.0 ? (double)bytes / (gpu_ms * 1e6) : 0.0,
+           cpu_ms, cpu_ms > 0.0 ? (double)bytes / (cpu_ms * 1e6) : 0.0,
+           gpu_ms > 0.0 ? cpu_ms / gpu_ms : 0.0, correct ? "PASS" : "FAIL");
+}
+
+// 以設備常駐的 retryix_memory 緩衝區比較原語與多執行緒 CPU 基準（含完成等待的牆鐘時間，取最佳值）
+int retryix_primitives_benchmark(retryix_prim_type_t type, size_t count, int iterations) {
+    retryix_primitives_context_t* ctx = g_primitives_context;
+    if (!ctx || count == 0 || count > RETRYIX_PRIM_MAX_COUNT) return -1;
+    if (iterations <= 0) iterations = 5;
+    if (prepare_type(ctx, type) != 0) return -1;
+
+    size_t elem = PRIM_ELEMENT_SIZES[type];
+    size_t bytes = count * elem;
+    void* input = retryix_memory_alloc(bytes, RETRYIX_MEM_READ_WRITE, "prim_bench_in");
+    void* output = retryix_memory_alloc(bytes, RETRYIX_MEM_READ_WRITE, "prim_bench_out");
+    void* expected = malloc(bytes);
+    if (!input || !output || !expected) {
+        if (output) retryix_memory_free(output);
+        if (input) retryix_memory_free(input);
+        free(expected);
+        return -1;
+    }
+
+    // 小整數值（約 1/4 為零供壓縮使用），浮點加總在容差內可重現
+    for (size_t i = 0; i < count; i++) {
+        int v = (int)((((uint32_t)i * 2654435761u) >> 16) & 3u);
+        switch (type) {
+            case RETRYIX_PRIM_INT: ((cl_int*)input)[i] = v; break;
+            case RETRYIX_PRIM_FLOAT: ((cl_float*)input)[i] = (cl_float)v; break;
+            default: ((cl_double*)input)[i] = (cl_double)v; break;
+        }
+    }
+    retryix_memory_copy_to_device(input, ctx->queue, true);
+
+    printf("\n=== RetryIX Primitives Benchmark (%s, %zu elements, %lu CPU threads) ===\n",
+           PRIM_TYPE_LABELS[type], count, ctx->cpu_threads);
+
+    int failures = 0;
+    for (int which = 0; which < 3; which++) {
+        double gpu_best = -1.0, cpu_best = -1.0;
+        bool correct = true;
+        size_t gpu_count = 0, cpu_count = 0;
+        retryix_prim_value_t gpu_value, cpu_value;
+        memset(&gpu_value, 0, sizeof(gpu_value));
+        memset(&cpu_value, 0, sizeof(cpu_value));
+
+        for (int it = 0; it <= iterations; it++) {
+            double t0 = rixNowMs();
+            int rc = -1;
+            switch (which) {
+                case 0: rc = retryix_prim_reduce(type, RETRYIX_PRIM_OP_SUM, input, count, &gpu_value); break;
+                case 1:
+                    rc = retryix_prim_scan(type, input, output, count, 0);
+                    if (rc == 0) rc = retryix_memory_sync(output);
+                    break;
+                default: rc = retryix_prim_compact(type, input, NULL, output, count, &gpu_count); break;
+            }
+            double gpu_ms = rixNowMs() - t0;
+            if (rc != 0) {
+                correct = false;
+                break;
+            }
+
+            t0 = rixNowMs();
+            switch (which) {
+                case 0: retryix_prim_cpu_reduce(type, RETRYIX_PRIM_OP_SUM, input, count, &cpu_value); break;
+                case 1: retryix_prim_cpu_scan(type, input, expected, count, 0); break;
+                default: retryix_prim_cpu_compact(type, input, NULL, expected, count, &cpu_count); break;
+            }
+            double cpu_ms = rixNowMs() - t0;
+
+            if (it == 0) continue; // 第一次為預熱（含編譯與暫存配置）
+            if (gpu_best < 0.0 || gpu_ms < gpu_best) gpu_best = gpu_ms;
+            if (cpu_best < 0.0 || cpu_ms < cpu_best) cpu_best = cpu_ms;
+        }
+
+        if (correct) {
+            switch (which) {
+                case 0: correct = values_match(type, &gpu_value, &cpu_value, 1); break;
+                case 1:
+                    retryix_memory_copy_from_device(output, ctx->queue, true);
+                    correct = values_match(type, output, expected, count);
+                    break;
+                default:
+                    retryix_memory_copy_from_device(output, ctx->queue, true);
+                    correct = (gpu_count == cpu_count) && values_match(type, output, expected, cpu_count);
+                    break;
+            }
+        }
+        if (!correct) failures++;
+
+        static const char* labels[3] = { "reduce (sum)", "exclusive scan", "compact" };
+        // 有效流量：reduce 讀一次，scan 讀寫各一次，compact 讀一次並寫出保留元素
+        size_t traffic = (which == 0) ? bytes : (which == 1) ? bytes * 2 : bytes + cpu_count * elem;
+        print_bench_row(labels[which], traffic, gpu_best, cpu_best, correct);
+    }
+    printf("=====================================================================\n\n");
+
+    free(expected);
+    retryix_memory_free(output);
+    retryix_memory_free(input);
+    return failures ? -1 : 0;
+}
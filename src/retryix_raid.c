@@ -0,0 +1,428 @@
+// retryix_raid.c - RetryIX Memory RAID：單一邏輯緩衝區以固定條帶大小輪流分散至多個設備（RAID-0）
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define RETRYIX_RAID_MAX_ARGS     32
+
+// 條帶 k 位於成員 k % width，成員內偏移 (k / width) * stripe_bytes
+struct retryix_raid_buffer {
+    size_t size;                            // 邏輯位元組數
+    size_t element_size;
+    size_t stripe_bytes;
+    size_t stripe_count;
+    int width;
+    int devices[RETRYIX_RAID_MAX_MEMBERS];  // 多設備管理器中的索引
+    cl_context contexts[RETRYIX_RAID_MAX_MEMBERS];
+    cl_command_queue queues[RETRYIX_RAID_MAX_MEMBERS];
+    cl_mem mems[RETRYIX_RAID_MAX_MEMBERS];  // 每個成員的底層緩衝區
+    cl_mem* stripes;                        // 每個條帶的子緩衝區（內核分派用）
+};
+
+// 每個成員一個池任務
+typedef struct {
+    retryix_raid_buffer_t* buffer;
+    int member;
+    size_t offset;
+    size_t size;
+    char* host;
+    bool write;
+    cl_int err;
+} retryix_raid_io_t;
+
+typedef struct {
+    int member;
+    cl_kernel kernel;                       // 此成員專用的內核物件，不與其他成員或呼叫端共用參數狀態
+    const char* template_name;
+    retryix_raid_buffer_t* layout;          // 第一個緩衝區參數，決定條帶切分
+    const retryix_raid_arg_t* args;
+    cl_uint num_args;
+    cl_int err;
+} retryix_raid_launch_t;
+
+static size_t gcd_size(size_t a, size_t b) {
+    while (b) {
+        size_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+static size_t stripe_length(const retryix_raid_buffer_t* buf, size_t k) {
+    size_t begin = k * buf->stripe_bytes;
+    return buf->size - begin < buf->stripe_bytes ? buf->size - begin : buf->stripe_bytes;
+}
+
+static size_t member_offset(const retryix_raid_buffer_t* buf, size_t k) {
+    return (k / (size_t)buf->width) * buf->stripe_bytes;
+}
+
+// 各成員並行處理：每個成員只排入自己的條帶，最後一次 clFinish
+static void io_task(void* arg) {
+    retryix_raid_io_t* io = (retryix_raid_io_t*)arg;
+    retryix_raid_buffer_t* buf = io->buffer;
+    size_t width = (size_t)buf->width;
+    size_t first = io->offset / buf->stripe_bytes;
+    size_t last = (io->offset + io->size - 1) / buf->stripe_bytes;
+    size_t k = first + ((size_t)io->member + width - first % width) % width;
+    cl_command_queue queue = buf->queues[io->member];
+    cl_mem mem = buf->mems[io->member];
+
+    io->err = CL_SUCCESS;
+    for (; k <= last && io->err == CL_SUCCESS; k += width) {
+        size_t stripe_begin = k * buf->stripe_bytes;
+        size_t lo = io->offset > stripe_begin ? io->offset : stripe_begin;
+        size_t stripe_end = stripe_begin + stripe_length(buf, k);
+        size_t hi = io->offset + io->size < stripe_end ? io->offset + io->size : stripe_end;
+        size_t device_offset = member_offset(buf, k) + (lo - stripe_begin);
+        char* host = io->host + (lo - io->offset);
+        if (io->write) {
+            io->err = clEnqueueWriteBuffer(queue, mem, CL_FALSE, device_offset, hi - lo, host, 0, NULL, NULL);
+        } else {
+            io->err = clEnqueueReadBuffer(queue, mem, CL_FALSE, device_offset, hi - lo, host, 0, NULL, NULL);
+        }
+    }
+    cl_int finish = clFinish(queue);
+    if (io->err == CL_SUCCESS) io->err = finish;
+}
+
+static int transfer(retryix_raid_buffer_t* buf, size_t offset, void* host, size_t size, bool write) {
+    if (!buf || !host || size == 0 || offset > buf->size || size > buf->size - offset) return -1;
+
+    retryix_raid_io_t ios[RETRYIX_RAID_MAX_MEMBERS];
+    retryix_pool_group_t group;
+    retryix_pool_group_init(&group);
+    for (int m = 0; m < buf->width; m++) {
+        ios[m].buffer = buf;
+        ios[m].member = m;
+        ios[m].offset = offset;
+        ios[m].size = size;
+        ios[m].host = (char*)host;
+        ios[m].write = write;
+        retryix_pool_spawn(&group, io_task, &ios[m]);
+    }
+    retryix_pool_wait(&group);
+
+    int rc = 0;
+    for (int m = 0; m < buf->width; m++) {
+        if (ios[m].err != CL_SUCCESS) {
+            printf("RetryIX Memory RAID: %s on member %d failed (%s)\n", write ? "write" : "read", m,
+                   rixCLErrorName(ios[m].err));
+            rc = -1;
+        }
+    }
+    return rc;
+}
+
+// 逐條帶設定參數並排入：緩衝區參數換成該條帶的子緩衝區，global size 為條帶元素數
+static void launch_task(void* arg) {
+    retryix_raid_launch_t* job = (retryix_raid_launch_t*)arg;
+    retryix_raid_buffer_t* layout = job->layout;
+    size_t width = (size_t)layout->width;
+    cl_command_queue queue = layout->queues[job->member];
+
+    job->err = CL_SUCCESS;
+    for (size_t k = (size_t)job->member; k < layout->stripe_count && job->err == CL_SUCCESS; k += width) {
+        size_t elements = stripe_length(layout, k) / layout->element_size;
+        cl_ulong base = (cl_ulong)(k * (layout->stripe_bytes / layout->element_size));
+        for (cl_uint a = 0; a < job->num_args && job->err == CL_SUCCESS; a++) {
+            const retryix_raid_arg_t* ra = &job->args[a];
+            switch (ra->kind) {
+            case RETRYIX_RAID_ARG_BUFFER:
+                job->err = clSetKernelArg(job->kernel, a, sizeof(cl_mem), &ra->buffer->stripes[k]);
+                break;
+            case RETRYIX_RAID_ARG_SCALAR:
+                job->err = clSetKernelArg(job->kernel, a, ra->size, ra->value);
+                break;
+            case RETRYIX_RAID_ARG_LOCAL:
+                job->err = clSetKernelArg(job->kernel, a, ra->size, NULL);
+                break;
+            case RETRYIX_RAID_ARG_STRIPE_BASE:
+                job->err = clSetKernelArg(job->kernel, a, sizeof(cl_ulong), &base);
+                break;
+            default:
+                job->err = CL_INVALID_ARG_VALUE;
+                break;
+            }
+        }
+        if (job->err == CL_SUCCESS && elements > 0) {
+            job->err = clEnqueueNDRangeKernel(queue, job->kernel, 1, NULL, &elements, NULL, 0, NULL, NULL);
+        }
+    }
+    cl_int finish = clFinish(queue);
+    if (job->err == CL_SUCCESS) job->err = finish;
+}
+
+static void release_buffer(retryix_raid_buffer_t* buf) {
+    if (buf->stripes) {
+        for (size_t k = 0; k < buf->stripe_count; k++) {
+            if (buf->stripes[k]) clReleaseMemObject(buf->stripes[k]);
+        }
+        free(buf->stripes);
+    }
+    for (int m = 0; m < buf->width; m++) {
+        if (buf->mems[m]) clReleaseMemObject(buf->mems[m]);
+    }
+    free(buf);
+}
+
+// === 公開 API ===
+
+retryix_raid_buffer_t* retryix_raid_alloc(size_t size, size_t element_size, const int* devices, int width,
+                                          size_t stripe_bytes) {
+    int available = retryix_multi_device_count();
+    if (size == 0 || element_size == 0 || available == 0) return NULL;
+    if (width <= 0) width = devices ? 0 : available;
+    if (width <= 0 || width > RETRYIX_RAID_MAX_MEMBERS || (!devices && width > available)) return NULL;
+
+    retryix_raid_buffer_t* buf = (retryix_raid_buffer_t*)calloc(1, sizeof(retryix_raid_buffer_t));
+    if (!buf) return NULL;
+    buf->size = size;
+    buf->element_size = element_size;
+    buf->width = width;
+
+    // 條帶大小需同時為元素大小與各成員子緩衝區起點對齊的倍數
+    size_t align = retryix_config_get_dword("MemoryRAID", "MemoryAlignment", 256);
+    if (align == 0) align = 1;
+    for (int m = 0; m < width; m++) {
+        int index = devices ? devices[m] : m;
+        cl_device_id device = NULL;
+        for (int p = 0; p < m; p++) {
+            if (buf->devices[p] == index) index = -1; // 同一設備不可重複
+        }
+        if (index < 0 || retryix_multi_get_device(index, &device, &buf->contexts[m], &buf->queues[m]) != 0) {
+            free(buf);
+            return NULL;
+        }
+        buf->devices[m] = index;
+        cl_uint align_bits = 0;
+        clGetDeviceInfo(device, CL_DEVICE_MEM_BASE_ADDR_ALIGN, sizeof(align_bits), &align_bits, NULL);
+        if (align_bits / 8 > align) align = align_bits / 8;
+    }
+    if (stripe_bytes == 0) stripe_bytes = (size_t)retryix_config_get_dword("MemoryRAID", "StripeKB", 1024) * 1024;
+    size_t granule = align / gcd_size(align, element_size) * element_size;
+    buf->stripe_bytes = round_up(stripe_bytes ? stripe_bytes : granule, granule);
+    buf->stripe_count = (size + buf->stripe_bytes - 1) / buf->stripe_bytes;
+
+    buf->stripes = (cl_mem*)calloc(buf->stripe_count, sizeof(cl_mem));
+    if (!buf->stripes) {
+        release_buffer(buf);
+        return NULL;
+    }
+
+    cl_int err = CL_SUCCESS;
+    for (int m = 0; m < width && err == CL_SUCCESS; m++) {
+        size_t member_stripes = (buf->stripe_count - (size_t)m + (size_t)width - 1) / (size_t)width;
+        if (member_stripes == 0) continue;
+        buf->mems[m] = clCreateBuffer(buf->contexts[m], CL_MEM_READ_WRITE, member_stripes * buf->stripe_bytes, NULL, &err);
+    }
+    for (size_t k = 0; k < buf->stripe_count && err == CL_SUCCESS; k++) {
+        cl_buffer_region region = { member_offset(buf, k), stripe_length(buf, k) };
+        buf->stripes[k] = clCreateSubBuffer(buf->mems[k % (size_t)width], CL_MEM_READ_WRITE,
+                                            CL_BUFFER_CREATE_TYPE_REGION, &region, &err);
+    }
+    if (err != CL_SUCCESS) {
+        printf("RetryIX Memory RAID: allocation of %zu bytes over %d devices failed (%s)\n", size, width,
+               rixCLErrorName(err));
+        release_buffer(buf);
+        return NULL;
+    }
+    return buf;
+}
+
+void retryix_raid_free(retryix_raid_buffer_t* buffer) {
+    if (buffer) release_buffer(buffer);
+}
+
+int retryix_raid_write(retryix_raid_buffer_t* buffer, size_t offset, const void* src, size_t size) {
+    return transfer(buffer, offset, (void*)src, size, true);
+}
+
+int retryix_raid_read(retryix_raid_buffer_t* buffer, size_t offset, void* dst, size_t size) {
+    return transfer(buffer, offset, dst, size, false);
+}
+
+int retryix_raid_get_info(const retryix_raid_buffer_t* buffer, retryix_raid_info_t* out) {
+    if (!buffer || !out) return -1;
+    memset(out, 0, sizeof(*out));
+    out->size = buffer->size;
+    out->element_size = buffer->element_size;
+    out->stripe_bytes = buffer->stripe_bytes;
+    out->stripe_count = buffer->stripe_count;
+    out->width = buffer->width;
+    memcpy(out->devices, buffer->devices, sizeof(int) * (size_t)buffer->width);
+    return 0;
+}
+
+int retryix_raid_launch(const char* template_name, const retryix_raid_arg_t* args, cl_uint num_args) {
+    if (!template_name || !args || num_args == 0 || num_args > RETRYIX_RAID_MAX_ARGS) return -1;
+
+    // 所有緩衝區參數需有相同的成員與條帶元素數，才能以同一切分分派
+    retryix_raid_buffer_t* layout = NULL;
+    for (cl_uint a = 0; a < num_args; a++) {
+        const retryix_raid_arg_t* ra = &args[a];
+        if (ra->kind == RETRYIX_RAID_ARG_SCALAR && (!ra->value || ra->size == 0)) return -1;
+        if (ra->kind != RETRYIX_RAID_ARG_BUFFER) continue;
+        if (!ra->buffer) return -1;
+        if (!layout) {
+            layout = ra->buffer;
+            continue;
+        }
+        if (ra->buffer->width != layout->width ||
+            memcmp(ra->buffer->devices, layout->devices, sizeof(int) * (size_t)layout->width) != 0 ||
+            ra->buffer->stripe_bytes / ra->buffer->element_size != layout->stripe_bytes / layout->element_size ||
+            ra->buffer->size / ra->buffer->element_size < layout->size / layout->element_size) {
+            printf("RetryIX Memory RAID: %s arguments have mismatched stripe layouts\n", template_name);
+            return -1;
+        }
+    }
+    if (!layout) return -1;
+
+    // 各成員任務在不同執行緒逐條帶設定參數，共用的模板內核會互相覆寫，因此每個成員另建內核物件
+    retryix_raid_launch_t jobs[RETRYIX_RAID_MAX_MEMBERS];
+    for (int m = 0; m < layout->width; m++) {
+        jobs[m].kernel = retryix_multi_create_kernel(template_name, layout->devices[m]);
+        if (!jobs[m].kernel) {
+            while (m-- > 0) clReleaseKernel(jobs[m].kernel);
+            return -1;
+        }
+    }
+
+    retryix_pool_group_t group;
+    retryix_pool_group_init(&group);
+    for (int m = 0; m < layout->width; m++) {
+        jobs[m].member = m;
+        jobs[m].template_name = template_name;
+        jobs[m].layout = layout;
+        jobs[m].args = args;
+        jobs[m].num_args = num_args;
+        retryix_pool_spawn(&group, launch_task, &jobs[m]);
+    }
+    retryix_pool_wait(&group);
+
+    int rc = 0;
+    for (int m = 0; m < layout->width; m++) {
+        if (jobs[m].err != CL_SUCCESS) {
+            printf("RetryIX Memory RAID: %s on member %d failed (%s)\n", template_name, m, rixCLErrorName(jobs[m].err));
+            rc = -1;
+        }
+        clReleaseKernel(jobs[m].kernel);
+    }
+    return rc;
+}
+
+// === 量測 ===
+
+static const char* RAID_BENCH_SOURCE =
+"__kernel void retryix_raid_scale(__global float* data, float alpha, ulong base) {\n"
+"    size_t i = get_global_id(0);\n"
+"    data[i] = data[i] * alpha + (float)((base + i) % 7);\n"
+"}\n";
+
+static double best_transfer_ms(retryix_raid_buffer_t* buf, void* host, size_t bytes, bool write, int iterations) {
+    double best = -1.0;
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        int rc = write ? retryix_raid_write(buf, 0, host, bytes) : retryix_raid_read(buf, 0, host, bytes);
+        double ms = rixNowMs() - t0;
+        if (rc != 0) return -1.0;
+        if (best < 0.0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+// 依條帶寬度 1..N 量測主機聚合頻寬，再以全寬度驗證逐條帶內核分派
+int retryix_raid_benchmark(size_t bytes, int iterations) {
+    if (retryix_multi_device_count() == 0 && retryix_multi_init(0) != 0) return -1;
+    int devices = retryix_multi_device_count();
+    if (devices > RETRYIX_RAID_MAX_MEMBERS) devices = RETRYIX_RAID_MAX_MEMBERS;
+    if (bytes == 0) bytes = (size_t)256 << 20;
+    if (iterations <= 0) iterations = 3;
+    bytes = bytes / sizeof(float) * sizeof(float);
+
+    float* host = (float*)malloc(bytes);
+    float* check = (float*)malloc(bytes);
+    if (!host || !check) {
+        free(host);
+        free(check);
+        return -1;
+    }
+    size_t count = bytes / sizeof(float);
+    for (size_t i = 0; i < count; i++) host[i] = (float)(i % 1000);
+
+    printf("\n=== RetryIX Memory RAID Benchmark (%.1f MB, %d devices, best of %d) ===\n",
+           (double)bytes / (1024.0 * 1024.0), devices, iterations);
+    printf("  width  stripe KB   write GB/s   read GB/s   write x   read x\n");
+
+    int failures = 0;
+    double base_write = 0.0, base_read = 0.0;
+    for (int width = 1; width <= devices; width++) {
+        retryix_raid_buffer_t* buf = retryix_raid_alloc(bytes, sizeof(float), NULL, width, 0);
+        if (!buf) {
+            printf("  %5d  allocation failed  FAIL\n", width);
+            failures++;
+            continue;
+        }
+        double write_ms = best_transfer_ms(buf, host, bytes, true, iterations);
+        double read_ms = best_transfer_ms(buf, check, bytes, false, iterations);
+        bool ok = write_ms > 0.0 && read_ms > 0.0 && memcmp(host, check, bytes) == 0;
+        double write_gbs = ok ? (double)bytes / (write_ms * 1e6) : 0.0;
+        double read_gbs = ok ? (double)bytes / (read_ms * 1e6) : 0.0;
+        if (width == 1) {
+            base_write = write_gbs;
+            base_read = read_gbs;
+        }
+        printf("  %5d  %9zu  %11.2f  %10.2f  %7.2fx  %6.2fx  %s\n", width, buf->stripe_bytes / 1024, write_gbs, read_gbs,
+               base_write > 0.0 ? write_gbs / base_write : 0.0, base_read > 0.0 ? read_gbs / base_read : 0.0,
+               ok ? "PASS" : "FAIL");
+        if (!ok) failures++;
+        retryix_raid_free(buf);
+    }
+
+    // 逐條帶分派：內核以條帶起點還原邏輯索引
+    retryix_raid_buffer_t* buf = retryix_raid_alloc(bytes, sizeof(float), NULL, devices, 0);
+    bool dispatch_ok = false;
+    if (buf && retryix_multi_register_template("retryix_raid_scale", "retryix_raid_scale", RAID_BENCH_SOURCE) == 0 &&
+        retryix_raid_write(buf, 0, host, bytes) == 0) {
+        float alpha = 2.0f;
+        retryix_raid_arg_t args[3] = {
+            { RETRYIX_RAID_ARG_BUFFER, buf, NULL, 0 },
+            { RETRYIX_RAID_ARG_SCALAR, NULL, &alpha, sizeof(float) },
+            { RETRYIX_RAID_ARG_STRIPE_BASE, NULL, NULL, 0 },
+        };
+        double t0 = rixNowMs();
+        if (retryix_raid_launch("retryix_raid_scale", args, 3) == 0 && retryix_raid_read(buf, 0, check, bytes) == 0) {
+            double ms = rixNowMs() - t0;
+            dispatch_ok = true;
+            for (size_t i = 0; i < count && dispatch_ok; i++) {
+                dispatch_ok = (check[i] == host[i] * alpha + (float)(i % 7));
+            }
+            printf("  Striped dispatch (%zu stripes over %d devices): %.3f ms  %s\n", buf->stripe_count, devices, ms,
+                   dispatch_ok ? "PASS" : "FAIL");
+        }
+    }
+    if (!dispatch_ok) {
+        if (!buf) printf("  Striped dispatch: allocation failed  FAIL\n");
+        else if (!failures) printf("  Striped dispatch: launch failed  FAIL\n");
+        failures++;
+    }
+    retryix_raid_free(buf);
+    printf("=====================================================\n\n");
+
+    free(host);
+    free(check);
+    return failures ? -1 : 0;
+}
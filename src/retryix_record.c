@@ -0,0 +1,571 @@
+// retryix_record.c - RetryIX 命令序列錄製與重播
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 錄製時內核尚未借出，無法查詢 CL_KERNEL_NUM_ARGS；先以上限拒絕異常索引，finalize 再比對實際參數數
+#define RETRYIX_RECORD_MAX_ARGS 256
+
+// 命令類型
+typedef enum {
+    RETRYIX_RECORD_CMD_WRITE = 0,           // 主機 -> 設備
+    RETRYIX_RECORD_CMD_READ,                // 設備 -> 主機
+    RETRYIX_RECORD_CMD_KERNEL               // 內核啟動
+} retryix_record_cmd_type_t;
+
+// 參數綁定方式
+typedef enum {
+    RETRYIX_RECORD_ARG_UNSET = 0,
+    RETRYIX_RECORD_ARG_VALUE,               // 錄製時固定的值
+    RETRYIX_RECORD_ARG_LOCAL,               // __local 記憶體
+    RETRYIX_RECORD_ARG_BUFFER_SLOT,         // 綁定緩衝區槽
+    RETRYIX_RECORD_ARG_SCALAR_SLOT          // 綁定純量槽
+} retryix_record_arg_kind_t;
+
+typedef struct {
+    retryix_record_arg_kind_t kind;
+    size_t size;
+    void* value;                            // VALUE 的副本
+    int slot;
+} retryix_record_arg_t;
+
+typedef struct {
+    retryix_record_cmd_type_t type;
+
+    // 傳輸
+    int slot;
+    size_t offset;
+    size_t size;
+    void* host_ptr;
+
+    // 內核
+    char template_name[64];
+    char kernel_name[64];                   // 空字串表示模板預設內核
+    cl_kernel kernel;                       // 錄製結束時借出的專屬實例
+    size_t global_work_size;
+    size_t local_work_size;
+    retryix_record_arg_t* args;
+    cl_uint arg_count;
+    size_t arg_capacity;
+} retryix_record_cmd_t;
+
+// 槽位的使用處（第 cmd 個命令的第 arg 個參數）
+typedef struct {
+    int cmd;
+    cl_uint arg;
+} retryix_record_use_t;
+
+typedef struct {
+    cl_mem buffer;
+    bool dirty;
+    retryix_record_use_t* uses;
+    size_t use_count;
+    size_t use_capacity;
+} retryix_record_buffer_slot_t;
+
+typedef struct {
+    size_t size;
+    void* value;
+    bool dirty;
+    retryix_record_use_t* uses;
+    size_t use_count;
+    size_t use_capacity;
+} retryix_record_scalar_slot_t;
+
+struct retryix_recording {
+    cl_command_queue queue;
+
+    retryix_record_cmd_t* cmds;
+    size_t cmd_count;
+    size_t cmd_capacity;
+
+    retryix_record_buffer_slot_t* buffers;
+    size_t buffer_count;
+    size_t buffer_capacity;
+
+    retryix_record_scalar_slot_t* scalars;
+    size_t scalar_count;
+    size_t scalar_capacity;
+
+    bool finalized;
+
+    // 統計
+    uint64_t replay_count;
+    uint64_t rebind_count;                  // 重播時重新設定的參數數
+    double replay_host_ms;                  // 重播的主機端排程耗時
+};
+
+// === 內部函數 ===
+
+static int grow_array(void** array, size_t* capacity, size_t needed, size_t elem_size) {
+    if (needed <= *capacity) return 0;
+    size_t new_capacity = *capacity ? *capacity * 2 : 8;
+    while (new_capacity < needed) new_capacity *= 2;
+    void* grown = realloc(*array, new_capacity * elem_size);
+    if (!grown) return -1;
+    *array = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+static retryix_record_cmd_t* new_cmd(retryix_recording_t* rec, retryix_record_cmd_type_t type, int* out_index) {
+    if (rec->finalized) {
+        printf("Recording is finalized; commands can no longer be added\n");
+        return NULL;
+    }
+    if (grow_array((void**)&rec->cmds, &rec->cmd_capacity, rec->cmd_count + 1,
+                   sizeof(retryix_record_cmd_t)) != 0) {
+        return NULL;
+    }
+    int index = (int)rec->cmd_count++;
+    retryix_record_cmd_t* cmd = &rec->cmds[index];
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->type = type;
+    cmd->slot = -1;
+    if (out_index) *out_index = index;
+    return cmd;
+}
+
+static retryix_record_arg_t* kernel_arg(retryix_recording_t* rec, int cmd_index, cl_uint arg_index) {
+    if (!rec || rec->finalized || cmd_index < 0 || (size_t)cmd_index >= rec->cmd_count) return NULL;
+    retryix_record_cmd_t* cmd = &rec->cmds[cmd_index];
+    if (cmd->type != RETRYIX_RECORD_CMD_KERNEL) return NULL;
+    if (arg_index >= RETRYIX_RECORD_MAX_ARGS) {
+        printf("Recorded kernel %s: argument index %u exceeds %d\n", cmd->template_name, arg_index,
+               RETRYIX_RECORD_MAX_ARGS);
+        return NULL;
+    }
+
+    if (arg_index >= cmd->arg_count) {
+        if (grow_array((void**)&cmd->args, &cmd->arg_capacity, arg_index + 1,
+                       sizeof(retryix_record_arg_t)) != 0) {
+            return NULL;
+        }
+        memset(&cmd->args[cmd->arg_count], 0, (arg_index + 1 - cmd->arg_count) * sizeof(retryix_record_arg_t));
+        cmd->arg_count = arg_index + 1;
+    }
+
+    retryix_record_arg_t* arg = &cmd->args[arg_index];
+    free(arg->value);
+    memset(arg, 0, sizeof(*arg));
+    return arg;
+}
+
+static int add_use(retryix_record_use_t** uses, size_t* count, size_t* capacity, int cmd, cl_uint arg) {
+    if (grow_array((void**)uses, capacity, *count + 1, sizeof(retryix_record_use_t)) != 0) return -1;
+    (*uses)[*count].cmd = cmd;
+    (*uses)[(*count)++].arg = arg;
+    return 0;
+}
+
+// 設定單一錄製參數
+static cl_int apply_arg(retryix_recording_t* rec, cl_kernel kernel, cl_uint index, const retryix_record_arg_t* arg) {
+    switch (arg->kind) {
+        case RETRYIX_RECORD_ARG_VALUE:
+            return clSetKernelArg(kernel, index, arg->size, arg->value);
+        case RETRYIX_RECORD_ARG_LOCAL:
+            return clSetKernelArg(kernel, index, arg->size, NULL);
+        case RETRYIX_RECORD_ARG_BUFFER_SLOT:
+            return clSetKernelArg(kernel, index, sizeof(cl_mem), &rec->buffers[arg->slot].buffer);
+        case RETRYIX_RECORD_ARG_SCALAR_SLOT:
+            return clSetKernelArg(kernel, index, rec->scalars[arg->slot].size, rec->scalars[arg->slot].value);
+        default:
+            return CL_INVALID_ARG_VALUE;
+    }
+}
+
+// 排入單一傳輸命令
+static cl_int enqueue_transfer(retryix_recording_t* rec, const retryix_record_cmd_t* cmd, cl_event* out_event) {
+    cl_mem buffer = rec->buffers[cmd->slot].buffer;
+    if (cmd->type == RETRYIX_RECORD_CMD_WRITE) {
+        return clEnqueueWriteBuffer(rec->queue, buffer, CL_FALSE, cmd->offset, cmd->size,
+                                    cmd->host_ptr, 0, NULL, out_event);
+    }
+    return clEnqueueReadBuffer(rec->queue, buffer, CL_FALSE, cmd->offset, cmd->size,
+                               cmd->host_ptr, 0, NULL, out_event);
+}
+
+static cl_int enqueue_kernel(retryix_recording_t* rec, const retryix_record_cmd_t* cmd, cl_kernel kernel,
+                             cl_event* out_event) {
+    size_t global = cmd->global_work_size;
+    size_t local = cmd->local_work_size;
+    return clEnqueueNDRangeKernel(rec->queue, kernel, 1, NULL, &global, local ? &local : NULL,
+                                  0, NULL, out_event);
+}
+
+// === 公開 API ===
+
+// 建立錄製（命令依序排入 queue；內核來自 retryix_kernel_* 管理器，需共用同一上下文）
+retryix_recording_t* retryix_record_create(cl_command_queue queue) {
+    if (!queue) return NULL;
+
+    retryix_recording_t* rec = (retryix_recording_t*)calloc(1, sizeof(retryix_recording_t));
+    if (!rec) return NULL;
+
+    clRetainCommandQueue(queue);
+    rec->queue = queue;
+    return rec;
+}
+
+void retryix_record_destroy(retryix_recording_t* rec) {
+    if (!rec) return;
+
+    clFinish(rec->queue);
+
+    for (size_t i = 0; i < rec->cmd_count; i++) {
+        retryix_record_cmd_t* cmd = &rec->cmds[i];
+        if (cmd->kernel) retryix_kernel_release(cmd->template_name, cmd->kernel);
+        for (cl_uint a = 0; a < cmd->arg_count; a++) free(cmd->args[a].value);
+        free(cmd->args);
+    }
+    free(rec->cmds);
+
+    for (size_t i = 0; i < rec->buffer_count; i++) free(rec->buffers[i].uses);
+    free(rec->buffers);
+
+    for (size_t i = 0; i < rec->scalar_count; i++) {
+        free(rec->scalars[i].value);
+        free(rec->scalars[i].uses);
+    }
+    free(rec->scalars);
+
+    clReleaseCommandQueue(rec->queue);
+    free(rec);
+}
+
+// 新增緩衝區槽（錄製與重播時以槽編號引用，可於重播前重新綁定）
+int retryix_record_buffer_slot(retryix_recording_t* rec, cl_mem buffer) {
+    if (!rec || rec->finalized) return -1;
+    if (grow_array((void**)&rec->buffers, &rec->buffer_capacity, rec->buffer_count + 1,
+                   sizeof(retryix_record_buffer_slot_t)) != 0) {
+        return -1;
+    }
+    retryix_record_buffer_slot_t* slot = &rec->buffers[rec->buffer_count];
+    memset(slot, 0, sizeof(*slot));
+    slot->buffer = buffer;
+    return (int)rec->buffer_count++;
+}
+
+// 新增純量槽（initial 可為 NULL，表示重播前必須設定）
+int retryix_record_scalar_slot(retryix_recording_t* rec, size_t size, const void* initial) {
+    if (!rec || rec->finalized || size == 0) return -1;
+    if (grow_array((void**)&rec->scalars, &rec->scalar_capacity, rec->scalar_count + 1,
+                   sizeof(retryix_record_scalar_slot_t)) != 0) {
+        return -1;
+    }
+    void* value = calloc(1, size);
+    if (!value) return -1;
+    if (initial) memcpy(value, initial, size);
+
+    retryix_record_scalar_slot_t* slot = &rec->scalars[rec->scalar_count];
+    memset(slot, 0, sizeof(*slot));
+    slot->size = size;
+    slot->value = value;
+    return (int)rec->scalar_count++;
+}
+
+// 重新綁定緩衝區槽，下次重播只重設引用此槽的參數
+int retryix_record_bind_buffer(retryix_recording_t* rec, int slot, cl_mem buffer) {
+    if (!rec || slot < 0 || (size_t)slot >= rec->buffer_count || !buffer) return -1;
+    retryix_record_buffer_slot_t* s = &rec->buffers[slot];
+    if (s->buffer != buffer) {
+        s->buffer = buffer;
+        s->dirty = true;
+    }
+    return 0;
+}
+
+// 更新純量槽的值
+int retryix_record_set_scalar(retryix_recording_t* rec, int slot, const void* value) {
+    if (!rec || slot < 0 || (size_t)slot >= rec->scalar_count || !value) return -1;
+    retryix_record_scalar_slot_t* s = &rec->scalars[slot];
+    if (memcmp(s->value, value, s->size) != 0) {
+        memcpy(s->value, value, s->size);
+        s->dirty = true;
+    }
+    return 0;
+}
+
+// 錄製傳輸，回傳命令編號
+int retryix_record_write(retryix_recording_t* rec, int slot, size_t offset, size_t size, const void* host_ptr) {
+    if (!rec || slot < 0 || (size_t)slot >= rec->buffer_count || size == 0 || !host_ptr) return -1;
+    int index;
+    retryix_record_cmd_t* cmd = new_cmd(rec, RETRYIX_RECORD_CMD_WRITE, &index);
+    if (!cmd) return -1;
+    cmd->slot = slot;
+    cmd->offset = offset;
+    cmd->size = size;
+    cmd->host_ptr = (void*)host_ptr;
+    return index;
+}
+
+int retryix_record_read(retryix_recording_t* rec, int slot, size_t offset, size_t size, void* host_ptr) {
+    if (!rec || slot < 0 || (size_t)slot >= rec->buffer_count || size == 0 || !host_ptr) return -1;
+    int index;
+    retryix_record_cmd_t* cmd = new_cmd(rec, RETRYIX_RECORD_CMD_READ, &index);
+    if (!cmd) return -1;
+    cmd->slot = slot;
+    cmd->offset = offset;
+    cmd->size = size;
+    cmd->host_ptr = host_ptr;
+    return index;
+}
+
+// 更換傳輸命令的主機指標（大小不變）
+int retryix_record_set_host_ptr(retryix_recording_t* rec, int cmd_index, void* host_ptr) {
+    if (!rec || cmd_index < 0 || (size_t)cmd_index >= rec->cmd_count || !host_ptr) return -1;
+    retryix_record_cmd_t* cmd = &rec->cmds[cmd_index];
+    if (cmd->type == RETRYIX_RECORD_CMD_KERNEL) return -1;
+    cmd->host_ptr = host_ptr;
+    return 0;
+}
+
+// 錄製內核啟動（kernel_name 為 NULL 時使用模板預設內核），回傳命令編號
+int retryix_record_kernel(retryix_recording_t* rec, const char* template_name, const char* kernel_name,
+                          size_t global_work_size, size_t local_work_size) {
+    if (!rec || !template_name || global_work_size == 0) return -1;
+    int index;
+    retryix_record_cmd_t* cmd = new_cmd(rec, RETRYIX_RECORD_CMD_KERNEL, &index);
+    if (!cmd) return -1;
+    snprintf(cmd->template_name, sizeof(cmd->template_name), "%s", template_name);
+    if (kernel_name) snprintf(cmd->kernel_name, sizeof(cmd->kernel_name), "%s", kernel_name);
+    cmd->global_work_size = global_work_size;
+    cmd->local_work_size = local_work_size;
+    return index;
+}
+
+int retryix_record_arg_value(retryix_recording_t* rec, int cmd_index, cl_uint arg_index, size_t size, const void* value) {
+    if (size == 0 || !value) return -1;
+    retryix_record_arg_t* arg = kernel_arg(rec, cmd_index, arg_index);
+    if (!arg) return -1;
+    arg->value = malloc(size);
+    if (!arg->value) return -1;
+    memcpy(arg->value, value, size);
+    arg->size = size;
+    arg->kind = RETRYIX_RECORD_ARG_VALUE;
+    return 0;
+}
+
+int retryix_record_arg_local(retryix_recording_t* rec, int cmd_index, cl_uint arg_index, size_t size) {
+    if (size == 0) return -1;
+    retryix_record_arg_t* arg = kernel_arg(rec, cmd_index, arg_index);
+    if (!arg) return -1;
+    arg->size = size;
+    arg->kind = RETRYIX_RECORD_ARG_LOCAL;
+    return 0;
+}
+
+int retryix_record_arg_buffer(retryix_recording_t* rec, int cmd_index, cl_uint arg_index, int slot) {
+    if (!rec || slot < 0 || (size_t)slot >= rec->buffer_count) return -1;
+    retryix_record_arg_t* arg = kernel_arg(rec, cmd_index, arg_index);
+    if (!arg) return -1;
+    arg->slot = slot;
+    arg->kind = RETRYIX_RECORD_ARG_BUFFER_SLOT;
+    return 0;
+}
+
+int retryix_record_arg_scalar(retryix_recording_t* rec, int cmd_index, cl_uint arg_index, int slot) {
+    if (!rec || slot < 0 || (size_t)slot >= rec->scalar_count) return -1;
+    retryix_record_arg_t* arg = kernel_arg(rec, cmd_index, arg_index);
+    if (!arg) return -1;
+    arg->slot = slot;
+    arg->kind = RETRYIX_RECORD_ARG_SCALAR_SLOT;
+    return 0;
+}
+
+// 結束錄製：一次性驗證所有命令、借出專屬內核實例並設定全部參數
+// 之後重播只重設變動槽位所引用的參數
+int retryix_record_end(retryix_recording_t* rec) {
+    if (!rec) return -1;
+    if (rec->finalized) return 0;
+
+    // 先前失敗的 end 可能留下部分使用紀錄
+    for (size_t i = 0; i < rec->buffer_count; i++) rec->buffers[i].use_count = 0;
+    for (size_t i = 0; i < rec->scalar_count; i++) rec->scalars[i].use_count = 0;
+
+    for (size_t i = 0; i < rec->cmd_count; i++) {
+        retryix_record_cmd_t* cmd = &rec->cmds[i];
+
+        if (cmd->type != RETRYIX_RECORD_CMD_KERNEL) {
+            cl_mem buffer = rec->buffers[cmd->slot].buffer;
+            size_t buffer_size = 0;
+            if (!buffer || clGetMemObjectInfo(buffer, CL_MEM_SIZE, sizeof(buffer_size), &buffer_size, NULL) != CL_SUCCESS ||
+                cmd->offset + cmd->size > buffer_size) {
+                printf("Recorded transfer %zu exceeds its buffer\n", i);
+                return -1;
+            }
+            continue;
+        }
+
+        if (!cmd->kernel) cmd->kernel = retryix_kernel_acquire(cmd->template_name, cmd->kernel_name[0] ? cmd->kernel_name : NULL);
+        if (!cmd->kernel) {
+            printf("Recorded kernel %s unavailable\n", cmd->template_name);
+            return -1;
+        }
+
+        cl_uint num_args = 0;
+        clGetKernelInfo(cmd->kernel, CL_KERNEL_NUM_ARGS, sizeof(num_args), &num_args, NULL);
+        if (cmd->arg_count != num_args) {
+            printf("Recorded kernel %s binds %u of %u arguments\n", cmd->template_name, cmd->arg_count, num_args);
+            return -1;
+        }
+
+        for (cl_uint a = 0; a < cmd->arg_count; a++) {
+            retryix_record_arg_t* arg = &cmd->args[a];
+            int rc = 0;
+            if (arg->kind == RETRYIX_RECORD_ARG_BUFFER_SLOT) {
+                retryix_record_buffer_slot_t* s = &rec->buffers[arg->slot];
+                rc = add_use(&s->uses, &s->use_count, &s->use_capacity, (int)i, a);
+            } else if (arg->kind == RETRYIX_RECORD_ARG_SCALAR_SLOT) {
+                retryix_record_scalar_slot_t* s = &rec->scalars[arg->slot];
+                rc = add_use(&s->uses, &s->use_count, &s->use_capacity, (int)i, a);
+            }
+
+            cl_int err = (rc == 0) ? apply_arg(rec, cmd->kernel, a, arg) : CL_OUT_OF_HOST_MEMORY;
+            if (err != CL_SUCCESS) {
+                printf("Recorded kernel %s argument %u invalid: %d\n", cmd->template_name, a, err);
+                return -1;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < rec->buffer_count; i++) rec->buffers[i].dirty = false;
+    for (size_t i = 0; i < rec->scalar_count; i++) rec->scalars[i].dirty = false;
+    rec->finalized = true;
+
+    printf("Recording finalized: %zu commands, %zu buffer slots, %zu scalar slots\n",
+           rec->cmd_count, rec->buffer_count, rec->scalar_count);
+    return 0;
+}
+
+// 重播：只重設變動槽位引用的參數，依序排入所有命令
+// out_event 為 NULL 時等待完成，否則回傳最後一個命令的事件（呼叫端負責釋放）
+int retryix_record_replay(retryix_recording_t* rec, cl_event* out_event) {
+    if (!rec || !rec->finalized || rec->cmd_count == 0) return -1;
+
+    double start = rixNowMs();
+
+    for (size_t i = 0; i < rec->buffer_count; i++) {
+        retryix_record_buffer_slot_t* s = &rec->buffers[i];
+        if (!s->dirty) continue;
+        for (size_t u = 0; u < s->use_count; u++) {
+            retryix_record_cmd_t* cmd = &rec->cmds[s->uses[u].cmd];
+            if (clSetKernelArg(cmd->kernel, s->uses[u].arg, sizeof(cl_mem), &s->buffer) != CL_SUCCESS) return -1;
+        }
+        rec->rebind_count += s->use_count;
+        s->dirty = false;
+    }
+    for (size_t i = 0; i < rec->scalar_count; i++) {
+        retryix_record_scalar_slot_t* s = &rec->scalars[i];
+        if (!s->dirty) continue;
+        for (size_t u = 0; u < s->use_count; u++) {
+            retryix_record_cmd_t* cmd = &rec->cmds[s->uses[u].cmd];
+            if (clSetKernelArg(cmd->kernel, s->uses[u].arg, s->size, s->value) != CL_SUCCESS) return -1;
+        }
+        rec->rebind_count += s->use_count;
+        s->dirty = false;
+    }
+
+    for (size_t i = 0; i < rec->cmd_count; i++) {
+        const retryix_record_cmd_t* cmd = &rec->cmds[i];
+        cl_event* ev = (out_event && i + 1 == rec->cmd_count) ? out_event : NULL;
+        cl_int err = (cmd->type == RETRYIX_RECORD_CMD_KERNEL) ? enqueue_kernel(rec, cmd, cmd->kernel, ev)
+                                                              : enqueue_transfer(rec, cmd, ev);
+        if (err != CL_SUCCESS) {
+            printf("Replay failed at command %zu: %d\n", i, err);
+            clFinish(rec->queue);
+            return -1;
+        }
+    }
+
+    rec->replay_host_ms += rixNowMs() - start;
+    rec->replay_count++;
+
+    if (!out_event) clFinish(rec->queue);
+    return 0;
+}
+
+// 以逐次呼叫方式執行相同序列（每個內核重新查找、驗證並設定全部參數），作為量測基準
+static int run_individual(retryix_recording_t* rec) {
+    for (size_t i = 0; i < rec->cmd_count; i++) {
+        const retryix_record_cmd_t* cmd = &rec->cmds[i];
+        if (cmd->type != RETRYIX_RECORD_CMD_KERNEL) {
+            if (enqueue_transfer(rec, cmd, NULL) != CL_SUCCESS) return -1;
+            continue;
+        }
+
+        cl_kernel kernel = retryix_kernel_acquire(cmd->template_name, cmd->kernel_name[0] ? cmd->kernel_name : NULL);
+        if (!kernel) return -1;
+
+        cl_uint num_args = 0;
+        clGetKernelInfo(kernel, CL_KERNEL_NUM_ARGS, sizeof(num_args), &num_args, NULL);
+        cl_int err = (num_args == cmd->arg_count) ? CL_SUCCESS : CL_INVALID_KERNEL_ARGS;
+        for (cl_uint a = 0; a < cmd->arg_count && err == CL_SUCCESS; a++) {
+            err = apply_arg(rec, kernel, a, &cmd->args[a]);
+        }
+        if (err == CL_SUCCESS) err = enqueue_kernel(rec, cmd, kernel, NULL);
+        retryix_kernel_release(cmd->template_name, kernel);
+        if (err != CL_SUCCESS) return -1;
+    }
+    return 0;
+}
+
+// 量測重播與逐次呼叫的主機端開銷（每次迭代的微秒數，皆不含等待設備完成）
+int retryix_record_benchmark(retryix_recording_t* rec, int iterations, double* out_replay_us, double* out_individual_us) {
+    if (!rec || !rec->finalized || iterations <= 0) return -1;
+
+    // 預熱
+    if (retryix_record_replay(rec, NULL) != 0 || run_individual(rec) != 0) return -1;
+    clFinish(rec->queue);
+
+    // 逐次呼叫借用的是池中其他實例，不影響錄製實例已設定的參數
+    double replay_ms = 0.0;
+    double individual_ms = 0.0;
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        if (run_individual(rec) != 0) return -1;
+        individual_ms += rixNowMs() - t0;
+        clFinish(rec->queue);
+
+        cl_event ev = NULL;
+        t0 = rixNowMs();
+        if (retryix_record_replay(rec, &ev) != 0) return -1;
+        replay_ms += rixNowMs() - t0;
+        clWaitForEvents(1, &ev);
+        clReleaseEvent(ev);
+    }
+
+    double replay_us = replay_ms * 1000.0 / iterations;
+    double individual_us = individual_ms * 1000.0 / iterations;
+    if (out_replay_us) *out_replay_us = replay_us;
+    if (out_individual_us) *out_individual_us = individual_us;
+
+    printf("\n=== RetryIX Replay Benchmark ===\n");
+    printf("Commands per iteration: %zu\n", rec->cmd_count);
+    printf("Individual calls: %.2f us/iteration\n", individual_us);
+    printf("Replay:           %.2f us/iteration\n", replay_us);
+    if (replay_us > 0.0) printf("Host overhead reduction: %.2fx\n", individual_us / replay_us);
+    printf("================================\n\n");
+    return 0;
+}
+
+void retryix_record_print_stats(retryix_recording_t* rec) {
+    if (!rec) return;
+
+    printf("\n=== RetryIX Recording ===\n");
+    printf("Commands: %zu (%s)\n", rec->cmd_count, rec->finalized ? "finalized" : "recording");
+    printf("Buffer Slots: %zu, Scalar Slots: %zu\n", rec->buffer_count, rec->scalar_count);
+    printf("Replays: %llu\n", (unsigned long long)rec->replay_count);
+    printf("Rebound Arguments: %llu\n", (unsigned long long)rec->rebind_count);
+    if (rec->replay_count > 0) {
+        printf("Average Replay Host Time: %.2f us\n", rec->replay_host_ms * 1000.0 / rec->replay_count);
+    }
+    printf("=========================\n\n");
+}
@@ -0,0 +1,659 @@
+// retryix_sort.c - RetryIX 內建設備基數排序與分段排序
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RETRYIX_SORT_MAX_LOCAL    256
+#define RETRYIX_SORT_MAX_COUNT    0x7FFFFFFFu   // 內核以 uint 索引，直方圖以 int 掃描
+#define RETRYIX_SORT_MAX_BITS     8
+
+static const char* SORT_KEY_LABELS[RETRYIX_SORT_KEY_TYPE_COUNT] = { "u32", "u64" };
+static const char* SORT_TEMPLATE_NAMES[RETRYIX_SORT_KEY_TYPE_COUNT] = { "retryix_sort_u32", "retryix_sort_u64" };
+static const size_t SORT_KEY_SIZES[RETRYIX_SORT_KEY_TYPE_COUNT] = { sizeof(cl_uint), sizeof(cl_ulong) };
+
+// === 內核源碼 ===
+
+static const char* SORT_KEY_HEADERS[RETRYIX_SORT_KEY_TYPE_COUNT] = {
+    "#define RIX_KEY uint\n",
+    "#define RIX_KEY ulong\n"
+};
+
+// 每個 work-group 處理 local_size 個鍵（一個 tile）。每一遍：
+//   retryix_sort_local   以逐位元 split（local memory 掃描）將 tile 依本遍位數穩定排序，輸出各位數計數
+//   （直方圖以 digit-major 排列：hist[digit * num_groups + group]，由主機端以 retryix_prim_scan 做排他掃描）
+//   retryix_sort_scatter 依掃描後的偏移與 tile 內排名寫回，保持穩定
+// 尾端 tile 以全 1 鍵補齊，穩定排序後必落在有效元素之後
+static const char* SORT_KERNEL_BODY =
+"#define RIX_KEY_PAD ((RIX_KEY)~(RIX_KEY)0)\n"
+"\n"
+"// local memory 排他掃描（Blelloch），回傳總和；lsize 需為 2 的冪次\n"
+"inline uint rix_sort_scan_local(__local uint* data, uint lid, uint lsize) {\n"
+"    for (uint d = 1; d < lsize; d <<= 1) {\n"
+"        uint i = (lid + 1) * (d << 1) - 1;\n"
+"        if (i < lsize) data[i] += data[i - d];\n"
+"        barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    }\n"
+"    uint total = data[lsize - 1];\n"
+"    barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    if (lid == 0) data[lsize - 1] = 0;\n"
+"    barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    for (uint d = lsize >> 1; d > 0; d >>= 1) {\n"
+"        uint i = (lid + 1) * (d << 1) - 1;\n"
+"        if (i < lsize) {\n"
+"            uint t = data[i - d];\n"
+"            data[i - d] = data[i];\n"
+"            data[i] += t;\n"
+"        }\n"
+"        barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    }\n"
+"    return total;\n"
+"}\n"
+"\n"
+"inline uint rix_sort_digit(RIX_KEY key, uint shift, uint bits) {\n"
+"    return (uint)(key >> shift) & ((1u << bits) - 1u);\n"
+"}\n"
+"\n"
+"__kernel void retryix_sort_local(__global const RIX_KEY* keys, __global const uint* vals, uint n,\n"
+"                                 uint shift, uint bits, uint has_vals,\n"
+"                                 __global RIX_KEY* tile_keys, __global uint* tile_vals,\n"
+"                                 __global uint* hist, uint num_groups,\n"
+"                                 __local RIX_KEY* lkeys, __local uint* lvals, __local uint* lscan,\n"
+"                                 __local uint* lrange) {\n"
+"    uint lid = get_local_id(0);\n"
+"    uint lsize = get_local_size(0);\n"
+"    uint group = get_group_id(0);\n"
+"    uint gid = (uint)get_global_id(0);\n"
+"    uint valid = min(lsize, n - group * lsize);\n"
+"    uint radix = 1u << bits;\n"
+"\n"
+"    RIX_KEY key = gid < n ? keys[gid] : RIX_KEY_PAD;\n"
+"    uint val = (has_vals && gid < n) ? vals[gid] : 0u;\n"
+"\n"
+"    // 逐位元穩定 split：0 在前、1 在後，各自維持原順序\n"
+"    for (uint b = 0; b < bits; b++) {\n"
+"        uint bit = (uint)(key >> (shift + b)) & 1u;\n"
+"        lscan[lid] = 1u - bit;\n"
+"        barrier(CLK_LOCAL_MEM_FENCE);\n"
+"        uint zeros = rix_sort_scan_local(lscan, lid, lsize);\n"
+"        uint zeros_before = lscan[lid];\n"
+"        uint dest = bit ? (zeros + lid - zeros_before) : zeros_before;\n"
+"        lkeys[dest] = key;\n"
+"        lvals[dest] = val;\n"
+"        barrier(CLK_LOCAL_MEM_FENCE);\n"
+"        key = lkeys[lid];\n"
+"        val = lvals[lid];\n"
+"        barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    }\n"
+"\n"
+"    // 由位數邊界求各位數計數（lrange[d] 為起點，lrange[radix + d] 為終點 + 1）\n"
+"    uint digit = rix_sort_digit(key, shift, bits);\n"
+"    lscan[lid] = digit;\n"
+"    for (uint d = lid; d < radix; d += lsize) {\n"
+"        lrange[d] = 0;\n"
+"        lrange[radix + d] = 0;\n"
+"    }\n"
+"    barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    if (lid < valid) {\n"
+"        if (lid == 0 || lscan[lid - 1] != digit) lrange[digit] = lid;\n"
+"        if (lid == valid - 1 || lscan[lid + 1] != digit) lrange[radix + digit] = lid + 1;\n"
+"    }\n"
+"    barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    for (uint d = lid; d < radix; d += lsize) {\n"
+"        hist[d * num_groups + group] = lrange[radix + d] - lrange[d];\n"
+"    }\n"
+"\n"
+"    if (gid < n) {\n"
+"        tile_keys[gid] = key;\n"
+"        if (has_vals) tile_vals[gid] = val;\n"
+"    }\n"
+"}\n"
+"\n"
+"// offsets 為排他掃描後的直方圖：目的位置 = 全域位數偏移 + tile 內同位數排名\n"
+"__kernel void retryix_sort_scatter(__global const RIX_KEY* tile_keys, __global const uint* tile_vals, uint n,\n"
+"                                   uint shift, uint bits, uint has_vals,\n"
+"                                   __global const uint* offsets, uint num_groups,\n"
+"                                   __global RIX_KEY* keys, __global uint* vals,\n"
+"                                   __local uint* ldigit, __local uint* lstart) {\n"
+"    uint lid = get_local_id(0);\n"
+"    uint lsize = get_local_size(0);\n"
+"    uint group = get_group_id(0);\n"
+"    uint gid = (uint)get_global_id(0);\n"
+"    uint valid = min(lsize, n - group * lsize);\n"
+"\n"
+"    RIX_KEY key = gid < n ? tile_keys[gid] : RIX_KEY_PAD;\n"
+"    uint digit = rix_sort_digit(key, shift, bits);\n"
+"    ldigit[lid] = digit;\n"
+"    barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    if (lid < valid && (lid == 0 || ldigit[lid - 1] != digit)) lstart[digit] = lid;\n"
+"    barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    if (lid < valid) {\n"
+"        uint dest = offsets[digit * num_groups + group] + lid - lstart[digit];\n"
+"        keys[dest] = key;\n"
+"        if (has_vals) vals[dest] = tile_vals[gid];\n"
+"    }\n"
+"}\n"
+"\n"
+"// 分段排序輔助內核\n"
+"__kernel void retryix_sort_iota(__global uint* out, uint n) {\n"
+"    uint i = (uint)get_global_id(0);\n"
+"    if (i < n) out[i] = i;\n"
+"}\n"
+"\n"
+"__kernel void retryix_sort_copy(__global const RIX_KEY* src, __global RIX_KEY* dst, uint n) {\n"
+"    uint i = (uint)get_global_id(0);\n"
+"    if (i < n) dst[i] = src[i];\n"
+"}\n"
+"\n"
+"__kernel void retryix_sort_gather(__global const RIX_KEY* src, __global const uint* perm, uint n,\n"
+"                                  __global RIX_KEY* dst) {\n"
+"    uint i = (uint)get_global_id(0);\n"
+"    if (i < n) dst[i] = src[perm[i]];\n"
+"}\n"
+"\n"
+"// 原始索引 perm[i] 所屬的分段（segment_offsets 共 num_segments + 1 個，二分搜尋）\n"
+"__kernel void retryix_sort_segment_of(__global const uint* perm, uint n,\n"
+"                                      __global const uint* segment_offsets, uint num_segments,\n"
+"                                      __global uint* segments) {\n"
+"    uint i = (uint)get_global_id(0);\n"
+"    if (i >= n) return;\n"
+"    uint p = perm[i];\n"
+"    uint lo = 0, hi = num_segments;\n"
+"    while (hi - lo > 1) {\n"
+"        uint mid = (lo + hi) >> 1;\n"
+"        if (segment_offsets[mid] <= p) lo = mid; else hi = mid;\n"
+"    }\n"
+"    segments[i] = lo;\n"
+"}\n";
+
+// === 上下文 ===
+
+// 可增長的暫存緩衝區（retryix_memory 配置）
+typedef struct {
+    void* ptr;
+    size_t size;
+} retryix_sort_buffer_t;
+
+typedef struct {
+    cl_context context;
+    cl_device_id device;
+    cl_command_queue queue;
+    cl_ulong local_mem_size;
+    bool prepared[RETRYIX_SORT_KEY_TYPE_COUNT];
+    size_t local_size[RETRYIX_SORT_KEY_TYPE_COUNT];
+    cl_uint radix_bits[RETRYIX_SORT_KEY_TYPE_COUNT];
+    unsigned long forced_bits;              // Sort\RadixBits（0 = 依 local memory 選擇）
+
+    retryix_sort_buffer_t tile_keys;
+    retryix_sort_buffer_t tile_vals;
+    retryix_sort_buffer_t hist;
+    retryix_sort_buffer_t dummy_vals;       // 無 payload 時綁定的佔位緩衝區
+    retryix_sort_buffer_t seg_keys;         // 分段排序：鍵副本 / 收集結果
+    retryix_sort_buffer_t seg_perm;
+    retryix_sort_buffer_t seg_ids;
+    retryix_sort_buffer_t seg_vals;
+
+    uint64_t sorts;
+    uint64_t passes;
+} retryix_sort_context_t;
+
+static retryix_sort_context_t* g_sort_context = NULL;
+
+static size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+static void* ensure_buffer(retryix_sort_buffer_t* buf, size_t bytes, const char* debug_name) {
+    if (buf->ptr && buf->size >= bytes) return buf->ptr;
+    if (buf->ptr) retryix_memory_free(buf->ptr);
+    buf->ptr = retryix_memory_alloc_from(NULL, bytes, RETRYIX_MEM_READ_WRITE, debug_name);
+    buf->size = buf->ptr ? bytes : 0;
+    return buf->ptr;
+}
+
+static void release_buffer(retryix_sort_buffer_t* buf) {
+    if (buf->ptr) retryix_memory_free(buf->ptr);
+    buf->ptr = NULL;
+    buf->size = 0;
+}
+
+// retryix_memory 配置以緩衝區參數綁定，其餘視為 SVM 指標
+static retryix_kernel_arg_t buffer_arg(const void* ptr, retryix_access_t access) {
+    retryix_kernel_arg_t arg;
+    arg.kind = retryix_memory_get_device_mem((void*)ptr) ? RETRYIX_ARG_BUFFER : RETRYIX_ARG_SVM;
+    arg.access = access;
+    arg.value = ptr;
+    arg.size = 0;
+    return arg;
+}
+
+static retryix_kernel_arg_t value_arg(const void* value, size_t size) {
+    retryix_kernel_arg_t arg = { RETRYIX_ARG_VALUE, RETRYIX_ACCESS_AUTO, value, size };
+    return arg;
+}
+
+static retryix_kernel_arg_t local_arg(size_t size) {
+    retryix_kernel_arg_t arg = { RETRYIX_ARG_LOCAL, RETRYIX_ACCESS_AUTO, NULL, size };
+    return arg;
+}
+
+// local_sort 的 local memory 用量
+static size_t local_bytes(retryix_sort_key_t key_type, size_t local, cl_uint bits) {
+    return local * (SORT_KEY_SIZES[key_type] + 2 * sizeof(cl_uint)) + 2 * ((size_t)1 << bits) * sizeof(cl_uint);
+}
+
+// 首次使用時編譯並決定 tile 大小與位數寬度：
+// 位數越寬遍數越少，但直方圖與位數邊界表隨 2^bits 增長；取 local memory 一半內可容納的最寬位數
+static int prepare_key_type(retryix_sort_context_t* ctx, retryix_sort_key_t key_type) {
+    if (key_type < 0 || key_type >= RETRYIX_SORT_KEY_TYPE_COUNT) return -1;
+    if (ctx->prepared[key_type]) return 0;
+
+    static const char* kernels[] = {
+        "retryix_sort_local", "retryix_sort_scatter", "retryix_sort_iota",
+        "retryix_sort_copy", "retryix_sort_gather", "retryix_sort_segment_of"
+    };
+    size_t limit = RETRYIX_SORT_MAX_LOCAL;
+    for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+        cl_kernel kernel = retryix_kernel_acquire(SORT_TEMPLATE_NAMES[key_type], kernels[i]);
+        if (!kernel) return -1;
+        size_t wg = 0;
+        if (clGetKernelWorkGroupInfo(kernel, ctx->device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(wg), &wg, NULL) == CL_SUCCESS &&
+            wg > 0 && wg < limit) {
+            limit = wg;
+        }
+        retryix_kernel_release(SORT_TEMPLATE_NAMES[key_type], kernel);
+    }
+
+    size_t local = 1;
+    while (local * 2 <= limit) local *= 2;
+
+    size_t budget = (size_t)(ctx->local_mem_size / 2);
+    static const cl_uint candidates[] = { 8, 6, 5, 4, 3, 2, 1 };
+    cl_uint bits = 0;
+    for (;;) {
+        for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+            if (ctx->forced_bits && candidates[i] != ctx->forced_bits) continue;
+            if (local_bytes(key_type, local, candidates[i]) <= budget) {
+                bits = candidates[i];
+                break;
+            }
+        }
+        if (bits || local <= 16) break;
+        local /= 2; // 連最窄位數都放不下時縮小 tile
+    }
+    if (!bits) {
+        printf("Sort: insufficient local memory (%llu bytes)\n", (unsigned long long)ctx->local_mem_size);
+        return -1;
+    }
+
+    ctx->local_size[key_type] = local;
+    ctx->radix_bits[key_type] = bits;
+    ctx->prepared[key_type] = true;
+    printf("Sort %s: tile %zu keys, %u-bit digits\n", SORT_KEY_LABELS[key_type], local, bits);
+    return 0;
+}
+
+static int launch(retryix_sort_context_t* ctx, retryix_sort_key_t key_type, const char* kernel_name,
+                  size_t global, const retryix_kernel_arg_t* args, cl_uint num_args) {
+    return retryix_kernel_execute_tracked(SORT_TEMPLATE_NAMES[key_type], kernel_name, global,
+                                          ctx->local_size[key_type], args, num_args, NULL);
+}
+
+// LSD 基數排序：每一遍 src -> tile 排序暫存 -> src，鍵與 payload 原地完成
+static int radix_sort_passes(retryix_sort_context_t* ctx, retryix_sort_key_t key_type,
+                             void* keys, void* vals, cl_uint n, cl_uint key_bits) {
+    size_t local = ctx->local_size[key_type];
+    cl_uint max_bits = ctx->radix_bits[key_type];
+    cl_uint num_groups = (cl_uint)((n + local - 1) / local);
+    size_t global = round_up(n, local);
+    size_t key_size = SORT_KEY_SIZES[key_type];
+
+    void* tile_keys = ensure_buffer(&ctx->tile_keys, (size_t)n * key_size, "sort_tile_keys");
+    void* tile_vals = vals ? ensure_buffer(&ctx->tile_vals, (size_t)n * sizeof(cl_uint), "sort_tile_vals")
+                           : ensure_buffer(&ctx->dummy_vals, sizeof(cl_uint), "sort_dummy_vals");
+    void* hist = ensure_buffer(&ctx->hist, ((size_t)1 << max_bits) * num_groups * sizeof(cl_uint), "sort_hist");
+    if (!tile_keys || !tile_vals || !hist) return -1;
+    void* val_buf = vals ? vals : tile_vals;
+    cl_uint has_vals = vals ? 1u : 0u;
+
+    int rc = 0;
+    for (cl_uint shift = 0; shift < key_bits && rc == 0; shift += max_bits) {
+        cl_uint bits = (key_bits - shift < max_bits) ? key_bits - shift : max_bits;
+        size_t radix = (size_t)1 << bits;
+
+        retryix_kernel_arg_t local_args[14] = {
+            buffer_arg(keys, RETRYIX_ACCESS_READ), buffer_arg(val_buf, RETRYIX_ACCESS_READ),
+            value_arg(&n, sizeof(n)), value_arg(&shift, sizeof(shift)), value_arg(&bits, sizeof(bits)),
+            value_arg(&has_vals, sizeof(has_vals)),
+            buffer_arg(tile_keys, RETRYIX_ACCESS_WRITE), buffer_arg(tile_vals, RETRYIX_ACCESS_WRITE),
+            buffer_arg(hist, RETRYIX_ACCESS_WRITE), value_arg(&num_groups, sizeof(num_groups)),
+            local_arg(local * key_size), local_arg(local * sizeof(cl_uint)), local_arg(local * sizeof(cl_uint)),
+            local_arg(2 * radix * sizeof(cl_uint))
+        };
+        rc = launch(ctx, key_type, "retryix_sort_local", global, local_args, 14);
+
+        if (rc == 0) rc = retryix_prim_scan(RETRYIX_PRIM_INT, hist, hist, radix * num_groups, 0);
+
+        if (rc == 0) {
+            retryix_kernel_arg_t scatter_args[12] = {
+                buffer_arg(tile_keys, RETRYIX_ACCESS_READ), buffer_arg(tile_vals, RETRYIX_ACCESS_READ),
+                value_arg(&n, sizeof(n)), value_arg(&shift, sizeof(shift)), value_arg(&bits, sizeof(bits)),
+                value_arg(&has_vals, sizeof(has_vals)),
+                buffer_arg(hist, RETRYIX_ACCESS_READ), value_arg(&num_groups, sizeof(num_groups)),
+                buffer_arg(keys, RETRYIX_ACCESS_WRITE), buffer_arg(val_buf, RETRYIX_ACCESS_WRITE),
+                local_arg(local * sizeof(cl_uint)), local_arg(radix * sizeof(cl_uint))
+            };
+            rc = launch(ctx, key_type, "retryix_sort_scatter", global, scatter_args, 12);
+        }
+        ctx->passes++;
+    }
+    return rc;
+}
+
+// === 公開 API ===
+
+int retryix_sort_init(cl_context context, cl_device_id device, cl_command_queue queue) {
+    if (g_sort_context) return 0;
+    if (!context || !device || !queue) return -1;
+
+    // 直方圖掃描使用平行原語（同時初始化記憶體管理器）
+    if (retryix_primitives_init(context, device, queue) != 0) return -1;
+
+    retryix_sort_context_t* ctx = (retryix_sort_context_t*)calloc(1, sizeof(retryix_sort_context_t));
+    if (!ctx) return -1;
+
+    ctx->context = context;
+    ctx->device = device;
+    ctx->queue = queue;
+    clGetDeviceInfo(device, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(ctx->local_mem_size), &ctx->local_mem_size, NULL);
+    if (ctx->local_mem_size == 0) ctx->local_mem_size = 16 * 1024;
+    ctx->forced_bits = retryix_config_get_dword("Sort", "RadixBits", 0);
+    if (ctx->forced_bits > RETRYIX_SORT_MAX_BITS) ctx->forced_bits = 0;
+
+    for (int t = 0; t < RETRYIX_SORT_KEY_TYPE_COUNT; t++) {
+        size_t len = strlen(SORT_KEY_HEADERS[t]) + strlen(SORT_KERNEL_BODY) + 2;
+        char* source = (char*)malloc(len);
+        if (!source) {
+            free(ctx);
+            return -1;
+        }
+        snprintf(source, len, "%s\n%s", SORT_KEY_HEADERS[t], SORT_KERNEL_BODY);
+        int rc = retryix_kernel_register_program(SORT_TEMPLATE_NAMES[t], source);
+        free(source);
+        if (rc != 0) {
+            free(ctx);
+            return -1;
+        }
+    }
+
+    g_sort_context = ctx;
+
+    printf("RetryIX Sort Initialized\n");
+    printf("  Local Memory: %llu bytes\n", (unsigned long long)ctx->local_mem_size);
+    return 0;
+}
+
+void retryix_sort_cleanup(void) {
+    retryix_sort_context_t* ctx = g_sort_context;
+    if (!ctx) return;
+
+    release_buffer(&ctx->tile_keys);
+    release_buffer(&ctx->tile_vals);
+    release_buffer(&ctx->hist);
+    release_buffer(&ctx->dummy_vals);
+    release_buffer(&ctx->seg_keys);
+    release_buffer(&ctx->seg_perm);
+    release_buffer(&ctx->seg_ids);
+    release_buffer(&ctx->seg_vals);
+    free(ctx);
+    g_sort_context = NULL;
+}
+
+int retryix_sort_radix(retryix_sort_key_t key_type, void* keys, void* values, size_t count, cl_uint key_bits) {
+    retryix_sort_context_t* ctx = g_sort_context;
+    if (!ctx || !keys || count == 0 || count > RETRYIX_SORT_MAX_COUNT) return -1;
+    if (prepare_key_type(ctx, key_type) != 0) return -1;
+
+    cl_uint width = (cl_uint)(SORT_KEY_SIZES[key_type] * 8);
+    if (key_bits == 0 || key_bits > width) key_bits = width;
+    if (count == 1) return 0;
+
+    ctx->sorts++;
+    return radix_sort_passes(ctx, key_type, keys, values, (cl_uint)count, key_bits);
+}
+
+// 分段排序：先依鍵排序（payload 為原始索引），再依所屬分段穩定排序，最後依排列收集鍵與值
+int retryix_sort_segmented(retryix_sort_key_t key_type, void* keys, void* values, size_t count,
+                           const void* segment_offsets, size_t num_segments) {
+    retryix_sort_context_t* ctx = g_sort_context;
+    if (!ctx || !keys || !segment_offsets || count == 0 || count > RETRYIX_SORT_MAX_COUNT) return -1;
+    if (num_segments == 0 || num_segments > count) return -1;
+    if (prepare_key_type(ctx, key_type) != 0 || prepare_key_type(ctx, RETRYIX_SORT_KEY_U32) != 0) return -1;
+    if (num_segments == 1) return retryix_sort_radix(key_type, keys, values, count, 0);
+
+    size_t key_size = SORT_KEY_SIZES[key_type];
+    cl_uint n = (cl_uint)count;
+    cl_uint segments = (cl_uint)num_segments;
+    void* key_copy = ensure_buffer(&ctx->seg_keys, count * key_size, "sort_seg_keys");
+    void* perm = ensure_buffer(&ctx->seg_perm, count * sizeof(cl_uint), "sort_seg_perm");
+    void* ids = ensure_buffer(&ctx->seg_ids, count * sizeof(cl_uint), "sort_seg_ids");
+    if (!key_copy || !perm || !ids) return -1;
+
+    cl_uint segment_bits = 0;
+    while (segment_bits < 32 && ((cl_ulong)1 << segment_bits) < num_segments) segment_bits++;
+
+    size_t global = round_up(count, ctx->local_size[key_type]);
+    size_t global_u32 = round_up(count, ctx->local_size[RETRYIX_SORT_KEY_U32]);
+    ctx->sorts++;
+
+    // 鍵副本與原始索引
+    retryix_kernel_arg_t copy_args[3] = {
+        buffer_arg(keys, RETRYIX_ACCESS_READ), buffer_arg(key_copy, RETRYIX_ACCESS_WRITE), value_arg(&n, sizeof(n))
+    };
+    int rc = launch(ctx, key_type, "retryix_sort_copy", global, copy_args, 3);
+    if (rc == 0) {
+        retryix_kernel_arg_t iota_args[2] = { buffer_arg(perm, RETRYIX_ACCESS_WRITE), value_arg(&n, sizeof(n)) };
+        rc = launch(ctx, RETRYIX_SORT_KEY_U32, "retryix_sort_iota", global_u32, iota_args, 2);
+    }
+    if (rc == 0) {
+        rc = radix_sort_passes(ctx, key_type, key_copy, perm, n, (cl_uint)(key_size * 8));
+    }
+
+    // 依分段穩定排序：鍵順序在分段內得以保留
+    if (rc == 0) {
+        retryix_kernel_arg_t seg_args[5] = {
+            buffer_arg(perm, RETRYIX_ACCESS_READ), value_arg(&n, sizeof(n)),
+            buffer_arg(segment_offsets, RETRYIX_ACCESS_READ), value_arg(&segments, sizeof(segments)),
+            buffer_arg(ids, RETRYIX_ACCESS_WRITE)
+        };
+        rc = launch(ctx, RETRYIX_SORT_KEY_U32, "retryix_sort_segment_of", global_u32, seg_args, 5);
+    }
+    if (rc == 0) rc = radix_sort_passes(ctx, RETRYIX_SORT_KEY_U32, ids, perm, n, segment_bits);
+
+    // 依最終排列收集，再寫回使用者緩衝區
+    if (rc == 0) {
+        retryix_kernel_arg_t gather_args[4] = {
+            buffer_arg(keys, RETRYIX_ACCESS_READ), buffer_arg(perm, RETRYIX_ACCESS_READ),
+            value_arg(&n, sizeof(n)), buffer_arg(key_copy, RETRYIX_ACCESS_WRITE)
+        };
+        rc = launch(ctx, key_type, "retryix_sort_gather", global, gather_args, 4);
+    }
+    if (rc == 0) {
+        retryix_kernel_arg_t back_args[3] = {
+            buffer_arg(key_copy, RETRYIX_ACCESS_READ), buffer_arg(keys, RETRYIX_ACCESS_WRITE), value_arg(&n, sizeof(n))
+        };
+        rc = launch(ctx, key_type, "retryix_sort_copy", global, back_args, 3);
+    }
+    if (rc == 0 && values) {
+        void* val_copy = ensure_buffer(&ctx->seg_vals, count * sizeof(cl_uint), "sort_seg_vals");
+        if (!val_copy) return -1;
+        retryix_kernel_arg_t gather_args[4] = {
+            buffer_arg(values, RETRYIX_ACCESS_READ), buffer_arg(perm, RETRYIX_ACCESS_READ),
+            value_arg(&n, sizeof(n)), buffer_arg(val_copy, RETRYIX_ACCESS_WRITE)
+        };
+        rc = launch(ctx, RETRYIX_SORT_KEY_U32, "retryix_sort_gather", global_u32, gather_args, 4);
+        if (rc == 0) {
+            retryix_kernel_arg_t back_args[3] = {
+                buffer_arg(val_copy, RETRYIX_ACCESS_READ), buffer_arg(values, RETRYIX_ACCESS_WRITE), value_arg(&n, sizeof(n))
+            };
+            rc = launch(ctx, RETRYIX_SORT_KEY_U32, "retryix_sort_copy", global_u32, back_args, 3);
+        }
+    }
+    return rc;
+}
+
+// === 量測 ===
+
+typedef struct {
+    cl_ulong key;
+    cl_uint index;
+} retryix_sort_pair_t;
+
+static int compare_pairs(const void* a, const void* b) {
+    const retryix_sort_pair_t* x = (const retryix_sort_pair_t*)a;
+    const retryix_sort_pair_t* y = (const retryix_sort_pair_t*)b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return (x->index > y->index) - (x->index < y->index); // 以原始索引決勝，等同穩定排序
+}
+
+static cl_ulong load_key(retryix_sort_key_t key_type, const void* keys, size_t i) {
+    return key_type == RETRYIX_SORT_KEY_U64 ? ((const cl_ulong*)keys)[i] : ((const cl_uint*)keys)[i];
+}
+
+static void store_key(retryix_sort_key_t key_type, void* keys, size_t i, cl_ulong key) {
+    if (key_type == RETRYIX_SORT_KEY_U64) ((cl_ulong*)keys)[i] = key;
+    else ((cl_uint*)keys)[i] = (cl_uint)key;
+}
+
+// 每段以 qsort 排序作為參考（begin..end 內依鍵與原始索引排序）
+static void reference_sort(retryix_sort_pair_t* pairs, const cl_uint* offsets, size_t num_segments) {
+    for (size_t s = 0; s < num_segments; s++) {
+        qsort(pairs + offsets[s], offsets[s + 1] - offsets[s], sizeof(retryix_sort_pair_t), compare_pairs);
+    }
+}
+
+// 比對設備結果與參考排序（鍵與 payload 都需一致，payload 一致即代表穩定）
+static bool verify_sorted(retryix_sort_key_t key_type, const void* keys, const cl_uint* vals,
+                          const retryix_sort_pair_t* expected, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (load_key(key_type, keys, i) != expected[i].key) return false;
+        if (vals && vals[i] != expected[i].index) return false;
+    }
+    return true;
+}
+
+// 量測主體：產生輸入、逐遍量測並驗證，任一項失敗回傳 -1
+static int run_sort_benchmark(retryix_sort_context_t* ctx, retryix_sort_key_t key_type, void* keys, cl_uint* vals,
+                              cl_uint* offsets, void* original, retryix_sort_pair_t* expected, size_t count,
+                              size_t num_segments, size_t segment_length, int iterations) {
+    size_t key_size = SORT_KEY_SIZES[key_type];
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (size_t i = 0; i < count; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        cl_ulong key = (key_type == RETRYIX_SORT_KEY_U64) ? (state & 0xFFFFFFFFFFull) : (state & 0xFFFFFu);
+        store_key(key_type, original, i, key);
+    }
+    for (size_t s = 0; s <= num_segments; s++) {
+        offsets[s] = (cl_uint)(s * segment_length < count ? s * segment_length : count);
+    }
+    retryix_memory_copy_to_device(offsets, ctx->queue, true);
+
+    printf("\n=== RetryIX Sort Benchmark (%s keys%s, %zu elements, %u-bit digits) ===\n",
+           SORT_KEY_LABELS[key_type], vals ? " + u32 values" : "", count, ctx->radix_bits[key_type]);
+
+    int failures = 0;
+    for (int segmented = 0; segmented < 2; segmented++) {
+        double gpu_best = -1.0, cpu_best = -1.0;
+        bool correct = true;
+        cl_uint whole[2] = { 0, (cl_uint)count };
+        const cl_uint* ref_offsets = segmented ? offsets : whole;
+        size_t ref_segments = segmented ? num_segments : 1;
+
+        for (int it = 0; it <= iterations && correct; it++) {
+            memcpy(keys, original, count * key_size);
+            retryix_memory_copy_to_device(keys, ctx->queue, true);
+            if (vals) {
+                for (size_t i = 0; i < count; i++) vals[i] = (cl_uint)i;
+                retryix_memory_copy_to_device(vals, ctx->queue, true);
+            }
+
+            double t0 = rixNowMs();
+            int sort_rc = segmented ? retryix_sort_segmented(key_type, keys, vals, count, offsets, num_segments)
+                                    : retryix_sort_radix(key_type, keys, vals, count, 0);
+            if (sort_rc == 0) sort_rc = retryix_memory_sync(keys);
+            if (sort_rc == 0 && vals) sort_rc = retryix_memory_sync(vals);
+            double gpu_ms = rixNowMs() - t0;
+            if (sort_rc != 0) {
+                correct = false;
+                break;
+            }
+
+            for (size_t i = 0; i < count; i++) {
+                expected[i].key = load_key(key_type, original, i);
+                expected[i].index = (cl_uint)i;
+            }
+            t0 = rixNowMs();
+            reference_sort(expected, ref_offsets, ref_segments);
+            double cpu_ms = rixNowMs() - t0;
+
+            if (it == 0) {
+                // 第一次為預熱（含編譯與暫存配置），同時驗證結果
+                retryix_memory_copy_from_device(keys, ctx->queue, true);
+                if (vals) retryix_memory_copy_from_device(vals, ctx->queue, true);
+                correct = verify_sorted(key_type, keys, vals, expected, count);
+                continue;
+            }
+            if (gpu_best < 0.0 || gpu_ms < gpu_best) gpu_best = gpu_ms;
+            if (cpu_best < 0.0 || cpu_ms < cpu_best) cpu_best = cpu_ms;
+        }
+        if (!correct) failures++;
+
+        printf("  %-10s GPU %9.3f ms (%8.2f Mkeys/s)  qsort %9.3f ms (%8.2f Mkeys/s)  %6.2fx  %s\n",
+               segmented ? "segmented" : "radix", gpu_best,
+               gpu_best > 0.0 ? (double)count / (gpu_best * 1e3) : 0.0, cpu_best,
+               cpu_best > 0.0 ? (double)count / (cpu_best * 1e3) : 0.0,
+               gpu_best > 0.0 ? cpu_best / gpu_best : 0.0, correct ? "PASS" : "FAIL");
+    }
+    printf("  (segmented: %zu segments of %zu keys)\n", num_segments, segment_length);
+    printf("=====================================================================\n\n");
+    return failures ? -1 : 0;
+}
+
+// 量測基數排序與分段排序的鍵/秒（含完成等待的牆鐘時間，取最佳值），並與單執行緒 qsort 參考比較；
+// 鍵值範圍刻意縮小以產生大量重複鍵，檢驗穩定性
+int retryix_sort_benchmark(retryix_sort_key_t key_type, size_t count, int with_values, int iterations) {
+    retryix_sort_context_t* ctx = g_sort_context;
+    if (!ctx || count < 2 || count > RETRYIX_SORT_MAX_COUNT) return -1;
+    if (iterations <= 0) iterations = 5;
+    if (prepare_key_type(ctx, key_type) != 0) return -1;
+
+    size_t key_size = SORT_KEY_SIZES[key_type];
+    size_t segment_length = 1000;
+    size_t num_segments = (count + segment_length - 1) / segment_length;
+
+    void* keys = retryix_memory_alloc(count * key_size, RETRYIX_MEM_READ_WRITE, "sort_bench_keys");
+    cl_uint* vals = with_values ? (cl_uint*)retryix_memory_alloc(count * sizeof(cl_uint), RETRYIX_MEM_READ_WRITE, "sort_bench_vals") : NULL;
+    cl_uint* offsets = (cl_uint*)retryix_memory_alloc((num_segments + 1) * sizeof(cl_uint), RETRYIX_MEM_READ_WRITE, "sort_bench_offsets");
+    void* original = malloc(count * key_size);
+    retryix_sort_pair_t* expected = (retryix_sort_pair_t*)malloc(count * sizeof(retryix_sort_pair_t));
+    int rc = -1;
+    if (keys && (!with_values || vals) && offsets && original && expected) {
+        rc = run_sort_benchmark(ctx, key_type, keys, vals, offsets, original, expected, count,
+                                num_segments, segment_length, iterations);
+    }
+
+    free(expected);
+    free(original);
+    if (offsets) retryix_memory_free(offsets);
+    if (vals) retryix_memory_free(vals);
+    if (keys) retryix_memory_free(keys);
+    return rc;
+}
@@ -0,0 +1,742 @@
+// retryix_spmv.c - RetryIX 稀疏矩陣向量乘法（CSR scalar / CSR vector / SELL-C-σ），依列長統計自動選擇格式
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define RETRYIX_SPMV_MAX_LOCAL      256
+#define RETRYIX_SPMV_MAX_LANES      32
+#define RETRYIX_SPMV_STREAM_KEY     "spmv.stream"
+#define RETRYIX_SPMV_STREAM_RUNS    3
+#define RETRYIX_SPMV_PADDING_SLOT   0xFFFFFFFFu
+
+static const char* SPMV_TYPE_LABELS[RETRYIX_BLAS_TYPE_COUNT] = { "float", "double" };
+static const char* SPMV_TEMPLATE_NAMES[RETRYIX_BLAS_TYPE_COUNT] = { "retryix_spmv_float", "retryix_spmv_double" };
+static const size_t SPMV_ELEMENT_SIZES[RETRYIX_BLAS_TYPE_COUNT] = { sizeof(cl_float), sizeof(cl_double) };
+static const char* SPMV_FORMAT_LABELS[RETRYIX_SPMV_FORMAT_COUNT] = { "AUTO", "CSR_SCALAR", "CSR_VECTOR", "SELL" };
+
+// === 內核源碼 ===
+
+static const char* SPMV_TYPE_HEADERS[RETRYIX_BLAS_TYPE_COUNT] = {
+    "#define RIX_T float\n"
+    "#define RIX_T4 float4\n",
+
+    "#ifndef RETRYIX_NATIVE_DOUBLE\n"
+    "#error \"double SpMV requires RETRYIX_NATIVE_DOUBLE\"\n"
+    "#endif\n"
+    "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n"
+    "#define RIX_T RETRYIX_REAL\n"
+    "#define RIX_T4 RETRYIX_REAL4\n"
+};
+
+static const char* SPMV_KERNEL_BODY =
+"// CSR scalar：每個 work-item 處理一列，適合短列\n"
+"__kernel void retryix_spmv_csr_scalar(uint rows, __global const uint* row_ptr, __global const uint* col,\n"
+"                                      __global const RIX_T* val, __global const RIX_T* x, __global RIX_T* y) {\n"
+"    uint row = get_global_id(0);\n"
+"    if (row >= rows) return;\n"
+"    RIX_T sum = (RIX_T)0;\n"
+"    uint end = row_ptr[row + 1];\n"
+"    for (uint j = row_ptr[row]; j < end; j++) sum += val[j] * x[col[j]];\n"
+"    y[row] = sum;\n"
+"}\n"
+"\n"
+"// CSR vector：每列由 lanes 個相鄰 work-item 合作（合併存取），local memory 歸約；lanes 為 2 的冪次\n"
+"__kernel void retryix_spmv_csr_vector(uint rows, uint lanes, __global const uint* row_ptr, __global const uint* col,\n"
+"                                      __global const RIX_T* val, __global const RIX_T* x, __global RIX_T* y,\n"
+"                                      __local RIX_T* scratch) {\n"
+"    uint lid = get_local_id(0);\n"
+"    uint lane = lid & (lanes - 1);\n"
+"    uint row = (uint)(get_global_id(0) / lanes);\n"
+"    RIX_T sum = (RIX_T)0;\n"
+"    if (row < rows) {\n"
+"        uint end = row_ptr[row + 1];\n"
+"        for (uint j = row_ptr[row] + lane; j < end; j += lanes) sum += val[j] * x[col[j]];\n"
+"    }\n"
+"    scratch[lid] = sum;\n"
+"    barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    for (uint s = lanes >> 1; s > 0; s >>= 1) {\n"
+"        if (lane < s) scratch[lid] += scratch[lid + s];\n"
+"        barrier(CLK_LOCAL_MEM_FENCE);\n"
+"    }\n"
+"    if (lane == 0 && row < rows) y[row] = scratch[lid];\n"
+"}\n"
+"\n"
+"// SELL-C-σ：每 C 列為一個 chunk，chunk 內以行主序交錯儲存，每個 work-item 處理一個排序後的列位置\n"
+"__kernel void retryix_spmv_sell(uint slots, uint chunk_rows, __global const uint* chunk_ptr,\n"
+"                                __global const uint* chunk_len, __global const uint* col, __global const RIX_T* val,\n"
+"                                __global const uint* perm, __global const RIX_T* x, __global RIX_T* y) {\n"
+"    uint slot = get_global_id(0);\n"
+"    if (slot >= slots) return;\n"
+"    uint chunk = slot / chunk_rows;\n"
+"    uint base = chunk_ptr[chunk] + slot % chunk_rows;\n"
+"    uint len = chunk_len[chunk];\n"
+"    RIX_T sum = (RIX_T)0;\n"
+"    for (uint j = 0; j < len; j++) {\n"
+"        uint idx = base + j * chunk_rows;\n"
+"        sum += val[idx] * x[col[idx]];\n"
+"    }\n"
+"    uint row = perm[slot];\n"
+"    if (row != 0xFFFFFFFFu) y[row] = sum;\n"
+"}\n"
+"\n"
+"// STREAM copy：量測可達的設備記憶體頻寬作為 SpMV 的上限參考\n"
+"__kernel void retryix_spmv_stream(__global const RIX_T4* in, __global RIX_T4* out, uint n4) {\n"
+"    uint i = get_global_id(0);\n"
+"    if (i < n4) out[i] = in[i];\n"
+"}\n";
+
+// === 上下文 ===
+
+// 列長統計
+typedef struct {
+    double mean;
+    double cv;                              // 變異係數（標準差 / 平均）
+    cl_uint max;
+    cl_uint empty;
+} retryix_spmv_row_stats_t;
+
+struct retryix_spmv_matrix {
+    retryix_blas_type_t type;
+    retryix_spmv_format_t format;
+    cl_uint rows;
+    cl_uint cols;
+    cl_uint nnz;
+    retryix_spmv_row_stats_t stats;
+
+    // CSR（呼叫端的 retryix_memory 緩衝區，不持有）
+    const cl_uint* row_ptr;
+    const cl_uint* col_idx;
+    const void* values;
+    cl_uint lanes;                          // CSR vector：每列的 work-item 數
+
+    // SELL-C-σ（模組配置的 retryix_memory 緩衝區）
+    cl_uint chunk_rows;                     // C
+    cl_uint sigma;                          // σ：排序視窗
+    cl_uint slots;                          // 列數補齊至 C 的倍數
+    cl_uint padded;                         // 含補零的儲存元素數
+    cl_uint* chunk_ptr;
+    cl_uint* chunk_len;
+    cl_uint* sell_col;
+    void* sell_val;
+    cl_uint* perm;
+};
+
+typedef struct {
+    cl_context context;
+    cl_device_id device;
+    cl_command_queue queue;
+    bool type_available[RETRYIX_BLAS_TYPE_COUNT];
+    bool prepared[RETRYIX_BLAS_TYPE_COUNT];
+    size_t local_size[RETRYIX_BLAS_TYPE_COUNT];
+
+    // 設定
+    unsigned long chunk_rows;               // Spmv\SellChunk
+    unsigned long sigma;                    // Spmv\SellSigma
+    unsigned long max_padding_pct;          // Spmv\SellMaxPaddingPct：SELL 補零上限（相對 nnz 的百分比）
+    unsigned long vector_min_row;           // Spmv\VectorMinRowLength：CSR vector 的最小平均列長
+    double stream_gbps;                     // STREAM copy 頻寬（0 = 尚未量測）
+
+    uint64_t multiplies;
+    uint64_t format_counts[RETRYIX_SPMV_FORMAT_COUNT];
+} retryix_spmv_context_t;
+
+static retryix_spmv_context_t* g_spmv_context = NULL;
+
+static size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// retryix_memory 配置以緩衝區參數綁定，其餘視為 SVM 指標
+static retryix_kernel_arg_t buffer_arg(const void* ptr, retryix_access_t access) {
+    retryix_kernel_arg_t arg;
+    arg.kind = retryix_memory_get_device_mem((void*)ptr) ? RETRYIX_ARG_BUFFER : RETRYIX_ARG_SVM;
+    arg.access = access;
+    arg.value = ptr;
+    arg.size = 0;
+    return arg;
+}
+
+static retryix_kernel_arg_t value_arg(const void* value, size_t size) {
+    retryix_kernel_arg_t arg = { RETRYIX_ARG_VALUE, RETRYIX_ACCESS_AUTO, value, size };
+    return arg;
+}
+
+static retryix_kernel_arg_t local_arg(size_t size) {
+    retryix_kernel_arg_t arg = { RETRYIX_ARG_LOCAL, RETRYIX_ACCESS_AUTO, NULL, size };
+    return arg;
+}
+
+// 首次使用時編譯並取各內核工作組上限內的 2 的冪次 local size
+static int prepare_type(retryix_spmv_context_t* ctx, retryix_blas_type_t type) {
+    if (type < 0 || type >= RETRYIX_BLAS_TYPE_COUNT || !ctx->type_available[type]) return -1;
+    if (ctx->prepared[type]) return 0;
+
+    static const char* kernels[] = {
+        "retryix_spmv_csr_scalar", "retryix_spmv_csr_vector", "retryix_spmv_sell", "retryix_spmv_stream"
+    };
+    size_t limit = RETRYIX_SPMV_MAX_LOCAL;
+    for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+        cl_kernel kernel = retryix_kernel_acquire(SPMV_TEMPLATE_NAMES[type], kernels[i]);
+        if (!kernel) return -1;
+        size_t wg = 0;
+        if (clGetKernelWorkGroupInfo(kernel, ctx->device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(wg), &wg, NULL) == CL_SUCCESS &&
+            wg > 0 && wg < limit) {
+            limit = wg;
+        }
+        retryix_kernel_release(SPMV_TEMPLATE_NAMES[type], kernel);
+    }
+
+    size_t local = 1;
+    while (local * 2 <= limit) local *= 2;
+    ctx->local_size[type] = local;
+    ctx->prepared[type] = true;
+    return 0;
+}
+
+// === CSR 轉換 ===
+
+static int validate_csr(cl_uint rows, cl_uint cols, const cl_uint* row_ptr, const cl_uint* col_idx) {
+    if (row_ptr[0] != 0) return -1;
+    for (cl_uint r = 0; r < rows; r++) {
+        if (row_ptr[r + 1] < row_ptr[r]) return -1;
+    }
+    cl_uint nnz = row_ptr[rows];
+    for (cl_uint j = 0; j < nnz; j++) {
+        if (col_idx[j] >= cols) return -1;
+    }
+    return 0;
+}
+
+static retryix_spmv_row_stats_t row_stats(cl_uint rows, const cl_uint* row_ptr) {
+    retryix_spmv_row_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    double sum = 0.0, sum_sq = 0.0;
+    for (cl_uint r = 0; r < rows; r++) {
+        cl_uint len = row_ptr[r + 1] - row_ptr[r];
+        sum += len;
+        sum_sq += (double)len * len;
+        if (len > stats.max) stats.max = len;
+        if (len == 0) stats.empty++;
+    }
+    stats.mean = sum / rows;
+    double variance = sum_sq / rows - stats.mean * stats.mean;
+    stats.cv = (stats.mean > 0.0 && variance > 0.0) ? sqrt(variance) / stats.mean : 0.0;
+    return stats;
+}
+
+typedef struct {
+    cl_uint len;
+    cl_uint row;
+} retryix_spmv_slot_t;
+
+static int compare_slot_desc(const void* a, const void* b) {
+    const retryix_spmv_slot_t* x = (const retryix_spmv_slot_t*)a;
+    const retryix_spmv_slot_t* y = (const retryix_spmv_slot_t*)b;
+    if (x->len != y->len) return (x->len < y->len) ? 1 : -1;
+    return (x->row > y->row) - (x->row < y->row);
+}
+
+// SELL-C-σ 版面：每 σ 列依列長遞減排序，chunk 寬度取其中最長列；回傳含補零的總元素數（超出 cl_uint 時回傳 0）
+static uint64_t sell_layout(cl_uint rows, const cl_uint* row_ptr, cl_uint chunk_rows, cl_uint sigma,
+                            retryix_spmv_slot_t* slots, cl_uint* chunk_len) {
+    cl_uint slot_count = (cl_uint)round_up(rows, chunk_rows);
+    for (cl_uint s = 0; s < slot_count; s++) {
+        slots[s].row = (s < rows) ? s : RETRYIX_SPMV_PADDING_SLOT;
+        slots[s].len = (s < rows) ? row_ptr[s + 1] - row_ptr[s] : 0;
+    }
+    for (cl_uint s = 0; s < slot_count; s += sigma) {
+        cl_uint window = (slot_count - s < sigma) ? slot_count - s : sigma;
+        qsort(slots + s, window, sizeof(retryix_spmv_slot_t), compare_slot_desc);
+    }
+
+    uint64_t padded = 0;
+    for (cl_uint c = 0; c < slot_count / chunk_rows; c++) {
+        cl_uint width = 0;
+        for (cl_uint i = 0; i < chunk_rows; i++) {
+            if (slots[c * chunk_rows + i].len > width) width = slots[c * chunk_rows + i].len;
+        }
+        chunk_len[c] = width;
+        padded += (uint64_t)width * chunk_rows;
+    }
+    return padded <= 0xFFFFFFFFu ? padded : 0;
+}
+
+static void free_sell(retryix_spmv_matrix_t* m) {
+    if (m->perm) retryix_memory_free(m->perm);
+    if (m->sell_val) retryix_memory_free(m->sell_val);
+    if (m->sell_col) retryix_memory_free(m->sell_col);
+    if (m->chunk_len) retryix_memory_free(m->chunk_len);
+    if (m->chunk_ptr) retryix_memory_free(m->chunk_ptr);
+    m->perm = NULL;
+    m->sell_val = NULL;
+    m->sell_col = NULL;
+    m->chunk_len = NULL;
+    m->chunk_ptr = NULL;
+}
+
+// 依 sell_layout 的結果建立 SELL 陣列並上傳
+static int build_sell(retryix_spmv_context_t* ctx, retryix_spmv_matrix_t* m,
+                      const retryix_spmv_slot_t* slots, const cl_uint* chunk_len_host) {
+    size_t elem = SPMV_ELEMENT_SIZES[m->type];
+    cl_uint chunks = m->slots / m->chunk_rows;
+    size_t storage = m->padded ? m->padded : 1;
+
+    m->chunk_ptr = (cl_uint*)retryix_memory_alloc_from(NULL, ((size_t)chunks + 1) * sizeof(cl_uint), RETRYIX_MEM_READ_ONLY, "spmv_sell_chunk_ptr");
+    m->chunk_len = (cl_uint*)retryix_memory_alloc_from(NULL, (size_t)chunks * sizeof(cl_uint), RETRYIX_MEM_READ_ONLY, "spmv_sell_chunk_len");
+    m->sell_col = (cl_uint*)retryix_memory_alloc_from(NULL, storage * sizeof(cl_uint), RETRYIX_MEM_READ_ONLY, "spmv_sell_col");
+    m->sell_val = retryix_memory_alloc_from(NULL, storage * elem, RETRYIX_MEM_READ_ONLY, "spmv_sell_val");
+    m->perm = (cl_uint*)retryix_memory_alloc_from(NULL, (size_t)m->slots * sizeof(cl_uint), RETRYIX_MEM_READ_ONLY, "spmv_sell_perm");
+    if (!m->chunk_ptr || !m->chunk_len || !m->sell_col || !m->sell_val || !m->perm) {
+        free_sell(m);
+        return -1;
+    }
+
+    cl_uint offset = 0;
+    for (cl_uint c = 0; c < chunks; c++) {
+        m->chunk_ptr[c] = offset;
+        m->chunk_len[c] = chunk_len_host[c];
+        offset += chunk_len_host[c] * m->chunk_rows;
+    }
+    m->chunk_ptr[chunks] = offset;
+    memset(m->sell_col, 0, storage * sizeof(cl_uint));
+    memset(m->sell_val, 0, storage * elem);
+
+    for (cl_uint s = 0; s < m->slots; s++) {
+        cl_uint row = slots[s].row;
+        m->perm[s] = row;
+        if (row == RETRYIX_SPMV_PADDING_SLOT) continue;
+        cl_uint base = m->chunk_ptr[s / m->chunk_rows] + s % m->chunk_rows;
+        cl_uint begin = m->row_ptr[row];
+        for (cl_uint j = 0; j < slots[s].len; j++) {
+            size_t dst = (size_t)base + (size_t)j * m->chunk_rows;
+            m->sell_col[dst] = m->col_idx[begin + j];
+            memcpy((char*)m->sell_val + dst * elem, (const char*)m->values + (size_t)(begin + j) * elem, elem);
+        }
+    }
+
+    void* buffers[] = { m->chunk_ptr, m->chunk_len, m->sell_col, m->sell_val, m->perm };
+    for (size_t i = 0; i < sizeof(buffers) / sizeof(buffers[0]); i++) {
+        if (retryix_memory_copy_to_device(buffers[i], ctx->queue, true) != 0) {
+            free_sell(m);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 格式選擇：SELL 補零在上限內時優先（合併存取且以 σ 排序吸收列長差異）；
+// 否則平均列長夠長時用 CSR vector，其餘（短列、高度不規則）用 CSR scalar
+static retryix_spmv_format_t choose_format(retryix_spmv_context_t* ctx, const retryix_spmv_matrix_t* m, uint64_t padded) {
+    if (padded > 0 && m->nnz > 0 && padded * 100 <= (uint64_t)m->nnz * ctx->max_padding_pct) return RETRYIX_SPMV_SELL;
+    if (m->stats.mean >= (double)ctx->vector_min_row) return RETRYIX_SPMV_CSR_VECTOR;
+    return RETRYIX_SPMV_CSR_SCALAR;
+}
+
+// === 公開 API ===
+
+int retryix_spmv_init(cl_context context, cl_device_id device, cl_command_queue queue) {
+    if (g_spmv_context) return 0;
+    if (!context || !device || !queue) return -1;
+
+    if (!retryix_memory_init(context, device)) return -1;
+
+    retryix_spmv_context_t* ctx = (retryix_spmv_context_t*)calloc(1, sizeof(retryix_spmv_context_t));
+    if (!ctx) return -1;
+
+    ctx->context = context;
+    ctx->device = device;
+    ctx->queue = queue;
+    ctx->chunk_rows = retryix_config_get_dword("Spmv", "SellChunk", 32);
+    ctx->sigma = retryix_config_get_dword("Spmv", "SellSigma", 256);
+    ctx->max_padding_pct = retryix_config_get_dword("Spmv", "SellMaxPaddingPct", 125);
+    ctx->vector_min_row = retryix_config_get_dword("Spmv", "VectorMinRowLength", 8);
+    if (ctx->chunk_rows == 0 || ctx->chunk_rows > 1024) ctx->chunk_rows = 32;
+    // σ 需為 C 的倍數，chunk 才不會跨越排序視窗
+    if (ctx->sigma < ctx->chunk_rows) ctx->sigma = ctx->chunk_rows;
+    ctx->sigma = round_up(ctx->sigma, ctx->chunk_rows);
+    if (ctx->max_padding_pct < 100) ctx->max_padding_pct = 100;
+
+    char value[64];
+    if (retryix_tuning_get(device, RETRYIX_SPMV_STREAM_KEY, value, sizeof(value)) == RETRYIX_SUCCESS) {
+        sscanf(value, "%lf", &ctx->stream_gbps);
+    }
+
+    char extensions[4096] = {0};
+    clGetDeviceInfo(device, CL_DEVICE_EXTENSIONS, sizeof(extensions) - 1, extensions, NULL);
+    bool fp64 = (strstr(extensions, "cl_khr_fp64") != NULL) &&
+                retryix_config_get_dword("Applications\\Scientific", "EnableDoubleSupport", 1) != 0;
+
+    for (int t = 0; t < RETRYIX_BLAS_TYPE_COUNT; t++) {
+        if (t == RETRYIX_BLAS_DOUBLE && !fp64) continue;
+        size_t len = strlen(SPMV_TYPE_HEADERS[t]) + strlen(SPMV_KERNEL_BODY) + 2;
+        char* source = (char*)malloc(len);
+        if (!source) {
+            free(ctx);
+            return -1;
+        }
+        snprintf(source, len, "%s\n%s", SPMV_TYPE_HEADERS[t], SPMV_KERNEL_BODY);
+        int rc = retryix_kernel_register_program(SPMV_TEMPLATE_NAMES[t], source);
+        free(source);
+        if (rc != 0) {
+            free(ctx);
+            return -1;
+        }
+        ctx->type_available[t] = true;
+    }
+
+    g_spmv_context = ctx;
+
+    printf("RetryIX SpMV Initialized\n");
+    printf("  SELL-C-sigma: C=%lu sigma=%lu, double: %s\n", ctx->chunk_rows, ctx->sigma, fp64 ? "YES" : "NO");
+    return 0;
+}
+
+void retryix_spmv_cleanup(void) {
+    if (!g_spmv_context) return;
+    free(g_spmv_context);
+    g_spmv_context = NULL;
+}
+
+// 由 CSR（retryix_memory 緩衝區，主機端內容有效）建立矩陣；format 為 AUTO 時依列長統計選擇。
+// CSR 緩衝區上傳後直接沿用，需存活至 retryix_spmv_destroy
+retryix_spmv_matrix_t* retryix_spmv_create(retryix_blas_type_t type, size_t rows, size_t cols,
+                                           const cl_uint* row_ptr, const cl_uint* col_idx, const void* values,
+                                           retryix_spmv_format_t format) {
+    retryix_spmv_context_t* ctx = g_spmv_context;
+    if (!ctx || !row_ptr || !col_idx || !values || rows == 0 || cols == 0) return NULL;
+    if (rows >= RETRYIX_SPMV_PADDING_SLOT - ctx->chunk_rows || cols > 0xFFFFFFFFu) return NULL;
+    if (format < 0 || format >= RETRYIX_SPMV_FORMAT_COUNT) return NULL;
+    if (prepare_type(ctx, type) != 0) return NULL;
+    if (!retryix_memory_get_device_mem((void*)row_ptr) || !retryix_memory_get_device_mem((void*)col_idx) ||
+        !retryix_memory_get_device_mem((void*)values)) {
+        printf("SpMV: CSR arrays must be retryix_memory buffers\n");
+        return NULL;
+    }
+    if (validate_csr((cl_uint)rows, (cl_uint)cols, row_ptr, col_idx) != 0) {
+        printf("SpMV: invalid CSR structure\n");
+        return NULL;
+    }
+
+    retryix_spmv_matrix_t* m = (retryix_spmv_matrix_t*)calloc(1, sizeof(retryix_spmv_matrix_t));
+    if (!m) return NULL;
+    m->type = type;
+    m->rows = (cl_uint)rows;
+    m->cols = (cl_uint)cols;
+    m->nnz = row_ptr[rows];
+    m->row_ptr = row_ptr;
+    m->col_idx = col_idx;
+    m->values = values;
+    m->stats = row_stats(m->rows, row_ptr);
+    m->chunk_rows = (cl_uint)ctx->chunk_rows;
+    m->sigma = (cl_uint)ctx->sigma;
+    m->slots = (cl_uint)round_up(rows, m->chunk_rows);
+
+    // CSR vector：取不小於平均列長的 2 的冪次（2 .. 32，且不超過 local size）
+    size_t max_lanes = ctx->local_size[type] < RETRYIX_SPMV_MAX_LANES ? ctx->local_size[type] : RETRYIX_SPMV_MAX_LANES;
+    m->lanes = 2;
+    while (m->lanes < max_lanes && m->lanes < m->stats.mean) m->lanes *= 2;
+    if (m->lanes > max_lanes) m->lanes = (cl_uint)max_lanes;
+
+    // SELL 版面同時作為格式選擇的依據（補零比例）
+    retryix_spmv_slot_t* slots = (retryix_spmv_slot_t*)malloc((size_t)m->slots * sizeof(retryix_spmv_slot_t));
+    cl_uint* chunk_len = (cl_uint*)malloc((size_t)(m->slots / m->chunk_rows) * sizeof(cl_uint));
+    uint64_t padded = 0;
+    if (slots && chunk_len && (format == RETRYIX_SPMV_AUTO || format == RETRYIX_SPMV_SELL)) {
+        padded = sell_layout(m->rows, row_ptr, m->chunk_rows, m->sigma, slots, chunk_len);
+    }
+    m->padded = (cl_uint)padded;
+    m->format = (format == RETRYIX_SPMV_AUTO) ? choose_format(ctx, m, padded) : format;
+
+    int rc = 0;
+    if (m->format == RETRYIX_SPMV_SELL) {
+        rc = (slots && chunk_len && (padded > 0 || m->nnz == 0)) ? build_sell(ctx, m, slots, chunk_len) : -1;
+    } else {
+        rc = retryix_memory_copy_to_device((void*)row_ptr, ctx->queue, true);
+        if (rc == 0) rc = retryix_memory_copy_to_device((void*)col_idx, ctx->queue, true);
+        if (rc == 0) rc = retryix_memory_copy_to_device((void*)values, ctx->queue, true);
+    }
+    free(chunk_len);
+    free(slots);
+    if (rc != 0) {
+        printf("SpMV: failed to build %s matrix\n", SPMV_FORMAT_LABELS[m->format]);
+        free(m);
+        return NULL;
+    }
+    return m;
+}
+
+void retryix_spmv_destroy(retryix_spmv_matrix_t* matrix) {
+    if (!matrix) return;
+    free_sell(matrix);
+    free(matrix);
+}
+
+retryix_spmv_format_t retryix_spmv_get_format(const retryix_spmv_matrix_t* matrix) {
+    return matrix ? matrix->format : RETRYIX_SPMV_AUTO;
+}
+
+const char* retryix_spmv_format_name(retryix_spmv_format_t format) {
+    return (format >= 0 && format < RETRYIX_SPMV_FORMAT_COUNT) ? SPMV_FORMAT_LABELS[format] : "UNKNOWN";
+}
+
+// y = A * x（x 有 cols 個元素、y 有 rows 個元素；retryix_memory 或 SVM 指標）
+int retryix_spmv_multiply(const retryix_spmv_matrix_t* matrix, const void* x, void* y) {
+    retryix_spmv_context_t* ctx = g_spmv_context;
+    if (!ctx || !matrix || !x || !y) return -1;
+    const retryix_spmv_matrix_t* m = matrix;
+    const char* name = SPMV_TEMPLATE_NAMES[m->type];
+    size_t local = ctx->local_size[m->type];
+    cl_uint rows = m->rows;
+    int rc = -1;
+
+    if (m->format == RETRYIX_SPMV_CSR_SCALAR) {
+        retryix_kernel_arg_t args[6] = {
+            value_arg(&rows, sizeof(rows)), buffer_arg(m->row_ptr, RETRYIX_ACCESS_READ),
+            buffer_arg(m->col_idx, RETRYIX_ACCESS_READ), buffer_arg(m->values, RETRYIX_ACCESS_READ),
+            buffer_arg(x, RETRYIX_ACCESS_READ), buffer_arg(y, RETRYIX_ACCESS_WRITE)
+        };
+        rc = retryix_kernel_execute_tracked(name, "retryix_spmv_csr_scalar", round_up(rows, local), local, args, 6, NULL);
+    } else if (m->format == RETRYIX_SPMV_CSR_VECTOR) {
+        cl_uint lanes = m->lanes;
+        size_t rows_per_group = local / lanes;
+        retryix_kernel_arg_t args[8] = {
+            value_arg(&rows, sizeof(rows)), value_arg(&lanes, sizeof(lanes)),
+            buffer_arg(m->row_ptr, RETRYIX_ACCESS_READ), buffer_arg(m->col_idx, RETRYIX_ACCESS_READ),
+            buffer_arg(m->values, RETRYIX_ACCESS_READ), buffer_arg(x, RETRYIX_ACCESS_READ),
+            buffer_arg(y, RETRYIX_ACCESS_WRITE), local_arg(local * SPMV_ELEMENT_SIZES[m->type])
+        };
+        size_t groups = (rows + rows_per_group - 1) / rows_per_group;
+        rc = retryix_kernel_execute_tracked(name, "retryix_spmv_csr_vector", groups * local, local, args, 8, NULL);
+    } else if (m->format == RETRYIX_SPMV_SELL) {
+        cl_uint slots = m->slots;
+        cl_uint chunk_rows = m->chunk_rows;
+        retryix_kernel_arg_t args[9] = {
+            value_arg(&slots, sizeof(slots)), value_arg(&chunk_rows, sizeof(chunk_rows)),
+            buffer_arg(m->chunk_ptr, RETRYIX_ACCESS_READ), buffer_arg(m->chunk_len, RETRYIX_ACCESS_READ),
+            buffer_arg(m->sell_col, RETRYIX_ACCESS_READ), buffer_arg(m->sell_val, RETRYIX_ACCESS_READ),
+            buffer_arg(m->perm, RETRYIX_ACCESS_READ), buffer_arg(x, RETRYIX_ACCESS_READ),
+            buffer_arg(y, RETRYIX_ACCESS_WRITE)
+        };
+        rc = retryix_kernel_execute_tracked(name, "retryix_spmv_sell", round_up(slots, local), local, args, 9, NULL);
+    }
+    if (rc == 0) {
+        ctx->multiplies++;
+        ctx->format_counts[m->format]++;
+    }
+    return rc;
+}
+
+// 單次 SpMV 的最少記憶體流量：矩陣（值、行索引、列指標 / SELL 中繼資料）+ x + y
+static double spmv_bytes(const retryix_spmv_matrix_t* m) {
+    size_t elem = SPMV_ELEMENT_SIZES[m->type];
+    double matrix_bytes = (m->format == RETRYIX_SPMV_SELL)
+        ? (double)m->padded * (elem + sizeof(cl_uint)) + (double)(m->slots / m->chunk_rows) * 2 * sizeof(cl_uint) +
+          (double)m->slots * sizeof(cl_uint)
+        : (double)m->nnz * (elem + sizeof(cl_uint)) + ((double)m->rows + 1) * sizeof(cl_uint);
+    return matrix_bytes + (double)m->cols * elem + (double)m->rows * elem;
+}
+
+// === 量測 ===
+
+// STREAM copy 頻寬（讀 + 寫），結果以設備為單位快取
+static double measure_stream(retryix_spmv_context_t* ctx, retryix_blas_type_t type) {
+    if (ctx->stream_gbps > 0.0) return ctx->stream_gbps;
+
+    size_t bytes = (size_t)retryix_config_get_dword("Spmv", "StreamSizeMB", 64) << 20;
+    if (bytes < (1u << 20)) bytes = 1u << 20;
+    size_t elem4 = SPMV_ELEMENT_SIZES[type] * 4;
+    cl_uint n4 = (cl_uint)(bytes / elem4);
+    void* in = retryix_memory_alloc(bytes, RETRYIX_MEM_READ_WRITE, "spmv_stream_in");
+    void* out = retryix_memory_alloc(bytes, RETRYIX_MEM_READ_WRITE, "spmv_stream_out");
+    double best = -1.0;
+    if (in && out) {
+        memset(in, 0, bytes);
+        retryix_memory_copy_to_device(in, ctx->queue, true);
+        size_t local = ctx->local_size[type];
+        retryix_kernel_arg_t args[3] = {
+            buffer_arg(in, RETRYIX_ACCESS_READ), buffer_arg(out, RETRYIX_ACCESS_WRITE), value_arg(&n4, sizeof(n4))
+        };
+        for (int run = 0; run <= RETRYIX_SPMV_STREAM_RUNS; run++) {
+            double t0 = rixNowMs();
+            if (retryix_kernel_execute_tracked(SPMV_TEMPLATE_NAMES[type], "retryix_spmv_stream",
+                                               round_up(n4, local), local, args, 3, NULL) != 0 ||
+                retryix_memory_sync(out) != 0) {
+                best = -1.0;
+                break;
+            }
+            double ms = rixNowMs() - t0;
+            if (run == 0) continue;
+            if (best < 0.0 || ms < best) best = ms;
+        }
+    }
+    if (out) retryix_memory_free(out);
+    if (in) retryix_memory_free(in);
+
+    if (best > 0.0) {
+        char value[64];
+        ctx->stream_gbps = 2.0 * (double)n4 * elem4 / (best * 1e6);
+        snprintf(value, sizeof(value), "%.3f", ctx->stream_gbps);
+        retryix_tuning_put(ctx->device, RETRYIX_SPMV_STREAM_KEY, value);
+    }
+    return ctx->stream_gbps;
+}
+
+static double load_value(retryix_blas_type_t type, const void* data, size_t i) {
+    return type == RETRYIX_BLAS_FLOAT ? (double)((const cl_float*)data)[i] : ((const cl_double*)data)[i];
+}
+
+static void store_value(retryix_blas_type_t type, void* data, size_t i, double value) {
+    if (type == RETRYIX_BLAS_FLOAT) ((cl_float*)data)[i] = (cl_float)value;
+    else ((cl_double*)data)[i] = value;
+}
+
+// 產生測試矩陣：pattern 0 為五點差分（列長一致），1 為冪律列長（少數長列）
+static bool generate_matrix(retryix_blas_type_t type, int pattern, cl_uint rows, cl_uint* row_ptr, cl_uint* col_idx,
+                            void* values, size_t capacity) {
+    uint32_t seed = 12345u;
+    cl_uint nnz = 0;
+    cl_uint grid = (cl_uint)sqrt((double)rows);
+    if (grid == 0) grid = 1;
+    row_ptr[0] = 0;
+    for (cl_uint r = 0; r < rows; r++) {
+        if (pattern == 0) {
+            long neighbors[5] = { (long)r - grid, (long)r - 1, (long)r, (long)r + 1, (long)r + grid };
+            for (int k = 0; k < 5; k++) {
+                if (neighbors[k] < 0 || neighbors[k] >= (long)rows) continue;
+                if (nnz >= capacity) return false;
+                col_idx[nnz] = (cl_uint)neighbors[k];
+                store_value(type, values, nnz, neighbors[k] == (long)r ? 4.0 : -1.0);
+                nnz++;
+            }
+        } else {
+            seed = seed * 1664525u + 1013904223u;
+            double u = ((seed >> 8) + 1.0) / (double)(1u << 24);
+            cl_uint len = (cl_uint)(2.0 / pow(u, 0.6));     // 平均約 5，尾端可達數千
+            if (len > rows) len = rows;
+            if (len > 4096) len = 4096;
+            for (cl_uint k = 0; k < len; k++) {
+                if (nnz >= capacity) return false;
+                seed = seed * 1664525u + 1013904223u;
+                col_idx[nnz] = (cl_uint)(((uint64_t)r + (uint64_t)k * 7919u + (seed >> 20)) % rows);
+                store_value(type, values, nnz, (double)(seed >> 8) / (double)(1u << 24) - 0.5);
+                nnz++;
+            }
+        }
+        row_ptr[r + 1] = nnz;
+    }
+    return true;
+}
+
+static double bench_format(const retryix_spmv_matrix_t* m, const void* x, void* y, int iterations) {
+    double best = -1.0;
+    for (int it = 0; it <= iterations; it++) {
+        double t0 = rixNowMs();
+        if (retryix_spmv_multiply(m, x, y) != 0 || retryix_memory_sync(y) != 0) return -1.0;
+        double ms = rixNowMs() - t0;
+        if (it == 0) continue;
+        if (best < 0.0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+static int bench_pattern(retryix_spmv_context_t* ctx, retryix_blas_type_t type, int pattern, cl_uint rows,
+                         int iterations, double stream) {
+    size_t elem = SPMV_ELEMENT_SIZES[type];
+    size_t capacity = (size_t)rows * 16;
+    cl_uint* row_ptr = (cl_uint*)retryix_memory_alloc(((size_t)rows + 1) * sizeof(cl_uint), RETRYIX_MEM_READ_ONLY, "spmv_bench_row_ptr");
+    cl_uint* col_idx = (cl_uint*)retryix_memory_alloc(capacity * sizeof(cl_uint), RETRYIX_MEM_READ_ONLY, "spmv_bench_col");
+    void* values = retryix_memory_alloc(capacity * elem, RETRYIX_MEM_READ_ONLY, "spmv_bench_val");
+    void* x = retryix_memory_alloc((size_t)rows * elem, RETRYIX_MEM_READ_WRITE, "spmv_bench_x");
+    void* y = retryix_memory_alloc((size_t)rows * elem, RETRYIX_MEM_READ_WRITE, "spmv_bench_y");
+    double* expected = (double*)malloc((size_t)rows * sizeof(double));
+    int failures = 0;
+
+    if (!row_ptr || !col_idx || !values || !x || !y || !expected ||
+        !generate_matrix(type, pattern, rows, row_ptr, col_idx, values, capacity)) {
+        failures = 1;
+    } else {
+        for (cl_uint i = 0; i < rows; i++) store_value(type, x, i, 1.0 + (double)(i % 17) / 16.0);
+        retryix_memory_copy_to_device(x, ctx->queue, true);
+
+        double t0 = rixNowMs();
+        double max_abs = 1e-30;
+        for (cl_uint r = 0; r < rows; r++) {
+            double sum = 0.0;
+            for (cl_uint j = row_ptr[r]; j < row_ptr[r + 1]; j++) sum += load_value(type, values, j) * load_value(type, x, col_idx[j]);
+            expected[r] = sum;
+            if (fabs(sum) > max_abs) max_abs = fabs(sum);
+        }
+        double cpu_ms = rixNowMs() - t0;
+
+        retryix_spmv_row_stats_t stats = row_stats(rows, row_ptr);
+        printf(" %s, %u rows, nnz %u, row length mean %.1f max %u cv %.2f (CPU CSR %.3f ms)\n",
+               pattern == 0 ? "5-point stencil" : "power-law rows", rows, row_ptr[rows], stats.mean, stats.max,
+               stats.cv, cpu_ms);
+
+        for (int f = 0; f < RETRYIX_SPMV_FORMAT_COUNT; f++) {
+            retryix_spmv_matrix_t* m = retryix_spmv_create(type, rows, rows, row_ptr, col_idx, values, (retryix_spmv_format_t)f);
+            if (!m) {
+                printf("  %-10s create failed\n", SPMV_FORMAT_LABELS[f]);
+                failures++;
+                continue;
+            }
+            double ms = bench_format(m, x, y, iterations);
+            double err = 1.0;
+            if (ms > 0.0 && retryix_memory_copy_from_device(y, ctx->queue, true) == 0) {
+                err = 0.0;
+                for (cl_uint r = 0; r < rows; r++) {
+                    double e = fabs(load_value(type, y, r) - expected[r]) / max_abs;
+                    if (e > err) err = e;
+                }
+            }
+            bool correct = ms > 0.0 && err <= (type == RETRYIX_BLAS_FLOAT ? 1e-4 : 1e-10);
+            if (!correct) failures++;
+            double gbps = ms > 0.0 ? spmv_bytes(m) / (ms * 1e6) : 0.0;
+            char label[32];
+            if (f == RETRYIX_SPMV_AUTO) snprintf(label, sizeof(label), "AUTO->%s", SPMV_FORMAT_LABELS[m->format]);
+            else snprintf(label, sizeof(label), "%s", SPMV_FORMAT_LABELS[f]);
+            printf("  %-18s %9.3f ms  %7.2f GB/s  %5.1f%% of stream  %5.1f GFLOP/s  err %.1e  %s\n", label, ms, gbps,
+                   stream > 0.0 ? 100.0 * gbps / stream : 0.0, ms > 0.0 ? 2.0 * m->nnz / (ms * 1e6) : 0.0,
+                   err, correct ? "PASS" : "FAIL");
+            retryix_spmv_destroy(m);
+        }
+    }
+
+    free(expected);
+    if (y) retryix_memory_free(y);
+    if (x) retryix_memory_free(x);
+    if (values) retryix_memory_free(values);
+    if (col_idx) retryix_memory_free(col_idx);
+    if (row_ptr) retryix_memory_free(row_ptr);
+    return failures;
+}
+
+// 以五點差分與冪律列長兩種矩陣量測各格式的 GB/s（相對 STREAM copy 頻寬）並與 CPU CSR 結果比對
+int retryix_spmv_benchmark(retryix_blas_type_t type, size_t rows, int iterations) {
+    retryix_spmv_context_t* ctx = g_spmv_context;
+    if (!ctx || rows == 0 || rows > (1u << 26)) return -1;
+    if (iterations <= 0) iterations = 5;
+    if (prepare_type(ctx, type) != 0) {
+        printf("SpMV: %s not available on this device\n",
+               (type >= 0 && type < RETRYIX_BLAS_TYPE_COUNT) ? SPMV_TYPE_LABELS[type] : "type");
+        return -1;
+    }
+
+    double stream = measure_stream(ctx, type);
+    printf("\n=== RetryIX SpMV Benchmark (%s) ===\n", SPMV_TYPE_LABELS[type]);
+    printf(" STREAM copy bandwidth: %.2f GB/s\n", stream);
+    int failures = 0;
+    for (int pattern = 0; pattern < 2; pattern++) {
+        failures += bench_pattern(ctx, type, pattern, (cl_uint)rows, iterations, stream);
+    }
+    printf("======================================\n\n");
+    return failures ? -1 : 0;
+}
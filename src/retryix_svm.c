@@ -1,7 +1,9 @@
 // retryix_svm.c - RetryIX SVM Implementation (Fixed)
 #define CL_TARGET_OPENCL_VERSION 200  // 避免 OpenCL 3.0 警告
 
-#include <CL/cl.h>
+#include "retryix.h"
+#include "retryix_hazard.h"
+#include "retryix_thread.h"
 #include <stdio.h>
 #include <stdlib.h>  // 添加 aligned_alloc 支援
 #include <string.h>
@@ -20,25 +22,6 @@
     #define aligned_free(ptr) free(ptr)
 #endif
 
-// SVM 能力等級定義 - 修正枚舉衝突
-typedef enum {
-    RETRYIX_SVM_LEVEL_NONE = 0,           // 不支援 SVM
-    RETRYIX_SVM_LEVEL_COARSE_GRAIN,       // 粗粒度 SVM (手動同步)
-    RETRYIX_SVM_LEVEL_FINE_GRAIN,         // 細粒度 SVM (自動同步)
-    RETRYIX_SVM_LEVEL_FINE_GRAIN_SYSTEM,  // 系統級細粒度 SVM
-    RETRYIX_SVM_LEVEL_EMULATED            // 軟體模擬 SVM
-} retryix_svm_level_t;
-
-// SVM 記憶體標誌 - 與等級分開定義
-typedef enum {
-    RETRYIX_SVM_FLAG_READ_WRITE = 0x1,
-    RETRYIX_SVM_FLAG_READ_ONLY = 0x2,
-    RETRYIX_SVM_FLAG_WRITE_ONLY = 0x4,
-    RETRYIX_SVM_FLAG_ATOMIC = 0x8,
-    RETRYIX_SVM_FLAG_FINE_GRAIN = 0x10,
-    RETRYIX_SVM_FLAG_COARSE_GRAIN = 0x20
-} retryix_svm_flags_t;
-
 // SVM 記憶體描述符
 typedef struct {
     void* ptr;                      // SVM 指針
@@ -51,10 +34,13 @@ typedef struct {
     bool is_mapped;                // 是否已映射
     void* fallback_buffer;         // 回退緩衝區（用於不支援 SVM 的設備）
     cl_mem fallback_mem;           // 回退 OpenCL 記憶體對象
+    retryix_hazard_t hazard;       // 設備端存取紀錄
+    bool indirect;                 // 由其他 SVM 結構內的指標間接存取
+    bool auto_unmapped;            // 啟動前自動解映射，啟動後需重新映射
 } retryix_svm_descriptor_t;
 
-// SVM 上下文管理
-typedef struct {
+// SVM 上下文管理（retryix.h 中為不透明型別）
+struct retryix_svm_context {
     cl_context context;
     cl_device_id device;
     retryix_svm_level_t max_svm_level;
@@ -63,6 +49,9 @@ typedef struct {
     size_t svm_alignment;
     size_t max_svm_size;
     
+    // 保護描述符陣列與存取紀錄（可重入：內核執行器持有至 end_launch / abort_launch）
+    rix_mutex_t lock;
+    
     // 記憶體管理
     retryix_svm_descriptor_t* descriptors;
     size_t descriptor_count;
@@ -73,7 +62,7 @@ typedef struct {
     size_t peak_allocated;
     uint64_t alloc_count;
     uint64_t free_count;
-} retryix_svm_context_t;
+};
 
 // === 函數聲明 ===
 RETRYIX_EXPORT retryix_svm_context_t* retryix_svm_create_context(cl_context context, cl_device_id device);
@@ -83,6 +72,48 @@ RETRYIX_EXPORT void* retryix_svm_alloc(retryix_svm_context_t* ctx, size_t size,
 RETRYIX_EXPORT int retryix_svm_free(retryix_svm_context_t* ctx, void* ptr);
 RETRYIX_EXPORT int retryix_svm_map(retryix_svm_context_t* ctx, void* ptr, cl_command_queue queue);
 RETRYIX_EXPORT int retryix_svm_unmap(retryix_svm_context_t* ctx, void* ptr, cl_command_queue queue);
+RETRYIX_EXPORT int retryix_svm_hazard_waits(retryix_svm_context_t* ctx, void* ptr, retryix_access_t access,
+                                            cl_event* waits, cl_uint max_waits, cl_uint* num_waits);
+RETRYIX_EXPORT int retryix_svm_hazard_record(retryix_svm_context_t* ctx, void* ptr, retryix_access_t access, cl_event event);
+RETRYIX_EXPORT int retryix_svm_sync(retryix_svm_context_t* ctx, void* ptr);
+RETRYIX_EXPORT void retryix_svm_lock(retryix_svm_context_t* ctx);
+RETRYIX_EXPORT void retryix_svm_unlock(retryix_svm_context_t* ctx);
+RETRYIX_EXPORT int retryix_svm_set_indirect(retryix_svm_context_t* ctx, void* ptr, int indirect);
+RETRYIX_EXPORT int retryix_svm_set_kernel_arg(retryix_svm_context_t* ctx, cl_kernel kernel, cl_uint arg_index, void* ptr);
+RETRYIX_EXPORT int retryix_svm_begin_launch(retryix_svm_context_t* ctx, cl_kernel kernel, cl_command_queue queue,
+                                            void* const* ptrs, const retryix_access_t* access, cl_uint count,
+                                            cl_event* waits, cl_uint max_waits, cl_uint* num_waits);
+RETRYIX_EXPORT int retryix_svm_end_launch(retryix_svm_context_t* ctx, cl_command_queue queue,
+                                          void* const* ptrs, const retryix_access_t* access, cl_uint count,
+                                          cl_event event);
+RETRYIX_EXPORT int retryix_svm_abort_launch(retryix_svm_context_t* ctx, cl_command_queue queue);
+
+// 查找 SVM 描述符
+static retryix_svm_descriptor_t* find_svm_descriptor(retryix_svm_context_t* ctx, void* ptr) {
+    for (size_t i = 0; i < ctx->descriptor_count; i++) {
+        if (ctx->descriptors[i].ptr == ptr) {
+            return &ctx->descriptors[i];
+        }
+    }
+    return NULL;
+}
+
+// 查找包含 ptr 的 SVM 描述符（ptr 可指向配置內部）
+static retryix_svm_descriptor_t* find_containing_descriptor(retryix_svm_context_t* ctx, const void* ptr) {
+    const char* p = (const char*)ptr;
+    for (size_t i = 0; i < ctx->descriptor_count; i++) {
+        const char* base = (const char*)ctx->descriptors[i].ptr;
+        if (p >= base && p < base + ctx->descriptors[i].size) {
+            return &ctx->descriptors[i];
+        }
+    }
+    return NULL;
+}
+
+static bool is_native_level(retryix_svm_level_t level) {
+    return level == RETRYIX_SVM_LEVEL_COARSE_GRAIN || level == RETRYIX_SVM_LEVEL_FINE_GRAIN ||
+           level == RETRYIX_SVM_LEVEL_FINE_GRAIN_SYSTEM;
+}
 
 // 檢測設備 SVM 能力的實現
 retryix_svm_level_t retryix_svm_probe_capabilities(cl_device_id device, cl_bitfield* capabilities) {
@@ -152,6 +183,7 @@ retryix_svm_context_t* retryix_svm_create_context(cl_context context, cl_device_
         free(ctx);
         return NULL;
     }
+    rix_mutex_init_recursive(&ctx->lock);
     
     printf("RetryIX SVM Context Created\n");
     printf("  SVM Level: %d\n", ctx->max_svm_level);
@@ -195,7 +227,7 @@ void* retryix_svm_alloc(retryix_svm_context_t* ctx, size_t size, retryix_svm_fla
             
             ptr = clSVMAlloc(ctx->context, svm_flags, aligned_size, ctx->svm_alignment);
             desc.level = ctx->max_svm_level;
-            desc.is_mapped = true;
+            desc.is_mapped = (ctx->max_svm_level != RETRYIX_SVM_LEVEL_COARSE_GRAIN); // 粗粒度需顯式映射
             
             if (ptr) {
                 printf("Native SVM allocation: %p (%zu bytes, level %d)\n", ptr, aligned_size, desc.level);
@@ -228,11 +260,21 @@ void* retryix_svm_alloc(retryix_svm_context_t* ctx, size_t size, retryix_svm_fla
     }
     
     if (ptr) {
+        rix_mutex_lock(&ctx->lock);
         // 添加到描述符陣列
         if (ctx->descriptor_count >= ctx->descriptor_capacity) {
-            ctx->descriptor_capacity *= 2;
-            ctx->descriptors = (retryix_svm_descriptor_t*)realloc(ctx->descriptors, 
-                                ctx->descriptor_capacity * sizeof(retryix_svm_descriptor_t));
+            size_t capacity = ctx->descriptor_capacity * 2;
+            retryix_svm_descriptor_t* grown = (retryix_svm_descriptor_t*)realloc(ctx->descriptors,
+                                               capacity * sizeof(retryix_svm_descriptor_t));
+            if (!grown) {
+                rix_mutex_unlock(&ctx->lock);
+                if (desc.fallback_mem) clReleaseMemObject(desc.fallback_mem);
+                if (is_native_level(desc.level)) clSVMFree(ctx->context, ptr);
+                else aligned_free(ptr);
+                return NULL;
+            }
+            ctx->descriptors = grown;
+            ctx->descriptor_capacity = capacity;
         }
         
         desc.ptr = ptr;
@@ -244,15 +286,14 @@ void* retryix_svm_alloc(retryix_svm_context_t* ctx, size_t size, retryix_svm_fla
         if (ctx->total_allocated > ctx->peak_allocated) {
             ctx->peak_allocated = ctx->total_allocated;
         }
+        rix_mutex_unlock(&ctx->lock);
     }
     
     return ptr;
 }
 
 // 釋放 SVM 記憶體
-int retryix_svm_free(retryix_svm_context_t* ctx, void* ptr) {
-    if (!ctx || !ptr) return -1;
-    
+static int svm_free_locked(retryix_svm_context_t* ctx, void* ptr) {
     // 查找描述符
     for (size_t i = 0; i < ctx->descriptor_count; i++) {
         if (ctx->descriptors[i].ptr == ptr) {
@@ -263,6 +304,9 @@ int retryix_svm_free(retryix_svm_context_t* ctx, void* ptr) {
                 return 0; // 仍有其他引用
             }
             
+            // 等待仍在使用此記憶體的命令
+            rix_hazard_sync(&desc->hazard);
+            
             // 根據類型釋放記憶體
             switch (desc->level) {
                 case RETRYIX_SVM_LEVEL_FINE_GRAIN_SYSTEM:
@@ -298,10 +342,17 @@ int retryix_svm_free(retryix_svm_context_t* ctx, void* ptr) {
     return -1; // 未找到
 }
 
-// SVM 記憶體映射
-int retryix_svm_map(retryix_svm_context_t* ctx, void* ptr, cl_command_queue queue) {
-    if (!ctx || !ptr || !queue) return -1;
+int retryix_svm_free(retryix_svm_context_t* ctx, void* ptr) {
+    if (!ctx || !ptr) return -1;
     
+    rix_mutex_lock(&ctx->lock);
+    int rc = svm_free_locked(ctx, ptr);
+    rix_mutex_unlock(&ctx->lock);
+    return rc;
+}
+
+// SVM 記憶體映射
+static int svm_map_locked(retryix_svm_context_t* ctx, void* ptr, cl_command_queue queue) {
     // 查找描述符
     for (size_t i = 0; i < ctx->descriptor_count; i++) {
         if (ctx->descriptors[i].ptr == ptr) {
@@ -311,20 +362,27 @@ int retryix_svm_map(retryix_svm_context_t* ctx, void* ptr, cl_command_queue queu
             
             cl_int err = CL_SUCCESS;
             switch (desc->level) {
-                case RETRYIX_SVM_LEVEL_COARSE_GRAIN:
-                    // 粗粒度 SVM 需要顯式映射
-                    err = clEnqueueSVMMap(queue, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, ptr, desc->size, 0, NULL, NULL);
+                case RETRYIX_SVM_LEVEL_COARSE_GRAIN: {
+                    // 粗粒度 SVM 需要顯式映射（讀寫映射：等待未完成的讀取或最後寫入）
+                    cl_event waits[RETRYIX_MAX_HAZARD_WAITS];
+                    cl_uint num_waits = 0;
+                    rix_hazard_waits_or_sync(&desc->hazard, true, waits, RETRYIX_MAX_HAZARD_WAITS, &num_waits);
+                    err = clEnqueueSVMMap(queue, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, ptr, desc->size,
+                                          num_waits, num_waits ? waits : NULL, NULL);
                     break;
+                }
                     
                 case RETRYIX_SVM_LEVEL_FINE_GRAIN:
                 case RETRYIX_SVM_LEVEL_FINE_GRAIN_SYSTEM:
-                    // 細粒度 SVM 自動映射
+                    // 細粒度 SVM 自動映射，主機存取前仍需等待設備命令
+                    rix_hazard_sync(&desc->hazard);
                     break;
                     
                 case RETRYIX_SVM_LEVEL_EMULATED:
                 case RETRYIX_SVM_LEVEL_NONE:
                 default:
-                    // 模擬 SVM 不需要映射
+                    // 模擬 SVM 不需要映射，主機存取前仍需等待設備命令
+                    rix_hazard_sync(&desc->hazard);
                     break;
             }
             
@@ -339,10 +397,17 @@ int retryix_svm_map(retryix_svm_context_t* ctx, void* ptr, cl_command_queue queu
     return -1;
 }
 
-// SVM 記憶體解映射
-int retryix_svm_unmap(retryix_svm_context_t* ctx, void* ptr, cl_command_queue queue) {
+int retryix_svm_map(retryix_svm_context_t* ctx, void* ptr, cl_command_queue queue) {
     if (!ctx || !ptr || !queue) return -1;
     
+    rix_mutex_lock(&ctx->lock);
+    int rc = svm_map_locked(ctx, ptr, queue);
+    rix_mutex_unlock(&ctx->lock);
+    return rc;
+}
+
+// SVM 記憶體解映射
+static int svm_unmap_locked(retryix_svm_context_t* ctx, void* ptr, cl_command_queue queue) {
     // 查找描述符
     for (size_t i = 0; i < ctx->descriptor_count; i++) {
         if (ctx->descriptors[i].ptr == ptr) {
@@ -350,11 +415,13 @@ int retryix_svm_unmap(retryix_svm_context_t* ctx, void* ptr, cl_command_queue qu
             
             if (!desc->is_mapped) return 0; // 已經解映射
             
+            // 解映射後設備端看到主機的修改，視為一次寫入
             cl_int err = CL_SUCCESS;
+            cl_event ev = NULL;
             switch (desc->level) {
                 case RETRYIX_SVM_LEVEL_COARSE_GRAIN:
                     // 粗粒度 SVM 需要顯式解映射
-                    err = clEnqueueSVMUnmap(queue, ptr, 0, NULL, NULL);
+                    err = clEnqueueSVMUnmap(queue, ptr, 0, NULL, &ev);
                     break;
                     
                 case RETRYIX_SVM_LEVEL_FINE_GRAIN:
@@ -367,11 +434,20 @@ int retryix_svm_unmap(retryix_svm_context_t* ctx, void* ptr, cl_command_queue qu
                 default:
                     // 模擬 SVM：需要顯式拷貝數據
                     if (desc->fallback_mem) {
-                        err = clEnqueueWriteBuffer(queue, desc->fallback_mem, CL_TRUE, 0, desc->size, ptr, 0, NULL, NULL);
+                        cl_event waits[RETRYIX_MAX_HAZARD_WAITS];
+                        cl_uint num_waits = 0;
+                        rix_hazard_waits_or_sync(&desc->hazard, true, waits, RETRYIX_MAX_HAZARD_WAITS, &num_waits);
+                        err = clEnqueueWriteBuffer(queue, desc->fallback_mem, CL_TRUE, 0, desc->size, ptr,
+                                                   num_waits, num_waits ? waits : NULL, &ev);
                     }
                     break;
             }
             
+            if (ev) {
+                if (err == CL_SUCCESS) rix_hazard_record(&desc->hazard, true, ev);
+                clReleaseEvent(ev);
+            }
+            
             if (err == CL_SUCCESS) {
                 desc->is_mapped = false;
                 return 0;
@@ -383,6 +459,253 @@ int retryix_svm_unmap(retryix_svm_context_t* ctx, void* ptr, cl_command_queue qu
     return -1;
 }
 
+int retryix_svm_unmap(retryix_svm_context_t* ctx, void* ptr, cl_command_queue queue) {
+    if (!ctx || !ptr || !queue) return -1;
+    
+    rix_mutex_lock(&ctx->lock);
+    int rc = svm_unmap_locked(ctx, ptr, queue);
+    rix_mutex_unlock(&ctx->lock);
+    return rc;
+}
+
+// 收集設備端存取 SVM 記憶體前需等待的事件
+int retryix_svm_hazard_waits(retryix_svm_context_t* ctx, void* ptr, retryix_access_t access,
+                             cl_event* waits, cl_uint max_waits, cl_uint* num_waits) {
+    if (!ctx || !ptr || !num_waits || (max_waits && !waits)) return -1;
+    
+    rix_mutex_lock(&ctx->lock);
+    retryix_svm_descriptor_t* desc = find_svm_descriptor(ctx, ptr);
+    int rc = desc ? rix_hazard_waits(&desc->hazard, (access & RETRYIX_ACCESS_WRITE) != 0, waits, max_waits, num_waits)
+                  : -1;
+    rix_mutex_unlock(&ctx->lock);
+    return rc;
+}
+
+// 登記已排入的存取事件
+int retryix_svm_hazard_record(retryix_svm_context_t* ctx, void* ptr, retryix_access_t access, cl_event event) {
+    if (!ctx || !ptr || !event) return -1;
+    
+    rix_mutex_lock(&ctx->lock);
+    retryix_svm_descriptor_t* desc = find_svm_descriptor(ctx, ptr);
+    if (desc) rix_hazard_record(&desc->hazard, (access & RETRYIX_ACCESS_WRITE) != 0, event);
+    rix_mutex_unlock(&ctx->lock);
+    return desc ? 0 : -1;
+}
+
+// 等待 SVM 記憶體所有未完成的存取
+int retryix_svm_sync(retryix_svm_context_t* ctx, void* ptr) {
+    if (!ctx || !ptr) return -1;
+    
+    rix_mutex_lock(&ctx->lock);
+    retryix_svm_descriptor_t* desc = find_svm_descriptor(ctx, ptr);
+    if (desc) rix_hazard_sync(&desc->hazard);
+    rix_mutex_unlock(&ctx->lock);
+    return desc ? 0 : -1;
+}
+
+void retryix_svm_lock(retryix_svm_context_t* ctx) {
+    if (ctx) rix_mutex_lock(&ctx->lock);
+}
+
+void retryix_svm_unlock(retryix_svm_context_t* ctx) {
+    if (ctx) rix_mutex_unlock(&ctx->lock);
+}
+
+// 標記配置會經由其他 SVM 結構內的指標被內核存取（啟動時以 CL_KERNEL_EXEC_INFO_SVM_PTRS 登記）
+int retryix_svm_set_indirect(retryix_svm_context_t* ctx, void* ptr, int indirect) {
+    if (!ctx || !ptr) return -1;
+    
+    rix_mutex_lock(&ctx->lock);
+    retryix_svm_descriptor_t* desc = find_svm_descriptor(ctx, ptr);
+    if (desc) {
+        if (indirect && !is_native_level(desc->level)) {
+            printf("WARNING: emulated SVM %p cannot be dereferenced indirectly by kernels\n", ptr);
+        }
+        desc->indirect = indirect != 0;
+    }
+    rix_mutex_unlock(&ctx->lock);
+    return desc ? 0 : -1;
+}
+
+// 綁定 SVM 內核參數：原生等級使用 clSetKernelArgSVMPointer，模擬等級綁定回退緩衝區
+int retryix_svm_set_kernel_arg(retryix_svm_context_t* ctx, cl_kernel kernel, cl_uint arg_index, void* ptr) {
+    if (!ctx || !kernel || !ptr) return -1;
+    
+    rix_mutex_lock(&ctx->lock);
+    retryix_svm_descriptor_t* desc = find_containing_descriptor(ctx, ptr);
+    cl_int err = CL_INVALID_ARG_VALUE;
+    if (desc && is_native_level(desc->level)) {
+        err = clSetKernelArgSVMPointer(kernel, arg_index, ptr);
+    } else if (desc && ptr != desc->ptr) {
+        printf("ERROR: emulated SVM argument must point to the start of its allocation\n");
+    } else if (desc) {
+        err = clSetKernelArg(kernel, arg_index, sizeof(cl_mem), &desc->fallback_mem);
+    }
+    rix_mutex_unlock(&ctx->lock);
+    if (!desc) return -1;
+    
+    if (err != CL_SUCCESS) {
+        printf("Failed to bind SVM argument %u: %d\n", arg_index, err);
+        return -1;
+    }
+    return 0;
+}
+
+// 啟動涉及的描述符：直接參數與所有間接存取的配置
+static bool launch_uses(retryix_svm_context_t* ctx, retryix_svm_descriptor_t* desc,
+                        void* const* ptrs, const retryix_access_t* access, cl_uint count, bool* is_write) {
+    bool used = false;
+    *is_write = false;
+    for (cl_uint i = 0; i < count; i++) {
+        if (find_containing_descriptor(ctx, ptrs[i]) == desc) {
+            used = true;
+            if (!access || (access[i] & RETRYIX_ACCESS_WRITE)) *is_write = true;
+        }
+    }
+    if (desc->indirect) {
+        used = true;
+        *is_write = true;                   // 間接存取無法推斷模式，視為讀寫
+    }
+    return used;
+}
+
+// begin_launch 或排入內核失敗時復原：重新映射本次自動解映射的粗粒度配置並清除其標記，主機仍可繼續存取
+static void restore_auto_unmapped(retryix_svm_context_t* ctx, cl_command_queue queue) {
+    for (size_t i = 0; i < ctx->descriptor_count; i++) {
+        retryix_svm_descriptor_t* desc = &ctx->descriptors[i];
+        if (!desc->auto_unmapped) continue;
+        
+        cl_event waits[RETRYIX_MAX_HAZARD_WAITS];
+        cl_uint num_waits = 0;
+        rix_hazard_waits_or_sync(&desc->hazard, true, waits, RETRYIX_MAX_HAZARD_WAITS, &num_waits);
+        if (clEnqueueSVMMap(queue, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, desc->ptr, desc->size,
+                            num_waits, num_waits ? waits : NULL, NULL) == CL_SUCCESS) {
+            desc->is_mapped = true;
+        }
+        desc->auto_unmapped = false;
+    }
+}
+
+// 啟動前準備：登記間接存取的配置、解映射主機仍持有的粗粒度配置，並收集相依等待事件
+// 等待清單空間不足時改為主機端等待該配置完成
+static int svm_begin_launch_locked(retryix_svm_context_t* ctx, cl_kernel kernel, cl_command_queue queue,
+                                   void* const* ptrs, const retryix_access_t* access, cl_uint count,
+                                   cl_event* waits, cl_uint max_waits, cl_uint* num_waits) {
+    // 本次使用的原生配置：間接存取者必須登記；直接參數一併列入，
+    // 使每次啟動都覆寫內核上次留下的 SVM_PTRS（可能指向已釋放的配置）
+    void** listed = NULL;
+    cl_uint listed_count = 0;
+    
+    for (size_t i = 0; i < ctx->descriptor_count; i++) {
+        retryix_svm_descriptor_t* desc = &ctx->descriptors[i];
+        bool is_write;
+        if (!launch_uses(ctx, desc, ptrs, access, count, &is_write)) continue;
+        
+        if (is_native_level(desc->level)) {
+            if (!listed) listed = (void**)malloc(ctx->descriptor_count * sizeof(void*));
+            if (!listed) {
+                restore_auto_unmapped(ctx, queue);
+                return -1;
+            }
+            listed[listed_count++] = desc->ptr;
+        }
+        
+        // 粗粒度：主機映射期間設備不可存取，先解映射（主機修改視為一次寫入）
+        if (desc->level == RETRYIX_SVM_LEVEL_COARSE_GRAIN && desc->is_mapped) {
+            cl_event ev = NULL;
+            if (clEnqueueSVMUnmap(queue, desc->ptr, 0, NULL, &ev) != CL_SUCCESS) {
+                free(listed);
+                restore_auto_unmapped(ctx, queue);
+                return -1;
+            }
+            rix_hazard_record(&desc->hazard, true, ev);
+            clReleaseEvent(ev);
+            desc->is_mapped = false;
+            desc->auto_unmapped = true;
+        }
+        
+        rix_hazard_waits_or_sync(&desc->hazard, is_write, waits, max_waits, num_waits);
+    }
+    
+    cl_int err = CL_SUCCESS;
+    if (listed_count > 0) {
+        err = clSetKernelExecInfo(kernel, CL_KERNEL_EXEC_INFO_SVM_PTRS, listed_count * sizeof(void*), listed);
+    }
+    if (err == CL_SUCCESS && ctx->max_svm_level == RETRYIX_SVM_LEVEL_FINE_GRAIN_SYSTEM) {
+        cl_bool system = CL_TRUE;
+        err = clSetKernelExecInfo(kernel, CL_KERNEL_EXEC_INFO_SVM_FINE_GRAIN_SYSTEM, sizeof(system), &system);
+    }
+    free(listed);
+    
+    if (err != CL_SUCCESS) {
+        printf("Failed to register indirect SVM pointers: %d\n", err);
+        restore_auto_unmapped(ctx, queue);
+        return -1;
+    }
+    return 0;
+}
+
+int retryix_svm_begin_launch(retryix_svm_context_t* ctx, cl_kernel kernel, cl_command_queue queue,
+                             void* const* ptrs, const retryix_access_t* access, cl_uint count,
+                             cl_event* waits, cl_uint max_waits, cl_uint* num_waits) {
+    if (!ctx || !kernel || !queue || !num_waits || (count && !ptrs)) return -1;
+    
+    rix_mutex_lock(&ctx->lock);
+    int rc = svm_begin_launch_locked(ctx, kernel, queue, ptrs, access, count, waits, max_waits, num_waits);
+    rix_mutex_unlock(&ctx->lock);
+    return rc;
+}
+
+// 啟動後：登記內核事件，並重新映射啟動前自動解映射的粗粒度配置（非阻塞，主機存取前呼叫 retryix_svm_sync）
+static int svm_end_launch_locked(retryix_svm_context_t* ctx, cl_command_queue queue,
+                                 void* const* ptrs, const retryix_access_t* access, cl_uint count,
+                                 cl_event event) {
+    int rc = 0;
+    for (size_t i = 0; i < ctx->descriptor_count; i++) {
+        retryix_svm_descriptor_t* desc = &ctx->descriptors[i];
+        bool is_write;
+        if (!launch_uses(ctx, desc, ptrs, access, count, &is_write)) continue;
+        
+        rix_hazard_record(&desc->hazard, is_write, event);
+        
+        if (desc->auto_unmapped) {
+            cl_event ev = NULL;
+            if (clEnqueueSVMMap(queue, CL_FALSE, CL_MAP_READ | CL_MAP_WRITE, desc->ptr, desc->size,
+                                1, &event, &ev) == CL_SUCCESS) {
+                // 映射後由主機讀取，之後的設備寫入需等待
+                rix_hazard_record(&desc->hazard, false, ev);
+                clReleaseEvent(ev);
+                desc->is_mapped = true;
+            } else {
+                rc = -1;
+            }
+            desc->auto_unmapped = false;
+        }
+    }
+    return rc;
+}
+
+int retryix_svm_end_launch(retryix_svm_context_t* ctx, cl_command_queue queue,
+                           void* const* ptrs, const retryix_access_t* access, cl_uint count,
+                           cl_event event) {
+    if (!ctx || !queue || !event || (count && !ptrs)) return -1;
+    
+    rix_mutex_lock(&ctx->lock);
+    int rc = svm_end_launch_locked(ctx, queue, ptrs, access, count, event);
+    rix_mutex_unlock(&ctx->lock);
+    return rc;
+}
+
+// begin_launch 成功但內核未能排入時呼叫（取代 end_launch）
+int retryix_svm_abort_launch(retryix_svm_context_t* ctx, cl_command_queue queue) {
+    if (!ctx || !queue) return -1;
+    
+    rix_mutex_lock(&ctx->lock);
+    restore_auto_unmapped(ctx, queue);
+    rix_mutex_unlock(&ctx->lock);
+    return 0;
+}
+
 // 銷毀 SVM 上下文
 void retryix_svm_destroy_context(retryix_svm_context_t* svm_ctx) {
     if (!svm_ctx) return;
@@ -400,5 +723,6 @@ void retryix_svm_destroy_context(retryix_svm_context_t* svm_ctx) {
     if (svm_ctx->descriptors) {
         free(svm_ctx->descriptors);
     }
+    rix_mutex_destroy(&svm_ctx->lock);
     free(svm_ctx);
 }
\ No newline at end of file
@@ -0,0 +1,280 @@
+// retryix_thread.h
+// Minimal portable threading helpers (Win32 / pthreads) for RetryIX
+#ifndef RETRYIX_THREAD_H
+#define RETRYIX_THREAD_H
+
+#include <stdint.h>
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+// ── Types ────────────────────────────────────────────────────────────────────
+#ifdef _WIN32
+typedef CRITICAL_SECTION   rix_mutex_t;
+typedef CONDITION_VARIABLE rix_cond_t;
+typedef HANDLE             rix_thread_t;
+typedef INIT_ONCE          rix_once_t;
+  #define RIX_ONCE_INIT    INIT_ONCE_STATIC_INIT
+typedef DWORD              rix_thread_ret_t;
+  #define RIX_THREAD_CALL  WINAPI
+  #define RIX_THREAD_RETURN 0
+#else
+typedef pthread_mutex_t    rix_mutex_t;
+typedef pthread_cond_t     rix_cond_t;
+typedef pthread_t          rix_thread_t;
+typedef pthread_once_t     rix_once_t;
+  #define RIX_ONCE_INIT    PTHREAD_ONCE_INIT
+typedef void*              rix_thread_ret_t;
+  #define RIX_THREAD_CALL
+  #define RIX_THREAD_RETURN NULL
+#endif
+
+// 執行緒入口：rix_thread_ret_t RIX_THREAD_CALL fn(void* arg) { ...; return RIX_THREAD_RETURN; }
+typedef rix_thread_ret_t (RIX_THREAD_CALL *rix_thread_fn)(void*);
+
+// ── Mutex ────────────────────────────────────────────────────────────────────
+static inline void rix_mutex_init(rix_mutex_t* m) {
+#ifdef _WIN32
+    InitializeCriticalSection(m);
+#else
+    pthread_mutex_init(m, NULL);
+#endif
+}
+
+// 可重入互斥鎖：同一執行緒可重複鎖定（需相同次數解鎖）；Win32 臨界區本身即可重入
+static inline void rix_mutex_init_recursive(rix_mutex_t* m) {
+#ifdef _WIN32
+    InitializeCriticalSection(m);
+#else
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(m, &attr);
+    pthread_mutexattr_destroy(&attr);
+#endif
+}
+
+static inline void rix_mutex_destroy(rix_mutex_t* m) {
+#ifdef _WIN32
+    DeleteCriticalSection(m);
+#else
+    pthread_mutex_destroy(m);
+#endif
+}
+
+static inline void rix_mutex_lock(rix_mutex_t* m) {
+#ifdef _WIN32
+    EnterCriticalSection(m);
+#else
+    pthread_mutex_lock(m);
+#endif
+}
+
+static inline void rix_mutex_unlock(rix_mutex_t* m) {
+#ifdef _WIN32
+    LeaveCriticalSection(m);
+#else
+    pthread_mutex_unlock(m);
+#endif
+}
+
+// ── Once ─────────────────────────────────────────────────────────────────────
+// fn 在整個行程只執行一次，其他呼叫者等待其完成（延遲初始化全局鎖或單例）
+#ifdef _WIN32
+static inline BOOL CALLBACK rix_once_thunk(PINIT_ONCE once, PVOID fn, PVOID* unused) {
+    (void)once;
+    (void)unused;
+    ((void (*)(void))fn)();
+    return TRUE;
+}
+#endif
+
+static inline void rix_call_once(rix_once_t* once, void (*fn)(void)) {
+#ifdef _WIN32
+    InitOnceExecuteOnce(once, rix_once_thunk, (PVOID)fn, NULL);
+#else
+    pthread_once(once, fn);
+#endif
+}
+
+// ── Condition variable ───────────────────────────────────────────────────────
+static inline void rix_cond_init(rix_cond_t* c) {
+#ifdef _WIN32
+    InitializeConditionVariable(c);
+#else
+    pthread_cond_init(c, NULL);
+#endif
+}
+
+static inline void rix_cond_destroy(rix_cond_t* c) {
+#ifdef _WIN32
+    (void)c; // Win32 條件變數不需釋放
+#else
+    pthread_cond_destroy(c);
+#endif
+}
+
+static inline void rix_cond_wait(rix_cond_t* c, rix_mutex_t* m) {
+#ifdef _WIN32
+    SleepConditionVariableCS(c, m, INFINITE);
+#else
+    pthread_cond_wait(c, m);
+#endif
+}
+
+static inline void rix_cond_signal(rix_cond_t* c) {
+#ifdef _WIN32
+    WakeConditionVariable(c);
+#else
+    pthread_cond_signal(c);
+#endif
+}
+
+static inline void rix_cond_broadcast(rix_cond_t* c) {
+#ifdef _WIN32
+    WakeAllConditionVariable(c);
+#else
+    pthread_cond_broadcast(c);
+#endif
+}
+
+// ── Thread ───────────────────────────────────────────────────────────────────
+// 成功回傳 0
+static inline int rix_thread_create(rix_thread_t* t, rix_thread_fn fn, void* arg) {
+#ifdef _WIN32
+    *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    return *t ? 0 : -1;
+#else
+    return pthread_create(t, NULL, fn, arg) == 0 ? 0 : -1;
+#endif
+}
+
+static inline void rix_thread_join(rix_thread_t t) {
+#ifdef _WIN32
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+#else
+    pthread_join(t, NULL);
+#endif
+}
+
+// ── Thread-local storage / atomics ───────────────────────────────────────────
+#ifdef _WIN32
+  #define RIX_THREAD_LOCAL __declspec(thread)
+#else
+  #define RIX_THREAD_LOCAL __thread
+#endif
+
+static inline int rix_atomic_load_int(volatile int* p) {
+#ifdef _WIN32
+    return (int)InterlockedCompareExchange((volatile LONG*)p, 0, 0);
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void rix_atomic_store_int(volatile int* p, int value) {
+#ifdef _WIN32
+    InterlockedExchange((volatile LONG*)p, (LONG)value);
+#else
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+#endif
+}
+
+// 回傳遞增後的值
+static inline uint32_t rix_atomic_inc_u32(volatile uint32_t* p) {
+#ifdef _WIN32
+    return (uint32_t)InterlockedIncrement((volatile LONG*)p);
+#else
+    return __atomic_add_fetch(p, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline uint64_t rix_atomic_inc_u64(volatile uint64_t* p) {
+#ifdef _WIN32
+    return (uint64_t)InterlockedIncrement64((volatile LONG64*)p);
+#else
+    return __atomic_add_fetch(p, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline void rix_atomic_store_u64(volatile uint64_t* p, uint64_t value) {
+#ifdef _WIN32
+    InterlockedExchange64((volatile LONG64*)p, (LONG64)value);
+#else
+    __atomic_store_n(p, value, __ATOMIC_RELAXED);
+#endif
+}
+
+// 64 位元索引與指標原子操作（工作竊取佇列使用）：load 為 acquire、store 為 release
+static inline int64_t rix_atomic_load_i64(volatile int64_t* p) {
+#ifdef _WIN32
+    return (int64_t)InterlockedCompareExchange64((volatile LONG64*)p, 0, 0);
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void rix_atomic_store_i64(volatile int64_t* p, int64_t value) {
+#ifdef _WIN32
+    InterlockedExchange64((volatile LONG64*)p, (LONG64)value);
+#else
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+#endif
+}
+
+// 成功回傳 1（順序一致）
+static inline int rix_atomic_cas_i64(volatile int64_t* p, int64_t expected, int64_t desired) {
+#ifdef _WIN32
+    return InterlockedCompareExchange64((volatile LONG64*)p, (LONG64)desired, (LONG64)expected) == (LONG64)expected;
+#else
+    return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED) ? 1 : 0;
+#endif
+}
+
+// 回傳相加後的值
+static inline int64_t rix_atomic_add_i64(volatile int64_t* p, int64_t delta) {
+#ifdef _WIN32
+    return (int64_t)InterlockedExchangeAdd64((volatile LONG64*)p, (LONG64)delta) + delta;
+#else
+    return __atomic_add_fetch(p, delta, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void* rix_atomic_load_ptr(void* volatile* p) {
+#ifdef _WIN32
+    return InterlockedCompareExchangePointer(p, NULL, NULL);
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void rix_atomic_store_ptr(void* volatile* p, void* value) {
+#ifdef _WIN32
+    InterlockedExchangePointer(p, value);
+#else
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+#endif
+}
+
+static inline void rix_atomic_fence(void) {
+#ifdef _WIN32
+    MemoryBarrier();
+#else
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void rix_thread_yield(void) {
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+#endif // RETRYIX_THREAD_H
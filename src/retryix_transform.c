@@ -0,0 +1,578 @@
+// retryix_transform.c - RetryIX 傳輸時轉換（AoS↔SoA 拆分、型別轉換與打包於 pinned 暫存區一次完成）
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define RETRYIX_TRANSFORM_SLOTS        2
+#define RETRYIX_TRANSFORM_BLOCK        128     // 每次處理的記錄數：來源記錄區塊留在 L1 內完成所有欄位
+#define RETRYIX_TRANSFORM_MIN_BYTES    65536   // 每個池任務至少處理的位元組數
+
+static const size_t FIELD_SIZES[RETRYIX_FIELD_TYPE_COUNT] = { 1, 1, 2, 2, 4, 4, 2, 4, 8 };
+static const char* FIELD_LABELS[RETRYIX_FIELD_TYPE_COUNT] = { "u8", "i8", "u16", "i16", "u32", "i32", "f16", "f32", "f64" };
+
+typedef struct {
+    cl_context context;
+    cl_device_id device;
+    cl_command_queue queue;
+
+    size_t staging_bytes;
+    cl_mem staging_mem[RETRYIX_TRANSFORM_SLOTS];
+    char* staging_ptr[RETRYIX_TRANSFORM_SLOTS];
+    cl_event staging_events[RETRYIX_TRANSFORM_SLOTS][RETRYIX_TRANSFORM_MAX_FIELDS];
+    cl_uint staging_event_count[RETRYIX_TRANSFORM_SLOTS];
+    int next_slot;
+
+    uint64_t uploaded_records;
+    uint64_t downloaded_records;
+} retryix_transform_context_t;
+
+static retryix_transform_context_t* g_transform_context = NULL;
+
+// 單一次傳輸的欄位配置（暫存區內各欄位為連續 SoA 區段）
+typedef struct {
+    const retryix_layout_t* layout;
+    size_t chunk_records;
+    size_t slot_offset[RETRYIX_TRANSFORM_MAX_FIELDS];
+    size_t host_bytes[RETRYIX_TRANSFORM_MAX_FIELDS];
+    size_t device_bytes[RETRYIX_TRANSFORM_MAX_FIELDS];
+} retryix_transform_plan_t;
+
+typedef struct {
+    const retryix_transform_plan_t* plan;
+    char* records;              // 本段第一筆記錄
+    char* staging;              // 暫存槽
+    size_t count;
+    bool upload;
+} retryix_transform_job_t;
+
+// === 型別轉換 ===
+// 相同型別直接複製；f32↔f16 走 retryix_half（F16C）；其餘經 double 中介
+// （可精確表示所有來源型別），整數目標採最近偶數捨入並飽和，NaN 轉為 0
+
+static void widen_to_double(double* out, const void* in, retryix_field_type_t type, size_t n) {
+    size_t i;
+    switch (type) {
+        case RETRYIX_FIELD_U8:  for (i = 0; i < n; i++) out[i] = ((const uint8_t*)in)[i]; break;
+        case RETRYIX_FIELD_I8:  for (i = 0; i < n; i++) out[i] = ((const int8_t*)in)[i]; break;
+        case RETRYIX_FIELD_U16: for (i = 0; i < n; i++) out[i] = ((const uint16_t*)in)[i]; break;
+        case RETRYIX_FIELD_I16: for (i = 0; i < n; i++) out[i] = ((const int16_t*)in)[i]; break;
+        case RETRYIX_FIELD_U32: for (i = 0; i < n; i++) out[i] = ((const uint32_t*)in)[i]; break;
+        case RETRYIX_FIELD_I32: for (i = 0; i < n; i++) out[i] = ((const int32_t*)in)[i]; break;
+        case RETRYIX_FIELD_F32: for (i = 0; i < n; i++) out[i] = ((const float*)in)[i]; break;
+        case RETRYIX_FIELD_F64: memcpy(out, in, n * sizeof(double)); break;
+        case RETRYIX_FIELD_F16:
+            for (i = 0; i < n; i += 8) {
+                float tmp[8];
+                size_t m = n - i < 8 ? n - i : 8;
+                retryix_half_to_float(tmp, (const cl_half*)in + i, m);
+                for (size_t k = 0; k < m; k++) out[i + k] = tmp[k];
+            }
+            break;
+        default: break;
+    }
+}
+
+static double saturate(double v, double lo, double hi) {
+    if (v != v) return 0.0;
+    v = nearbyint(v);
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static void narrow_from_double(void* out, retryix_field_type_t type, const double* in, size_t n) {
+    size_t i;
+    switch (type) {
+        case RETRYIX_FIELD_U8:  for (i = 0; i < n; i++) ((uint8_t*)out)[i] = (uint8_t)saturate(in[i], 0.0, 255.0); break;
+        case RETRYIX_FIELD_I8:  for (i = 0; i < n; i++) ((int8_t*)out)[i] = (int8_t)saturate(in[i], -128.0, 127.0); break;
+        case RETRYIX_FIELD_U16: for (i = 0; i < n; i++) ((uint16_t*)out)[i] = (uint16_t)saturate(in[i], 0.0, 65535.0); break;
+        case RETRYIX_FIELD_I16: for (i = 0; i < n; i++) ((int16_t*)out)[i] = (int16_t)saturate(in[i], -32768.0, 32767.0); break;
+        case RETRYIX_FIELD_U32: for (i = 0; i < n; i++) ((uint32_t*)out)[i] = (uint32_t)saturate(in[i], 0.0, 4294967295.0); break;
+        case RETRYIX_FIELD_I32: for (i = 0; i < n; i++) ((int32_t*)out)[i] = (int32_t)saturate(in[i], -2147483648.0, 2147483647.0); break;
+        case RETRYIX_FIELD_F32: for (i = 0; i < n; i++) ((float*)out)[i] = (float)in[i]; break;
+        case RETRYIX_FIELD_F64: memcpy(out, in, n * sizeof(double)); break;
+        case RETRYIX_FIELD_F16:
+            for (i = 0; i < n; i += 8) {
+                float tmp[8];
+                size_t m = n - i < 8 ? n - i : 8;
+                for (size_t k = 0; k < m; k++) tmp[k] = (float)in[i + k];
+                retryix_half_from_float((cl_half*)out + i, tmp, m);
+            }
+            break;
+        default: break;
+    }
+}
+
+static void convert_elements(void* dst, retryix_field_type_t dst_type, const void* src, retryix_field_type_t src_type,
+                             size_t n, double* scratch) {
+    if (dst_type == src_type) {
+        memcpy(dst, src, n * FIELD_SIZES[src_type]);
+    } else if (src_type == RETRYIX_FIELD_F32 && dst_type == RETRYIX_FIELD_F16) {
+        retryix_half_from_float((cl_half*)dst, (const float*)src, n);
+    } else if (src_type == RETRYIX_FIELD_F16 && dst_type == RETRYIX_FIELD_F32) {
+        retryix_half_to_float((float*)dst, (const cl_half*)src, n);
+    } else {
+        widen_to_double(scratch, src, src_type, n);
+        narrow_from_double(dst, dst_type, scratch, n);
+    }
+}
+
+// === 平行處理 ===
+
+// 以區塊為單位處理記錄：每個區塊依序處理所有欄位，來源/目的記錄只經過一次
+static void transform_range(void* arg, size_t first_block, size_t last_block) {
+    const retryix_transform_job_t* job = (const retryix_transform_job_t*)arg;
+    const retryix_transform_plan_t* plan = job->plan;
+    const retryix_layout_t* layout = plan->layout;
+    // 以 double 宣告保證對齊：轉換時會以 float/double/cl_half 存取
+    double gather[RETRYIX_TRANSFORM_BLOCK * RETRYIX_TRANSFORM_MAX_COMPONENTS];
+    double scratch[RETRYIX_TRANSFORM_BLOCK * RETRYIX_TRANSFORM_MAX_COMPONENTS];
+
+    for (size_t blk = first_block; blk < last_block; blk++) {
+        size_t b = blk * RETRYIX_TRANSFORM_BLOCK;
+        size_t n = job->count - b < RETRYIX_TRANSFORM_BLOCK ? job->count - b : RETRYIX_TRANSFORM_BLOCK;
+        const char* rec = job->records + b * layout->stride;
+        char* rec_out = job->records + b * layout->stride;
+
+        for (cl_uint f = 0; f < layout->num_fields; f++) {
+            const retryix_field_desc_t* field = &layout->fields[f];
+            size_t hb = plan->host_bytes[f];
+            char* soa = job->staging + plan->slot_offset[f] + b * plan->device_bytes[f];
+            bool same = (field->host_type == field->device_type);
+            size_t elements = n * field->components;
+
+            if (job->upload) {
+                char* packed = same ? soa : (char*)gather;
+                for (size_t r = 0; r < n; r++) memcpy(packed + r * hb, rec + r * layout->stride + field->offset, hb);
+                if (!same) convert_elements(soa, field->device_type, gather, field->host_type, elements, scratch);
+            } else {
+                const char* packed = soa;
+                if (!same) {
+                    convert_elements(gather, field->host_type, soa, field->device_type, elements, scratch);
+                    packed = (const char*)gather;
+                }
+                for (size_t r = 0; r < n; r++) memcpy(rec_out + r * layout->stride + field->offset, packed + r * hb, hb);
+            }
+        }
+    }
+}
+
+// 以區塊為單位交由共用執行緒池；每個任務至少 MIN_BYTES，區塊不會被拆開
+static void run_transform(const retryix_transform_plan_t* plan, char* records, char* staging, size_t count,
+                          size_t record_bytes, bool upload) {
+    retryix_transform_job_t job = { plan, records, staging, count, upload };
+    size_t blocks = (count + RETRYIX_TRANSFORM_BLOCK - 1) / RETRYIX_TRANSFORM_BLOCK;
+    size_t block_bytes = RETRYIX_TRANSFORM_BLOCK * (record_bytes ? record_bytes : 1);
+    size_t grain = (RETRYIX_TRANSFORM_MIN_BYTES + block_bytes - 1) / block_bytes;
+    retryix_pool_parallel_for(blocks, grain, transform_range, &job);
+}
+
+// === 暫存區 ===
+
+static void wait_slot(retryix_transform_context_t* ctx, int slot) {
+    if (ctx->staging_event_count[slot] > 0) {
+        clWaitForEvents(ctx->staging_event_count[slot], ctx->staging_events[slot]);
+        for (cl_uint i = 0; i < ctx->staging_event_count[slot]; i++) clReleaseEvent(ctx->staging_events[slot][i]);
+        ctx->staging_event_count[slot] = 0;
+    }
+}
+
+static int acquire_slot(retryix_transform_context_t* ctx) {
+    int slot = ctx->next_slot;
+    ctx->next_slot = (ctx->next_slot + 1) % RETRYIX_TRANSFORM_SLOTS;
+    wait_slot(ctx, slot);
+    return slot;
+}
+
+static void drain_slots(retryix_transform_context_t* ctx) {
+    for (int s = 0; s < RETRYIX_TRANSFORM_SLOTS; s++) wait_slot(ctx, s);
+}
+
+static void release_staging(retryix_transform_context_t* ctx) {
+    drain_slots(ctx);
+    for (int s = 0; s < RETRYIX_TRANSFORM_SLOTS; s++) {
+        if (ctx->staging_ptr[s]) {
+            clEnqueueUnmapMemObject(ctx->queue, ctx->staging_mem[s], ctx->staging_ptr[s], 0, NULL, NULL);
+            ctx->staging_ptr[s] = NULL;
+        }
+        if (ctx->staging_mem[s]) {
+            clReleaseMemObject(ctx->staging_mem[s]);
+            ctx->staging_mem[s] = NULL;
+        }
+    }
+    clFinish(ctx->queue);
+}
+
+static int create_staging(retryix_transform_context_t* ctx) {
+    for (int s = 0; s < RETRYIX_TRANSFORM_SLOTS; s++) {
+        cl_int err;
+        ctx->staging_mem[s] = clCreateBuffer(ctx->context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,
+                                             ctx->staging_bytes, NULL, &err);
+        if (err != CL_SUCCESS || !ctx->staging_mem[s]) {
+            ctx->staging_mem[s] = NULL;
+            return -1;
+        }
+        ctx->staging_ptr[s] = (char*)clEnqueueMapBuffer(ctx->queue, ctx->staging_mem[s], CL_TRUE, CL_MAP_READ | CL_MAP_WRITE,
+                                                        0, ctx->staging_bytes, 0, NULL, NULL, &err);
+        if (err != CL_SUCCESS || !ctx->staging_ptr[s]) {
+            ctx->staging_ptr[s] = NULL;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 驗證佈局並計算暫存槽內各欄位區段
+static int make_plan(retryix_transform_context_t* ctx, const retryix_layout_t* layout, retryix_transform_plan_t* plan,
+                     size_t* record_bytes) {
+    if (!layout || !layout->fields || layout->num_fields == 0 || layout->num_fields > RETRYIX_TRANSFORM_MAX_FIELDS) return -1;
+    size_t device_total = 0;
+    size_t host_total = 0;
+    plan->layout = layout;
+    for (cl_uint f = 0; f < layout->num_fields; f++) {
+        const retryix_field_desc_t* field = &layout->fields[f];
+        if (field->host_type < 0 || field->host_type >= RETRYIX_FIELD_TYPE_COUNT) return -1;
+        if (field->device_type < 0 || field->device_type >= RETRYIX_FIELD_TYPE_COUNT) return -1;
+        if (field->components == 0 || field->components > RETRYIX_TRANSFORM_MAX_COMPONENTS) return -1;
+        plan->host_bytes[f] = FIELD_SIZES[field->host_type] * field->components;
+        plan->device_bytes[f] = FIELD_SIZES[field->device_type] * field->components;
+        if (field->offset + plan->host_bytes[f] > layout->stride) return -1;
+        device_total += plan->device_bytes[f];
+        host_total += plan->host_bytes[f];
+    }
+
+    size_t chunk = ctx->staging_bytes / device_total;
+    if (chunk >= 64) chunk &= ~(size_t)63;   // 區段起點維持 8 位元組對齊
+    if (chunk == 0) return -1;
+    size_t offset = 0;
+    for (cl_uint f = 0; f < layout->num_fields; f++) {
+        plan->slot_offset[f] = offset;
+        offset += chunk * plan->device_bytes[f];
+    }
+    plan->chunk_records = chunk;
+    *record_bytes = host_total > device_total ? host_total : device_total;
+    return 0;
+}
+
+// 以暫存槽排入各欄位的傳輸，設備緩衝區相依追蹤與一般傳輸一致
+static int enqueue_fields(retryix_transform_context_t* ctx, const retryix_transform_plan_t* plan, void* const* buffers,
+                          int slot, size_t first, size_t count, bool write) {
+    retryix_access_t access = write ? RETRYIX_ACCESS_WRITE : RETRYIX_ACCESS_READ;
+    for (cl_uint f = 0; f < plan->layout->num_fields; f++) {
+        cl_mem mem = retryix_memory_get_device_mem(buffers[f]);
+        if (!mem) return -1;
+        cl_event waits[RETRYIX_MAX_HAZARD_WAITS];
+        cl_uint num_waits = 0;
+        retryix_memory_lock();              // 收集等待至登記事件之間不可被其他執行緒插入
+        if (retryix_memory_hazard_waits(buffers[f], access, waits, RETRYIX_MAX_HAZARD_WAITS, &num_waits) != 0) {
+            // 等待清單溢位：改為主機端等待所有未完成存取，不可遺漏相依
+            num_waits = 0;
+            retryix_memory_sync(buffers[f]);
+        }
+
+        size_t bytes = plan->device_bytes[f];
+        char* host = ctx->staging_ptr[slot] + plan->slot_offset[f];
+        cl_event ev = NULL;
+        cl_int err = write
+            ? clEnqueueWriteBuffer(ctx->queue, mem, CL_FALSE, first * bytes, count * bytes, host,
+                                   num_waits, num_waits ? waits : NULL, &ev)
+            : clEnqueueReadBuffer(ctx->queue, mem, CL_FALSE, first * bytes, count * bytes, host,
+                                  num_waits, num_waits ? waits : NULL, &ev);
+        if (err != CL_SUCCESS) {
+            retryix_memory_unlock();
+            printf("Transform: field %u transfer failed (%s)\n", f, rixCLErrorName(err));
+            return -1;
+        }
+        retryix_memory_hazard_record(buffers[f], access, ev);
+        retryix_memory_unlock();
+        ctx->staging_events[slot][ctx->staging_event_count[slot]++] = ev;
+    }
+    return 0;
+}
+
+// === 公開 API ===
+
+int retryix_transform_init(cl_context context, cl_device_id device, cl_command_queue queue) {
+    if (g_transform_context) return 0;
+    if (!context || !device || !queue) return -1;
+    if (!retryix_memory_init(context, device)) return -1;
+
+    retryix_transform_context_t* ctx = (retryix_transform_context_t*)calloc(1, sizeof(retryix_transform_context_t));
+    if (!ctx) return -1;
+
+    ctx->context = context;
+    ctx->device = device;
+    ctx->queue = queue;
+
+    unsigned long staging_kb = retryix_config_get_dword("Transform", "StagingKB", 8192);
+    if (staging_kb < 256) staging_kb = 256;
+    ctx->staging_bytes = (size_t)staging_kb * 1024;
+
+    if (create_staging(ctx) != 0) {
+        release_staging(ctx);
+        free(ctx);
+        return -1;
+    }
+
+    g_transform_context = ctx;
+
+    printf("RetryIX Transform Staging Initialized\n");
+    printf("  Pool workers: %d, staging: 2 x %lu KB pinned\n", retryix_pool_size(), staging_kb);
+    return 0;
+}
+
+void retryix_transform_cleanup(void) {
+    retryix_transform_context_t* ctx = g_transform_context;
+    if (!ctx) return;
+    release_staging(ctx);
+    free(ctx);
+    g_transform_context = NULL;
+}
+
+size_t retryix_transform_field_bytes(const retryix_layout_t* layout, cl_uint field, size_t count) {
+    if (!layout || !layout->fields || field >= layout->num_fields) return 0;
+    const retryix_field_desc_t* desc = &layout->fields[field];
+    if (desc->device_type < 0 || desc->device_type >= RETRYIX_FIELD_TYPE_COUNT) return 0;
+    return FIELD_SIZES[desc->device_type] * desc->components * count;
+}
+
+const char* retryix_transform_type_name(retryix_field_type_t type) {
+    if (type < 0 || type >= RETRYIX_FIELD_TYPE_COUNT) return "unknown";
+    return FIELD_LABELS[type];
+}
+
+// AoS 記錄 -> 各欄位 SoA 設備緩衝區：拆分、轉換與打包一次寫入 pinned 暫存區，
+// 下一段的轉換與上一段的 DMA 重疊。非阻塞時 records 於返回後即可重用
+int retryix_transform_upload(const retryix_layout_t* layout, const void* records, size_t count,
+                             void* const* buffers, int blocking) {
+    retryix_transform_context_t* ctx = g_transform_context;
+    if (!ctx || !records || !buffers || count == 0) return -1;
+    retryix_transform_plan_t plan;
+    size_t record_bytes = 0;
+    if (make_plan(ctx, layout, &plan, &record_bytes) != 0) return -1;
+
+    for (size_t done = 0; done < count; ) {
+        size_t n = count - done < plan.chunk_records ? count - done : plan.chunk_records;
+        int slot = acquire_slot(ctx);
+        run_transform(&plan, (char*)records + done * layout->stride, ctx->staging_ptr[slot], n, record_bytes, true);
+        if (enqueue_fields(ctx, &plan, buffers, slot, done, n, true) != 0) {
+            drain_slots(ctx);
+            return -1;
+        }
+        done += n;
+    }
+    ctx->uploaded_records += count;
+    if (blocking) drain_slots(ctx);
+    return 0;
+}
+
+// 各欄位 SoA 設備緩衝區 -> AoS 記錄（阻塞）：只寫入佈局描述的欄位，其餘位元組不變
+int retryix_transform_download(const retryix_layout_t* layout, void* records, size_t count, void* const* buffers) {
+    retryix_transform_context_t* ctx = g_transform_context;
+    if (!ctx || !records || !buffers || count == 0) return -1;
+    retryix_transform_plan_t plan;
+    size_t record_bytes = 0;
+    if (make_plan(ctx, layout, &plan, &record_bytes) != 0) return -1;
+
+    drain_slots(ctx);
+    size_t chunk = plan.chunk_records;
+    int slot = acquire_slot(ctx);
+    if (enqueue_fields(ctx, &plan, buffers, slot, 0, count < chunk ? count : chunk, false) != 0) {
+        drain_slots(ctx);
+        return -1;
+    }
+
+    for (size_t done = 0; done < count; ) {
+        size_t n = count - done < chunk ? count - done : chunk;
+        size_t next = done + n;
+        int current = slot;
+        if (next < count) {
+            slot = acquire_slot(ctx);
+            size_t next_n = count - next < chunk ? count - next : chunk;
+            if (enqueue_fields(ctx, &plan, buffers, slot, next, next_n, false) != 0) {
+                drain_slots(ctx);
+                return -1;
+            }
+        }
+        wait_slot(ctx, current);
+        run_transform(&plan, (char*)records + done * layout->stride, ctx->staging_ptr[current], n, record_bytes, false);
+        done = next;
+    }
+    ctx->downloaded_records += count;
+    return 0;
+}
+
+// === 量測 ===
+
+typedef struct {
+    float position[3];
+    double mass;
+    int32_t id;
+    uint8_t flags;
+} retryix_transform_bench_record_t;
+
+static const retryix_field_desc_t BENCH_FIELDS[] = {
+    { offsetof(retryix_transform_bench_record_t, position), RETRYIX_FIELD_F32, RETRYIX_FIELD_F16, 3 },
+    { offsetof(retryix_transform_bench_record_t, mass),     RETRYIX_FIELD_F64, RETRYIX_FIELD_F32, 1 },
+    { offsetof(retryix_transform_bench_record_t, id),       RETRYIX_FIELD_I32, RETRYIX_FIELD_I32, 1 },
+    { offsetof(retryix_transform_bench_record_t, flags),    RETRYIX_FIELD_U8,  RETRYIX_FIELD_U8,  1 }
+};
+#define BENCH_FIELD_COUNT ((cl_uint)(sizeof(BENCH_FIELDS) / sizeof(BENCH_FIELDS[0])))
+
+static double best_of(int iterations, const double* samples) {
+    double best = -1.0;
+    for (int i = 0; i < iterations; i++) {
+        if (samples[i] > 0.0 && (best < 0.0 || samples[i] < best)) best = samples[i];
+    }
+    return best;
+}
+
+// 基準做法：先於主機拆分/轉換到各欄位的主機影子，再逐欄位 copy_to_device（兩次走訪）
+static int two_pass_upload(const retryix_transform_bench_record_t* records, size_t count, void* const* buffers,
+                           cl_command_queue queue) {
+    cl_half* position = (cl_half*)buffers[0];
+    float* mass = (float*)buffers[1];
+    int32_t* id = (int32_t*)buffers[2];
+    uint8_t* flags = (uint8_t*)buffers[3];
+    for (size_t i = 0; i < count; i++) {
+        retryix_half_from_float(position + i * 3, records[i].position, 3);
+        mass[i] = (float)records[i].mass;
+        id[i] = records[i].id;
+        flags[i] = records[i].flags;
+    }
+    for (cl_uint f = 0; f < BENCH_FIELD_COUNT; f++) {
+        if (retryix_memory_copy_to_device(buffers[f], queue, f + 1 == BENCH_FIELD_COUNT) != 0) return -1;
+    }
+    return 0;
+}
+
+static int two_pass_download(retryix_transform_bench_record_t* records, size_t count, void* const* buffers,
+                             cl_command_queue queue) {
+    for (cl_uint f = 0; f < BENCH_FIELD_COUNT; f++) {
+        if (retryix_memory_copy_from_device(buffers[f], queue, true) != 0) return -1;
+    }
+    const cl_half* position = (const cl_half*)buffers[0];
+    const float* mass = (const float*)buffers[1];
+    const int32_t* id = (const int32_t*)buffers[2];
+    const uint8_t* flags = (const uint8_t*)buffers[3];
+    for (size_t i = 0; i < count; i++) {
+        retryix_half_to_float(records[i].position, position + i * 3, 3);
+        records[i].mass = mass[i];
+        records[i].id = id[i];
+        records[i].flags = flags[i];
+    }
+    return 0;
+}
+
+static int run_transform_benchmark(retryix_transform_context_t* ctx, size_t count, int iterations,
+                                   retryix_transform_bench_record_t* records, retryix_transform_bench_record_t* result,
+                                   void* const* buffers, double* samples) {
+    retryix_layout_t layout = { sizeof(retryix_transform_bench_record_t), BENCH_FIELDS, BENCH_FIELD_COUNT };
+    int failures = 0;
+
+    uint32_t seed = 11u;
+    for (size_t i = 0; i < count; i++) {
+        for (int c = 0; c < 3; c++) {
+            seed = seed * 1664525u + 1013904223u;
+            records[i].position[c] = (float)(seed >> 8) / (float)(1u << 24) * 100.0f - 50.0f;
+        }
+        records[i].mass = 1.0 + (double)(i % 1000) * 0.001;
+        records[i].id = (int32_t)i;
+        records[i].flags = (uint8_t)(i * 7);
+    }
+
+    printf("\n=== RetryIX Transform Staging Benchmark (%zu records, %zu -> %zu bytes each) ===\n", count,
+           sizeof(retryix_transform_bench_record_t), (size_t)(3 * 2 + 4 + 4 + 1));
+    for (cl_uint f = 0; f < BENCH_FIELD_COUNT; f++) {
+        printf("  field %u: %s x%u -> %s\n", f, retryix_transform_type_name(BENCH_FIELDS[f].host_type),
+               BENCH_FIELDS[f].components, retryix_transform_type_name(BENCH_FIELDS[f].device_type));
+    }
+
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        samples[it] = (two_pass_upload(records, count, buffers, ctx->queue) == 0) ? rixNowMs() - t0 : -1.0;
+    }
+    double split_up = best_of(iterations, samples);
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        samples[it] = (retryix_transform_upload(&layout, records, count, buffers, 1) == 0) ? rixNowMs() - t0 : -1.0;
+    }
+    double fused_up = best_of(iterations, samples);
+
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        samples[it] = (two_pass_download(result, count, buffers, ctx->queue) == 0) ? rixNowMs() - t0 : -1.0;
+    }
+    double split_down = best_of(iterations, samples);
+    memset(result, 0, count * sizeof(retryix_transform_bench_record_t));
+    for (int it = 0; it < iterations; it++) {
+        double t0 = rixNowMs();
+        samples[it] = (retryix_transform_download(&layout, result, count, buffers) == 0) ? rixNowMs() - t0 : -1.0;
+    }
+    double fused_down = best_of(iterations, samples);
+
+    // 驗證：位置經 half 捨入、質量經 float 捨入，其餘欄位原樣
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; i++) {
+        cl_half h[3];
+        float expected[3];
+        retryix_half_from_float(h, records[i].position, 3);
+        retryix_half_to_float(expected, h, 3);
+        if (memcmp(expected, result[i].position, sizeof(expected)) != 0 || result[i].mass != (double)(float)records[i].mass ||
+            result[i].id != records[i].id || result[i].flags != records[i].flags) {
+            mismatches++;
+        }
+    }
+    if (mismatches || fused_up < 0.0 || fused_down < 0.0) failures++;
+
+    double mb = count * sizeof(retryix_transform_bench_record_t) / 1e6;
+    printf("  upload   split+copy %8.3f ms (%7.2f GB/s of AoS)  fused %8.3f ms (%7.2f GB/s of AoS)  %.2fx\n",
+           split_up, split_up > 0.0 ? mb / split_up : 0.0, fused_up, fused_up > 0.0 ? mb / fused_up : 0.0,
+           fused_up > 0.0 ? split_up / fused_up : 0.0);
+    printf("  download copy+merge %8.3f ms (%7.2f GB/s of AoS)  fused %8.3f ms (%7.2f GB/s of AoS)  %.2fx\n",
+           split_down, split_down > 0.0 ? mb / split_down : 0.0, fused_down, fused_down > 0.0 ? mb / fused_down : 0.0,
+           fused_down > 0.0 ? split_down / fused_down : 0.0);
+    printf("  roundtrip: %zu mismatches  %s\n", mismatches, failures ? "FAIL" : "PASS");
+    printf("=====================================================\n\n");
+    return failures;
+}
+
+int retryix_transform_benchmark(size_t count, int iterations) {
+    retryix_transform_context_t* ctx = g_transform_context;
+    if (!ctx || count == 0) return -1;
+    if (iterations <= 0) iterations = 5;
+
+    retryix_layout_t layout = { sizeof(retryix_transform_bench_record_t), BENCH_FIELDS, BENCH_FIELD_COUNT };
+    retryix_transform_bench_record_t* records =
+        (retryix_transform_bench_record_t*)malloc(count * sizeof(retryix_transform_bench_record_t));
+    retryix_transform_bench_record_t* result =
+        (retryix_transform_bench_record_t*)calloc(count, sizeof(retryix_transform_bench_record_t));
+    double* samples = (double*)malloc((size_t)iterations * sizeof(double));
+    void* buffers[BENCH_FIELD_COUNT] = { NULL };
+    bool allocated = true;
+    for (cl_uint f = 0; f < BENCH_FIELD_COUNT; f++) {
+        buffers[f] = retryix_memory_alloc(retryix_transform_field_bytes(&layout, f, count), RETRYIX_MEM_READ_WRITE,
+                                          "transform_bench");
+        if (!buffers[f]) allocated = false;
+    }
+
+    int failures = 1;
+    if (records && result && samples && allocated) {
+        failures = run_transform_benchmark(ctx, count, iterations, records, result, buffers, samples);
+    }
+
+    for (cl_uint f = 0; f < BENCH_FIELD_COUNT; f++) {
+        if (buffers[f]) retryix_memory_free(buffers[f]);
+    }
+    free(samples);
+    free(result);
+    free(records);
+    return failures ? -1 : 0;
+}
@@ -0,0 +1,309 @@
+// test_retryix_units.c - RetryIX 決定性回歸檢查（make test）
+// 純主機端項目一律執行；需要 OpenCL 設備的項目在找不到設備時略過
+// 用法：
+//   ./test_retryix_units.exe    # 全部通過回傳 0，否則回傳失敗數
+
+#ifndef CL_TARGET_OPENCL_VERSION
+#define CL_TARGET_OPENCL_VERSION 200
+#endif
+#include "retryix_cl_compat.h"
+#include "retryix.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 從 retryix_kernel.c 導出的 API
+int  retryix_kernel_init(cl_context context, cl_device_id device, cl_command_queue queue);
+void retryix_kernel_cleanup(void);
+
+static int g_checks = 0;
+static int g_failures = 0;
+
+#define CHECK(cond, ...) do { \
+    g_checks++; \
+    if (!(cond)) { \
+        g_failures++; \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+    } \
+} while (0)
+
+typedef struct {
+    cl_context context;
+    cl_device_id device;
+    cl_command_queue queue;
+} test_device_t;
+
+// 取第一個平台的第一個設備；找不到時 context 為 NULL
+static void open_device(test_device_t* dev) {
+    memset(dev, 0, sizeof(*dev));
+    cl_platform_id platform = NULL;
+    cl_uint num_platforms = 0;
+    if (clGetPlatformIDs(1, &platform, &num_platforms) != CL_SUCCESS || num_platforms == 0) return;
+    cl_uint num_devices = 0;
+    if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 1, &dev->device, &num_devices) != CL_SUCCESS || num_devices == 0) return;
+
+    cl_int err;
+    dev->context = clCreateContext(NULL, 1, &dev->device, NULL, NULL, &err);
+    if (err != CL_SUCCESS) {
+        dev->context = NULL;
+        return;
+    }
+    dev->queue = rixCreateQueue(dev->context, dev->device, &err);
+    if (err != CL_SUCCESS || !dev->queue) {
+        clReleaseContext(dev->context);
+        dev->context = NULL;
+        dev->queue = NULL;
+    }
+}
+
+static void close_device(test_device_t* dev) {
+    if (dev->queue) clReleaseCommandQueue(dev->queue);
+    if (dev->context) clReleaseContext(dev->context);
+    memset(dev, 0, sizeof(*dev));
+}
+
+// === 雜湊表 ===
+
+// 每個鍵重複兩次，最後一個換成保留值；另一半查詢為不存在的鍵
+static void test_hash(const test_device_t* dev) {
+    if (!dev->context) {
+        printf("SKIP hash: no OpenCL device\n");
+        return;
+    }
+    if (retryix_kernel_init(dev->context, dev->device, dev->queue) != 0 ||
+        retryix_hash_init(dev->context, dev->device, dev->queue, NULL) != 0) {
+        CHECK(false, "hash init failed");
+        return;
+    }
+
+    const size_t n = 4096;
+    const cl_uint mult = 2654435761u;
+    cl_uint* keys = (cl_uint*)retryix_memory_alloc(n * sizeof(cl_uint), RETRYIX_MEM_READ_WRITE, "test_hash_keys");
+    cl_uint* values = (cl_uint*)retryix_memory_alloc(n * sizeof(cl_uint), RETRYIX_MEM_READ_WRITE, "test_hash_values");
+    cl_uint* queries = (cl_uint*)retryix_memory_alloc(2 * n * sizeof(cl_uint), RETRYIX_MEM_READ_WRITE, "test_hash_queries");
+    cl_uint* out = (cl_uint*)retryix_memory_alloc(2 * n * sizeof(cl_uint), RETRYIX_MEM_READ_WRITE, "test_hash_out");
+    retryix_hash_table_t* table = retryix_hash_create(n, 0.5, 0);
+    CHECK(keys && values && queries && out && table, "hash allocation failed");
+
+    if (keys && values && queries && out && table) {
+        for (size_t i = 0; i < n; i++) {
+            keys[i] = (cl_uint)(i / 2) * mult;
+            values[i] = keys[i] ^ 0x5A5A5A5Au;
+            queries[i] = keys[i];
+            queries[n + i] = (cl_uint)(i + 0x100000u) * mult;
+        }
+        keys[n - 1] = RETRYIX_HASH_NOT_FOUND;
+        queries[n - 1] = RETRYIX_HASH_NOT_FOUND;
+        retryix_memory_copy_to_device(keys, dev->queue, true);
+        retryix_memory_copy_to_device(values, dev->queue, true);
+        retryix_memory_copy_to_device(queries, dev->queue, true);
+
+        size_t inserted = 0;
+        CHECK(retryix_hash_insert(table, keys, values, n, &inserted) == 0, "hash insert failed");
+        CHECK(inserted == n / 2, "hash inserted %zu distinct keys, expected %zu", inserted, n / 2);
+        CHECK(retryix_hash_size(table) == n / 2, "hash size %zu, expected %zu", retryix_hash_size(table), n / 2);
+
+        size_t found = 0;
+        CHECK(retryix_hash_lookup(table, queries, out, 2 * n, &found) == 0, "hash lookup failed");
+        CHECK(found == n - 1, "hash found %zu keys, expected %zu", found, n - 1);
+        retryix_memory_copy_from_device(out, dev->queue, true);
+        size_t wrong = 0;
+        for (size_t i = 0; i < n - 1; i++) wrong += (out[i] != values[i]);
+        for (size_t i = n - 1; i < 2 * n; i++) wrong += (out[i] != RETRYIX_HASH_NOT_FOUND);
+        CHECK(wrong == 0, "hash lookup returned %zu wrong values", wrong);
+
+        size_t occupied = 0, distinct = 0;
+        CHECK(retryix_hash_count(table, &occupied) == 0 && occupied == n / 2,
+              "hash count %zu, expected %zu", occupied, n / 2);
+        CHECK(retryix_hash_count_distinct(keys, n, &distinct) == 0 && distinct == n / 2,
+              "hash distinct %zu, expected %zu", distinct, n / 2);
+    }
+
+    retryix_hash_destroy(table);
+    if (out) retryix_memory_free(out);
+    if (queries) retryix_memory_free(queries);
+    if (values) retryix_memory_free(values);
+    if (keys) retryix_memory_free(keys);
+    retryix_hash_cleanup();
+    retryix_kernel_cleanup();
+    retryix_memory_cleanup();
+}
+
+// === 半精度轉換（主機端） ===
+
+// 已知位元樣式（含次正規、溢位、最近偶數捨入的平手情況），再以全部 65536 個值做來回轉換
+static void test_half_conversion(void) {
+    static const struct { float value; cl_half bits; } cases[] = {
+        { 0.0f, 0x0000 }, { -0.0f, 0x8000 }, { 1.0f, 0x3C00 }, { -2.0f, 0xC000 },
+        { 65504.0f, 0x7BFF },                   // 最大有限值
+        { 65520.0f, 0x7C00 },                   // 捨入後溢位為無限大
+        { 1e10f, 0x7C00 }, { INFINITY, 0x7C00 }, { -INFINITY, 0xFC00 },
+        { 6.103515625e-5f, 0x0400 },            // 2^-14 最小正規值
+        { 5.9604644775390625e-8f, 0x0001 },     // 2^-24 最小次正規值
+        { 2.98023223876953125e-8f, 0x0000 },    // 2^-25 平手捨入至偶數 0
+        { 8.94069671630859375e-8f, 0x0002 },    // 3 * 2^-25 平手捨入至偶數 2
+        { 1.00048828125f, 0x3C00 },             // 1 + 2^-11 平手捨入至偶數
+        { 1.00146484375f, 0x3C02 },             // 1 + 3 * 2^-11 平手捨入至偶數
+    };
+    const size_t count = sizeof(cases) / sizeof(cases[0]);
+    for (size_t i = 0; i < count; i++) {
+        cl_half bits = 0;
+        retryix_half_from_float(&bits, &cases[i].value, 1);
+        CHECK(bits == cases[i].bits, "half_from_float(%g) = 0x%04X, expected 0x%04X",
+              cases[i].value, (unsigned)bits, (unsigned)cases[i].bits);
+    }
+
+    float nan_value = NAN;
+    cl_half nan_bits = 0;
+    retryix_half_from_float(&nan_bits, &nan_value, 1);
+    CHECK((nan_bits & 0x7C00) == 0x7C00 && (nan_bits & 0x03FF) != 0, "half_from_float(NaN) = 0x%04X", (unsigned)nan_bits);
+
+    cl_half* all = (cl_half*)malloc(65536 * sizeof(cl_half));
+    cl_half* back = (cl_half*)malloc(65536 * sizeof(cl_half));
+    float* widened = (float*)malloc(65536 * sizeof(float));
+    CHECK(all && back && widened, "half allocation failed");
+    if (all && back && widened) {
+        for (size_t i = 0; i < 65536; i++) all[i] = (cl_half)i;
+        retryix_half_to_float(widened, all, 65536);
+        retryix_half_from_float(back, widened, 65536);
+        size_t wrong = 0;
+        for (size_t i = 0; i < 65536; i++) {
+            bool is_nan = (all[i] & 0x7C00) == 0x7C00 && (all[i] & 0x03FF) != 0;
+            if (is_nan) wrong += !isnan(widened[i]);
+            else wrong += (back[i] != all[i]);
+        }
+        CHECK(wrong == 0, "half round trip changed %zu of 65536 values", wrong);
+        CHECK(widened[0x3555] == 0.333251953125f && widened[0x0001] == 5.9604644775390625e-8f &&
+              widened[0xFC00] == -INFINITY, "half_to_float known values");
+    }
+    free(widened);
+    free(back);
+    free(all);
+}
+
+// === CPU 偽設備（主機端） ===
+
+// 元素數刻意不是向量寬度與區塊大小的倍數，涵蓋 SIMD 尾端與跨區塊進位；小整數值浮點數使總和在 2^24 內精確
+static void test_cpu_fallback(void) {
+    if (retryix_cpu_device_init() != 0) {
+        CHECK(false, "cpu device init failed");
+        return;
+    }
+
+    const size_t n = 3 * 65536 + 7;
+    float* a = (float*)malloc(n * sizeof(float));
+    float* b = (float*)malloc(n * sizeof(float));
+    float* out = (float*)malloc(n * sizeof(float));
+    cl_int* ints = (cl_int*)malloc(n * sizeof(cl_int));
+    cl_int* scan = (cl_int*)malloc(n * sizeof(cl_int));
+    CHECK(a && b && out && ints && scan, "cpu allocation failed");
+
+    if (a && b && out && ints && scan) {
+        for (size_t i = 0; i < n; i++) {
+            a[i] = (float)(i % 16);
+            b[i] = (float)(i % 7) - 3.0f;
+            ints[i] = (cl_int)(i % 11) - 5;
+        }
+
+        size_t wrong = 0;
+        CHECK(retryix_cpu_elementwise(RETRYIX_CPU_OP_AXPY, out, a, b, 2.0f, n) == 0, "cpu axpy failed");
+        for (size_t i = 0; i < n; i++) wrong += (out[i] != 2.0f * a[i] + b[i]);
+        CHECK(wrong == 0, "cpu axpy returned %zu wrong values", wrong);
+
+        // out 與 a 相同（原地運算）
+        memcpy(out, a, n * sizeof(float));
+        CHECK(retryix_cpu_elementwise(RETRYIX_CPU_OP_INCREMENT, out, out, NULL, 0.0f, n) == 0, "cpu increment failed");
+        wrong = 0;
+        for (size_t i = 0; i < n; i++) wrong += (out[i] != a[i] + 1.0f);
+        CHECK(wrong == 0, "cpu increment returned %zu wrong values", wrong);
+        CHECK(retryix_cpu_elementwise(RETRYIX_CPU_OP_ADD, out, a, NULL, 0.0f, n) != 0, "cpu add accepted a NULL operand");
+
+        double expect_sum = 0.0;
+        cl_int expect_min = ints[0], expect_max = ints[0];
+        long long expect_isum = 0;
+        for (size_t i = 0; i < n; i++) {
+            expect_sum += a[i];
+            expect_isum += ints[i];
+            if (ints[i] < expect_min) expect_min = ints[i];
+            if (ints[i] > expect_max) expect_max = ints[i];
+        }
+        float fsum = 0.0f;
+        cl_int isum = 0, imin = 0, imax = 0;
+        CHECK(retryix_cpu_reduce(RETRYIX_PRIM_FLOAT, RETRYIX_PRIM_OP_SUM, a, n, &fsum) == 0 && fsum == (float)expect_sum,
+              "cpu float sum %.1f, expected %.1f", fsum, expect_sum);
+        CHECK(retryix_cpu_reduce(RETRYIX_PRIM_INT, RETRYIX_PRIM_OP_SUM, ints, n, &isum) == 0 && isum == (cl_int)expect_isum,
+              "cpu int sum %d, expected %lld", isum, expect_isum);
+        CHECK(retryix_cpu_reduce(RETRYIX_PRIM_INT, RETRYIX_PRIM_OP_MIN, ints, n, &imin) == 0 && imin == expect_min,
+              "cpu int min %d, expected %d", imin, expect_min);
+        CHECK(retryix_cpu_reduce(RETRYIX_PRIM_INT, RETRYIX_PRIM_OP_MAX, ints, n, &imax) == 0 && imax == expect_max,
+              "cpu int max %d, expected %d", imax, expect_max);
+
+        for (int inclusive = 0; inclusive <= 1; inclusive++) {
+            CHECK(retryix_cpu_scan(RETRYIX_PRIM_INT, ints, scan, n, inclusive) == 0, "cpu scan failed");
+            cl_int running = 0;
+            wrong = 0;
+            for (size_t i = 0; i < n; i++) {
+                if (inclusive) running += ints[i];
+                wrong += (scan[i] != running);
+                if (!inclusive) running += ints[i];
+            }
+            CHECK(wrong == 0, "cpu %s scan returned %zu wrong values", inclusive ? "inclusive" : "exclusive", wrong);
+        }
+    }
+
+    free(scan);
+    free(ints);
+    free(out);
+    free(b);
+    free(a);
+    retryix_cpu_device_cleanup();
+}
+
+// === 設備分割方案解析（主機端） ===
+
+static void test_partition_parse(void) {
+    retryix_partition_spec_t spec;
+    CHECK(retryix_partition_parse("numa", &spec) == 0 && spec.mode == RETRYIX_PARTITION_BY_AFFINITY &&
+          spec.domain == CL_DEVICE_AFFINITY_DOMAIN_NUMA, "parse numa");
+    CHECK(retryix_partition_parse("L3", &spec) == 0 && spec.mode == RETRYIX_PARTITION_BY_AFFINITY &&
+          spec.domain == CL_DEVICE_AFFINITY_DOMAIN_L3_CACHE, "parse L3 (case-insensitive)");
+    CHECK(retryix_partition_parse("next", &spec) == 0 &&
+          spec.domain == CL_DEVICE_AFFINITY_DOMAIN_NEXT_PARTITIONABLE, "parse next");
+    CHECK(retryix_partition_parse("equally:4", &spec) == 0 && spec.mode == RETRYIX_PARTITION_EQUALLY && spec.units == 4,
+          "parse equally:4");
+    CHECK(retryix_partition_parse("Counts:2,3,1", &spec) == 0 && spec.mode == RETRYIX_PARTITION_BY_COUNTS &&
+          spec.num_counts == 3 && spec.counts[0] == 2 && spec.counts[1] == 3 && spec.counts[2] == 1,
+          "parse counts:2,3,1");
+
+    char many[128] = "counts:";
+    for (int i = 0; i <= RETRYIX_PARTITION_MAX_UNITS; i++) strcat(many, i ? ",1" : "1");
+    const char* invalid[] = { "", "bogus", "equally:0", "equally:", "counts:", "counts:1,0", many };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        CHECK(retryix_partition_parse(invalid[i], &spec) != 0, "parse accepted \"%s\"", invalid[i]);
+    }
+    char too_long[160];
+    memset(too_long, 'a', sizeof(too_long) - 1);
+    too_long[sizeof(too_long) - 1] = '\0';
+    CHECK(retryix_partition_parse(too_long, &spec) != 0, "parse accepted an over-long scheme");
+    CHECK(retryix_partition_parse(NULL, &spec) != 0 && retryix_partition_parse("numa", NULL) != 0, "parse accepted NULL");
+}
+
+int main(void) {
+    test_device_t dev;
+    open_device(&dev);
+
+    test_half_conversion();
+    test_cpu_fallback();
+    test_partition_parse();
+    test_hash(&dev);
+
+    close_device(&dev);
+    retryix_pool_cleanup();
+    printf("%d checks, %d failures\n", g_checks, g_failures);
+    return g_failures;
+}